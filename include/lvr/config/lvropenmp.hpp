@@ -24,6 +24,9 @@ public:
 
 	/// Enables the maximum number of parallel threads
 	static void setMaxNumThreads();
+
+	/// Returns the number of the calling thread in the current team, 0 without OpenMP
+	static int  getThreadNum();
 };
 
 } // namespace lvr
@@ -0,0 +1,198 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+ /*
+ * PointOctreeLOD.hpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#ifndef POINTOCTREELOD_H_
+#define POINTOCTREELOD_H_
+
+#include <lvr/io/PointBuffer.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace lvr
+{
+
+/**
+ * @brief   A node of the level of detail hierarchy. The fields are
+ *          written to disk one by one, without the padding before
+ *          \ref offset.
+ */
+struct LODNode
+{
+    /// Minimum corner of the (cubic) node
+    float       min[3];
+
+    /// Edge length of the node
+    float       size;
+
+    /// Minimum distance between the points stored in this node
+    float       spacing;
+
+    /// Depth in the tree, root is level 0
+    int32_t     level;
+
+    /// Index of the parent node, -1 for the root
+    int32_t     parent;
+
+    /// Indices of the child nodes per octant, -1 if not present
+    int32_t     children[8];
+
+    /// Index of the first point of this node in the point storage
+    uint64_t    offset;
+
+    /// Number of points stored in this node
+    uint64_t    numPoints;
+};
+
+/**
+ * @brief   Camera parameters for view dependent node selection.
+ */
+struct LODView
+{
+    LODView();
+
+    /// Camera position
+    float       position[3];
+
+    /// Frustum planes (a, b, c, d) with normals pointing inside.
+    /// Only the first numPlanes entries are used.
+    float       planes[6][4];
+
+    /// Number of valid frustum planes. 0 disables culling
+    int         numPlanes;
+
+    /// Vertical field of view in radians
+    float       fov;
+
+    /// Height of the viewport in pixels
+    float       screenHeight;
+
+    /// Nodes whose point spacing projects to less pixels are not loaded
+    float       minPixelSize;
+};
+
+/**
+ * @brief   An octree based level of detail structure for large point
+ *          clouds in the style of Potree. Every inner node stores a
+ *          subsample of the points in its volume with a spacing that
+ *          halves with each level, the remaining points are pushed down
+ *          to the children. Rendering the nodes returned by selectNodes()
+ *          gives a view dependent approximation of the cloud that is
+ *          bounded by a point budget.
+ *
+ *          A hierarchy can be saved to a directory and reopened later.
+ *          Opening only reads the node table, point data of the nodes is
+ *          read from disk on demand.
+ */
+class PointOctreeLOD
+{
+public:
+
+    /**
+     * @brief   Builds the hierarchy. The levels are processed in parallel.
+     *
+     * @param buffer            The input point cloud
+     * @param maxLeafPoints     Nodes with less points are not split
+     * @param gridResolution    Each node keeps at most gridResolution^3
+     *                          points, one per cell of a regular grid
+     */
+    PointOctreeLOD(PointBufferPtr buffer, size_t maxLeafPoints = 20000, int gridResolution = 128);
+
+    virtual ~PointOctreeLOD() {};
+
+    /**
+     * @brief   Opens a hierarchy that was written by save(). Only the node
+     *          table is read, the points stay on disk.
+     */
+    static boost::shared_ptr<PointOctreeLOD> open(std::string directory);
+
+    /**
+     * @brief   Writes the hierarchy into the given directory (created if
+     *          necessary).
+     */
+    void save(std::string directory);
+
+    /**
+     * @brief   Selects the nodes to render for the given view. Nodes are
+     *          traversed by their projected size (largest first) until
+     *          the point budget is exhausted.
+     *
+     * @param view          Camera parameters
+     * @param pointBudget   Maximum number of points in all selected nodes
+     * @param nodes         The indices of the selected nodes
+     *
+     * @return  The number of points in the selected nodes
+     */
+    size_t selectNodes(const LODView& view, size_t pointBudget, std::vector<size_t>& nodes) const;
+
+    /**
+     * @brief   Returns the points (and colors, if present) of a node.
+     *          For opened hierarchies the data is read from disk.
+     */
+    PointBufferPtr getNodePoints(size_t id) const;
+
+    /// Returns the number of nodes in the hierarchy
+    size_t  getNumNodes() const { return m_nodes.size(); }
+
+    /// Returns the node with the given index
+    const LODNode& getNode(size_t id) const { return m_nodes[id]; }
+
+    /// Returns the total number of points in the hierarchy
+    size_t  getNumPoints() const { return m_numPoints; }
+
+    /// True if the hierarchy stores point colors
+    bool    hasColors() const { return m_hasColors; }
+
+private:
+
+    PointOctreeLOD();
+
+    /// The nodes in breadth first order. The root is the first node.
+    std::vector<LODNode>    m_nodes;
+
+    /// Points of all nodes in node order (empty for opened hierarchies)
+    floatArr                m_points;
+
+    /// Colors of all nodes in node order
+    ucharArr                m_colors;
+
+    /// Directory of an opened hierarchy
+    std::string             m_directory;
+
+    /// Total number of points
+    size_t                  m_numPoints;
+
+    /// True if colors are available
+    bool                    m_hasColors;
+};
+
+typedef boost::shared_ptr<PointOctreeLOD> PointOctreeLODPtr;
+
+} // namespace lvr
+
+#endif /* POINTOCTREELOD_H_ */
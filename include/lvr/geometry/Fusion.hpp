@@ -32,45 +32,11 @@
 #include <boost/unordered_map.hpp>
 
 #include <vector>
-#include <stack>
-#include <set>
-#include <list>
-#include <map>
-#include <unordered_map>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <float.h>
 #include <math.h>
-#include <algorithm>
-#include <queue>
-
-#ifndef __APPLE__
-#include <GL/glu.h>
-#include <GL/glut.h>
-#else
-#include <OpenGL/glu.h>
-#include <GLUT/glut.h>
-#endif
-
-#include <CGAL/Simple_cartesian.h>
-#include <CGAL/AABB_tree.h>
-#include <CGAL/AABB_traits.h>
-#include <CGAL/AABB_triangle_primitive.h>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Projection_traits_xy_3.h>
-#include <CGAL/Projection_traits_yz_3.h>
-#include <CGAL/Projection_traits_xz_3.h>
-#include <CGAL/Delaunay_triangulation_2.h>
-#include <CGAL/Constrained_Delaunay_triangulation_2.h>
-#include <CGAL/Constrained_triangulation_plus_2.h>
-#include <CGAL/intersections.h>
-#include <CGAL/Triangulation_face_base_with_info_2.h>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/squared_distance_3.h>
-#include <CGAL/Aff_transformation_3.h>
-#include <CGAL/Vector_3.h>
-#include <CGAL/Polygon_2.h>
+#include <stdint.h>
 
 #include "Vertex.hpp"
 #include "Normal.hpp"
@@ -82,81 +48,48 @@
 #include <lvr/io/Timestamp.hpp>
 #include <lvr/io/Progress.hpp>
 #include <lvr/io/Model.hpp>
-
-
+#include <lvr/config/lvropenmp.hpp>
 
 #define POINT_DIST_EPSILON 1e-4
 
 using namespace std;
 
-typedef CGAL::Simple_cartesian<double> 								K;
-typedef K::FT 														FT;
-typedef K::Segment_3 												Segment;
-typedef K::Point_3 													Point;
-typedef K::Triangle_3												Triangle;
-typedef K::Plane_3													Plane;
-
-typedef CGAL::Exact_predicates_inexact_constructions_kernel 		KD;
-typedef CGAL::Projection_traits_xz_3<KD>  							Gt;
-typedef CGAL::Delaunay_triangulation_2<Gt> 							Delaunay;
-typedef KD::Point_3 												PointD;
-typedef KD::Triangle_3 												TriangleD;
-
-struct FaceInfo2
+namespace lvr
 {
-	FaceInfo2(){}
-	int nesting_level;
-	bool in_domain(){
-		return nesting_level%2 == 1;
-	}
-};
-
-typedef CGAL::Aff_transformation_3<K> 								AffineTF;
-typedef CGAL::Polygon_2<K> 											Polygon;
-typedef CGAL::Triangulation_vertex_base_2<K> Vb;
-typedef CGAL::Triangulation_face_base_with_info_2<FaceInfo2,K> 		Fbb;
-typedef CGAL::Constrained_triangulation_face_base_2<K,Fbb> 			Fb;
-typedef CGAL::Triangulation_data_structure_2<Vb,Fb> 				TDS;
-typedef CGAL::Exact_intersections_tag 								Itag;
-typedef CGAL::Constrained_Delaunay_triangulation_2<K, TDS, Itag>	CDT;
-typedef CGAL::Constrained_triangulation_plus_2<CDT>					CDTplus;
-typedef CGAL::Triangle_2<K>											Triangle2D;
-typedef CDTplus::Point	 											Point2D;
-
-// CGAL Extensions
-
+template<typename VertexT, typename NormalT> class FusionVertex;
+template<typename VertexT, typename NormalT> class FusionFace;
 
-class ExtendedTriangle: public Triangle
+/**
+ * @brief   Integer coordinates of a cell of the uniform grids used to
+ *          weld vertices and to find the global faces near a point.
+ *          64 bit, since positions are quantized with POINT_DIST_EPSILON.
+ */
+struct FusionCell
 {
-public:
-	
-	ExtendedTriangle(Point& p, Point& q, Point& r) : Triangle(p, q, r)
-		{ m_self_index = -1; }
-	
-	ExtendedTriangle(Point& p, Point& q, Point& r, int i) : Triangle(p, q, r)
-		{ m_self_index = i; }
+    int64_t x, y, z;
 
-	/// The corresponding face's index in the mesh
-	int m_self_index;
+    bool operator==(const FusionCell& other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
 };
 
-typedef ExtendedTriangle ETriangle;
-
-typedef std::vector<ETriangle>::iterator Iterator;
-typedef CGAL::AABB_triangle_primitive<K,Iterator> Primitive;
-typedef CGAL::AABB_traits<K, Primitive> AABB_triangle_traits;
-typedef CGAL::AABB_tree<AABB_triangle_traits> Tree;
-typedef Tree::Object_and_primitive_id Object_and_primitive_id;
-typedef Tree::Primitive_id Primitive_id;
-
-
-namespace lvr
+struct FusionCellHash
 {
-template<typename VertexT, typename NormalT> class FusionVertex;
-template<typename VertexT, typename NormalT> class FusionFace;
+    size_t operator()(const FusionCell& c) const
+    {
+        return ((size_t)c.x * 73856093) ^ ((size_t)c.y * 19349663) ^ ((size_t)c.z * 83492791);
+    }
+};
 
 /**
  * @brief Implementation of a mesh structure that can be used to incrementally fuse different meshes into one.
+ *
+ * The global faces are stored in a hashed uniform grid that is extended
+ * whenever faces are added, so integrating a new mesh never rebuilds the
+ * index of the already fused ones. The distances of all new vertices to
+ * the global mesh are computed in parallel. Only the insertion of the
+ * accepted faces, which changes the global buffers, is done serially.
  */
  
 template<typename VertexT, typename NormalT> class Fusion : public BaseMesh<VertexT, NormalT>
@@ -167,11 +100,13 @@ public:
 	typedef FusionFace<VertexT, NormalT> FFace;
 	typedef FusionVertex<VertexT, NormalT> FVertex;
 	
-	typedef map<VertexT, size_t> Map;
-	typedef typename map<VertexT, size_t>::iterator MapIterator;
-	
-	typedef set<Point> PointSet;
-	typedef typename set<Point>::iterator PointSetIterator;
+	/// Hashed map from quantized positions to global vertex indices
+	typedef boost::unordered_map<FusionCell, size_t, FusionCellHash> Map;
+	typedef typename Map::iterator MapIterator;
+
+	/// Hashed grid of global face indices
+	typedef boost::unordered_map<FusionCell, vector<size_t>, FusionCellHash> Grid;
+	typedef typename Grid::iterator GridIterator;
 
 
 // Constructors
@@ -189,7 +124,7 @@ public:
 	/**
 	 * @brief   Destructor.
 	 */
-	virtual ~Fusion() {};
+	virtual ~Fusion() { reset(); };
 
 	
 // Methods of BaseMesh
@@ -238,6 +173,11 @@ public:
 	 */
 	virtual void flipEdge(uint v1, uint v2);
 
+	/**
+	 * @brief	Returns the number of vertices in the fused mesh
+	 */
+	virtual size_t meshSize() { return m_global_vertices.size(); };
+
 	
 // Fusion Specific Methods
 	
@@ -290,7 +230,7 @@ public:
 // Parameter Methods
 
 	/**
-	 * Sets the distance treshold used for AABB search
+	 * Sets the distance treshold used to classify the faces of a new mesh
 	 *
 	 * @param t 	distance treshold
 	 */ 
@@ -331,57 +271,47 @@ private:
 	///  The length of the global vertex buffer
 	size_t						  m_global_index;
 	
-	// Nochmal überarbeiten
 	/// FaceBuffer used during integration process
-	vector<FFace*> remote_faces; 
-    vector<FFace*> intersection_faces;
-    vector<FFace*> closeby_faces;
-    int redundant_faces;
-	int special_case_faces;	
-
-	/// The CGAL AABB Tree
-	Tree		tree;
-	/// The Vector the CGAL Tree is based on
-	vector<ETriangle> tree_triangles;
-	
-	//Tree		local_tree;
-	//vector<ETriangle> local_tree_triangles;
-	
-	
+	vector<FFace*> remote_faces;
+	vector<FFace*> intersection_faces;
+	vector<FFace*> closeby_faces;
+	int redundant_faces;
+	int special_case_faces;
+
+	/// The hashed grid of the global faces
+	Grid		m_grid;
+
+	/// Edge length of a grid cell, fixed by the first integrated mesh
+	double		m_cellSize;
+
 	/// The Map with all global vertices
 	Map			global_vertices_map;
-	
-	
+
+	/// Index of the global vertex closest to each local vertex, -1 if there is none in range
+	vector<long> m_local_snap;
 
 	/**
 	* @brief   Reset the the local buffer e.g. after integration or at initialization.
 	*/
 	virtual void clearLocalBuffer();
 
-	/**
-     * @brief   Reset the the global buffer e.g. at initialization.
-     */
-	//virtual void clearGlobalBuffer();
-	
 // Printing Methods
-		
+
 	/**
 	* @brief   Prints the current status of the local buffer on the console.
 	*/
 	virtual void printLocalBufferStatus();
-	
+
 	/**
 	* @brief   Prints the current status of the local buffer on the console.
 	*/
 	virtual void printGlobalBufferStatus();
-	
+
 	/**
 	* @brief   Prints the current status of the face sorting process on the console.
 	*/
 	virtual void printFaceSortingStatus();
 
-
-	
 	/**
 	 * @brief 	This method should be called every time
 	 * 			a vertex is transferred into the global buffer
@@ -389,165 +319,71 @@ private:
 	 * @param	v 		A FusionVertex from the local buffer.
 	 */
 	virtual void addGlobalVertex(FVertex *v);
-	
-	/**
-	 * @brief 	creates CGAL ETriangle from lvr Face
-	 */
-	virtual ETriangle faceToETriangle(FFace *face);
-	
-	/**
-	 * @brief 	creates CGAL Plane from lvr Face
-	 */
-	virtual Plane faceToPlane(FFace *face);
-	
-	/**
-	 * @brief calculates Transformation matrix from face to xy plane
-	 */
-	 virtual AffineTF calcTransform(FFace *face);
-	
-	/**
-     * @brief   Insert a new triangle into global mesh
-     *
-     * @param   f       A face from the local buffer
-     */
-	virtual void addGlobalFace(FFace *f);	
-    
-    /**
-     * @brief   build CGAL-AABB-Tree from global mesh
-	 *
-     */ 
-	virtual void buildTree();
-	
-	/**
-     * @brief   build map of global vertices with global buffer index
-	 *
-     */
-	virtual void buildVertexMap();
-	
-	/**
-     * @brief   Sort faces based on how to integrate them
-     */
-	virtual void sortFaces();
-	
-	/**
-     * @brief   Adds faces to global buffer taking care of redundant vertices
-     * 
-	 * @param	faces	Faces to be added to global buffer
-     */
-	virtual void addGlobal(vector<FFace*>& faces);
-		
-	/**
-     * @brief   Form new Triangles via Delauny Triangulation and add them to globale buffer
-	 *
-	 * @param	vertices	Vertices to triangulate
-     */
-	virtual void triangulateAndAdd(vector<Point>& vertices, Tree& tree);
-	
-	/**
-     * @brief   assigns new vertices for triangulation to their border region
-     * 
-     * @param	vertexRegions	Vector of so far formed borderRegions
-	 * @param	new_vertices	Vertices to be added to a single border Region
-     */
-	virtual void assignToBorderRegion(vector<PointSet>& vertexRegions, vector<Point>new_vertices);
-	
-	/**
-     * @brief  Integrate intersection faces
-     * 
-     * @param	faces	Faces to be integrated
-     */
-	virtual void intersectIntegrate(vector<FFace*>& faces);
-	
-	/**
-     * @brief  splits faces at their intersection points and builds new triangles
-     * 
-     * @param	faces	Faces to be split
-     * @param	tree	tree containing intersecting faces
-     */
-	virtual void splitIntersectFaces(vector<FFace*>& faces, Tree& tree);
-	
-	/**
-	 * @brief	Finds all intersecting Triangles in Tree
-	 * 
-	 * @param	face	Face to find intersections with
-	 * 
-	 * @return	Adresses of Triangles in Global Buffer
-	 */
-	virtual vector<int> getIntersectingTriangles(FFace* face);
-	
+
 	/**
-	 * @brief	Finds all intersection points with tree
-	 * 
-	 * @param	face	Face to find intersections with
-	 * 			points		vector to add found intersections points to
+	 * @brief   Returns the index of a global vertex within POINT_DIST_EPSILON
+	 *          of the given one or -1 if there is none
 	 */
-	virtual void getIntersectionPoints(FFace* face, vector<Point>& local_points, vector<Point>& global_points);
+	virtual long findGlobalVertex(const VertexT& v);
 
 	/**
-	 * @brief	Returns the CGAL Segments of a FFace
+	 * @brief   Insert a new triangle into global mesh
 	 *
-	 * @param	face 	Face to get the Segments from
-	 * @return	vector of CGAL Segments
+	 * @param   a, b, c     Global indices of the triangle vertices
 	 */
-	virtual vector<Segment> face2Segments(FFace* face);
+	virtual void addGlobalFace(size_t a, size_t b, size_t c);
 
 	/**
-	 * @brief	Returns true, if the given point lies on the given segment
-	 *
-	 * @param	p the point to check
-	 * @param 	s the segment to check
-	 * @return 	true, if the given point lies on the given segment
+	 * @brief   Chooses the grid cell size from the local mesh and the
+	 *          distance threshold. Called when the global mesh is empty.
 	 */
-	virtual bool pointOnSegment(Point& p, Segment& s);
-
+	virtual void initGrid();
 
 	/**
-	 * @brief	Finds all intersection segments
-	 * 
-	 * @param	face	Face to find intersection witt
-	 * 			segments	a vector, contains the found intersections segments
+	 * @brief   Returns the grid cell that contains the given point
 	 */
-	virtual void getIntersectionSegments(FFace *face, vector<Segment>& segments, Tree& tree);
+	FusionCell gridCell(const VertexT& v) const;
 
 	/**
-	 * @brief	sort the given segments in the order of an edge sequence with a starting- and an endpoint
+	 * @brief   Computes the squared distance of a point to the global mesh
+	 *          and its closest global vertex. Only the global faces within
+	 *          the distance threshold are considered. Does not modify the
+	 *          fusion and may be called in parallel.
+	 *
+	 * @param   v           The query point
+	 * @param   nearest     The index of the closest global vertex in range or -1
 	 *
-	 * @param	segments a vector of secments to sort
+	 * @return  The squared distance or DBL_MAX if no face is in range
 	 */
-	virtual bool sortSegments(vector<Segment>& segments, vector<Point>& points);
-
+	double distanceToGlobal(const VertexT& v, long& nearest) const;
 
 	/**
-	 * @brief	triangulates the given polygon
-	 * 
-	 * @param 	polygon		the polygon to trinagluate
-	 * @param 	triangles 	a vector of polygons for the resulting triangles
-	 * @return 	true, if the triangulation was successful
+	 * @brief   Returns the squared distance between a point and a global face
 	 */
-	virtual bool polygonTriangulation(Polygon& polygon, vector<Triangle2D>& triangles);
+	double squaredDistance(const VertexT& v, FFace* f) const;
 
 	/**
-	 * @brief	writs the given polygons in a svg file with the given filename
-	 * @param 	polys the polygons
-	 * @param	filename the filename of the resulting svg file
+	 * @brief   Sort faces based on how to integrate them. The distances of
+	 *          the local vertices to the global mesh are computed in parallel.
 	 */
-	virtual void writePolygonToSVG(vector<Polygon>& polys, vector<Triangle2D>& triangles, string& filename);
+	virtual void sortFaces();
 
 	/**
-	 * @brief 	build polygons from a intesected face and the intersection path
+	 * @brief   Adds faces to global buffer taking care of redundant vertices
 	 *
-	 * @param 	face 	the face to build polygons from
-	 * @param 	points	the intersection path
-	 * @return  vector of vectors with points to hold the polygons
+	 * @param	faces	Faces to be added to global buffer
 	 */
-	virtual vector<vector<Point> > buildPolygons(FFace *face, vector<Point>& points);
-
-	virtual void markDomains(CDT& cdt);
+	virtual void addGlobal(vector<FFace*>& faces);
 
-	virtual void markDomains(CDT& ct,
-		CDT::Face_handle start,
-		int index,
-		list<CDT::Edge>& border );
+	/**
+	 * @brief  Integrate intersection faces. Vertices that are close to the
+	 *         global mesh are snapped to the nearest global vertex, which
+	 *         closes the seam between the meshes. Faces that collapse are
+	 *         dropped.
+	 *
+	 * @param	faces	Faces to be integrated
+	 */
+	virtual void intersectIntegrate(vector<FFace*>& faces);
 };
 
 } // namespace lvr
@@ -0,0 +1,734 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * Fusion.tcc
+ *
+ *  @date   11.07.2013
+ *  @author Ann-Katrin Häuser (ahaeuser@uos.de)
+ *  @author Henning Deeken (hdeeken@uos.de)
+ *  @author Thomas Wiemann (twiemann@uos.de)
+ *  @author Sebastian Puetz (spuetz@uos.de)
+ */
+
+namespace lvr
+{
+
+template<typename VertexT, typename NormalT> Fusion<VertexT, NormalT>::Fusion()
+{
+	verbose = false;
+	threshold = 0.01;
+	m_cellSize = 0;
+	m_local_index = 0;
+	m_global_index = 0;
+	redundant_faces = 0;
+	special_case_faces = 0;
+	this->m_finalized = false;
+}
+
+template<typename VertexT, typename NormalT> Fusion<VertexT, NormalT>::Fusion(MeshBufferPtr model)
+{
+	verbose = false;
+	threshold = 0.01;
+	m_cellSize = 0;
+	m_local_index = 0;
+	m_global_index = 0;
+	redundant_faces = 0;
+	special_case_faces = 0;
+	this->m_finalized = false;
+
+	addMesh(model);
+	lazyIntegrate();
+}
+
+///
+/// Methods of BaseMesh
+///
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addVertex(VertexT v)
+{
+	FVertex* vertex = new FVertex(v);
+	vertex->m_self_index = -1;
+	m_local_vertices.push_back(vertex);
+	m_local_index++;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addNormal(NormalT n)
+{
+	if(m_local_vertices.size())
+	{
+		m_local_vertices.back()->m_normal = n;
+	}
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addTriangle(uint a, uint b, uint c)
+{
+	FFace* face = new FFace;
+
+	face->m_index[0] = a;
+	face->m_index[1] = b;
+	face->m_index[2] = c;
+
+	face->vertices[0] = m_local_vertices[a];
+	face->vertices[1] = m_local_vertices[b];
+	face->vertices[2] = m_local_vertices[c];
+
+	face->m_self_index = m_local_faces.size();
+	m_local_faces.push_back(face);
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::finalize()
+{
+	size_t numVertices = m_global_vertices.size();
+	size_t numFaces = m_global_faces.size();
+
+	floatArr vertexBuffer(new float[3 * numVertices]);
+	floatArr normalBuffer(new float[3 * numVertices]);
+	uintArr  indexBuffer(new unsigned int[3 * numFaces]);
+
+	#pragma omp parallel for
+	for(long i = 0; i < (long)numVertices; i++)
+	{
+		for(int j = 0; j < 3; j++)
+		{
+			vertexBuffer[3 * i + j] = m_global_vertices[i]->m_position[j];
+			normalBuffer[3 * i + j] = m_global_vertices[i]->m_normal[j];
+		}
+	}
+
+	#pragma omp parallel for
+	for(long i = 0; i < (long)numFaces; i++)
+	{
+		for(int j = 0; j < 3; j++)
+		{
+			indexBuffer[3 * i + j] = m_global_faces[i]->m_index[j];
+		}
+	}
+
+	if ( !this->m_meshBuffer )
+	{
+		this->m_meshBuffer = MeshBufferPtr( new MeshBuffer );
+	}
+	this->m_meshBuffer->setVertexArray( vertexBuffer, numVertices );
+	this->m_meshBuffer->setVertexNormalArray( normalBuffer, numVertices );
+	this->m_meshBuffer->setFaceArray( indexBuffer, numFaces );
+
+	this->m_finalized = true;
+
+	if(verbose)
+	{
+		cout << timestamp << "Finalized mesh with " << numVertices << " vertices and " << numFaces << " faces." << endl;
+	}
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::flipEdge(uint v1, uint v2)
+{
+	cout << timestamp << "Fusion: flipEdge() is not supported." << endl;
+}
+
+///
+/// Fusion Specific Methods
+///
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addMesh(MeshBufferPtr model)
+{
+	if(!model)
+	{
+		cout << timestamp << "Fusion: Given mesh buffer is empty." << endl;
+		return;
+	}
+
+	clearLocalBuffer();
+
+	floatView vertices = model->getVertexView();
+	floatView normals = model->getVertexNormalView();
+	uintView faces = model->getFaceView();
+
+	m_local_vertices.reserve(vertices.size());
+	m_local_faces.reserve(faces.size());
+
+	for(size_t i = 0; i < vertices.size(); i++)
+	{
+		addVertex(VertexT(vertices(i, 0), vertices(i, 1), vertices(i, 2)));
+		if(normals.size() == vertices.size())
+		{
+			addNormal(NormalT(normals(i, 0), normals(i, 1), normals(i, 2)));
+		}
+	}
+
+	for(size_t i = 0; i < faces.size(); i++)
+	{
+		addTriangle(faces(i, 0), faces(i, 1), faces(i, 2));
+	}
+
+	if(verbose)
+	{
+		printLocalBufferStatus();
+	}
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::integrate()
+{
+	if(m_global_faces.size() == 0)
+	{
+		lazyIntegrate();
+		return;
+	}
+
+	if(verbose)
+	{
+		cout << timestamp << "Start integrating mesh..." << endl;
+	}
+
+	sortFaces();
+
+	addGlobal(remote_faces);
+	intersectIntegrate(intersection_faces);
+
+	if(verbose)
+	{
+		printGlobalBufferStatus();
+	}
+
+	clearLocalBuffer();
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::lazyIntegrate()
+{
+	if(m_global_faces.size() == 0)
+	{
+		initGrid();
+	}
+
+	if(verbose)
+	{
+		cout << timestamp << "Start lazy integration..." << endl;
+	}
+
+	// Add all vertices without looking for redundant ones
+	m_global_vertices.reserve(m_global_vertices.size() + m_local_vertices.size());
+	for(size_t i = 0; i < m_local_vertices.size(); i++)
+	{
+		addGlobalVertex(m_local_vertices[i]);
+	}
+
+	for(size_t i = 0; i < m_local_faces.size(); i++)
+	{
+		FFace* f = m_local_faces[i];
+		addGlobalFace(f->vertices[0]->m_self_index, f->vertices[1]->m_self_index, f->vertices[2]->m_self_index);
+	}
+
+	if(verbose)
+	{
+		printGlobalBufferStatus();
+	}
+
+	clearLocalBuffer();
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addMeshAndIntegrate(MeshBufferPtr model)
+{
+	addMesh(model);
+	integrate();
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addMeshAndLazyIntegrate(MeshBufferPtr model)
+{
+	addMesh(model);
+	lazyIntegrate();
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addMeshAndRemoteIntegrateOnly(MeshBufferPtr model)
+{
+	addMesh(model);
+
+	if(m_global_faces.size() == 0)
+	{
+		lazyIntegrate();
+		return;
+	}
+
+	sortFaces();
+	addGlobal(remote_faces);
+
+	if(verbose)
+	{
+		printGlobalBufferStatus();
+	}
+
+	clearLocalBuffer();
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::reset()
+{
+	clearLocalBuffer();
+
+	for(size_t i = 0; i < m_global_faces.size(); i++)
+	{
+		delete m_global_faces[i];
+	}
+	for(size_t i = 0; i < m_global_vertices.size(); i++)
+	{
+		delete m_global_vertices[i];
+	}
+
+	m_global_faces.clear();
+	m_global_vertices.clear();
+	m_global_index = 0;
+
+	m_grid.clear();
+	global_vertices_map.clear();
+	m_cellSize = 0;
+
+	this->m_finalized = false;
+}
+
+///
+/// Private Methods
+///
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::clearLocalBuffer()
+{
+	for(size_t i = 0; i < m_local_faces.size(); i++)
+	{
+		delete m_local_faces[i];
+	}
+	for(size_t i = 0; i < m_local_vertices.size(); i++)
+	{
+		delete m_local_vertices[i];
+	}
+
+	m_local_faces.clear();
+	m_local_vertices.clear();
+	m_local_snap.clear();
+	m_local_index = 0;
+
+	remote_faces.clear();
+	intersection_faces.clear();
+	closeby_faces.clear();
+	redundant_faces = 0;
+	special_case_faces = 0;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::printLocalBufferStatus()
+{
+	cout << timestamp << "Local Buffer: " << m_local_vertices.size() << " vertices, " << m_local_faces.size() << " faces" << endl;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::printGlobalBufferStatus()
+{
+	cout << timestamp << "Global Buffer: " << m_global_vertices.size() << " vertices, " << m_global_faces.size()
+		 << " faces in " << m_grid.size() << " grid cells" << endl;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::printFaceSortingStatus()
+{
+	cout << timestamp << "Face sorting: " << remote_faces.size() << " remote, " << intersection_faces.size()
+		 << " intersection, " << closeby_faces.size() << " closeby faces" << endl;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addGlobalVertex(FVertex *v)
+{
+	FVertex* vertex = new FVertex(*v);
+	vertex->m_self_index = m_global_index;
+	vertex->is_valid = true;
+	v->m_self_index = m_global_index;
+
+	m_global_vertices.push_back(vertex);
+
+	// The first vertex at a position is the one redundant vertices are welded to
+	FusionCell key = {(int64_t)floor(v->m_position[0] / POINT_DIST_EPSILON),
+					  (int64_t)floor(v->m_position[1] / POINT_DIST_EPSILON),
+					  (int64_t)floor(v->m_position[2] / POINT_DIST_EPSILON)};
+	global_vertices_map.insert(make_pair(key, m_global_index));
+
+	m_global_index++;
+}
+
+template<typename VertexT, typename NormalT> long Fusion<VertexT, NormalT>::findGlobalVertex(const VertexT& v)
+{
+	int64_t cx = (int64_t)floor(v[0] / POINT_DIST_EPSILON);
+	int64_t cy = (int64_t)floor(v[1] / POINT_DIST_EPSILON);
+	int64_t cz = (int64_t)floor(v[2] / POINT_DIST_EPSILON);
+
+	// Check the cell of the vertex first, the neighbors catch positions that
+	// are rounded into different cells
+	FusionCell key = {cx, cy, cz};
+	MapIterator it = global_vertices_map.find(key);
+	if(it != global_vertices_map.end())
+	{
+		return it->second;
+	}
+
+	for(int dx = -1; dx <= 1; dx++)
+	{
+		for(int dy = -1; dy <= 1; dy++)
+		{
+			for(int dz = -1; dz <= 1; dz++)
+			{
+				FusionCell n = {cx + dx, cy + dy, cz + dz};
+				it = global_vertices_map.find(n);
+				if(it != global_vertices_map.end())
+				{
+					VertexT d = m_global_vertices[it->second]->m_position - v;
+					if(d[0] * d[0] + d[1] * d[1] + d[2] * d[2] < POINT_DIST_EPSILON * POINT_DIST_EPSILON)
+					{
+						return it->second;
+					}
+				}
+			}
+		}
+	}
+	return -1;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addGlobalFace(size_t a, size_t b, size_t c)
+{
+	FFace* face = new FFace;
+
+	face->m_index[0] = a;
+	face->m_index[1] = b;
+	face->m_index[2] = c;
+
+	face->vertices[0] = m_global_vertices[a];
+	face->vertices[1] = m_global_vertices[b];
+	face->vertices[2] = m_global_vertices[c];
+
+	face->m_self_index = m_global_faces.size();
+	face->is_valid = true;
+	m_global_faces.push_back(face);
+
+	// Insert the face into all cells overlapped by its bounding box
+	FusionCell min = gridCell(face->vertices[0]->m_position);
+	FusionCell max = min;
+	for(int i = 1; i < 3; i++)
+	{
+		FusionCell cell = gridCell(face->vertices[i]->m_position);
+		min.x = std::min(min.x, cell.x); max.x = std::max(max.x, cell.x);
+		min.y = std::min(min.y, cell.y); max.y = std::max(max.y, cell.y);
+		min.z = std::min(min.z, cell.z); max.z = std::max(max.z, cell.z);
+	}
+
+	for(int64_t x = min.x; x <= max.x; x++)
+	{
+		for(int64_t y = min.y; y <= max.y; y++)
+		{
+			for(int64_t z = min.z; z <= max.z; z++)
+			{
+				FusionCell cell = {x, y, z};
+				m_grid[cell].push_back(face->m_self_index);
+			}
+		}
+	}
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::initGrid()
+{
+	// Use the mean edge length, but at least the distance threshold. Then
+	// each face overlaps only a few cells and every query touches at most
+	// eight cells.
+	double length = 0;
+	for(size_t i = 0; i < m_local_faces.size(); i++)
+	{
+		FFace* f = m_local_faces[i];
+		for(int j = 0; j < 3; j++)
+		{
+			VertexT d = f->vertices[j]->m_position - f->vertices[(j + 1) % 3]->m_position;
+			length += sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+		}
+	}
+
+	if(m_local_faces.size())
+	{
+		length /= 3 * m_local_faces.size();
+	}
+
+	m_cellSize = std::max(length, sqrt(threshold));
+	if(m_cellSize <= 0)
+	{
+		m_cellSize = 1.0;
+	}
+
+	if(verbose)
+	{
+		cout << timestamp << "Fusion grid cell size: " << m_cellSize << endl;
+	}
+}
+
+template<typename VertexT, typename NormalT> FusionCell Fusion<VertexT, NormalT>::gridCell(const VertexT& v) const
+{
+	FusionCell cell = {(int64_t)floor(v[0] / m_cellSize),
+					   (int64_t)floor(v[1] / m_cellSize),
+					   (int64_t)floor(v[2] / m_cellSize)};
+	return cell;
+}
+
+template<typename VertexT, typename NormalT> double Fusion<VertexT, NormalT>::distanceToGlobal(const VertexT& v, long& nearest) const
+{
+	double r = sqrt(threshold);
+	double dist = DBL_MAX;
+	double vertexDist = threshold;
+	nearest = -1;
+
+	FusionCell min = gridCell(VertexT(v[0] - r, v[1] - r, v[2] - r));
+	FusionCell max = gridCell(VertexT(v[0] + r, v[1] + r, v[2] + r));
+
+	for(int64_t x = min.x; x <= max.x; x++)
+	{
+		for(int64_t y = min.y; y <= max.y; y++)
+		{
+			for(int64_t z = min.z; z <= max.z; z++)
+			{
+				FusionCell cell = {x, y, z};
+				typename Grid::const_iterator it = m_grid.find(cell);
+				if(it == m_grid.end())
+				{
+					continue;
+				}
+
+				const vector<size_t>& faces = it->second;
+				for(size_t i = 0; i < faces.size(); i++)
+				{
+					FFace* f = m_global_faces[faces[i]];
+					dist = std::min(dist, squaredDistance(v, f));
+
+					for(int j = 0; j < 3; j++)
+					{
+						VertexT d = f->vertices[j]->m_position - v;
+						double dv = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+						if(dv < vertexDist)
+						{
+							vertexDist = dv;
+							nearest = f->m_index[j];
+						}
+					}
+				}
+			}
+		}
+	}
+	return dist;
+}
+
+template<typename VertexT, typename NormalT> double Fusion<VertexT, NormalT>::squaredDistance(const VertexT& v, FFace* f) const
+{
+	// Closest point on triangle, see Ericson, Real-Time Collision Detection, 5.1.5
+	const VertexT& a = f->vertices[0]->m_position;
+	const VertexT& b = f->vertices[1]->m_position;
+	const VertexT& c = f->vertices[2]->m_position;
+
+	double ab[3], ac[3], ap[3], closest[3];
+	for(int i = 0; i < 3; i++)
+	{
+		ab[i] = b[i] - a[i];
+		ac[i] = c[i] - a[i];
+		ap[i] = v[i] - a[i];
+	}
+
+	double d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+	double d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+
+	double bp[3], cp[3];
+	for(int i = 0; i < 3; i++)
+	{
+		bp[i] = v[i] - b[i];
+		cp[i] = v[i] - c[i];
+	}
+
+	double d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+	double d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+	double d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+	double d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+
+	double vc = d1 * d4 - d3 * d2;
+	double vb = d5 * d2 - d1 * d6;
+	double va = d3 * d6 - d5 * d4;
+
+	double s, t;
+	if(d1 <= 0 && d2 <= 0)
+	{
+		s = 0; t = 0;
+	}
+	else if(d3 >= 0 && d4 <= d3)
+	{
+		s = 1; t = 0;
+	}
+	else if(d6 >= 0 && d5 <= d6)
+	{
+		s = 0; t = 1;
+	}
+	else if(vc <= 0 && d1 >= 0 && d3 <= 0)
+	{
+		s = d1 / (d1 - d3); t = 0;
+	}
+	else if(vb <= 0 && d2 >= 0 && d6 <= 0)
+	{
+		s = 0; t = d2 / (d2 - d6);
+	}
+	else if(va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+	{
+		t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		s = 1 - t;
+	}
+	else
+	{
+		double denom = 1.0 / (va + vb + vc);
+		s = vb * denom;
+		t = vc * denom;
+	}
+
+	double dist = 0;
+	for(int i = 0; i < 3; i++)
+	{
+		closest[i] = a[i] + s * ab[i] + t * ac[i] - v[i];
+		dist += closest[i] * closest[i];
+	}
+	return dist;
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::sortFaces()
+{
+	remote_faces.clear();
+	intersection_faces.clear();
+	closeby_faces.clear();
+	redundant_faces = 0;
+	special_case_faces = 0;
+
+	// The global buffers are not changed here, so all distance queries
+	// can run in parallel
+	m_local_snap.resize(m_local_vertices.size());
+
+	#pragma omp parallel for schedule(dynamic, 256)
+	for(long i = 0; i < (long)m_local_vertices.size(); i++)
+	{
+		FVertex* v = m_local_vertices[i];
+		v->m_tree_dist = distanceToGlobal(v->m_position, m_local_snap[i]);
+	}
+
+	vector<unsigned char> close(m_local_faces.size());
+
+	#pragma omp parallel for
+	for(long i = 0; i < (long)m_local_faces.size(); i++)
+	{
+		FFace* f = m_local_faces[i];
+		close[i] = 0;
+		for(int j = 0; j < 3; j++)
+		{
+			if(f->vertices[j]->m_tree_dist < threshold)
+			{
+				close[i]++;
+			}
+		}
+	}
+
+	for(size_t i = 0; i < m_local_faces.size(); i++)
+	{
+		if(close[i] == 0)
+		{
+			remote_faces.push_back(m_local_faces[i]);
+		}
+		else if(close[i] == 3)
+		{
+			closeby_faces.push_back(m_local_faces[i]);
+			redundant_faces++;
+		}
+		else
+		{
+			intersection_faces.push_back(m_local_faces[i]);
+		}
+	}
+
+	if(verbose)
+	{
+		printFaceSortingStatus();
+	}
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::addGlobal(vector<FFace*>& faces)
+{
+	for(size_t i = 0; i < faces.size(); i++)
+	{
+		FFace* f = faces[i];
+		for(int j = 0; j < 3; j++)
+		{
+			FVertex* v = f->vertices[j];
+			if(v->m_self_index == (size_t)-1)
+			{
+				long index = findGlobalVertex(v->m_position);
+				if(index >= 0)
+				{
+					v->m_self_index = index;
+				}
+				else
+				{
+					addGlobalVertex(v);
+				}
+			}
+		}
+		addGlobalFace(f->vertices[0]->m_self_index, f->vertices[1]->m_self_index, f->vertices[2]->m_self_index);
+	}
+}
+
+template<typename VertexT, typename NormalT> void Fusion<VertexT, NormalT>::intersectIntegrate(vector<FFace*>& faces)
+{
+	for(size_t i = 0; i < faces.size(); i++)
+	{
+		FFace* f = faces[i];
+		size_t index[3];
+
+		for(int j = 0; j < 3; j++)
+		{
+			FVertex* v = f->vertices[j];
+			long snap = m_local_snap[f->m_index[j]];
+			if(v->m_tree_dist < threshold && snap >= 0)
+			{
+				index[j] = snap;
+			}
+			else
+			{
+				if(v->m_self_index == (size_t)-1)
+				{
+					long found = findGlobalVertex(v->m_position);
+					if(found >= 0)
+					{
+						v->m_self_index = found;
+					}
+					else
+					{
+						addGlobalVertex(v);
+					}
+				}
+				index[j] = v->m_self_index;
+			}
+		}
+
+		if(index[0] == index[1] || index[1] == index[2] || index[0] == index[2])
+		{
+			special_case_faces++;
+			continue;
+		}
+		addGlobalFace(index[0], index[1], index[2]);
+	}
+
+	if(verbose)
+	{
+		cout << timestamp << "Integrated " << faces.size() - special_case_faces << " intersection faces, dropped "
+			 << special_case_faces << " collapsed faces." << endl;
+	}
+}
+
+} // namespace lvr
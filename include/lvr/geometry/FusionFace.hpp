@@ -36,8 +36,6 @@ using namespace std;
 #include "FusionVertex.hpp"
 #include "Normal.hpp"
 
-#include <CGAL/AABB_triangle_primitive.h>
-
 namespace lvr
 {
 
@@ -15,6 +15,7 @@
 #include <boost/geometry/geometries/polygon.hpp>
 #include <boost/geometry/io/wkt/wkt.hpp>
 #include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <Eigen/Core>
 //lvr include
@@ -119,6 +120,62 @@ public:
 
 
 private:
+	/**
+	 * @brief The data of a region that is needed for the coplanarity check
+	 */
+	struct RegionInfo
+	{
+		// bounding box, enlarged by m_distance_threshold_bounding
+		VertexT min;
+		VertexT max;
+
+		// plane of the region in Hesse normal form
+		float n[3];
+		float d;
+
+		// false, if the region has no vertices
+		bool valid;
+
+		// vertices of the outer polygon(-shell)
+		std::vector<VertexT> shell;
+	};
+
+	/**
+	 * @brief Integer coordinates of a cell of the bounding box grid
+	 */
+	struct BoxCell
+	{
+		int c[3];
+
+		bool operator==(const BoxCell& other) const
+		{
+			return c[0] == other.c[0] && c[1] == other.c[1] && c[2] == other.c[2];
+		}
+	};
+
+	struct BoxCellHash
+	{
+		size_t operator()(const BoxCell& b) const
+		{
+			return ((size_t)b.c[0] * 73856093) ^ ((size_t)b.c[1] * 19349663) ^ ((size_t)b.c[2] * 83492791);
+		}
+	};
+
+	/**
+	 * @brief Fuses all coplanar regions of one label. Only regions whose
+	 * 		bounding boxes share a cell of a hashed grid are checked
+	 * 		for coplanarity.
+	 *
+	 * @param polyregions the regions with the same label
+	 * @param output the fused and the remaining regions are appended here
+	 */
+	void fuseGroup(std::vector<PolyRegion>& polyregions, std::vector<PolyRegion>& output);
+
+	/**
+	 * @brief Collects the data of a region for the coplanarity check
+	 */
+	RegionInfo regionInfo(PolyRegion& a);
+
 	/**
 	 * @brief This function tests if these two Polygons are planar
 	 *
@@ -127,7 +184,7 @@ private:
 	 *
 	 * @return true, if these Polygons are planar
 	 */
-	bool isPlanar(PolyRegion a, PolyRegion b);
+	bool isPlanar(const RegionInfo& a, const RegionInfo& b);
 
 	/**
 	 * @brief This method calculates a transformation matrix from the xyz-Plane (3D) to the xy-Plane (2D).
@@ -157,10 +214,11 @@ private:
 	 *
 	 * @param a PolygonRegion which will be transformed
 	 * @param trans transformation as 4x4 matrix
+	 * @param dirty_fix the main axis of the dirty fix is stored here
 	 *
 	 * @return the resulting BoostPolygon
 	 */
-	BoostPolygon transformto2DBoost(PolyRegion a, Eigen::Matrix4f trans);
+	BoostPolygon transformto2DBoost(PolyRegion a, Eigen::Matrix4f trans, int& dirty_fix);
 
 
 	/**
@@ -168,10 +226,11 @@ private:
 	 *
 	 * @param a BoostPolygon which will be transformed
 	 * @param trans transformation as 4x4 matrix
+	 * @param dirty_fix the main axis computed by transformto2DBoost
 	 *
 	 * @return the resulting lvr PolygonRegion
 	 */
-	PolygonRegion<VertexT, NormalT> transformto3Dlvr(BoostPolygon a, Eigen::Matrix4f trans);
+	PolygonRegion<VertexT, NormalT> transformto3Dlvr(BoostPolygon a, Eigen::Matrix4f trans, int dirty_fix);
 
 	// Vector for all data (Polygonmesh)
 	PolyRegionMap	m_polyregionmap;
@@ -188,9 +247,6 @@ private:
 	// thresholt for overlapping bounding box check
 	double 			m_distance_threshold_bounding;
 
-	// part of a TODO
-	int dirty_fix;
-
 	// true, if the best fit plane for the transformation should be calculated with Ransac
 	// false, the best fit plane will be calculated by the interpolated normal and the centroid of all points
 	bool m_useRansac;
@@ -125,167 +125,238 @@ bool PolygonFusion<VertexT, NormalT>::doFusion(std::vector<PolyRegion> &output)
 	// step 2-5) in these bins, find "co-planar" polyregions -> same plane (Δ)
 	// TODO fix coplanar detection (gewichtet nach Anzahl Punkten)
 	// TODO benchmark coplanar threshold and fusion / detection order (not only first one)
+	// The label groups are independent, so they are fused in parallel. The
+	// results are appended in the order of the labels afterwards.
+	std::vector<std::vector<PolyRegion>* > groups;
 	typename PolyRegionMap::iterator map_iter;
 	for( map_iter = m_polyregionmap.begin(); map_iter != m_polyregionmap.end(); ++map_iter )
 	{
-		// init the container
-		std::vector<PolyRegion> polyregions = (*map_iter).second;
-		std::vector<PolyRegion> coplanar_regions;
-		std::vector<PolyRegion> nonplanar_regions;
-		std::vector<PolyRegion> fused_regions;
+		groups.push_back(&(map_iter->second));
+	}
+
+	std::vector<std::vector<PolyRegion> > group_output(groups.size());
 
+	#pragma omp parallel for schedule(dynamic)
+	for(int i = 0; i < (int)groups.size(); i++)
+	{
+		fuseGroup(*groups[i], group_output[i]);
+	}
+
+	for(size_t i = 0; i < group_output.size(); i++)
+	{
+		output.insert(output.end(), group_output[i].begin(), group_output[i].end());
+	}
 
-		typename std::vector<PolyRegion>::iterator region_iter;
-		for( region_iter = polyregions.begin(); region_iter != polyregions.end(); )
+	// done!
+	return true;
+}
+
+
+template<typename VertexT, typename NormalT>
+void PolygonFusion<VertexT, NormalT>::fuseGroup(std::vector<PolyRegion>& polyregions, std::vector<PolyRegion>& output)
+{
+	std::vector<PolyRegion> nonplanar_regions;
+	std::vector<PolyRegion> fused_regions;
+
+	size_t n = polyregions.size();
+	std::vector<RegionInfo> infos(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		infos[i] = regionInfo(polyregions[i]);
+	}
+
+	// Index the bounding boxes in a hashed grid. Two regions can only be
+	// coplanar if their enlarged boxes overlap, i.e. if they share a cell.
+	// The cell size is the mean box extent, regions that would cover too
+	// many cells are kept in a list that is checked for every region.
+	float cell_size = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		VertexT extent = infos[i].max - infos[i].min;
+		cell_size += std::max(extent.x, std::max(extent.y, extent.z));
+	}
+	cell_size = n ? std::max(cell_size / n, (float)(2 * m_distance_threshold_bounding)) : 1.0f;
+
+	typedef boost::unordered_map<BoxCell, std::vector<size_t>, BoxCellHash> BoxGrid;
+	BoxGrid grid;
+	std::vector<size_t> large_regions;
+	std::vector<bool> large(n, false);
+
+	std::vector<BoxCell> min_cells(n), max_cells(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		for(int j = 0; j < 3; j++)
 		{
-			// assume there exists at least least one coplanar region
-			coplanar_regions.push_back((*region_iter));
+			min_cells[i].c[j] = (int)floor(infos[i].min[j] / cell_size);
+			max_cells[i].c[j] = (int)floor(infos[i].max[j] / cell_size);
+		}
 
-			// check all polygons with the same label, if they are coplanar to the actual polygon
-			typename std::vector<PolyRegion>::iterator coplanar_iter;
-			for( coplanar_iter = polyregions.begin(); coplanar_iter != polyregions.end(); )
-			{
-				// do not compare a polygon to itself
-				if ( region_iter != coplanar_iter )
-				{
-					// if they are coplanar,
-					if ( isPlanar((*region_iter), (*coplanar_iter)) )
-					{
-						coplanar_regions.push_back((*coplanar_iter));
-						// remove element from vector
-						coplanar_iter = polyregions.erase(coplanar_iter);
-					}
-					else
-					{
-						++coplanar_iter;
-					}
-				}
-				else
-				{
-					++coplanar_iter;
-				}
-			} // end for coplanar
+		long cells = 1;
+		for(int j = 0; j < 3; j++)
+		{
+			cells *= max_cells[i].c[j] - min_cells[i].c[j] + 1;
+		}
 
+		if(cells > 4096)
+		{
+			large_regions.push_back(i);
+			large[i] = true;
+			continue;
+		}
 
-			// assumption was wrong, no coplanar region for this PolygonRegion
-			if ( coplanar_regions.size() == 1 )
-			{
-				// save this Region in the nonplaner Regions
-				nonplanar_regions.push_back((*region_iter));
-				coplanar_regions.clear();
-			}
-			// assumption was correct, need to do fusion with a least two PolygonRegions
-			else
+		BoxCell cell;
+		for(cell.c[0] = min_cells[i].c[0]; cell.c[0] <= max_cells[i].c[0]; cell.c[0]++)
+			for(cell.c[1] = min_cells[i].c[1]; cell.c[1] <= max_cells[i].c[1]; cell.c[1]++)
+				for(cell.c[2] = min_cells[i].c[2]; cell.c[2] <= max_cells[i].c[2]; cell.c[2]++)
+					grid[cell].push_back(i);
+	}
+
+	// Greedily take the first remaining region and fuse it with all
+	// remaining regions that are coplanar to it, as the linear scan did
+	std::vector<bool> used(n, false);
+	std::vector<size_t> candidates;
+	std::vector<PolyRegion> coplanar_regions;
+
+	for(size_t i = 0; i < n; i++)
+	{
+		if(used[i])
+		{
+			continue;
+		}
+		used[i] = true;
+
+		if(large[i])
+		{
+			// A large region overlaps most of the grid, test all regions
+			candidates.resize(n);
+			for(size_t k = 0; k < n; k++)
 			{
-				// Try to fuse all coplanar regions at once
-				fuse(coplanar_regions, fused_regions);
+				candidates[k] = k;
 			}
+		}
+		else
+		{
+			candidates = large_regions;
+
+			BoxCell cell;
+			for(cell.c[0] = min_cells[i].c[0]; cell.c[0] <= max_cells[i].c[0]; cell.c[0]++)
+				for(cell.c[1] = min_cells[i].c[1]; cell.c[1] <= max_cells[i].c[1]; cell.c[1]++)
+					for(cell.c[2] = min_cells[i].c[2]; cell.c[2] <= max_cells[i].c[2]; cell.c[2]++)
+					{
+						typename BoxGrid::iterator it = grid.find(cell);
+						if(it != grid.end())
+						{
+							candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+						}
+					}
+		}
 
-			// increment region iterator
-			region_iter = polyregions.erase(region_iter);
+		// keep the order of the regions
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
-			// store the fused polygonregions in the output vector
-			typename std::vector<PolyRegion>::iterator out_it;
-			for(out_it = fused_regions.begin() ; out_it != fused_regions.end() ; ++out_it)
+		// assume there exists at least least one coplanar region
+		coplanar_regions.push_back(polyregions[i]);
+
+		for(size_t k = 0; k < candidates.size(); k++)
+		{
+			size_t c = candidates[k];
+			if(!used[c] && isPlanar(infos[i], infos[c]))
 			{
-				output.push_back((*out_it));
+				coplanar_regions.push_back(polyregions[c]);
+				used[c] = true;
 			}
+		}
 
-			// clear the container
-			fused_regions.clear();
-			coplanar_regions.clear();
-		} // end for Polyregions with same label
-
-		// store the polygonregions without interest in the output vector
-		typename std::vector<PolyRegion>::iterator out_it;
-		for(out_it = nonplanar_regions.begin() ; out_it != nonplanar_regions.end() ; ++out_it)
+		// assumption was wrong, no coplanar region for this PolygonRegion
+		if ( coplanar_regions.size() == 1 )
 		{
-			output.push_back((*out_it));
+			// save this Region in the nonplaner Regions
+			nonplanar_regions.push_back(polyregions[i]);
 		}
-		nonplanar_regions.clear();
-	} // end for map
+		// assumption was correct, need to do fusion with a least two PolygonRegions
+		else
+		{
+			// Try to fuse all coplanar regions at once
+			fuse(coplanar_regions, fused_regions);
 
-	// done!
-	return true;
-}
+			// store the fused polygonregions in the output vector
+			output.insert(output.end(), fused_regions.begin(), fused_regions.end());
+		}
 
+		// clear the container
+		fused_regions.clear();
+		coplanar_regions.clear();
+	}
 
+	// store the polygonregions without interest in the output vector
+	output.insert(output.end(), nonplanar_regions.begin(), nonplanar_regions.end());
+}
 
 
 template<typename VertexT, typename NormalT>
-bool PolygonFusion<VertexT, NormalT>::isPlanar(PolyRegion a, PolyRegion b)
+typename PolygonFusion<VertexT, NormalT>::RegionInfo PolygonFusion<VertexT, NormalT>::regionInfo(PolyRegion& a)
 {
-	bool coplanar = true;
-
-	// at first, make boundingbox-check
-	VertexT min_a = a.getBoundMin();
-	VertexT min_b = b.getBoundMin();
-	VertexT max_a = a.getBoundMax();
-	VertexT max_b = b.getBoundMax();
+	RegionInfo info;
 
 	// include the distance_threshold (it looks good but there were no big analysis...)
 	VertexT dist_thres(m_distance_threshold_bounding, m_distance_threshold_bounding, m_distance_threshold_bounding);
-	min_a -= dist_thres;
-	max_a += dist_thres;
-	min_b -= dist_thres;
-	max_b += dist_thres;
-
-	// check BoundingBoxes, if they overlap
-	if ( max_a.x < min_b.x || min_a.x > max_b.x ) coplanar = false;
-	if ( max_a.y < min_b.y || min_a.y > max_b.y ) coplanar = false;
-	if ( max_a.z < min_b.z || min_a.z > max_b.z ) coplanar = false;
-
-	// if the BoundingBox-check failed, return false
-	if(!coplanar)
-	{
-		return coplanar;
-	}
-
-	// Now, check real coplanarity
-	NormalT norm_a;
-	VertexT point_a;
+	info.min = a.getBoundMin() - dist_thres;
+	info.max = a.getBoundMax() + dist_thres;
 
-	// get the first vertex of the first polygon of this region and the normal of this region
+	// span the plane (Hesse normal form) with the first vertex of the first
+	// polygon of this region and the normal of this region
 	std::vector<VertexT> tmp_vec = a.getPolygon().getVertices();
-	if(tmp_vec.size() != 0)
+	info.valid = tmp_vec.size() != 0;
+	if(info.valid)
 	{
-		point_a = tmp_vec[0];
-		norm_a = a.getNormal();
+		NormalT norm_a = a.getNormal();
+		info.n[0] = norm_a.x;
+		info.n[1] = norm_a.y;
+		info.n[2] = norm_a.z;
+		info.d = - ((info.n[0] * tmp_vec[0].x) + (info.n[1] * tmp_vec[0].y) + (info.n[2] * tmp_vec[0].z) );
 	}
-	else
+
+	// the outer polygon(-shell) is checked against the planes of other regions
+	std::vector<Polygon<VertexT, NormalT> > polygons = a.getPolygons();
+	if(polygons.size())
 	{
-		std::cout << timestamp << "The vector with planar regions was empty, so nothing to do here and return false! (!!!This should not happend!!!)" << std::endl;
-		return false;
+		info.shell = polygons[0].getVertices();
 	}
 
-	// span the plane (Hesse normal form)
-	float n_x = norm_a.x;
-	float n_y = norm_a.y;
-	float n_z = norm_a.z;
+	return info;
+}
+
 
-	float p1_x = point_a.x;
-	float p1_y = point_a.y;
-	float p1_z = point_a.z;
+template<typename VertexT, typename NormalT>
+bool PolygonFusion<VertexT, NormalT>::isPlanar(const RegionInfo& a, const RegionInfo& b)
+{
+	// at first, make boundingbox-check
+	if ( a.max.x < b.min.x || a.min.x > b.max.x ) return false;
+	if ( a.max.y < b.min.y || a.min.y > b.max.y ) return false;
+	if ( a.max.z < b.min.z || a.min.z > b.max.z ) return false;
 
-	float d = - ((n_x * p1_x) + (n_y * p1_y) + (n_z * p1_z) );
-	float distance = 0.0;
+	// Now, check real coplanarity
+	if(!a.valid)
+	{
+		std::cout << timestamp << "The vector with planar regions was empty, so nothing to do here and return false! (!!!This should not happend!!!)" << std::endl;
+		return false;
+	}
 
-	std::vector<Polygon<VertexT, NormalT>> polygons_b;
-	polygons_b = b.getPolygons();
+	float length = sqrt( a.n[0] * a.n[0] + a.n[1] * a.n[1] + a.n[2] * a.n[2] );
 
 	// Check for all points (outer Polygon(-shell)) from polyregion b, the point to plane (polyregion a) distance
-	std::vector<VertexT> check_me = polygons_b.at(0).getVertices();
-	typename std::vector<VertexT>::iterator point_iter;
-	for( point_iter = check_me.begin(); coplanar != false, point_iter != check_me.end(); ++point_iter )
+	for(size_t i = 0; i < b.shell.size(); i++)
 	{
-		distance = abs( ( ( n_x * (*point_iter).x ) + ( n_y  *  (*point_iter).y ) + ( n_z  *  (*point_iter).z ) + d ) ) / sqrt( n_x * n_x + n_y * n_y + n_z * n_z );
+		const VertexT& p = b.shell[i];
+		float distance = fabs( ( a.n[0] * p.x ) + ( a.n[1] * p.y ) + ( a.n[2] * p.z ) + a.d ) / length;
 		if ( distance > m_distance_threshold )
 		{
-			coplanar = false;
+			return false;
 		}
 	}
 
-	return coplanar;
+	return true;
 }
 
 template<typename VertexT, typename NormalT>
@@ -388,12 +459,15 @@ bool PolygonFusion<VertexT, NormalT>::fuse(std::vector<PolyRegion> coplanar_poly
 	std::vector<BoostPolygon> input;
 	std::vector<BoostPolygon> output;
 
+	// main axis of the dirty fix, set by transformto2DBoost
+	int dirty_fix = 0;
+
 	// transform all the PolygonRegions
 	typename std::vector<PolyRegion>::iterator poly_iter;
 	for(poly_iter = coplanar_polys.begin(); poly_iter != coplanar_polys.end(); ++poly_iter)
 	{
 		// transform to 2D boost polyon
-		input.push_back(transformto2DBoost((*poly_iter), trans_mat));
+		input.push_back(transformto2DBoost((*poly_iter), trans_mat, dirty_fix));
 	}
 
 	// the rest of the method is a little bit dirty, because boost (at the latest with ROS compatible Version) can´t handle
@@ -531,14 +605,14 @@ bool PolygonFusion<VertexT, NormalT>::fuse(std::vector<PolyRegion> coplanar_poly
 	// store the unfused polygonregions in the output vec and transform them into 3D
 	for(input_iter = intersectors.begin(); input_iter != intersectors.end(); ++input_iter)
 	{
-		result.push_back(transformto3Dlvr((*input_iter),trans_mat_inv));
+		result.push_back(transformto3Dlvr((*input_iter),trans_mat_inv, dirty_fix));
 	}
 
 	// transform the fused polygonregion in 3D and store then in the output vec
 	typename std::vector<BoostPolygon>::iterator output_iter;
 	for(output_iter = output.begin(); output_iter != output.end(); ++output_iter)
 	{
-		result.push_back(transformto3Dlvr((*output_iter), trans_mat_inv));
+		result.push_back(transformto3Dlvr((*output_iter), trans_mat_inv, dirty_fix));
 	}
 
 	return true;
@@ -596,7 +670,7 @@ Eigen::Matrix4f PolygonFusion<VertexT, NormalT>::calcTransform(VertexT a, Vertex
 
 
 template<typename VertexT, typename NormalT>
-boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<float> > PolygonFusion<VertexT, NormalT>::transformto2DBoost(PolyRegion a, Eigen::Matrix4f trans)
+boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<float> > PolygonFusion<VertexT, NormalT>::transformto2DBoost(PolyRegion a, Eigen::Matrix4f trans, int& dirty_fix)
 {
 	// TODO boost::geometry::correct - Einbauen, spart die staendigen Abfragen und umdrehen von Polygonen bzw. Loechern
 
@@ -860,7 +934,7 @@ boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<float> > Po
 }
 
 template<typename VertexT, typename NormalT>
-PolygonRegion<VertexT, NormalT> PolygonFusion<VertexT, NormalT>::transformto3Dlvr(BoostPolygon poly, Eigen::Matrix4f trans)
+PolygonRegion<VertexT, NormalT> PolygonFusion<VertexT, NormalT>::transformto3Dlvr(BoostPolygon poly, Eigen::Matrix4f trans, int dirty_fix)
 {
     typedef boost::geometry::model::d2::point_xy<float> point;
     using boost::geometry::get;
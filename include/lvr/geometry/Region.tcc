@@ -30,6 +30,8 @@
 #include <vector>
 #include <psimpl.h>
 
+#include <lvr/reconstruction/PlaneFitting.hpp>
+
 namespace lvr
 {
 
@@ -422,61 +424,37 @@ void Region<VertexT, NormalT>::regressionPlane()
         return;
     }
 
-    VertexT point1;
-    VertexT point2;
-    VertexT point3;
-
-    //representation of best regression plane by point and normal
-    VertexT bestpoint;
-    NormalT bestNorm;
-
-    float bestdist = std::numeric_limits<float>::max();
-    float dist     = 0;
-
-    int iterations              = 0;
-    int nonimproving_iterations = 0;
-
-    while((nonimproving_iterations < 30) && (iterations < 200))
+    // Collect the corners of all faces
+    vector<float>  points(9 * m_faces.size());
+    vector<size_t> ids(3 * m_faces.size());
+    for(size_t i = 0; i < m_faces.size(); i++)
     {
-    	NormalT n0;
-        //randomly choose 3 disjoint points
-        do{
-            point1 = (*m_faces[rand() % m_faces.size()])(0)->m_position;
-            point2 = (*m_faces[rand() % m_faces.size()])(1)->m_position;
-            point3 = (*m_faces[rand() % m_faces.size()])(2)->m_position;
-
-            //compute normal of the plane given by the 3 points
-            n0 = (point1 - point2).cross(point1 - point3);
-            n0.normalize();
-
-        }while(point1 == point2 || point2 == point3 || point3 == point1 || n0.length() == 0);
-
-        //compute error to at most 50 other randomly chosen points
-        dist = 0;
-        for(int i = 0; i < min(50, (int)m_faces.size()); i++)
+        for(int p = 0; p < 3; p++)
         {
-            VertexT refpoint = (*m_faces[rand() % m_faces.size()])(0)->m_position;
-            dist += fabs(refpoint * n0 - point1 * n0) / min(50, (int)m_faces.size());
+            VertexT v = (*m_faces[i])(p)->m_position;
+            points[9 * i + 3 * p]     = v[0];
+            points[9 * i + 3 * p + 1] = v[1];
+            points[9 * i + 3 * p + 2] = v[2];
+            ids[3 * i + p] = 3 * i + p;
         }
+    }
 
-        //a new optimum is found
-        if(dist < bestdist)
-        {
-            bestdist = dist;
-
-            bestpoint = point1;
-            bestNorm = n0;
-
-            nonimproving_iterations = 0;
-        }
-        else
-        {
-            nonimproving_iterations++;
-        }
+    // Seeded with the region number, so regions can be fitted in parallel
+    // and the result does not depend on the order
+    FastRandom random(m_regionNumber);
 
-        iterations++;
+    float n[3];
+    float point[3];
+    if(!fitPlaneRANSAC(&points[0], &ids[0], ids.size(), random, n, point, 200))
+    {
+        m_normal = m_faces[0]->getFaceNormal();
+        return;
     }
 
+    //representation of best regression plane by point and normal
+    VertexT bestpoint(point[0], point[1], point[2]);
+    NormalT bestNorm(n[0], n[1], n[2]);
+
     //drag points into the regression plane
     for(size_t i = 0; i < m_faces.size(); i++)
     {
@@ -491,7 +469,7 @@ void Region<VertexT, NormalT>::regressionPlane()
     }
     this->m_inPlane = true;
     this->m_normal = calcNormal();
-    this->m_stuetzvektor = point1;
+    this->m_stuetzvektor = bestpoint;
 }
 
 template<typename VertexT, typename NormalT>
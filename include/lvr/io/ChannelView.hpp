@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * @file      ChannelView.hpp
+ * @brief     Non-owning views of point and mesh buffer channels.
+ */
+
+#ifndef CHANNELVIEW_HPP_
+#define CHANNELVIEW_HPP_
+
+#include <cstddef>
+
+namespace lvr
+{
+
+/**
+ * @brief   A non-owning view of a buffer channel.
+ *
+ *          The accessors of PointBuffer and MeshBuffer return shared
+ *          arrays by value. Every call changes the reference count
+ *          atomically, which gets expensive when it is done per element
+ *          in parallel loops. A view only holds a raw pointer, the number
+ *          of elements, the number of components per element and the
+ *          distance between two elements. It has to be created once
+ *          outside of the loop and is only valid as long as the buffer
+ *          exists and the channel is not replaced.
+ *
+ *          Code that gets a shared array once and indexes it in a loop
+ *          does not touch the reference count per element and gains
+ *          nothing from a view. This holds for the PLY, ASCII and LAS IO,
+ *          the Texturizer, the display classes and the viewer bridges,
+ *          which therefore still use the shared arrays.
+ */
+template<typename T>
+class ChannelView
+{
+public:
+
+    /// Creates an empty view
+    ChannelView() : m_data(0), m_size(0), m_width(0), m_stride(0) {}
+
+    /**
+     * @brief   Creates a view of the given data
+     *
+     * @param data      Pointer to the first component of the first element
+     * @param size      Number of elements
+     * @param width     Number of components per element
+     * @param stride    Number of values between two elements, defaults
+     *                  to the width for tightly packed data
+     */
+    ChannelView(T* data, size_t size, size_t width, size_t stride = 0)
+        : m_data(data), m_size(data ? size : 0), m_width(width), m_stride(stride ? stride : width) {}
+
+    /// Returns a pointer to the components of the i-th element
+    T* operator[](size_t i) const { return m_data + i * m_stride; }
+
+    /// Returns the c-th component of the i-th element
+    T& operator()(size_t i, size_t c) const { return m_data[i * m_stride + c]; }
+
+    /// Returns the number of elements
+    size_t size() const { return m_size; }
+
+    /// Returns the number of components per element
+    size_t width() const { return m_width; }
+
+    /// Returns the number of values between two elements
+    size_t stride() const { return m_stride; }
+
+    /// Returns true if the channel contains no data
+    bool empty() const { return m_size == 0; }
+
+    /// Returns the raw data pointer
+    T* data() const { return m_data; }
+
+private:
+
+    T*      m_data;
+    size_t  m_size;
+    size_t  m_width;
+    size_t  m_stride;
+};
+
+typedef ChannelView<float>          floatView;
+typedef ChannelView<unsigned char>  ucharView;
+typedef ChannelView<unsigned int>   uintView;
+
+} // namespace lvr
+
+#endif /* CHANNELVIEW_HPP_ */
@@ -0,0 +1,138 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * Checkpoint.hpp
+ */
+
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include <lvr/io/DataStruct.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/shared_array.hpp>
+
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief   The binary result of a pipeline stage, stored as a list of
+ *          arrays in a checkpoint directory. The file name is derived from
+ *          the stage name and a key that describes the input file and all
+ *          parameters the stage depends on, so a changed parameter never
+ *          reuses an old result.
+ *
+ *          Files are written to a temporary file and renamed afterwards and
+ *          carry a checksum, so interrupted or damaged checkpoints are
+ *          detected and ignored.
+ */
+class Checkpoint
+{
+public:
+
+    /**
+     * @brief   Creates an empty checkpoint
+     *
+     * @param directory     The checkpoint directory
+     * @param stage         Name of the stage, e.g. "normals"
+     * @param key           Description of the input and the parameters
+     */
+    Checkpoint(string directory, string stage, string key);
+
+    /// Appends a copy of count elements of data
+    template<typename T>
+    void add(boost::shared_array<T> data, size_t count)
+    {
+        addBlock(data.get(), sizeof(T), count);
+    }
+
+    /**
+     * @brief   Returns a copy of the array with the given index
+     *
+     * @param index     Position of the array in the order of add()
+     * @param count     The number of elements. 0 if the index or the
+     *                  element type does not match.
+     */
+    template<typename T>
+    boost::shared_array<T> get(size_t index, size_t& count) const
+    {
+        count = 0;
+        if(index >= m_blocks.size() || m_elementSizes[index] != sizeof(T))
+        {
+            return boost::shared_array<T>();
+        }
+
+        count = m_counts[index];
+        boost::shared_array<T> data(new T[count]);
+        memcpy(data.get(), m_blocks[index].get(), count * sizeof(T));
+        return data;
+    }
+
+    /// Returns the number of stored arrays
+    size_t size() const { return m_blocks.size(); }
+
+    /**
+     * @brief   Writes the checkpoint file. The directory is created if
+     *          necessary.
+     *
+     * @return  false if the file could not be written
+     */
+    bool write() const;
+
+    /**
+     * @brief   Reads the checkpoint file of the stage and key
+     *
+     * @return  false if there is no file or if it is damaged or belongs
+     *          to a different key
+     */
+    bool read();
+
+    /// Returns the name of the checkpoint file
+    string filename() const;
+
+    /**
+     * @brief   Returns a description of a file that changes whenever the
+     *          file is modified: its absolute path, size and modification
+     *          time.
+     */
+    static string fileSignature(string filename);
+
+private:
+
+    void addBlock(const void* data, size_t elementSize, size_t count);
+
+    string              m_directory;
+    string              m_stage;
+    string              m_key;
+
+    /// The stored arrays and their element sizes and counts
+    vector<ucharArr>    m_blocks;
+    vector<size_t>      m_elementSizes;
+    vector<size_t>      m_counts;
+};
+
+} // namespace lvr
+
+#endif /* CHECKPOINT_HPP_ */
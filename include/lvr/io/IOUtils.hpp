@@ -121,6 +121,37 @@ void transformAndReducePointCloud(ModelPtr model, int modulo, int sx, int sy, in
  */
 void transformPointCloud(ModelPtr model, Eigen::Matrix4d transformation);
 
+/**
+ * @brief   Converts an Eigen transformation into a column major float
+ *          matrix with the memory layout of \ref Matrix4.
+ *
+ * @param   transformation  A transformation
+ * @param   matrix          An array of 16 floats
+ */
+void transformationToFloat(const Eigen::Matrix4d& transformation, float* matrix);
+
+/**
+ * @brief   Applies an affine transformation to an array of float triples
+ *          in place. The array is processed in parallel, four points at
+ *          once with SSE instructions if they are available.
+ *
+ * @param   points          The interleaved x, y, z coordinates
+ * @param   n               The number of points
+ * @param   matrix          A column major 4x4 matrix (\ref Matrix4 layout)
+ */
+void transformPoints(float* points, size_t n, const float* matrix);
+
+/**
+ * @brief   Applies only the linear part of the given transformation to an
+ *          array of normals in place. See \ref transformPoints.
+ */
+void transformNormals(float* normals, size_t n, const float* matrix);
+
+/**
+ * @brief   Transforms the points and normals of the given buffer in place.
+ */
+void transformPointBuffer(PointBufferPtr buffer, const Eigen::Matrix4d& transformation);
+
 /**
  * @brief   Transforms the given point buffer according to the transformation
  *          stored in \ref transformFile and appends the transformed points and
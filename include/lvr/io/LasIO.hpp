@@ -28,11 +28,33 @@
 
 #include "BaseIO.hpp"
 
+#include <functional>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+using std::vector;
+
+class LASheader;
+class LASwriter;
+
 namespace lvr
 {
 
 /**
  * @brief   Interface class to read laser scan data in .las-Format
+ *
+ *          Compressed .laz files are supported as well. Colors are taken
+ *          from the RGB values of the points if the point format has them,
+ *          otherwise from the intensities. Large files are decoded in
+ *          parallel, each thread seeks to its own part of the points.
+ *          Reads can be restricted to a rectangle in the xy plane. If a
+ *          spatial index (.lax file) exists, only the parts of the file
+ *          that overlap the rectangle are decoded.
+ *
+ *          Georeferenced coordinates are too large for floats. They are
+ *          shifted by the lower corner of the file's bounding box, which is
+ *          stored in the model and added back by save().
  */
 class LasIO : public BaseIO
 {
@@ -47,6 +69,35 @@ public:
      */
     virtual ModelPtr read(string filename );
 
+    /**
+     * @brief Reads the points whose x and y coordinates are inside the
+     *        given rectangle.
+     */
+    ModelPtr read(string filename, double minX, double minY, double maxX, double maxY);
+
+    /**
+     * @brief Streams the points of a file in chunks of at most chunkSize
+     *        points as interleaved xyz coordinates. Every chunk is decoded
+     *        in parallel.
+     *
+     * @param shift     If given, the coordinates are shifted like in read()
+     *                  and the shift is stored here. Otherwise they are
+     *                  converted unchanged.
+     * @return False if the file can't be read
+     */
+    static bool readChunks(string filename, size_t chunkSize, std::function<void(vector<float>&)> f,
+            double* shift = 0);
+
+    /**
+     * @brief Writes a quadtree index (.lax file) next to the given file.
+     *        Later reads of a rectangle use it to skip the points
+     *        outside of the region.
+     *
+     * @param filename  A .las or .laz file
+     * @param cellSize  Edge length of the smallest quadtree cells
+     */
+    static bool createIndex(string filename, float cellSize = 100.0f);
+
     /**
      * @brief Save the loaded elements to the given file.
      *
@@ -54,6 +105,82 @@ public:
      */
     virtual void save( string filename );
 
+private:
+
+    /**
+     * @brief Reads a file. If region is given, only the points inside of
+     *        the rectangle (min x, min y, max x, max y) are read.
+     */
+    ModelPtr readRegion(string filename, const double* region);
+};
+
+/**
+ * @brief   Writes point clouds chunk by chunk into a .las or .laz file.
+ *
+ *          The file is created with the first chunk. Points are stored with
+ *          the given scale relative to an offset that is derived from the
+ *          first point. A shift that was subtracted when reading is added
+ *          back in double precision. The point count and bounding box in the header are
+ *          updated when the writer is closed. The writer owns the open
+ *          file and can't be copied.
+ */
+class LasWriter : boost::noncopyable
+{
+public:
+
+    /**
+     * @brief Creates a writer for the given file
+     *
+     * @param filename  The file to write, .laz files are compressed
+     * @param colors    Whether RGB values are stored
+     * @param scale     Resolution of the stored coordinates
+     * @param shift     Added to all coordinates, see Model::m_shift
+     */
+    LasWriter(string filename, bool colors = false, double scale = 0.001, const double* shift = 0);
+
+    /// Closes the file
+    ~LasWriter();
+
+    /**
+     * @brief Appends n points with interleaved xyz coordinates and
+     *        optional interleaved RGB colors and intensities.
+     *
+     * @return False if the file can't be written
+     */
+    bool write(const float* points, size_t n, const unsigned char* colors = 0, const float* intensities = 0);
+
+    /// Appends all points of the given buffer
+    bool write(PointBufferPtr buffer);
+
+    /// Sets the shift that is added to the points of the following writes
+    void setShift(const double* shift);
+
+    /**
+     * @brief Updates the header and closes the file
+     *
+     * @return The number of written points
+     */
+    size_t close();
+
+private:
+
+    string          m_filename;
+
+    bool            m_colors;
+
+    double          m_scale;
+
+    double          m_shift[3];
+
+    /// The laslib writer, created with the first chunk
+    LASwriter*      m_writer;
+
+    LASheader*      m_header;
+
+    size_t          m_numPoints;
+
+    /// Number of coordinates that were out of the range of the file
+    size_t          m_clipped;
 };
 
 } /* namespace lvr */
@@ -42,6 +42,7 @@
 #include <algorithm>
 #include <iostream>
 #include "DataStruct.hpp"
+#include "ChannelView.hpp"
 
 namespace lvr
 {
@@ -273,6 +274,22 @@ class MeshBuffer
         idx3uArr getIndexedFaceArray( size_t &n );
 
 
+        /**
+         * \brief Get non-owning views of the mesh channels.
+         *
+         * In contrast to the array getters no reference count is touched,
+         * so the views should be used in (parallel) loops. A view is only
+         * valid as long as the buffer exists and the channel is not
+         * replaced. Views of missing channels are empty.
+         **/
+        floatView getVertexView();
+        floatView getVertexNormalView();
+        ucharView getVertexColorView();
+        floatView getVertexIntensityView();
+        floatView getVertexConfidenceView();
+        uintView  getFaceView();
+
+
 #define SECTION_SETTER
         /**********************************************************************
          * SETTER
@@ -47,24 +47,31 @@ public:
     {
         m_pointCloud = p;
         m_mesh = m;
+        m_shift[0] = m_shift[1] = m_shift[2] = 0.0;
     };
 
     Model( MeshBufferPtr m, PointBufferPtr p )
     {
         m_pointCloud = p;
         m_mesh = m;
+        m_shift[0] = m_shift[1] = m_shift[2] = 0.0;
     };
 
     Model( MeshBufferPtr m )
     {
         m_pointCloud.reset();
         m_mesh = m;
+        m_shift[0] = m_shift[1] = m_shift[2] = 0.0;
     };
 
     virtual ~Model() {};
 
     PointBufferPtr      m_pointCloud;
     MeshBufferPtr       m_mesh;
+
+    /// Subtracted from the coordinates of georeferenced data to keep them
+    /// precise as floats. Writers that support it add it back.
+    double              m_shift[3];
 };
 
 typedef boost::shared_ptr<Model> ModelPtr;
@@ -38,6 +38,7 @@
 #include <rply.h>
 #include <stdint.h>
 #include <cstdio>
+#include <functional>
 #include <vector>
 
 #include <locale.h>
@@ -149,9 +150,48 @@ class PLYIO : public BaseIO
         ModelPtr read( string filename );
 
 
+        /**
+         * \brief Stream the points of a binary little endian PLY.
+         *
+         * Calls f for chunks of at most chunkSize points with their
+         * interleaved coordinates and normals. The normals are empty if the
+         * file has none. Like read(), the \c point element is used or, if
+         * there is neither \c point nor \c face, the \c vertex element.
+         *
+         * \return False if the file can't be read this way. The points of
+         *         ascii files and other layouts have to be read with read().
+         **/
+        static bool readChunks( string filename, size_t chunkSize,
+                std::function<void(std::vector<float>&, std::vector<float>&)> f );
+
+
     private:
 
 
+        /**
+         * \brief Read a binary little endian PLY block wise.
+         *
+         * Whole element blocks are read at once and converted in parallel
+         * into the buffer channels, bypassing the per value callbacks of
+         * rply.
+         *
+         * \return The model or an empty pointer if the file is not binary
+         *         little endian or uses a layout that is not supported.
+         *         The caller then falls back to rply.
+         **/
+        ModelPtr readBinary( string filename, bool readColor, bool readConfidence,
+                bool readIntensity, bool readNormals, bool readFaces );
+
+
+        /**
+         * \brief Save the model as binary little endian PLY block wise.
+         *
+         * \return False if the host is not little endian. The caller then
+         *         falls back to rply.
+         **/
+        bool saveBinary( string filename );
+
+
         /**
          * \brief Callback for read vertices.
          * \param argument  Argument to pass the read data.
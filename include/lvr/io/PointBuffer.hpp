@@ -45,6 +45,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include "DataStruct.hpp"
+#include "ChannelView.hpp"
 
 namespace lvr
 {
@@ -337,6 +338,21 @@ public:
     idx1fArr getIndexedPointConfidenceArray( size_t &n );
 
 
+    /**
+     * \brief Get non-owning views of the point channels.
+     *
+     * In contrast to the array getters no reference count is touched, so
+     * the views should be used in (parallel) loops. A view is only valid
+     * as long as the buffer exists and the channel is not replaced. Views
+     * of missing channels are empty.
+     **/
+    floatView getPointView();
+    floatView getPointNormalView();
+    ucharView getPointColorView();
+    floatView getPointIntensityView();
+    floatView getPointConfidenceView();
+
+
     /**
      * \brief Clear internal point buffers.
      *
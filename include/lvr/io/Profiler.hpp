@@ -0,0 +1,145 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * Profiler.hpp
+ */
+
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+using std::ostream;
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief   The measurements of one pipeline stage
+ */
+struct ProfilerRecord
+{
+    /// Name of the stage, e.g. "normals" or "distances"
+    string  name;
+
+    /// Elapsed wall clock time in seconds
+    double  wallTime;
+
+    /// CPU time of all threads of the process in seconds
+    double  cpuTime;
+
+    /// Peak resident set size of the process at the end of the stage in kB
+    size_t  peakRss;
+
+    /// Number of processed items, e.g. points or query points
+    size_t  items;
+};
+
+/**
+ * @brief   Collects the run time, CPU time, memory consumption and
+ *          throughput of named pipeline stages. Stages are measured with
+ *          a ProfilerStage object and stored in the order they end.
+ */
+class Profiler
+{
+public:
+
+    /// Returns the global profiler
+    static Profiler& instance();
+
+    /// Stores the measurements of a finished stage
+    void addRecord(const ProfilerRecord& record);
+
+    /// Returns all records
+    vector<ProfilerRecord> getRecords();
+
+    /// Removes all records
+    void clear();
+
+    /// Prints a table of all stages
+    void print(ostream& os);
+
+    /**
+     * @brief   Writes all stages into a JSON file
+     *
+     * @return  false if the file could not be written
+     */
+    bool writeJSON(string filename);
+
+    /// Returns the CPU time of the process in seconds
+    static double cpuTime();
+
+    /// Returns the peak resident set size of the process in kB
+    static size_t peakRss();
+
+private:
+
+    Profiler() {}
+
+    /// The finished stages
+    vector<ProfilerRecord>  m_records;
+
+    /// Protects the records if stages end in different threads
+    boost::mutex            m_mutex;
+};
+
+/**
+ * @brief   Measures a pipeline stage from its creation until stop() is
+ *          called or the object is destroyed and stores the result in the
+ *          global profiler.
+ */
+class ProfilerStage
+{
+public:
+
+    /**
+     * @brief   Starts the measurement
+     *
+     * @param name      Name of the stage
+     * @param items     Number of items processed in the stage
+     */
+    ProfilerStage(string name, size_t items = 0);
+
+    /// Stops the measurement if stop() was not called
+    ~ProfilerStage();
+
+    /// Sets the number of items processed in the stage
+    void setItems(size_t items) { m_items = items; }
+
+    /// Stops the measurement and stores the record
+    void stop();
+
+private:
+
+    string  m_name;
+    size_t  m_items;
+    double  m_startWall;
+    double  m_startCpu;
+    bool    m_running;
+};
+
+} // namespace lvr
+
+#endif /* PROFILER_HPP_ */
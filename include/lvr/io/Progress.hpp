@@ -39,6 +39,9 @@ using std::string;
 
 #include <boost/thread/mutex.hpp>
 
+#include <atomic>
+#include <vector>
+
 namespace lvr{
 
 /**
@@ -49,6 +52,12 @@ namespace lvr{
  * 	After each iteration the ++-operator should be called. The
  * 	progress information in '%' is automatically printed to stdout
  * 	together with the given prefix string.
+ *
+ * 	The operator can be called from parallel loops. Each thread counts
+ * 	its iterations in its own counter without locking. Only every few
+ * 	iterations the counters are summed up under a lock to update the
+ * 	output. Near the end every iteration is checked, so the last
+ * 	percentages are printed as well.
  */
 
 typedef void(*ProgressCallbackPtr)(int);
@@ -91,6 +100,16 @@ public:
 
 protected:
 
+	/// A counter that fills a whole cache line to avoid false sharing
+	struct PaddedCounter
+	{
+		std::atomic<size_t>	value;
+		char				padding[64 - sizeof(std::atomic<size_t>)];
+	};
+
+	/// Sums up the thread counters and prints the output if necessary
+	void update();
+
 	/// Prints the output
 	void print_bar();
 
@@ -100,10 +119,19 @@ protected:
 	/// The number of iterations
 	size_t			m_maxVal;
 
-        /// The current counter
-    size_t	 		m_currentVal;
+	/// The sum of all thread counters at the last update
+	size_t	 		m_currentVal;
+
+	/// The iteration counters of the threads
+	std::vector<PaddedCounter>	m_counters;
+
+	/// The number of iterations of a thread between two updates
+	size_t			m_batchSize;
+
+	/// True if every iteration triggers an update
+	std::atomic<bool>	m_tail;
 
-	/// A mutex object for counter increment (for parallel executions)
+	/// A mutex object for the output (for parallel executions)
 	boost::mutex 	m_mutex;
 
 	/// The current progress in percent
@@ -156,9 +184,9 @@ protected:
 	size_t			m_stepVal;
 
 	/// The current counter value
-	size_t			m_currentVal;
+	std::atomic<size_t>	m_currentVal;
 
-	/// A mutex object for counter increment (for parallel executions)
+	/// A mutex object for the output (for parallel executions)
 	boost::mutex 	m_mutex;
 
 	/// A string stream for output generation
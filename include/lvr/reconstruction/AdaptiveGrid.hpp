@@ -0,0 +1,228 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * AdaptiveGrid.hpp
+ */
+
+#ifndef _ADAPTIVEGRID_HPP_
+#define _ADAPTIVEGRID_HPP_
+
+#include "HashGrid.hpp"
+#include "QueryPoint.hpp"
+#include "PointsetSurface.hpp"
+
+#include <lvr/geometry/BoundingBox.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief   A leaf of an adaptive grid. Position and size are given in
+ *          units of the voxel size.
+ */
+struct AdaptiveCell
+{
+	/// Lattice index of the lower corner
+	int32_t x, y, z;
+
+	/// Edge length, a power of two
+	int32_t size;
+
+	/// Whether data points may lie inside the cell or within one voxel of it
+	bool    populated;
+};
+
+/**
+ * @brief   A sparse octree grid whose cell size follows the local shape
+ *          of the surface.
+ *
+ *          The root cell covers the bounding box with a padding of the
+ *          maximum leaf size. Cells that are larger than the maximum leaf
+ *          size are split if data points are near them, so all cells
+ *          around the surface have at most the maximum leaf size. Below
+ *          that, a cell is split until it contains no points or its points
+ *          are flat: all normals are within a threshold of their mean and
+ *          no point deviates more than a fraction of the cell size from
+ *          the plane through their centroid. Cells of one voxel are never
+ *          split. Finally, leaves are split until touching leaves differ
+ *          in size by at most a factor of two. Large flat regions thus get
+ *          few large cells while curved and detailed regions are sampled
+ *          with the voxel size.
+ *
+ *          Each leaf has one query point in its center. The surface is
+ *          extracted on the dual grid of the leaves, see
+ *          \ref AdaptiveReconstruction.
+ */
+template<typename VertexT>
+class AdaptiveGrid : public GridBase
+{
+public:
+
+	/**
+	 * @brief   Builds the octree for the points of the given surface
+	 *
+	 * @param voxelsize         Edge length of the smallest cells
+	 * @param surface           The surface with the points and normals
+	 * @param bb                Bounding box of the points
+	 * @param levels            Number of levels above the voxel size, the
+	 *                          largest leaves near the surface have an edge
+	 *                          length of 2^levels voxels
+	 * @param tolerance         Maximum distance of the points of a leaf from
+	 *                          their plane relative to the leaf size
+	 * @param normalThreshold   Minimum cosine between each point normal of
+	 *                          a leaf and the mean normal
+	 */
+	AdaptiveGrid(float voxelsize, typename PointsetSurface<VertexT>::Ptr& surface, BoundingBox<VertexT> bb,
+			int levels = 4, float tolerance = 0.05, float normalThreshold = 0.95);
+
+	virtual ~AdaptiveGrid() {}
+
+	/**
+	 * @brief   Calculates the distance values of the leaf centers
+	 */
+	void calcDistanceValues();
+
+	/**
+	 * @brief   Does nothing. The cells of an adaptive grid are created
+	 *          from the points only.
+	 */
+	virtual void addLatticePoint(int i, int j, int k, float distance = 0.0) {}
+
+	/**
+	 * @brief   Saves center, size and distance value of each leaf
+	 */
+	virtual void saveGrid(string file);
+
+	/// Returns the query points, one in the center of each leaf
+	vector<QueryPoint<VertexT> >& getQueryPoints() { return m_queryPoints; }
+
+	/// Returns the leaves in the order of the query points
+	const vector<AdaptiveCell>& getCells() const { return m_cells; }
+
+	/// Returns the number of leaves
+	size_t getNumberOfCells() const { return m_cells.size(); }
+
+	/**
+	 * @brief   Returns the leaf that contains the voxel with the given
+	 *          lattice index or -1 if it is outside of the grid
+	 */
+	int findCell(int x, int y, int z) const;
+
+	/// Returns the edge length of the root cell in voxels
+	int getSize() const { return m_size; }
+
+	/// Returns the edge length of the largest leaves near the surface in voxels
+	int getMaxLeafSize() const { return m_maxLeafSize; }
+
+	float getVoxelsize() const { return m_voxelsize; }
+
+private:
+
+	/// A cell of the octree
+	struct Node
+	{
+		/// Index of the first of the eight children or -1 for leaves
+		int32_t child;
+
+		/// Index of the leaf in m_cells or -1 for inner nodes
+		int32_t cell;
+
+		/// The points inside the node are m_pointIds[begin, end)
+		size_t  begin, end;
+	};
+
+	/**
+	 * @brief   Splits the given node recursively as long as its points
+	 *          are not flat
+	 */
+	void subdivide(int node, int x, int y, int z, int size);
+
+	/// Creates the children of a node and subdivides them
+	void split(int node, int x, int y, int z, int size);
+
+	/**
+	 * @brief   Splits leaves until the edge lengths of all touching leaves
+	 *          differ by at most a factor of two. Otherwise large empty
+	 *          leaves next to fine detail would distort the interpolated
+	 *          surface.
+	 */
+	void balance();
+
+	/// Collects the leaves below the given node
+	void collectLeaves(int node, int x, int y, int z, int size, vector<AdaptiveCell>& leaves, vector<int>& nodes);
+
+	/**
+	 * @brief   Returns the leaf node that contains the voxel with the given
+	 *          lattice index and its edge length or -1 if it is outside
+	 */
+	int findNode(int x, int y, int z, int& size) const;
+
+	/**
+	 * @brief   Checks whether data points may lie within the given margin
+	 *          in voxels around a cell. Tests the nearest point to the cell
+	 *          center against the circumscribed sphere, so the result may
+	 *          be true for points slightly outside of the margin.
+	 */
+	bool nearPoints(int x, int y, int z, int size, float margin);
+
+	/// Checks whether the given points are flat enough for a leaf of the given size
+	bool isFlat(size_t begin, size_t end, int size);
+
+	/// Returns the position of a lattice point
+	VertexT position(float x, float y, float z) const;
+
+	typename PointsetSurface<VertexT>::Ptr	m_surface;
+
+	float						m_voxelsize;
+
+	/// Position of the lattice point (0, 0, 0)
+	VertexT						m_origin;
+
+	/// Edge length of the root cell in voxels
+	int							m_size;
+
+	int							m_maxLeafSize;
+
+	float						m_tolerance;
+
+	float						m_normalThreshold;
+
+	vector<Node>				m_nodes;
+
+	vector<AdaptiveCell>		m_cells;
+
+	vector<QueryPoint<VertexT> >	m_queryPoints;
+
+	/// Point indices, partitioned by the nodes while the tree is built
+	vector<size_t>				m_pointIds;
+};
+
+} /* namespace lvr */
+
+#include "AdaptiveGrid.tcc"
+
+#endif /* _ADAPTIVEGRID_HPP_ */
@@ -0,0 +1,453 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * AdaptiveGrid.tcc
+ */
+
+#include "AdaptiveGrid.hpp"
+#include "SpatialSort.hpp"
+#include "FastReconstructionTables.hpp"
+
+#include <lvr/io/Progress.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace lvr
+{
+
+template<typename VertexT>
+AdaptiveGrid<VertexT>::AdaptiveGrid(float voxelsize, typename PointsetSurface<VertexT>::Ptr& surface, BoundingBox<VertexT> bb,
+		int levels, float tolerance, float normalThreshold)
+	: GridBase(false), m_surface(surface), m_voxelsize(voxelsize),
+	  m_tolerance(tolerance), m_normalThreshold(normalThreshold)
+{
+	levels = std::max(0, std::min(levels, 10));
+	m_maxLeafSize = 1 << levels;
+
+	// Pad the bounding box by one maximum leaf, so that all leaves around
+	// the surface have neighbors on all sides
+	float padding = m_maxLeafSize * m_voxelsize;
+	VertexT v_min = bb.getMin();
+	m_origin = VertexT(v_min[0] - padding, v_min[1] - padding, v_min[2] - padding);
+	int extent = (int)ceil(bb.getLongestSide() / m_voxelsize) + 2 * m_maxLeafSize + 1;
+	m_size = m_maxLeafSize;
+	while(m_size < extent && m_size < (1 << 30))
+	{
+		m_size *= 2;
+	}
+
+	cout << timestamp << "Creating adaptive grid..." << endl;
+
+	floatView points = m_surface->pointBuffer()->getPointView();
+	m_pointIds.resize(points.size());
+	for(size_t i = 0; i < m_pointIds.size(); i++)
+	{
+		m_pointIds[i] = i;
+	}
+
+	Node root = {-1, -1, 0, m_pointIds.size()};
+	m_nodes.push_back(root);
+	subdivide(0, 0, 0, 0, m_size);
+	balance();
+
+	vector<size_t>().swap(m_pointIds);
+
+	// Create the leaves
+	vector<int> nodes;
+	collectLeaves(0, 0, 0, 0, m_size, m_cells, nodes);
+	m_queryPoints.reserve(m_cells.size());
+	for(size_t i = 0; i < m_cells.size(); i++)
+	{
+		const AdaptiveCell& c = m_cells[i];
+		m_nodes[nodes[i]].cell = i;
+		m_queryPoints.push_back(QueryPoint<VertexT>(position(c.x + 0.5f * c.size, c.y + 0.5f * c.size, c.z + 0.5f * c.size)));
+	}
+
+	// Empty leaves next to the points count as populated, e.g. in the
+	// gaps between the scan lines of sparse scans
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(int i = 0; i < (int)m_cells.size(); i++)
+	{
+		AdaptiveCell& c = m_cells[i];
+		if(!c.populated && c.size <= m_maxLeafSize)
+		{
+			c.populated = nearPoints(c.x, c.y, c.z, c.size, 0.5f);
+		}
+	}
+
+	cout << timestamp << "Created " << m_cells.size() << " cells in " << m_nodes.size()
+	     << " octree nodes." << endl;
+}
+
+template<typename VertexT>
+VertexT AdaptiveGrid<VertexT>::position(float x, float y, float z) const
+{
+	return VertexT(m_origin[0] + x * m_voxelsize,
+	               m_origin[1] + y * m_voxelsize,
+	               m_origin[2] + z * m_voxelsize);
+}
+
+template<typename VertexT>
+void AdaptiveGrid<VertexT>::subdivide(int node, int x, int y, int z, int size)
+{
+	size_t begin = m_nodes[node].begin;
+	size_t end   = m_nodes[node].end;
+
+	if(size == 1)
+	{
+		return;
+	}
+	else if(size > m_maxLeafSize)
+	{
+		if(begin == end && !nearPoints(x, y, z, size, m_maxLeafSize))
+		{
+			return;
+		}
+	}
+	else if(begin == end || isFlat(begin, end, size))
+	{
+		return;
+	}
+
+	split(node, x, y, z, size);
+}
+
+template<typename VertexT>
+void AdaptiveGrid<VertexT>::split(int node, int x, int y, int z, int size)
+{
+	// Sort the points into the children: by z, then y, then x, so that
+	// child c = dx + 2 * dy + 4 * dz gets the range [bounds[c], bounds[c + 1])
+	floatView points = m_surface->pointBuffer()->getPointView();
+	int half = size / 2;
+	float mid[3] = {m_origin[0] + (x + half) * m_voxelsize,
+	                m_origin[1] + (y + half) * m_voxelsize,
+	                m_origin[2] + (z + half) * m_voxelsize};
+
+	size_t bounds[9];
+	bounds[0] = m_nodes[node].begin;
+	bounds[8] = m_nodes[node].end;
+	vector<size_t>::iterator first = m_pointIds.begin();
+	for(int axis = 2, step = 4; axis >= 0; axis--, step /= 2)
+	{
+		for(int c = 0; c < 8; c += 2 * step)
+		{
+			vector<size_t>::iterator it = std::partition(first + bounds[c], first + bounds[c + 2 * step],
+					[&](size_t i) { return points[i][axis] < mid[axis]; });
+			bounds[c + step] = it - first;
+		}
+	}
+
+	int child = m_nodes.size();
+	m_nodes[node].child = child;
+	for(int c = 0; c < 8; c++)
+	{
+		Node n = {-1, -1, bounds[c], bounds[c + 1]};
+		m_nodes.push_back(n);
+	}
+
+	for(int c = 0; c < 8; c++)
+	{
+		subdivide(child + c,
+		          x + (c & 1 ? half : 0),
+		          y + (c & 2 ? half : 0),
+		          z + (c & 4 ? half : 0),
+		          half);
+	}
+}
+
+template<typename VertexT>
+void AdaptiveGrid<VertexT>::balance()
+{
+	vector<AdaptiveCell> leaves;
+	vector<int> nodes;
+	collectLeaves(0, 0, 0, 0, m_size, leaves, nodes);
+
+	// Every leaf that touches a smaller one contains one of the voxels
+	// around a corner of the smaller leaf. Only the leaves that were
+	// created by the last splits and the smaller leaves that caused them
+	// have to be checked again.
+	while(!leaves.empty())
+	{
+		vector<AdaptiveCell> large;
+		vector<int> largeNodes;
+		vector<char> violated(leaves.size(), 0);
+
+		#pragma omp parallel for schedule(dynamic, 1024)
+		for(int i = 0; i < (int)leaves.size(); i++)
+		{
+			const AdaptiveCell& leaf = leaves[i];
+			for(int k = 0; k < 8; k++)
+			{
+				int vx = leaf.x + (box_creation_table[k][0] > 0 ? leaf.size : 0);
+				int vy = leaf.y + (box_creation_table[k][1] > 0 ? leaf.size : 0);
+				int vz = leaf.z + (box_creation_table[k][2] > 0 ? leaf.size : 0);
+				for(int o = 0; o < 8; o++)
+				{
+					int x = vx + (box_creation_table[o][0] > 0 ? 0 : -1);
+					int y = vy + (box_creation_table[o][1] > 0 ? 0 : -1);
+					int z = vz + (box_creation_table[o][2] > 0 ? 0 : -1);
+					int size;
+					int n = findNode(x, y, z, size);
+					if(n >= 0 && size > 2 * leaf.size)
+					{
+						AdaptiveCell cell = {x & ~(size - 1), y & ~(size - 1), z & ~(size - 1), size, false};
+						violated[i] = 1;
+
+						#pragma omp critical
+						{
+							large.push_back(cell);
+							largeNodes.push_back(n);
+						}
+					}
+				}
+			}
+		}
+
+		vector<AdaptiveCell> next;
+		vector<int> nextNodes;
+		for(size_t i = 0; i < leaves.size(); i++)
+		{
+			if(violated[i])
+			{
+				next.push_back(leaves[i]);
+				nextNodes.push_back(nodes[i]);
+			}
+		}
+
+		// Split the large leaves, their children are subdivided further if
+		// their points are not flat
+		for(size_t i = 0; i < large.size(); i++)
+		{
+			int n = largeNodes[i];
+			if(m_nodes[n].child < 0)
+			{
+				const AdaptiveCell& c = large[i];
+				split(n, c.x, c.y, c.z, c.size);
+				collectLeaves(n, c.x, c.y, c.z, c.size, next, nextNodes);
+			}
+		}
+
+		leaves.swap(next);
+		nodes.swap(nextNodes);
+	}
+}
+
+template<typename VertexT>
+void AdaptiveGrid<VertexT>::collectLeaves(int node, int x, int y, int z, int size, vector<AdaptiveCell>& leaves, vector<int>& nodes)
+{
+	int child = m_nodes[node].child;
+	if(child < 0)
+	{
+		AdaptiveCell cell = {x, y, z, size, m_nodes[node].begin != m_nodes[node].end};
+		leaves.push_back(cell);
+		nodes.push_back(node);
+		return;
+	}
+
+	int half = size / 2;
+	for(int c = 0; c < 8; c++)
+	{
+		collectLeaves(child + c,
+		              x + (c & 1 ? half : 0),
+		              y + (c & 2 ? half : 0),
+		              z + (c & 4 ? half : 0),
+		              half, leaves, nodes);
+	}
+}
+
+template<typename VertexT>
+int AdaptiveGrid<VertexT>::findNode(int x, int y, int z, int& size) const
+{
+	if(x < 0 || y < 0 || z < 0 || x >= m_size || y >= m_size || z >= m_size)
+	{
+		return -1;
+	}
+
+	int node = 0;
+	size = m_size;
+	while(m_nodes[node].child >= 0)
+	{
+		size /= 2;
+		int c = (x & size ? 1 : 0) + (y & size ? 2 : 0) + (z & size ? 4 : 0);
+		node = m_nodes[node].child + c;
+	}
+	return node;
+}
+
+template<typename VertexT>
+bool AdaptiveGrid<VertexT>::nearPoints(int x, int y, int z, int size, float margin)
+{
+	VertexT center = position(x + 0.5f * size, y + 0.5f * size, z + 0.5f * size);
+	vector<size_t> ids;
+	m_surface->searchTree()->kSearch(center, 1, ids);
+	if(ids.empty())
+	{
+		return false;
+	}
+
+	floatView points = m_surface->pointBuffer()->getPointView();
+	float dx = points[ids[0]][0] - center[0];
+	float dy = points[ids[0]][1] - center[1];
+	float dz = points[ids[0]][2] - center[2];
+	float radius = 0.8661f * (size + 2 * margin) * m_voxelsize;
+	return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+template<typename VertexT>
+bool AdaptiveGrid<VertexT>::isFlat(size_t begin, size_t end, int size)
+{
+	// Too few points to estimate a plane
+	if(end - begin < 3)
+	{
+		return false;
+	}
+
+	floatView points  = m_surface->pointBuffer()->getPointView();
+	floatView normals = m_surface->pointBuffer()->getPointNormalView();
+	if(normals.size() < points.size())
+	{
+		return false;
+	}
+
+	// Mean normal and centroid. Normals are flipped to the side of the
+	// first one, so that unoriented normals do not cancel out.
+	size_t i0 = m_pointIds[begin];
+	float first[3] = {normals[i0][0], normals[i0][1], normals[i0][2]};
+	double n[3] = {0, 0, 0};
+	double c[3] = {0, 0, 0};
+	for(size_t i = begin; i < end; i++)
+	{
+		size_t id = m_pointIds[i];
+		float dot = normals[id][0] * first[0] + normals[id][1] * first[1] + normals[id][2] * first[2];
+		float sign = dot < 0 ? -1.0f : 1.0f;
+		for(int a = 0; a < 3; a++)
+		{
+			n[a] += sign * normals[id][a];
+			c[a] += points[id][a];
+		}
+	}
+
+	double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if(length == 0)
+	{
+		return false;
+	}
+
+	size_t count = end - begin;
+	for(int a = 0; a < 3; a++)
+	{
+		n[a] /= length;
+		c[a] /= count;
+	}
+
+	double maxDistance = m_tolerance * size * m_voxelsize;
+	for(size_t i = begin; i < end; i++)
+	{
+		size_t id = m_pointIds[i];
+		double dot = normals[id][0] * n[0] + normals[id][1] * n[1] + normals[id][2] * n[2];
+		double distance = (points[id][0] - c[0]) * n[0] + (points[id][1] - c[1]) * n[1] + (points[id][2] - c[2]) * n[2];
+		if(fabs(dot) < m_normalThreshold || fabs(distance) > maxDistance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename VertexT>
+int AdaptiveGrid<VertexT>::findCell(int x, int y, int z) const
+{
+	int size;
+	int node = findNode(x, y, z, size);
+	return node < 0 ? -1 : m_nodes[node].cell;
+}
+
+template<typename VertexT>
+void AdaptiveGrid<VertexT>::calcDistanceValues()
+{
+	// Status message output
+	string comment = timestamp.getElapsedTime() + "Calculating distance values ";
+	ProgressBar progress(m_queryPoints.size(), comment);
+
+	Timestamp ts;
+
+	// Visit the query points along a Morton curve like PointsetGrid
+	size_t numQueryPoints = m_queryPoints.size();
+	vector<float> positions(3 * numQueryPoints);
+	for(size_t i = 0; i < numQueryPoints; i++)
+	{
+		positions[3 * i]     = m_queryPoints[i].m_position[0];
+		positions[3 * i + 1] = m_queryPoints[i].m_position[1];
+		positions[3 * i + 2] = m_queryPoints[i].m_position[2];
+	}
+	vector<size_t> order;
+	spatialOrder(numQueryPoints ? &positions[0] : 0, numQueryPoints, MORTON_CURVE, order);
+
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(int j = 0; j < (int)numQueryPoints; j++)
+	{
+		size_t i = order[j];
+		float projectedDistance;
+		float euklideanDistance;
+
+		// Leaves above the maximum leaf size are far from all points and
+		// never part of the surface
+		int size = m_cells[i].size;
+		this->m_surface->distance(m_queryPoints[i].m_position, projectedDistance, euklideanDistance);
+		if(size > m_maxLeafSize || euklideanDistance > 1.7320 * size * m_voxelsize)
+		{
+			m_queryPoints[i].m_invalid = true;
+		}
+		m_queryPoints[i].m_distance = projectedDistance;
+		++progress;
+	}
+	cout << endl;
+	cout << timestamp << "Elapsed time: " << ts << endl;
+}
+
+template<typename VertexT>
+void AdaptiveGrid<VertexT>::saveGrid(string filename)
+{
+	cout << timestamp << "Writing grid..." << endl;
+
+	std::ofstream out(filename.c_str());
+	if(!out.good())
+	{
+		cout << timestamp << "Unable to write " << filename << "." << endl;
+		return;
+	}
+
+	// Header, then one line with center, edge length and distance per leaf
+	out << m_queryPoints.size() << " " << m_voxelsize << " " << m_cells.size() << endl;
+	for(size_t i = 0; i < m_queryPoints.size(); i++)
+	{
+		float distance = m_queryPoints[i].m_distance;
+		out << m_queryPoints[i].m_position[0] << " "
+		    << m_queryPoints[i].m_position[1] << " "
+		    << m_queryPoints[i].m_position[2] << " "
+		    << m_cells[i].size * m_voxelsize << " "
+		    << (isnan(distance) ? 0 : distance) << endl;
+	}
+	out.close();
+}
+
+} /* namespace lvr */
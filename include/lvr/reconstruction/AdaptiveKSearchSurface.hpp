@@ -41,6 +41,7 @@
 #include <lvr/geometry/BoundingBox.hpp>
 
 #include "PointsetSurface.hpp"
+#include "PlaneFitting.hpp"
 
 #include "boost/shared_ptr.hpp"
 
@@ -188,6 +189,15 @@ public:
      */
     void calculateSurfaceNormals();
 
+    /**
+     * @brief Calculates normals only for the points from index \ref first
+     *        on and keeps the normals of the points before. Used when
+     *        new points are appended to a point set with known normals.
+     *        The normals of all points are estimated if the point buffer
+     *        has no normals.
+     */
+    void calculateSurfaceNormals(size_t first);
+
     /**
      * @brief If set to true, normals will be calculated using RANSAC instead of
      *        plane fitting
@@ -216,8 +226,10 @@ public:
 
 	/**
          * @brief Interpolate the initial normals with the \ref m_ki neighbors
+         *
+         * @param first     Index of the first point whose normal is interpolated
          */
-        void interpolateSurfaceNormals();
+        void interpolateSurfaceNormals(size_t first = 0);
 
 private:
 
@@ -285,17 +297,26 @@ private:
 
 	/**
 	 * @brief Calculates a tangent plane for the query point using the provided
-	 *        k-neighborhood
+	 *        k-neighborhood. The normal is the direction of least variance
+	 *        of the neighborhood, see \ref fitPlane.
 	 *
 	 * @param queryPoint    The point for which the tangent plane is created
 	 * @param k             The size of the used k-neighborhood
 	 * @param id            The positions of the neighborhood points in \ref m_points
-	 * @param ok            True, if RANSAC interpolation was succesfull
 	 */
 	Plane<VertexT, NormalT> calcPlane(const VertexT &queryPoint,
             const size_t &k,
             const vector<size_t> &id);
 
+	/**
+	 * @brief Calculates a tangent plane for the query point with RANSAC,
+	 *        see \ref fitPlaneRANSAC.
+	 *
+	 * @param queryPoint    The point for which the tangent plane is created
+	 * @param k             The size of the used k-neighborhood
+	 * @param id            The positions of the neighborhood points in \ref m_points
+	 * @param ok            True, if RANSAC interpolation was succesfull
+	 */
 	Plane<VertexT, NormalT> calcPlaneRANSAC(const VertexT &queryPoint,
             const size_t &k,
             const vector<size_t> &id, bool &ok );
@@ -236,22 +236,41 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::init()
 
 template<typename VertexT, typename NormalT>
 void AdaptiveKSearchSurface<VertexT, NormalT>::calculateSurfaceNormals()
+{
+    calculateSurfaceNormals(0);
+}
+
+template<typename VertexT, typename NormalT>
+void AdaptiveKSearchSurface<VertexT, NormalT>::calculateSurfaceNormals(size_t first)
 {
     size_t k_0 = this->m_kn;
 
-    cout << timestamp << "Initializing normal array..." << endl;
+    // Keeping normals requires a normal for every point
+    size_t numNormals = 0;
+    this->m_pointBuffer->getPointNormalArray(numNormals);
+    if(first > 0 && (!this->m_normals || numNormals != this->m_numPoints))
+    {
+        cout << timestamp << "No normals to keep. Estimating all normals." << endl;
+        first = 0;
+    }
 
-    //Initialize normal array
-    this->m_normals = coord3fArr( new coord<float>[this->m_numPoints] );
-    this->m_pointBuffer->setIndexedPointNormalArray(this->m_normals, this->m_numPoints);
+    if(first == 0)
+    {
+        cout << timestamp << "Initializing normal array..." << endl;
+
+        //Initialize normal array
+        this->m_normals = coord3fArr( new coord<float>[this->m_numPoints] );
+        this->m_pointBuffer->setIndexedPointNormalArray(this->m_normals, this->m_numPoints);
+    }
+    first = std::min(first, this->m_numPoints);
 
     //float mean_distance;
     // Create a progress counter
     string comment = timestamp.getElapsedTime() + "Estimating normals ";
-    ProgressBar progress(this->m_numPoints, comment);
+    ProgressBar progress(this->m_numPoints - first, comment);
 
     //#pragma omp parallel for schedule(static)
-    for( size_t i = 0; i < this->m_numPoints; i++){
+    for( size_t i = first; i < this->m_numPoints; i++){
 
         Vertexf query_point;
         Normalf normal;
@@ -373,70 +392,59 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::calculateSurfaceNormals()
     }
     cout << endl;
 
-    if(this->m_ki) interpolateSurfaceNormals();
+    if(this->m_ki) interpolateSurfaceNormals(first);
 }
 
 
 template<typename VertexT, typename NormalT>
-void AdaptiveKSearchSurface<VertexT, NormalT>::interpolateSurfaceNormals()
+void AdaptiveKSearchSurface<VertexT, NormalT>::interpolateSurfaceNormals(size_t first)
 {
-    // Create a temporal normal array for the
-    vector<NormalT> tmp(this->m_numPoints, NormalT());
+    first = std::min(first, this->m_numPoints);
+    size_t count = this->m_numPoints - first;
+
+    // The interpolated normals are gathered into a second buffer, so every
+    // thread only reads the initial normals and the result does not depend
+    // on the number of threads or the scheduling
+    coord3fArr tmp( new coord<float>[count] );
 
     // Create progress output
     string comment = timestamp.getElapsedTime() + "Interpolating normals ";
-    ProgressBar progress(this->m_numPoints, comment);
+    ProgressBar progress(count, comment);
 
     // Interpolate normals
-    #pragma omp parallel for schedule(static)
-    for( size_t i = 0; i < this->m_numPoints; i++){
-
+    #pragma omp parallel
+    {
         vector<size_t> id;
         vector<float> di;
 
-        this->m_searchTree->kSearch(this->m_points[i], this->m_ki, id, di);
-
-        VertexT mean;
-        NormalT mean_normal;
-
-        for(size_t j = 0; j < this->m_ki; j++)
+        #pragma omp for schedule(static)
+        for(long i = first; i < (long)this->m_numPoints; i++)
         {
-            mean += VertexT(this->m_normals[id[j]][0],
-                            this->m_normals[id[j]][1],
-                            this->m_normals[id[j]][2]);
-        }
-        mean_normal = NormalT(mean);
-
-        tmp[i] = mean;
-
-        ///todo Try to remove this code. Should improve the results at all.
-        for(size_t j = 0; j < this->m_ki; j++)
-        {
-            NormalT n(this->m_normals[id[j]][0],
-                      this->m_normals[id[j]][1],
-                      this->m_normals[id[j]][2]);
+            this->m_searchTree->kSearch(this->m_points[i], this->m_ki, id, di);
 
-
-            // Only override existing normals if the interpolated
-            // normals is significantly different from the initial
-            // estimation. This helps to avoid a too smooth normal
-            // field
-            if(fabs(n * mean_normal) > 0.2 )
+            VertexT mean;
+            for(size_t j = 0; j < id.size(); j++)
             {
-                this->m_normals[id[j]][0] = mean_normal[0];
-                this->m_normals[id[j]][1] = mean_normal[1];
-                this->m_normals[id[j]][2] = mean_normal[2];
+                mean += VertexT(this->m_normals[id[j]][0],
+                                this->m_normals[id[j]][1],
+                                this->m_normals[id[j]][2]);
             }
+            NormalT mean_normal(mean);
+
+            tmp[i - first][0] = mean_normal[0];
+            tmp[i - first][1] = mean_normal[1];
+            tmp[i - first][2] = mean_normal[2];
+            ++progress;
         }
-        ++progress;
     }
     cout << endl;
     cout << timestamp << "Copying normals..." << endl;
 
-    for(size_t i = 0; i < this->m_numPoints; i++){
-        this->m_normals[i][0] = tmp[i][0];
-        this->m_normals[i][1] = tmp[i][1];
-        this->m_normals[i][2] = tmp[i][2];
+    // Copy back, the normal array is shared with the point buffer
+    #pragma omp parallel for schedule(static)
+    for(long i = first; i < (long)this->m_numPoints; i++)
+    {
+        this->m_normals[i] = tmp[i - first];
     }
 }
 
@@ -577,53 +585,33 @@ Plane<VertexT, NormalT> AdaptiveKSearchSurface<VertexT, NormalT>::calcPlane(cons
         const size_t &k,
         const vector<size_t> &id)
 {
-    /**
-     * @todo Think of a better way to code this magic number.
-     */
-    float epsilon = 100.0;
-
-    VertexT diff1, diff2;
-    NormalT normal;
-
-    float z1 = 0;
-    float z2 = 0;
+    // Total least squares fit of the neighborhood
+    float query[3] = {queryPoint[0], queryPoint[1], queryPoint[2]};
+    float n[3];
+    float centroid[3];
 
-    // Calculate a least sqaures fit to the given points
-    Eigen::Vector3f C;
-    Eigen::VectorXf F(k);
-    Eigen::MatrixXf B(k,3);
+    Plane<VertexT, NormalT> p;
+    p.a = 0;
+    p.b = 0;
+    p.c = 0;
+    p.p = queryPoint;
 
-    for(size_t j = 0; j < k; j++){
-        F(j)    =  this->m_points[id[j]][1];
-        B(j, 0) = 1.0f;
-        B(j, 1) = this->m_points[id[j]][0];
-        B(j, 2) = this->m_points[id[j]][2];
+    if(!fitPlane((const float*)this->m_points.get(), &id[0], k, query, n, centroid))
+    {
+        cout << "Warning: Degenerated neighborhood in plane fit." << endl;
+        p.n = NormalT(0, 1, 0);
+        return p;
     }
 
-    C = B.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(F);
-
-    // Calculate to vectors in the fitted plane
-    z1 = C(0) + C(1) * (queryPoint[0] + epsilon) + C(2) * queryPoint[2];
-    z2 = C(0) + C(1) * queryPoint[0] + C(2) * (queryPoint[2] + epsilon);
-
-    // Calculcate the plane's normal via the cross product
-    diff1 = VertexT(queryPoint[0] + epsilon, z1, queryPoint[2]) - queryPoint;
-    diff2 = VertexT(queryPoint[0], z2, queryPoint[2] + epsilon) - queryPoint;
-
-    normal = diff1.cross(diff2);
-
-    if(isnan(normal[0]) || isnan(normal[1]) || isnan(normal[2]))
+    // Represent the plane as height field y = a + b * x + c * z if possible
+    if(fabs(n[1]) > 1e-6)
     {
-        cout << "Warning: Nan-coordinate in plane normal." << endl;
+        p.b = -n[0] / n[1];
+        p.c = -n[2] / n[1];
+        p.a = centroid[1] - p.b * centroid[0] - p.c * centroid[2];
     }
 
-    // Create a plane representation and return the result
-    Plane<VertexT, NormalT> p;
-    p.a = C(0);
-    p.b = C(1);
-    p.c = C(2);
-    p.n = normal;
-    p.p = queryPoint;
+    p.n = NormalT(n[0], n[1], n[2]);
 
     return p;
 }
@@ -642,144 +630,33 @@ size_t AdaptiveKSearchSurface<VertexT, NormalT>::getNumPoints()
     return m_numPoints;
 }
 
-   template<typename VertexT, typename NormalT>
-   Plane<VertexT, NormalT> AdaptiveKSearchSurface<VertexT, NormalT>::calcPlaneRANSAC(const VertexT &queryPoint,
-           const size_t &k,
-           const vector<size_t> &id,
-           bool &ok)
-           {
-
-       Plane<VertexT, NormalT> p;
-
-       VertexT point1;
-       VertexT point2;
-       VertexT point3;
-
-       //representation of best regression plane by point and normal
-       VertexT bestpoint;
-       NormalT bestNorm;
-
-       float bestdist = numeric_limits<float>::max();
-       float dist     = 0;
-
-       int iterations              = 0;
-       int nonimproving_iterations = 0;
-
-       //  int max_nonimproving = max(5, k / 2);
-       int max_interations  = 10;
-
-       while((nonimproving_iterations < 5) && (iterations < max_interations))
-       {
-           NormalT n0;
-
-           //randomly choose 3 disjoint points
-           int c = 0;
-           //do{
-           //    //cout << "AAA" << endl;
-           //    int index[3];
-           //    for(int i = 0; i < 3; i++)
-           //    {
-           //        float f = 1.0 * rand() / RAND_MAX;
-           //        int r = (int)(f * (id.size() - 1));
-           //        index[i] = id[r];
-           //    }
-
-           //    if(index[0] == index[1] || index[1] == index[2] || index[2] == index[0])
-           //    {
-           //        continue;
-           //    }
-
-           //    point1 = VertexT(this->m_points[index[0]][0],this->m_points[index[0]][1], this->m_points[index[0]][2]);
-           //    point2 = VertexT(this->m_points[index[1]][0],this->m_points[index[1]][1], this->m_points[index[1]][2]);
-           //    point3 = VertexT(this->m_points[index[2]][0],this->m_points[index[2]][1], this->m_points[index[2]][2]);
-
-           //    //compute normal of the plane given by the 3 points
-           //    n0 = (point1 - point2).cross(point1 - point3);
-           //    n0.normalize();
-
-           //    //            if( (point1 != point2) && (point2 != point3) && (point3 != point1) )
-           //    //            {
-           //    //                break;
-           //    //            }
-           //    c++;
-
-           //    //            cout << index[0] << " " << index[1] << " " << index[2] << " " << id.size() << endl;
-           //    //            cout << point1;
-           //    //            cout << point2;
-           //    //            cout << point3;
-           //    //            cout << endl;
-
-           //    // Check for deadlock
-           //    if(c > 50)
-           //    {
-           //        cout << "DL " << k << endl;
-           //        ok = false;
-           //        return p;
-           //    }
-           //}
-           //while(true);
-
-		   std::set<unsigned long> ids;
-		   std::default_random_engine generator;
-		   std::uniform_int_distribution<unsigned long> distribution(0, id.size() - 1);
-		   auto number = std::bind(distribution, generator);
-		   do
-		   {
-			   ids.insert(number());
-			   c++;
-			   if (c == 20) cout << "Deadlock" << endl;
-		   } 
-		   while (ids.size() < 3 && c <= 20);
-
-		   vector<unsigned long> sample_ids(ids.size());
-		   std::copy(ids.begin(), ids.end(), sample_ids.begin());
-
-		   point1 = VertexT(this->m_points[sample_ids[0]][0], this->m_points[sample_ids[0]][1], this->m_points[sample_ids[0]][2]);
-		   point2 = VertexT(this->m_points[sample_ids[1]][0], this->m_points[sample_ids[1]][1], this->m_points[sample_ids[1]][2]);
-		   point3 = VertexT(this->m_points[sample_ids[2]][0], this->m_points[sample_ids[2]][1], this->m_points[sample_ids[2]][2]);
-
-		   n0 = (point1 - point2).cross(point1 - point3);
-		   n0.normalize();
-
-           //compute error to at most 50 other randomly chosen points
-           dist = 0;
-           size_t n = min<size_t>(50,k);
-           for(size_t i = 0; i < n; i++)
-           {
-               size_t index = id[rand() % k];
-               VertexT refpoint = VertexT(this->m_points[index][0], this->m_points[index][1] ,this->m_points[index][2]);
-               dist += fabs(refpoint * n0 - point1 * n0);
-           }
-           if(n != 0) dist /= n;
-
-           //a new optimum is found
-           if(dist < bestdist)
-           {
-               bestdist = dist;
-
-               bestpoint = point1;
-               bestNorm = n0;
-
-               nonimproving_iterations = 0;
-           }
-           else
-           {
-               nonimproving_iterations++;
-           }
-
-           iterations++;
-       }
-
-       // Save plane parameters
-       p.a = 0;
-       p.b = 0;
-       p.c = 0;
-       p.n = bestNorm;
-       p.p = bestpoint;
-
-
-       return p;
-           }
+template<typename VertexT, typename NormalT>
+Plane<VertexT, NormalT> AdaptiveKSearchSurface<VertexT, NormalT>::calcPlaneRANSAC(const VertexT &queryPoint,
+        const size_t &k,
+        const vector<size_t> &id,
+        bool &ok)
+{
+    Plane<VertexT, NormalT> p;
+    p.a = 0;
+    p.b = 0;
+    p.c = 0;
+    p.p = queryPoint;
+
+    // The generator is seeded with the query point's first neighbor, so
+    // the result does not depend on the thread that processes the point
+    FastRandom random(id[0]);
+
+    float n[3];
+    float point[3];
+    ok = fitPlaneRANSAC((const float*)this->m_points.get(), &id[0], k, random, n, point);
+    if(ok)
+    {
+        p.n = NormalT(n[0], n[1], n[2]);
+        p.p = VertexT(point[0], point[1], point[2]);
+    }
+
+    return p;
+}
 
 template<typename VertexT, typename NormalT>
 Plane<VertexT, NormalT> AdaptiveKSearchSurface<VertexT, NormalT>::calcPlaneRANSACfromPoints(const VertexT &queryPoint,
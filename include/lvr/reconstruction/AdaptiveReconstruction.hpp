@@ -0,0 +1,82 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * AdaptiveReconstruction.hpp
+ */
+
+#ifndef _ADAPTIVERECONSTRUCTION_HPP_
+#define _ADAPTIVERECONSTRUCTION_HPP_
+
+#include "FastReconstruction.hpp"
+#include "AdaptiveGrid.hpp"
+
+namespace lvr
+{
+
+/**
+ * @brief   Dual marching cubes on an \ref AdaptiveGrid.
+ *
+ *          Every corner of a leaf that is not on the border of the grid
+ *          is surrounded by eight leaves, some of them may be the same.
+ *          Their centers form a dual cell with the corner layout of a
+ *          FastBox, which is triangulated with the marching cubes table.
+ *          Each corner is handled by the first of the smallest leaves
+ *          around it. Vertices lie on the line between two leaf centers
+ *          and are identified by this pair of leaves, so dual cells of
+ *          different sizes share their vertices and the mesh has no
+ *          cracks at changes of the resolution. No transition cells are
+ *          needed.
+ */
+template<typename VertexT, typename NormalT>
+class AdaptiveReconstruction : public FastReconstructionBase<VertexT, NormalT>
+{
+public:
+
+	/**
+	 * @brief   Constructor.
+	 *
+	 * @param grid  An adaptive grid with calculated distance values
+	 */
+	AdaptiveReconstruction(AdaptiveGrid<VertexT>* grid);
+
+	virtual ~AdaptiveReconstruction() {}
+
+	/**
+	 * @brief   Returns the surface reconstruction of the given point set.
+	 *
+	 * @param mesh
+	 */
+	virtual void getMesh(BaseMesh<VertexT, NormalT> &mesh);
+
+private:
+
+	/**
+	 * @brief   Appends the triangles of the dual cells of the given leaves
+	 *          to a list. Each triangle is stored as three vertex keys.
+	 */
+	void getTriangles(size_t begin, size_t end, vector<uint64_t>& triangles);
+
+	AdaptiveGrid<VertexT>*		m_grid;
+};
+
+} /* namespace lvr */
+
+#include "AdaptiveReconstruction.tcc"
+
+#endif /* _ADAPTIVERECONSTRUCTION_HPP_ */
@@ -0,0 +1,189 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * AdaptiveReconstruction.tcc
+ */
+
+#include "AdaptiveReconstruction.hpp"
+#include "FastReconstructionTables.hpp"
+#include "FastBoxTables.hpp"
+#include "MCTable.hpp"
+
+#include <lvr/io/Progress.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace lvr
+{
+
+template<typename VertexT, typename NormalT>
+AdaptiveReconstruction<VertexT, NormalT>::AdaptiveReconstruction(AdaptiveGrid<VertexT>* grid)
+{
+	m_grid = grid;
+}
+
+template<typename VertexT, typename NormalT>
+void AdaptiveReconstruction<VertexT, NormalT>::getTriangles(size_t begin, size_t end, vector<uint64_t>& triangles)
+{
+	const vector<AdaptiveCell>& cells = m_grid->getCells();
+	vector<QueryPoint<VertexT> >& qp = m_grid->getQueryPoints();
+	int size = m_grid->getSize();
+
+	for(size_t l = begin; l < end; l++)
+	{
+		const AdaptiveCell& cell = cells[l];
+		for(int k = 0; k < 8; k++)
+		{
+			int vx = cell.x + (box_creation_table[k][0] > 0 ? cell.size : 0);
+			int vy = cell.y + (box_creation_table[k][1] > 0 ? cell.size : 0);
+			int vz = cell.z + (box_creation_table[k][2] > 0 ? cell.size : 0);
+			if(vx <= 0 || vy <= 0 || vz <= 0 || vx >= size || vy >= size || vz >= size)
+			{
+				continue;
+			}
+
+			// The leaves around the corner in the order of the box corners
+			// and the first of the smallest of them
+			int dual[8];
+			int owner = -1;
+			for(int i = 0; i < 8; i++)
+			{
+				dual[i] = m_grid->findCell(vx + (box_creation_table[i][0] > 0 ? 0 : -1),
+				                           vy + (box_creation_table[i][1] > 0 ? 0 : -1),
+				                           vz + (box_creation_table[i][2] > 0 ? 0 : -1));
+				if(owner == -1 || cells[dual[i]].size < cells[owner].size)
+				{
+					owner = dual[i];
+				}
+			}
+			if(owner != (int)l)
+			{
+				continue;
+			}
+
+			int index = 0;
+			bool invalid = false;
+			for(int i = 0; i < 8; i++)
+			{
+				invalid = invalid || qp[dual[i]].m_invalid;
+				if(qp[dual[i]].m_distance > 0)
+				{
+					index |= (1 << i);
+				}
+			}
+			if(invalid)
+			{
+				continue;
+			}
+
+			// Edges of degenerated dual cells may connect the same pair of
+			// leaves, triangles with such duplicate vertices are skipped.
+			// The line between two leaf centers lies inside the two leaves,
+			// so the surface can only cross it if data points are in or
+			// next to one of them. Other crossings come from the distance
+			// values of empty leaves far from the surface.
+			for(int a = 0; MCTable[index][a] != -1; a += 3)
+			{
+				uint64_t keys[3];
+				bool supported = true;
+				for(int b = 0; b < 3; b++)
+				{
+					int edge = MCTable[index][a + b];
+					uint64_t first  = dual[vertex_edge_table[edge][0]];
+					uint64_t second = dual[vertex_edge_table[edge][1]];
+					keys[b] = first < second ? (first << 32 | second) : (second << 32 | first);
+					supported = supported && (cells[first].populated || cells[second].populated);
+				}
+				if(supported && keys[0] != keys[1] && keys[1] != keys[2] && keys[0] != keys[2])
+				{
+					triangles.insert(triangles.end(), keys, keys + 3);
+				}
+			}
+		}
+	}
+}
+
+template<typename VertexT, typename NormalT>
+void AdaptiveReconstruction<VertexT, NormalT>::getMesh(BaseMesh<VertexT, NormalT> &mesh)
+{
+	vector<QueryPoint<VertexT> >& qp = m_grid->getQueryPoints();
+	size_t numCells = m_grid->getNumberOfCells();
+
+	// Triangulate fixed chunks of leaves in parallel. The chunks are merged
+	// in their order, so the mesh does not depend on the number of threads.
+	const size_t chunkSize = 4096;
+	size_t numChunks = (numCells + chunkSize - 1) / chunkSize;
+	vector<vector<uint64_t> > triangles(numChunks);
+
+	string comment = timestamp.getElapsedTime() + "Creating Mesh ";
+	ProgressBar progress(numChunks, comment);
+
+	#pragma omp parallel for schedule(dynamic)
+	for(int c = 0; c < (int)numChunks; c++)
+	{
+		getTriangles(c * chunkSize, std::min(numCells, (c + 1) * chunkSize), triangles[c]);
+		if(!timestamp.isQuiet())
+			++progress;
+	}
+
+	if(!timestamp.isQuiet())
+		cout << endl;
+
+	// Create each vertex once on the line between its two leaf centers
+	unsigned int global_index = mesh.meshSize();
+	std::unordered_map<uint64_t, unsigned int> vertices;
+	for(size_t c = 0; c < numChunks; c++)
+	{
+		vector<uint64_t>& keys = triangles[c];
+		for(size_t t = 0; t < keys.size(); t += 3)
+		{
+			unsigned int index[3];
+			for(int b = 0; b < 3; b++)
+			{
+				std::unordered_map<uint64_t, unsigned int>::iterator it = vertices.find(keys[t + b]);
+				if(it != vertices.end())
+				{
+					index[b] = it->second;
+					continue;
+				}
+
+				const QueryPoint<VertexT>& p = qp[keys[t + b] >> 32];
+				const QueryPoint<VertexT>& q = qp[keys[t + b] & 0xffffffff];
+				float s = p.m_distance / (p.m_distance - q.m_distance);
+				VertexT v(p.m_position[0] + s * (q.m_position[0] - p.m_position[0]),
+				          p.m_position[1] + s * (q.m_position[1] - p.m_position[1]),
+				          p.m_position[2] + s * (q.m_position[2] - p.m_position[2]));
+
+				mesh.addVertex(v);
+				mesh.addNormal(NormalT());
+				vertices[keys[t + b]] = global_index;
+				index[b] = global_index++;
+			}
+			mesh.addTriangle(index[0], index[1], index[2]);
+		}
+		vector<uint64_t>().swap(keys);
+	}
+
+	cout << timestamp << "Created " << vertices.size() << " vertices from "
+	     << numCells << " adaptive cells." << endl;
+}
+
+} /* namespace lvr */
@@ -57,8 +57,31 @@ public:
             vector<QueryPoint<VertexT> > &query_points,
             uint &globalIndex);
 
+    /**
+     * @brief Forgets the mesh vertices and faces created by \ref getSurface
+     */
+    virtual void clearIntersections();
+
     void optimizePlanarFaces(size_t kc);
 
+    /**
+     * @brief Collects the vertices of the contour edges of this box that
+     *        are moved by optimizePlanarFaces.
+     *
+     * @param vertices      The vertices are appended to this vector
+     */
+    void getContourVertices(vector<HalfEdgeVertex<VertexT, NormalT>* > &vertices);
+
+    /**
+     * @brief Moves the given vertices into the centroid of their kc nearest
+     *        points. The searches are done in parallel, so every vertex
+     *        should only be contained once.
+     *
+     * @param vertices      The vertices to move
+     * @param kc            The number of nearest points
+     */
+    static void moveToCentroids(vector<HalfEdgeVertex<VertexT, NormalT>* > &vertices, size_t kc);
+
     // the point set surface
     static typename PointsetSurface<VertexT>::Ptr m_surface;
 
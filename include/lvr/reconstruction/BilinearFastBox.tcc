@@ -49,6 +49,13 @@ BilinearFastBox<VertexT, NormalT>::BilinearFastBox(VertexT &center)
 	//cout << m_surface << endl;
 }
 
+template<typename VertexT, typename NormalT>
+void BilinearFastBox<VertexT, NormalT>::clearIntersections()
+{
+    FastBox<VertexT, NormalT>::clearIntersections();
+    m_faces.clear();
+}
+
 template<typename VertexT, typename NormalT>
 void BilinearFastBox<VertexT, NormalT>::getSurface(
         BaseMesh<VertexT, NormalT> &m,
@@ -132,84 +139,103 @@ void BilinearFastBox<VertexT, NormalT>::optimizePlanarFaces(size_t kc)
 {
 	if(this->m_surface)
 	{
-		typedef HalfEdge<HalfEdgeVertex<VertexT, NormalT>, HalfEdgeFace<VertexT, NormalT> > HEdge;
+		vector<HalfEdgeVertex<VertexT, NormalT>* > vertices;
+		getContourVertices(vertices);
+		moveToCentroids(vertices, kc);
+	}
+}
 
-		typename SearchTree<VertexT>::Ptr tree = this->m_surface->searchTree();
+template<typename VertexT, typename NormalT>
+void BilinearFastBox<VertexT, NormalT>::getContourVertices(vector<HalfEdgeVertex<VertexT, NormalT>* > &vertices)
+{
+	typedef HalfEdge<HalfEdgeVertex<VertexT, NormalT>, HalfEdgeFace<VertexT, NormalT> > HEdge;
 
-		// Detect triangles that are on the border of the mesh
-		vector<HEdge*> out_edges;
+	// Detect triangles that are on the border of the mesh
+	vector<HEdge*> out_edges;
 
-		for(int i = 0; i < m_faces.size(); i++)
+	for(int i = 0; i < m_faces.size(); i++)
+	{
+		HalfEdgeFace<VertexT, NormalT>* face = m_faces[i];
+		HEdge* e = face->m_edge;
+		for(int j = 0; j < 2; j++)
 		{
-			HalfEdgeFace<VertexT, NormalT>* face = m_faces[i];
-			HEdge* e = face->m_edge;
-			for(int j = 0; j < 2; j++)
+			// Catch null pointer from outer faces
+			try
+			{
+				e->pair()->face();
+			}
+			catch (HalfEdgeAccessException& ex)
 			{
-				// Catch null pointer from outer faces
-				try
-				{
-					e->pair()->face();
-				}
-				catch (HalfEdgeAccessException& ex)
-				{
-					out_edges.push_back(e);
-				}
-
-				// Check integrity
-				try
-				{
-					e = e->next();
-				}
-				catch (HalfEdgeAccessException& ex)
-				{
-					// Face corrupted, abort
-					cout << "Warning, corrupted face" << endl;
-					break;
-				}
+				out_edges.push_back(e);
 			}
 
+			// Check integrity
+			try
+			{
+				e = e->next();
+			}
+			catch (HalfEdgeAccessException& ex)
+			{
+				// Face corrupted, abort
+				cout << "Warning, corrupted face" << endl;
+				break;
+			}
+		}
+
+	}
+
+	// Handle different cases
+	if(out_edges.size() == 1 || out_edges.size() == 2 )
+	{
+		for(int i = 0; i < out_edges.size(); i++)
+		{
+			vertices.push_back(out_edges[i]->start());
+			vertices.push_back(out_edges[i]->end());
 		}
+	}
+}
+
+template<typename VertexT, typename NormalT>
+void BilinearFastBox<VertexT, NormalT>::moveToCentroids(vector<HalfEdgeVertex<VertexT, NormalT>* > &vertices, size_t kc)
+{
+	if(!m_surface)
+	{
+		return;
+	}
+
+	// Use the tree and a view of the points directly, the searches
+	// run in parallel and copying shared pointers would serialize them
+	typename SearchTree<VertexT>::Ptr tree = m_surface->searchTree();
+	PointBufferPtr buffer = m_surface->pointBuffer();
+	floatView points = buffer->getPointView();
+
+	#pragma omp parallel for schedule(dynamic, 64)
+	for(int i = 0; i < (int)vertices.size(); i++)
+	{
+		vector<size_t> nearest;
+		tree->kSearch(vertices[i]->m_position, kc, nearest);
 
-		// Handle different cases
-		if(out_edges.size() == 1 || out_edges.size() == 2 )
+		// Hmmm, sometimes the k-search seems to fail...
+		float centroid[3] = {0.0f, 0.0f, 0.0f};
+		size_t nk = 0;
+		for(size_t a = 0; a < min(kc, nearest.size()); a++)
 		{
-			// Get nearest points
-			for(int i = 0; i < out_edges.size(); i++)
+			if(nearest[a] < points.size())
 			{
-				vector<VertexT> nearest1, nearest2;
-				this->m_surface->searchTree()->kSearch( out_edges[i]->start()->m_position, kc, nearest1);
-
-				size_t nk = min(kc, nearest1.size());
-
-
-				// Hmmm, sometimes the k-search seems to fail...
-				if(nk > 0)
-				{
-					VertexT centroid1;
-					for(int a = 0; a < nk; a++)
-					{
-						centroid1 += nearest1[a];
-					}
-					centroid1 /= nk;
-					out_edges[i]->start()->m_position = centroid1;
-				}
-
-				this->m_surface->searchTree()->kSearch( out_edges[i]->end()->m_position, kc, nearest2);
-				nk = min(kc, nearest2.size());
-
-				if(nk > 0)
-				{
-					VertexT centroid2;
-					for(int a = 0; a < nk; a++)
-					{
-						centroid2 += nearest2[a];
-					}
-					centroid2 /= nk;
-					out_edges[i]->end()->m_position = centroid2;
-				}
-
+				const float* p = points[nearest[a]];
+				centroid[0] += p[0];
+				centroid[1] += p[1];
+				centroid[2] += p[2];
+				nk++;
 			}
 		}
+
+		if(nk > 0)
+		{
+			vertices[i]->m_position[0] = centroid[0] / nk;
+			vertices[i]->m_position[1] = centroid[1] / nk;
+			vertices[i]->m_position[2] = centroid[2] / nk;
+		}
 	}
 }
 
@@ -121,6 +121,13 @@ public:
             vector<QueryPoint<VertexT> > &query_points,
             uint &globalIndex);
 
+    /**
+     * @brief Forgets the mesh vertices created by \ref getSurface, so
+     *        that the surface of the box can be extracted again into a
+     *        new mesh.
+     */
+    virtual void clearIntersections();
+
     /// The voxelsize of the reconstruction grid
     static float             m_voxelsize;
 
@@ -59,6 +59,15 @@ FastBox<VertexT, NormalT>::FastBox(VertexT &center)
     m_center = center;
 }
 
+template<typename VertexT, typename NormalT>
+void FastBox<VertexT, NormalT>::clearIntersections()
+{
+    for(int i = 0; i < 12; i++)
+    {
+    	m_intersections[i] = INVALID_INDEX;
+    }
+}
+
 template<typename VertexT, typename NormalT>
 void FastBox<VertexT, NormalT>::setVertex(int index, uint nb)
 {
@@ -29,6 +29,7 @@
 
 #include <lvr/geometry/Vertex.hpp>
 #include <lvr/geometry/BoundingBox.hpp>
+#include <lvr/io/MeshBuffer.hpp>
 
 #include "PointsetMeshGenerator.hpp"
 #include "LocalApproximation.hpp"
@@ -95,6 +96,35 @@ public:
      */
     virtual void getMesh(BaseMesh<VertexT, NormalT> &mesh);
 
+    /**
+     * @brief Extracts the surface of the given cells only, e.g. of the
+     *        cells returned by PointsetGrid::getUpdatedCells. The cells
+     *        and their neighbors forget the vertices of previous
+     *        extractions, so the result is a separate mesh fragment that
+     *        can be welded into the mesh of the other cells by
+     *        \ref spliceMesh. Sharp features and plane contours are not
+     *        processed, since they move vertices off the lattice edges.
+     *
+     * @param mesh      The mesh for the fragment
+     * @param cells     Hash values of the cells
+     */
+    void getMesh(BaseMesh<VertexT, NormalT> &mesh, const vector<size_t>& cells);
+
+    /**
+     * @brief Replaces the triangles of the given cells in a mesh that was
+     *        extracted from the grid by the triangles of a fragment that
+     *        was extracted by \ref getMesh for the same cells. Vertices on
+     *        the faces between replaced and kept cells are welded by their
+     *        lattice edge. The kept triangles are copied, but not extracted
+     *        again.
+     *
+     * @param mesh      The mesh of the whole grid
+     * @param fragment  The fragment of the given cells
+     * @param cells     Hash values of the replaced cells
+     * @return  The spliced mesh
+     */
+    MeshBufferPtr spliceMesh(MeshBufferPtr mesh, MeshBufferPtr fragment, const vector<size_t>& cells);
+
 private:
 
     HashGrid<VertexT, BoxT>*		m_grid;
@@ -26,8 +26,13 @@
 #include <lvr/geometry/BaseMesh.hpp>
 #include "FastReconstructionTables.hpp"
 #include "SharpBox.hpp"
+#include "LatticeEdge.hpp"
 #include <lvr/io/Progress.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
 namespace lvr
 {
 
@@ -40,6 +45,15 @@ FastReconstruction<VertexT, NormalT, BoxT>::FastReconstruction(HashGrid<VertexT,
 template<typename VertexT, typename NormalT, typename BoxT>
 void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, NormalT> &mesh)
 {
+	BoxTraits<BoxT> traits;
+
+	// Interpolate the normals of the sharp feature detection from
+	// normals that are computed once per query point
+	if(traits.type == "SharpBox" && SharpBox<VertexT, NormalT>::m_surface)
+	{
+		SharpBox<VertexT, NormalT>::calcQueryPointNormals(m_grid->getQueryPoints());
+	}
+
 	// Status message for mesh generation
 	string comment = timestamp.getElapsedTime() + "Creating Mesh ";
 	ProgressBar progress(m_grid->getNumberOfCells(), comment);
@@ -61,7 +75,10 @@ void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, Norma
 	if(!timestamp.isQuiet())
 		cout << endl;
 
-	BoxTraits<BoxT> traits;
+	if(traits.type == "SharpBox")
+	{
+		SharpBox<VertexT, NormalT>::clearQueryPointNormals();
+	}
 
 	if(traits.type == "SharpBox")  // Perform edge flipping for extended marching cubes
 	{
@@ -95,18 +112,210 @@ void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, Norma
 	{
 	    string comment = timestamp.getElapsedTime() + "Optimizing plane contours  ";
 	    ProgressBar progress(this->m_grid->getNumberOfCells(), comment);
+
+	    // Collect the contour vertices of all boxes first. Vertices are
+	    // shared between neighboring boxes, so each one is searched only
+	    // once and all searches run in one parallel pass.
+	    vector<HalfEdgeVertex<VertexT, NormalT>* > contour;
 	    for(it = this->m_grid->firstCell(); it != this->m_grid->lastCell(); it++)
 	    {
 	    	// F... type safety. According to traits object this is OK!
 	        BilinearFastBox<VertexT, NormalT>* box = reinterpret_cast<BilinearFastBox<VertexT, NormalT>*>(it->second);
-	        box->optimizePlanarFaces(5);
+	        box->getContourVertices(contour);
 	        ++progress;
 	    }
 	    cout << endl;
+
+	    std::sort(contour.begin(), contour.end());
+	    contour.erase(std::unique(contour.begin(), contour.end()), contour.end());
+	    BilinearFastBox<VertexT, NormalT>::moveToCentroids(contour, 5);
 	}
 
 }
 
+template<typename VertexT, typename NormalT, typename BoxT>
+void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, NormalT> &mesh, const vector<size_t>& cells)
+{
+	m_grid->clearIntersections(cells);
+
+	unsigned int global_index = mesh.meshSize();
+	for(size_t i = 0; i < cells.size(); i++)
+	{
+		BoxT* b = m_grid->getCell(cells[i]);
+		if(b)
+		{
+			b->getSurface(mesh, m_grid->getQueryPoints(), global_index);
+		}
+	}
+}
+
+template<typename VertexT, typename NormalT, typename BoxT>
+MeshBufferPtr FastReconstruction<VertexT, NormalT, BoxT>::spliceMesh(MeshBufferPtr mesh, MeshBufferPtr fragment, const vector<size_t>& cells)
+{
+	size_t numVertices, numFaces, numNormals, numColors;
+	floatArr vertices = mesh->getVertexArray(numVertices);
+	uintArr faces = mesh->getFaceArray(numFaces);
+	floatArr normals = mesh->getVertexNormalArray(numNormals);
+	ucharArr colors = mesh->getVertexColorArray(numColors);
+
+	size_t numFragmentVertices, numFragmentFaces, numFragmentNormals, numFragmentColors;
+	floatArr fragmentVertices = fragment->getVertexArray(numFragmentVertices);
+	uintArr fragmentFaces = fragment->getFaceArray(numFragmentFaces);
+	floatArr fragmentNormals = fragment->getVertexNormalArray(numFragmentNormals);
+	ucharArr fragmentColors = fragment->getVertexColorArray(numFragmentColors);
+
+	bool useNormals = numNormals == numVertices && numFragmentNormals == numFragmentVertices;
+	bool useColors = numColors == numVertices && numFragmentColors == numFragmentVertices;
+
+	VertexT v_min = m_grid->getBoundingBox().getMin();
+	Vertexf origin(v_min[0], v_min[1], v_min[2]);
+	float voxelsize = BoxT::m_voxelsize;
+	unordered_set<size_t> replaced(cells.begin(), cells.end());
+
+	// The triangles of a cell lie inside of it, so the cell is given by
+	// their centroid
+	vector<char> keepFace(numFaces, 0);
+	vector<int64_t> newIndex(numVertices, -1);
+	for(size_t i = 0; i < numFaces; i++)
+	{
+		int index[3];
+		for(int k = 0; k < 3; k++)
+		{
+			float c = (vertices[3 * faces[3 * i]     + k]
+			         + vertices[3 * faces[3 * i + 1] + k]
+			         + vertices[3 * faces[3 * i + 2] + k]) / 3.0f;
+			index[k] = (int)floorf((c - origin[k]) / voxelsize + 0.5f);
+		}
+
+		if(replaced.find(m_grid->hashValue(index[0], index[1], index[2])) == replaced.end())
+		{
+			keepFace[i] = 1;
+			for(int j = 0; j < 3; j++)
+			{
+				newIndex[faces[3 * i + j]] = 0;
+			}
+		}
+	}
+
+	// Compact the vertices that are still referenced
+	vector<float> newVertices;
+	vector<float> newNormals;
+	vector<unsigned char> newColors;
+	size_t count = 0;
+	for(size_t i = 0; i < numVertices; i++)
+	{
+		if(newIndex[i] == -1)
+		{
+			continue;
+		}
+
+		newIndex[i] = count++;
+		newVertices.insert(newVertices.end(), &vertices[3 * i], &vertices[3 * i] + 3);
+		if(useNormals)
+		{
+			newNormals.insert(newNormals.end(), &normals[3 * i], &normals[3 * i] + 3);
+		}
+		if(useColors)
+		{
+			newColors.insert(newColors.end(), &colors[3 * i], &colors[3 * i] + 3);
+		}
+	}
+
+	vector<unsigned int> newFaces;
+	newFaces.reserve(3 * numFaces);
+	for(size_t i = 0; i < numFaces; i++)
+	{
+		if(keepFace[i])
+		{
+			for(int j = 0; j < 3; j++)
+			{
+				newFaces.push_back(newIndex[faces[3 * i + j]]);
+			}
+		}
+	}
+
+	// Kept vertices of removed triangles lie on the faces between replaced
+	// and kept cells. The distance values at both ends of their edges were
+	// not changed, so the fragment creates them at the same position.
+	unordered_map<LatticeEdge, unsigned int, LatticeEdgeHash> border;
+	for(size_t i = 0; i < numFaces; i++)
+	{
+		if(keepFace[i])
+		{
+			continue;
+		}
+
+		for(int j = 0; j < 3; j++)
+		{
+			unsigned int v = faces[3 * i + j];
+			LatticeEdge edge;
+			if(newIndex[v] != -1 && latticeEdge(&vertices[3 * v], origin, voxelsize, edge))
+			{
+				border.insert(std::make_pair(edge, (unsigned int)newIndex[v]));
+			}
+		}
+	}
+
+	size_t numWelded = 0;
+	vector<unsigned int> fragmentIndex(numFragmentVertices);
+	for(size_t i = 0; i < numFragmentVertices; i++)
+	{
+		LatticeEdge edge;
+		if(latticeEdge(&fragmentVertices[3 * i], origin, voxelsize, edge))
+		{
+			typename unordered_map<LatticeEdge, unsigned int, LatticeEdgeHash>::iterator it = border.find(edge);
+			if(it != border.end())
+			{
+				fragmentIndex[i] = it->second;
+				numWelded++;
+				continue;
+			}
+		}
+
+		fragmentIndex[i] = count++;
+		newVertices.insert(newVertices.end(), &fragmentVertices[3 * i], &fragmentVertices[3 * i] + 3);
+		if(useNormals)
+		{
+			newNormals.insert(newNormals.end(), &fragmentNormals[3 * i], &fragmentNormals[3 * i] + 3);
+		}
+		if(useColors)
+		{
+			newColors.insert(newColors.end(), &fragmentColors[3 * i], &fragmentColors[3 * i] + 3);
+		}
+	}
+
+	for(size_t i = 0; i < numFragmentFaces; i++)
+	{
+		unsigned int a = fragmentIndex[fragmentFaces[3 * i]];
+		unsigned int b = fragmentIndex[fragmentFaces[3 * i + 1]];
+		unsigned int c = fragmentIndex[fragmentFaces[3 * i + 2]];
+
+		// Welding may collapse tiny triangles at the border
+		if(a != b && b != c && a != c)
+		{
+			newFaces.push_back(a);
+			newFaces.push_back(b);
+			newFaces.push_back(c);
+		}
+	}
+
+	cout << timestamp << "Replaced " << numFaces - std::count(keepFace.begin(), keepFace.end(), 1)
+	     << " faces by " << numFragmentFaces << " faces, " << numWelded << " welded vertices." << endl;
+
+	MeshBufferPtr result(new MeshBuffer);
+	result->setVertexArray(newVertices);
+	result->setFaceArray(newFaces);
+	if(useNormals)
+	{
+		result->setVertexNormalArray(newNormals);
+	}
+	if(useColors)
+	{
+		result->setVertexColorArray(newColors);
+	}
+	return result;
+}
+
 /*template<typename VertexT, typename NormalT, typename BoxT>
 void FastReconstruction<VertexT, typename BoxT, NormalT>::calcQueryPointValues(){
 
@@ -152,6 +152,31 @@ public:
 
 	box_map getCells() { return m_cells; }
 
+	/**
+	 * @brief	Removes the references to mesh vertices from all cells, so
+	 * 			that the surface can be extracted again into a new mesh,
+	 * 			e.g. after distance values were updated.
+	 */
+	void clearIntersections();
+
+	/**
+	 * @brief	Removes the references to mesh vertices from the given cells
+	 * 			and their neighbors, so that only these cells can be
+	 * 			extracted again into a new mesh.
+	 *
+	 * @param	cells	Hash values of the cells
+	 */
+	void clearIntersections(const vector<size_t>& cells);
+
+	/**
+	 * @return	The cell with the given hash value or 0 if it does not exist
+	 */
+	BoxT* getCell(size_t hash)
+	{
+		box_map_it it = m_cells.find(hash);
+		return it == m_cells.end() ? 0 : it->second;
+	}
+
 	/***
 	 * @brief	Destructor
 	 */
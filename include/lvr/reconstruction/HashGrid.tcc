@@ -343,6 +343,39 @@ void HashGrid<VertexT, BoxT>::setCoordinateScaling(float x, float y, float z)
 	m_coordinateScales[2] = z;
 }
 
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::clearIntersections()
+{
+	for(box_map_it it = m_cells.begin(); it != m_cells.end(); it++)
+	{
+		it->second->clearIntersections();
+	}
+}
+
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::clearIntersections(const vector<size_t>& cells)
+{
+	// The neighbors are cleared too, since getSurface reuses the vertices
+	// that were created by adjacent cells
+	for(size_t i = 0; i < cells.size(); i++)
+	{
+		BoxT* box = getCell(cells[i]);
+		if(!box)
+		{
+			continue;
+		}
+
+		box->clearIntersections();
+		for(int k = 0; k < 27; k++)
+		{
+			if(box->getNeighbor(k))
+			{
+				box->getNeighbor(k)->clearIntersections();
+			}
+		}
+	}
+}
+
 template<typename VertexT, typename BoxT>
 HashGrid<VertexT, BoxT>::~HashGrid()
 {
@@ -0,0 +1,76 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * LatticeEdge.hpp
+ */
+
+#ifndef LATTICEEDGE_HPP_
+#define LATTICEEDGE_HPP_
+
+#include <lvr/geometry/Vertex.hpp>
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace lvr
+{
+
+/**
+ * @brief   A marching cubes vertex position given as the edge of a
+ *          query point lattice it lies on. Meshes that were extracted
+ *          independently on the same lattice are welded by these IDs.
+ */
+struct LatticeEdge
+{
+    /// Index of the lower query point of the edge
+    int32_t x, y, z;
+
+    /// Axis of the edge (0: x, 1: y, 2: z)
+    int32_t axis;
+
+    bool operator==(const LatticeEdge& other) const
+    {
+        return x == other.x && y == other.y && z == other.z && axis == other.axis;
+    }
+};
+
+struct LatticeEdgeHash
+{
+    size_t operator()(const LatticeEdge& e) const
+    {
+        return ((size_t)e.x * 73856093) ^ ((size_t)e.y * 19349663)
+             ^ ((size_t)e.z * 83492791) ^ (size_t)e.axis;
+    }
+};
+
+/**
+ * @brief   Computes the lattice edge a vertex lies on.
+ *
+ * @param v         The vertex position
+ * @param origin    Lower corner of the lattice. Query point k lies at
+ *                  origin + (k + 0.5) * voxelsize
+ * @param voxelsize Distance of neighboring query points
+ * @param edge      The edge of the vertex
+ * @return  False if the vertex is not on a lattice edge
+ */
+bool latticeEdge(const float* v, const Vertexf& origin, float voxelsize, LatticeEdge& edge);
+
+} // namespace lvr
+
+#endif /* LATTICEEDGE_HPP_ */
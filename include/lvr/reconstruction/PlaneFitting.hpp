@@ -0,0 +1,142 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * PlaneFitting.hpp
+ */
+
+#ifndef PLANEFITTING_HPP_
+#define PLANEFITTING_HPP_
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace lvr
+{
+
+/**
+ * @brief   A small xorshift64* random number generator. It has no global
+ *          state, so every thread or every call can use its own instance
+ *          on the stack.
+ */
+class FastRandom
+{
+public:
+
+    /// Creates a generator. Equal seeds create equal sequences.
+    FastRandom(uint64_t seed = 0)
+    {
+        // Spread the seed with a splitmix64 step, the state must not be zero
+        seed += 0x9E3779B97F4A7C15ULL;
+        seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+        m_state = (seed ^ (seed >> 31)) | 1;
+    }
+
+    /// Returns the next 64 random bits
+    uint64_t next()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /// Returns a random number in [0, n)
+    uint32_t uniform(uint32_t n)
+    {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+
+private:
+    uint64_t m_state;
+};
+
+/**
+ * @brief   Fits a plane to a neighborhood of points in the total least
+ *          squares sense.
+ *
+ *          The 3x3 covariance matrix of the neighborhood is accumulated
+ *          with SSE, using coordinates relative to the query point to keep
+ *          the float sums accurate. The normal is the eigenvector of the
+ *          smallest eigenvalue, computed with Eigen's closed-form solver
+ *          for symmetric 3x3 matrices. No memory is allocated.
+ *
+ * @param points    Interleaved xyz coordinates of all points
+ * @param ids       Indices of the neighborhood points in points
+ * @param k         Number of neighborhood points
+ * @param query     The query point
+ * @param normal    The unit normal of the plane
+ * @param centroid  If given, the centroid of the neighborhood is stored here
+ *
+ * @return  false if the neighborhood has less than three points or all
+ *          points are equal. The normal is not set in this case.
+ */
+bool fitPlane(const float* points, const size_t* ids, size_t k,
+              const float* query, float* normal, float* centroid = 0);
+
+/**
+ * @brief   Fits planes to many neighborhoods in parallel
+ *
+ * @param points    Interleaved xyz coordinates of all points
+ * @param ids       Concatenated indices of all neighborhoods
+ * @param offsets   Neighborhood i consists of ids[offsets[i]] to
+ *                  ids[offsets[i + 1] - 1], so n + 1 offsets are needed
+ * @param n         Number of neighborhoods
+ * @param queries   Interleaved xyz coordinates of the n query points
+ * @param normals   Interleaved normals of the n planes. Degenerated
+ *                  neighborhoods get a zero normal.
+ * @param centroids If given, the centroids of the neighborhoods are stored here
+ */
+void fitPlanes(const float* points, const size_t* ids, const size_t* offsets, size_t n,
+               const float* queries, float* normals, float* centroids = 0);
+
+/**
+ * @brief   Fits a plane to a neighborhood of points with RANSAC.
+ *
+ *          Candidate planes through three random points are scored against
+ *          the whole neighborhood with SSE. Points closer than threshold
+ *          times the RMS radius of the neighborhood are inliers. The search
+ *          stops after maxIterations candidates, as soon as a candidate has
+ *          at least inlierRatio inliers, or when the standard RANSAC bound
+ *          for the best inlier ratio so far is reached with 99% confidence.
+ *          The best candidate is refined by a least squares fit of its
+ *          inliers. Neighborhoods of more than 256 points are subsampled,
+ *          all working arrays are on the stack.
+ *
+ * @param points        Interleaved xyz coordinates of all points
+ * @param ids           Indices of the neighborhood points in points
+ * @param k             Number of neighborhood points
+ * @param random        The random number generator
+ * @param normal        The unit normal of the plane
+ * @param point         The centroid of the inliers
+ * @param maxIterations Maximum number of candidate planes
+ * @param inlierRatio   Stop as soon as this ratio of inliers is found
+ * @param threshold     Inlier distance relative to the RMS radius of the
+ *                      neighborhood
+ *
+ * @return  false if the neighborhood is degenerated or all candidates were
+ *          collinear. normal and point are not set in this case.
+ */
+bool fitPlaneRANSAC(const float* points, const size_t* ids, size_t k, FastRandom& random,
+                    float* normal, float* point, size_t maxIterations = 50,
+                    float inlierRatio = 0.9f, float threshold = 0.1f);
+
+} // namespace lvr
+
+#endif /* PLANEFITTING_HPP_ */
@@ -12,6 +12,10 @@
 
 #include "PointsetSurface.hpp"
 
+#include <unordered_set>
+
+using std::unordered_set;
+
 namespace lvr
 {
 
@@ -26,8 +30,54 @@ public:
 
 	void calcDistanceValues();
 
+	/**
+	 * @brief Adds new points, e.g. of an additional scan, to the grid and
+	 *        updates the distance values that are affected by them.
+	 *
+	 * The new points have to be appended to the points of the current
+	 * surface and the given surface has to contain their normals. Cells
+	 * are created around the new points. Distance values are recalculated
+	 * for all new query points and for the query points of the cells
+	 * within the given radius of a new point, all other values are kept.
+	 * This is exact if the kd nearest neighbors of the kept query points
+	 * are closer than the radius, which holds for dense scans.
+	 *
+	 * The surface only has to contain the old points around the new ones,
+	 * so its search tree does not have to be built for the whole site.
+	 * It replaces the surface of the grid.
+	 *
+	 * Points outside the bounding box of the grid are skipped, so the grid
+	 * should be created with a bounding box that covers the whole site.
+	 * The cells whose surface may have changed are returned by
+	 * \ref getUpdatedCells. Only these cells have to be extracted again,
+	 * see FastReconstruction::spliceMesh. Call
+	 * \ref HashGrid::clearIntersections before extracting the whole
+	 * surface again.
+	 *
+	 * @param surface   The surface of the new points and the old points
+	 *                  around them
+	 * @param first     Index of the first new point in the surface
+	 * @param radius    Radius around the new points in which distance values
+	 *                  are updated. Two voxels if not positive.
+	 *
+	 * @return The number of recalculated distance values
+	 */
+	size_t addPoints(typename PointsetSurface<VertexT>::Ptr surface, size_t first, float radius = 0);
+
+	/**
+	 * @brief Returns the hash values of the cells that share a corner with
+	 *        a query point that was updated by the last call of
+	 *        \ref addPoints
+	 */
+	const vector<size_t>& getUpdatedCells() const { return m_updatedCells; }
+
 private:
 
+	/**
+	 * @brief Calculates the distance values of the given query points
+	 */
+	void calcDistanceValues(const vector<size_t>& ids);
+
     /**
      * @brief Rounds the given value to the neares integer value
      */
@@ -37,6 +87,9 @@ private:
     }
 
 	typename PointsetSurface<VertexT>::Ptr		m_surface;
+
+	/// The cells that were updated by the last call of \ref addPoints
+	vector<size_t>								m_updatedCells;
 };
 
 } /* namespace lvr */
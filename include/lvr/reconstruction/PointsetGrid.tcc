@@ -6,6 +6,7 @@
  */
 
 #include "PointsetGrid.hpp"
+#include "SpatialSort.hpp"
 
 namespace lvr
 {
@@ -19,9 +20,9 @@ PointsetGrid<VertexT, BoxT>::PointsetGrid(float cellSize, typename PointsetSurfa
 	VertexT v_min = this->m_boundingBox.getMin();
 	VertexT v_max = this->m_boundingBox.getMax();
 
-	// Get indexed point buffer pointer
-	size_t num_points;
-	coord3fArr points = this->m_surface->pointBuffer()->getIndexedPointArray(num_points);
+	// Get a view of the points
+	floatView points = this->m_surface->pointBuffer()->getPointView();
+	size_t num_points = points.size();
 
 	size_t index_x, index_y, index_z;
 
@@ -41,16 +42,41 @@ PointsetGrid<VertexT, BoxT>::PointsetGrid(float cellSize, typename PointsetSurfa
 
 template<typename VertexT, typename BoxT>
 void PointsetGrid<VertexT, BoxT>::calcDistanceValues()
+{
+	vector<size_t> ids(this->m_queryPoints.size());
+	for(size_t i = 0; i < ids.size(); i++)
+	{
+		ids[i] = i;
+	}
+	calcDistanceValues(ids);
+}
+
+template<typename VertexT, typename BoxT>
+void PointsetGrid<VertexT, BoxT>::calcDistanceValues(const vector<size_t>& ids)
 {
 	// Status message output
 	string comment = timestamp.getElapsedTime() + "Calculating distance values ";
-	ProgressBar progress(this->m_queryPoints.size(), comment);
+	ProgressBar progress(ids.size(), comment);
 
 	Timestamp ts;
 
+	// Visit the query points along a Morton curve, so that consecutive
+	// searches touch nearby parts of the search tree and point arrays
+	size_t numQueryPoints = ids.size();
+	vector<float> positions(3 * numQueryPoints);
+	for(size_t i = 0; i < numQueryPoints; i++)
+	{
+		positions[3 * i]     = this->m_queryPoints[ids[i]].m_position[0];
+		positions[3 * i + 1] = this->m_queryPoints[ids[i]].m_position[1];
+		positions[3 * i + 2] = this->m_queryPoints[ids[i]].m_position[2];
+	}
+	vector<size_t> order;
+	spatialOrder(numQueryPoints ? &positions[0] : 0, numQueryPoints, MORTON_CURVE, order);
+
 	// Calculate a distance value for each query point
 	#pragma omp parallel for
-	for( int i = 0; i < (int)this->m_queryPoints.size(); i++){
+	for( int j = 0; j < (int)numQueryPoints; j++){
+		size_t i = ids[order[j]];
 		float projectedDistance;
 		float euklideanDistance;
 
@@ -68,6 +94,119 @@ void PointsetGrid<VertexT, BoxT>::calcDistanceValues()
 	cout << timestamp << "Elapsed time: " << ts << endl;
 }
 
+template<typename VertexT, typename BoxT>
+size_t PointsetGrid<VertexT, BoxT>::addPoints(typename PointsetSurface<VertexT>::Ptr surface, size_t first, float radius)
+{
+	m_surface = surface;
+	if(radius <= 0)
+	{
+		radius = 2 * this->m_voxelsize;
+	}
+
+	VertexT v_min = this->m_boundingBox.getMin();
+	floatView points = m_surface->pointBuffer()->getPointView();
+	size_t num_points = points.size();
+	size_t numOldQueryPoints = this->m_queryPoints.size();
+
+	cout << timestamp << "Adding " << (num_points > first ? num_points - first : 0) << " points to grid..." << endl;
+
+	// Insert the new points like in the constructor and remember the
+	// cells that contain them. Indices outside of the bounding box would
+	// produce ambiguous hash values.
+	int maxIndex = (int)this->m_maxIndex - 1;
+	unordered_set<size_t> touched;
+	size_t skipped = 0;
+	for(size_t i = first; i < num_points; i++)
+	{
+		int index_x = calcIndex((points[i][0] - v_min[0]) / this->m_voxelsize);
+		int index_y = calcIndex((points[i][1] - v_min[1]) / this->m_voxelsize);
+		int index_z = calcIndex((points[i][2] - v_min[2]) / this->m_voxelsize);
+		if(index_x < 0 || index_y < 0 || index_z < 0
+		   || index_x >= maxIndex || index_y >= maxIndex || index_z >= maxIndex)
+		{
+			skipped++;
+			continue;
+		}
+
+		this->addLatticePoint(index_x, index_y, index_z);
+		touched.insert(this->hashValue(index_x, index_y, index_z));
+	}
+
+	if(skipped)
+	{
+		cout << timestamp << "Warning: Skipped " << skipped << " points outside of the grid." << endl;
+	}
+
+	// New query points and all query points of the cells within the radius
+	// around the touched cells have to be updated
+	vector<char> dirty(this->m_queryPoints.size(), 0);
+	for(size_t i = numOldQueryPoints; i < dirty.size(); i++)
+	{
+		dirty[i] = 1;
+	}
+
+	// The cells that share a corner with one of these query points have to
+	// be extracted again. They lie within one more cell around the radius
+	// and include the cells that were created for the new points.
+	int r = (int)ceil(radius / this->m_voxelsize);
+	unordered_set<size_t> updated;
+	typename unordered_set<size_t>::iterator hit;
+	for(hit = touched.begin(); hit != touched.end(); hit++)
+	{
+		int index_x = *hit / this->m_maxIndexSquare;
+		int index_y = (*hit / this->m_maxIndex) % this->m_maxIndex;
+		int index_z = *hit % this->m_maxIndex;
+
+		for(int dx = -r - 1; dx <= r + 1; dx++)
+		{
+			for(int dy = -r - 1; dy <= r + 1; dy++)
+			{
+				for(int dz = -r - 1; dz <= r + 1; dz++)
+				{
+					size_t hash = this->hashValue(index_x + dx, index_y + dy, index_z + dz);
+					BoxT* box = this->getCell(hash);
+					if(!box)
+					{
+						continue;
+					}
+
+					updated.insert(hash);
+					if(abs(dx) > r || abs(dy) > r || abs(dz) > r)
+					{
+						continue;
+					}
+
+					for(int k = 0; k < 8; k++)
+					{
+						uint v = box->getVertex(k);
+						if(v != BoxT::INVALID_INDEX)
+						{
+							dirty[v] = 1;
+						}
+					}
+				}
+			}
+		}
+	}
+	m_updatedCells.assign(updated.begin(), updated.end());
+
+	vector<size_t> ids;
+	for(size_t i = 0; i < dirty.size(); i++)
+	{
+		if(dirty[i])
+		{
+			this->m_queryPoints[i].m_invalid = false;
+			ids.push_back(i);
+		}
+	}
+
+	cout << timestamp << "Updating " << ids.size() << " of " << this->m_queryPoints.size()
+	     << " distance values." << endl;
+	calcDistanceValues(ids);
+
+	return ids.size();
+}
+
 template<typename VertexT, typename BoxT>
 PointsetGrid<VertexT, BoxT>::~PointsetGrid()
 {
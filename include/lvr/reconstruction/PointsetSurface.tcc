@@ -30,10 +30,9 @@ PointsetSurface<VertexT>::PointsetSurface(PointBufferPtr pointcloud)
     : m_pointBuffer(pointcloud)
 {
     // Calculate bounding box
-    size_t numPoints;
-    coord3fArr points = this->m_pointBuffer->getIndexedPointArray(numPoints);
+    floatView points = this->m_pointBuffer->getPointView();
 
-    for(size_t i = 0; i < numPoints; i++)
+    for(size_t i = 0; i < points.size(); i++)
     {
         this->m_boundingBox.expand(points[i][0], points[i][1], points[i][2]);
     }
@@ -53,13 +52,18 @@ VertexT PointsetSurface<VertexT>::getInterpolatedNormal(VertexT position)
 {
     vector<size_t> indices;
 	VertexT result(0,0,0);
-	size_t n;
-	this->searchTree()->kSearch(position, this->m_kn, indices);
+
+	// Use the members and a view directly, this is called for every query
+	// point from many threads and copying shared pointers would serialize
+	// them on the reference counts
+	floatView normals = this->m_pointBuffer->getPointNormalView();
+	this->m_searchTree->kSearch(position, this->m_kn, indices);
 	for (int i = 0; i < this->m_kn; i++)
 	{
-		result[0] += this->pointBuffer()->getIndexedPointNormalArray(n)[indices[i]][0];
-		result[1] += this->pointBuffer()->getIndexedPointNormalArray(n)[indices[i]][1];
-		result[2] += this->pointBuffer()->getIndexedPointNormalArray(n)[indices[i]][2];
+		const float* n = normals[indices[i]];
+		result[0] += n[0];
+		result[1] += n[1];
+		result[2] += n[2];
 	}
 	result /= this->m_kn;
 	return result;
@@ -82,9 +82,24 @@ public:
     virtual void kSearch( const coord < float >& qp, size_t k, vector< size_t > &indices, vector< float > &distances );
 
     // Pure virtual. All other search functions map to this. Must be implemented in sub-class.
+    // The results replace the contents of the given vectors, so callers can reuse them.
     virtual void kSearch( coord < float >&       qp, size_t k, vector< size_t > &indices, vector< float > &distances ) = 0;
     virtual void kSearch( VertexT      qp, size_t k, vector< VertexT > &neighbors ) = 0;
 
+    /**
+     * @brief Performs k-next-neighbour searches for many query points at once.
+     *        The default implementation distributes single searches over
+     *        all threads. Implementations can override it with a native
+     *        batch search.
+     *
+     * @param queries     The interleaved coordinates of the query points
+     * @param n           The number of query points
+     * @param k           The number of neighbours per query point
+     * @param indices     Is resized to n * k. The neighbours of query point
+     *                    i are stored at positions [i * k, (i + 1) * k).
+     */
+    virtual void kSearchBatch( const float* queries, size_t n, size_t k, vector< size_t > &indices );
+
 
 
     virtual void radiusSearch( float              qp[3], float r, vector< size_t > &indices ) = 0;
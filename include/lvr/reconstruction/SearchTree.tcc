@@ -138,6 +138,34 @@ void SearchTree< VertexT >::kSearch( const coord< float > &qp, size_t neighbours
 }
 
 
+template<typename VertexT>
+void SearchTree< VertexT >::kSearchBatch( const float* queries, size_t n, size_t k, vector< size_t > &indices )
+{
+    indices.resize(n * k);
+
+    #pragma omp parallel
+    {
+        vector< size_t > ind;
+        vector< float > dst;
+
+        #pragma omp for schedule(dynamic, 256)
+        for(long i = 0; i < (long)n; i++)
+        {
+            coord< float > qp;
+            qp[0] = queries[3 * i];
+            qp[1] = queries[3 * i + 1];
+            qp[2] = queries[3 * i + 2];
+            this->kSearch( qp, k, ind, dst );
+
+            for(size_t j = 0; j < k; j++)
+            {
+                indices[i * k + j] = j < ind.size() ? ind[j] : m_numPoints;
+            }
+        }
+    }
+}
+
+
 template<typename VertexT>
 void SearchTree< VertexT >::setKn( size_t kn ) {
     m_kn = kn;
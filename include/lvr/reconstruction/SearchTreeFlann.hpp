@@ -70,6 +70,13 @@ public:
 
     virtual void kSearch( VertexT qp, size_t k, vector< VertexT > &neighbors );
 
+    /**
+     * @brief Searches the neighbours of all query points with the batch
+     *        search of FLANN. The queries are split into one block per
+     *        thread.
+     */
+    virtual void kSearchBatch( const float* queries, size_t n, size_t k, vector< size_t > &indices );
+
     virtual void radiusSearch( float              qp[3], float r, vector< size_t > &indices );
     virtual void radiusSearch( VertexT&              qp, float r, vector< size_t > &indices );
     virtual void radiusSearch( const VertexT&        qp, float r, vector< size_t > &indices );
@@ -10,6 +10,10 @@
 #include <lvr/geometry/VertexTraits.hpp>
 #include <lvr/io/Timestamp.hpp>
 
+#include <lvr/config/lvropenmp.hpp>
+
+#include <algorithm>
+
 namespace lvr
 {
 
@@ -54,9 +58,41 @@ void SearchTreeFlann< VertexT >::kSearch( coord< float > &qp, size_t k, vector<
 	m_tree->knnSearch(query_point, ind, dist, k, flann::SearchParams());
 }
 
+template<typename VertexT>
+void SearchTreeFlann< VertexT >::kSearchBatch( const float* queries, size_t n, size_t k, vector< size_t > &indices )
+{
+	indices.resize(n * k);
+	if(n == 0 || k == 0)
+	{
+		return;
+	}
+
+	// One block of consecutive queries per thread
+	int numBlocks = OpenMPConfig::getNumThreads();
+	size_t blockSize = (n + numBlocks - 1) / numBlocks;
+
+	#pragma omp parallel for schedule(static, 1)
+	for(int b = 0; b < numBlocks; b++)
+	{
+		size_t first = std::min(n, b * blockSize);
+		size_t count = std::min(n, first + blockSize) - first;
+
+		if(count > 0)
+		{
+			vector<float> distances(count * k);
+			flann::Matrix<float> query(const_cast<float*>(queries + 3 * first), count, 3);
+			flann::Matrix<size_t> ind(&indices[first * k], count, k);
+			flann::Matrix<float> dist(&distances[0], count, k);
+
+			m_tree->knnSearch(query, ind, dist, k, flann::SearchParams());
+		}
+	}
+}
+
 template<typename VertexT>
 void SearchTreeFlann< VertexT >::kSearch(VertexT qp, size_t k, vector< VertexT > &nb)
 {
+	nb.clear();
 	flann::Matrix<float> query_point(new float[3], 1, 3);
 	query_point[0][0] = qp.x;
 	query_point[0][1] = qp.y;
@@ -136,6 +136,7 @@ void SearchTreeFlannPCL< VertexT >::kSearch(VertexT qp, size_t k, vector< Vertex
 {
     vector<size_t> indices;
     vector<float> dist;
+    neighbors.clear();
 
     coord<float> p;
     p[0] = qp[0];
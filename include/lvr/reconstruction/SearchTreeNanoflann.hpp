@@ -137,6 +137,28 @@ private:
         size_t          m_numPoints;
     };
 
+    /// Collects the indices of a radius search. The result set of nanoflann
+    /// does not compile with C++11.
+    class RadiusResultSet
+    {
+    public:
+        RadiusResultSet(float radius, vector<size_t>& indices) : m_radius(radius), m_indices(indices) {}
+
+        inline void addPoint(float dist, size_t index)
+        {
+            if(dist < m_radius)
+            {
+                m_indices.push_back(index);
+            }
+        }
+
+        inline float worstDist() const { return m_radius; }
+
+    private:
+        float               m_radius;
+        vector<size_t>&     m_indices;
+    };
+
     /// Point cloud adator
     NFPointCloud<float>* m_pointCloud;
 
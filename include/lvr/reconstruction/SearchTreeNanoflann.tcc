@@ -25,6 +25,8 @@
 
 #include <lvr/geometry/VertexTraits.hpp>
 
+#include <algorithm>
+
 namespace lvr
 {
 
@@ -55,21 +57,21 @@ void SearchTreeNanoflann<VertexT>::kSearch(
            vector< float > &distances )
 {
 
+    // Overwrite the results like the other search trees, so that callers
+    // can reuse the vectors
     float query_point[3] = {qp[0], qp[1], qp[2]};
-    vector<size_t> ret_index(neighbors);
-    vector<float>  dist(neighbors);
-    const size_t n = neighbors;
-    m_tree->knnSearch(&query_point[0], n, &ret_index[0], &dist[0]);
-
-    for(size_t i = 0; i < ret_index.size(); i++)
+    const size_t n = std::min(neighbors, this->m_numPoints);
+    indices.resize(n);
+    distances.resize(n);
+    if(n)
     {
-        indices.push_back(ret_index[i]);
-        distances.push_back(dist[i]);
+        m_tree->knnSearch(&query_point[0], n, &indices[0], &distances[0]);
     }
 }
 template<typename VertexT>
 void SearchTreeNanoflann<VertexT>::kSearch(VertexT qp, size_t k, vector< VertexT > &nb)
 {
+    nb.clear();
     float query_point[3] = {qp[0], qp[1], qp[2]};
     vector<size_t> neighbors(k);
     vector<float> dist(k);
@@ -99,19 +101,41 @@ void SearchTreeNanoflann<VertexT>::kSearch(VertexT qp, size_t k, vector< VertexT
 
 
 template<typename VertexT>
-void SearchTreeNanoflann<VertexT>::radiusSearch( float              qp[3], float r, vector< size_t > &indices ) {};
+void SearchTreeNanoflann<VertexT>::radiusSearch( float              qp[3], float r, vector< size_t > &indices )
+{
+    // The distances of the adaptor are squared
+    indices.clear();
+    RadiusResultSet result(r * r, indices);
+    m_tree->findNeighbors(result, qp, nanoflann::SearchParams());
+}
 
 template<typename VertexT>
-void SearchTreeNanoflann<VertexT>::radiusSearch( VertexT&              qp, float r, vector< size_t > &indices ) {};
+void SearchTreeNanoflann<VertexT>::radiusSearch( VertexT&              qp, float r, vector< size_t > &indices )
+{
+    float query_point[3] = {qp[0], qp[1], qp[2]};
+    radiusSearch(query_point, r, indices);
+}
 
 template<typename VertexT>
-void SearchTreeNanoflann<VertexT>::radiusSearch( const VertexT&        qp, float r, vector< size_t > &indices ) {};
+void SearchTreeNanoflann<VertexT>::radiusSearch( const VertexT&        qp, float r, vector< size_t > &indices )
+{
+    float query_point[3] = {qp[0], qp[1], qp[2]};
+    radiusSearch(query_point, r, indices);
+}
 
 template<typename VertexT>
-void SearchTreeNanoflann<VertexT>::radiusSearch( coord< float >&       qp, float r, vector< size_t > &indices ) {};
+void SearchTreeNanoflann<VertexT>::radiusSearch( coord< float >&       qp, float r, vector< size_t > &indices )
+{
+    float query_point[3] = {qp.x, qp.y, qp.z};
+    radiusSearch(query_point, r, indices);
+}
 
 template<typename VertexT>
-void SearchTreeNanoflann<VertexT>::radiusSearch( const coord< float >& qp, float r, vector< size_t > &indices ) {};
+void SearchTreeNanoflann<VertexT>::radiusSearch( const coord< float >& qp, float r, vector< size_t > &indices )
+{
+    float query_point[3] = {qp.x, qp.y, qp.z};
+    radiusSearch(query_point, r, indices);
+}
 
 
 
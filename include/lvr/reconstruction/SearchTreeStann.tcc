@@ -78,10 +78,12 @@ template<typename VertexT>
 void SearchTreeStann< VertexT >::kSearch( coord< float > &qp, size_t neighbours, vector< size_t > &indices, vector< float > &distances )
 {
 	vector<double> dst;
+    indices.clear();
     m_pointTree.ksearch( qp, neighbours, indices, dst, 0);
+    distances.resize(dst.size());
     for(size_t i = 0; i < dst.size(); i++)
     {
-    	distances.push_back(static_cast<float>(dst[i]));
+    	distances[i] = static_cast<float>(dst[i]);
     }
 }
 
@@ -89,6 +91,7 @@ void SearchTreeStann< VertexT >::kSearch( coord< float > &qp, size_t neighbours,
 void SearchTreeStann< VertexT >::kSearch(VertexT qp, size_t k, vector< VertexT > &neighbors)
 {
     vector<size_t> indices;
+    neighbors.clear();
 	float f_qp[3] = {qp.x, qp.y, qp.z};
 	SearchTree<VertexT>::kSearch(f_qp, k, indices);
 	for(size_t i = 0; i < indices.size(); i++)
@@ -31,6 +31,8 @@
 #include "FastBox.hpp"
 #include <float.h>
 #include "ExtendedMCTable.hpp"
+#include <lvr/io/Progress.hpp>
+#include <lvr/io/Timestamp.hpp>
 
 namespace lvr
 {
@@ -81,6 +83,24 @@ public:
     // the point set surface
     static typename PointsetSurface<VertexT>::Ptr m_surface;
 
+    /**
+     * @brief Computes the interpolated surface normal of every valid query
+     *        point in one parallel pass. The normals of the edge
+     *        intersections are afterwards interpolated from these values
+     *        instead of searching the neighborhood of every intersection.
+     *
+     * @param query_points  The query points of the reconstruction grid
+     */
+    static void calcQueryPointNormals(vector<QueryPoint<VertexT> > &query_points);
+
+    /**
+     * @brief Frees the cached query point normals
+     */
+    static void clearQueryPointNormals();
+
+    // the cached normals of the query points
+    static vector<NormalT> m_queryPointNormals;
+
 private:
     /**
      * @brief gets the normals for the given vertices
@@ -91,7 +111,22 @@ private:
      */
     void getNormals(VertexT vertex_positions[], NormalT vertex_normals[]);
 
-    void detectSharpFeatures(VertexT vertex_positions[], NormalT vertex_normals[], uint index);
+    /**
+     * @brief interpolates the normals of the given vertices from the cached
+     *        normals of the query points of the corresponding edges
+     *
+     * @param corners			The corners of the box
+     * @param vertex_positions	The vertices on the edges of the box
+     * @param vertex_normals	This array holds the normals of the given vertices
+     * 							after calling the method.
+     */
+    void getNormals(VertexT corners[], VertexT vertex_positions[], NormalT vertex_normals[]);
+
+    /// Blends of the cached normals that are shorter are replaced by the
+    /// interpolated normal of the intersection
+    static const float MIN_BLENDED_NORMAL_LENGTH;
+
+    void detectSharpFeatures(VertexT corners[], VertexT vertex_positions[], NormalT vertex_normals[], uint index);
 
 
     typedef SharpBox<VertexT, NormalT> BoxType;
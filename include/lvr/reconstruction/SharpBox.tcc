@@ -40,6 +40,12 @@ float SharpBox<VertexT, NormalT>::m_phi_corner = 0.7f;
 template<typename VertexT, typename NormalT>
 typename PointsetSurface<VertexT>::Ptr SharpBox<VertexT, NormalT>::m_surface;
 
+template<typename VertexT, typename NormalT>
+vector<NormalT> SharpBox<VertexT, NormalT>::m_queryPointNormals;
+
+template<typename VertexT, typename NormalT>
+const float SharpBox<VertexT, NormalT>::MIN_BLENDED_NORMAL_LENGTH = 0.5f;
+
 template<typename VertexT, typename NormalT>
 SharpBox<VertexT, NormalT>::SharpBox(VertexT v) : FastBox<VertexT, NormalT>(v)
 {
@@ -63,7 +69,80 @@ void SharpBox<VertexT, NormalT>::getNormals(VertexT vertex_positions[], NormalT
 }
 
 template<typename VertexT, typename NormalT>
-void SharpBox<VertexT, NormalT>::detectSharpFeatures(VertexT vertex_positions[], NormalT vertex_normals[], uint index)
+void SharpBox<VertexT, NormalT>::getNormals(VertexT corners[], VertexT vertex_positions[], NormalT vertex_normals[])
+{
+	// Fall back to a neighborhood search if no normals were cached
+	if(m_queryPointNormals.empty())
+	{
+		getNormals(vertex_positions, vertex_normals);
+		return;
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		int c1 = vertex_edge_table[i][0];
+		int c2 = vertex_edge_table[i][1];
+
+		// Position of the intersection on the edge
+		float edgeLength = corners[c1].distance(corners[c2]);
+		float t = edgeLength > 0 ? corners[c1].distance(vertex_positions[i]) / edgeLength : 0.5f;
+
+		const NormalT& n1 = m_queryPointNormals[this->m_vertices[c1]];
+		const NormalT& n2 = m_queryPointNormals[this->m_vertices[c2]];
+		float blend[3];
+		for(int k = 0; k < 3; k++)
+		{
+			blend[k] = n1[k] * (1.0f - t) + n2[k] * t;
+		}
+
+		// Corner normals that point in very different directions, which
+		// is common at sharp features, blend to a short vector without a
+		// meaningful direction. Search the normal of the intersection in
+		// that case.
+		float length = sqrt(blend[0] * blend[0] + blend[1] * blend[1] + blend[2] * blend[2]);
+		if(length < MIN_BLENDED_NORMAL_LENGTH)
+		{
+			vertex_normals[i] = (NormalT) m_surface->getInterpolatedNormal(vertex_positions[i]);
+		}
+		else
+		{
+			vertex_normals[i] = NormalT(blend[0], blend[1], blend[2]);
+		}
+	}
+}
+
+template<typename VertexT, typename NormalT>
+void SharpBox<VertexT, NormalT>::calcQueryPointNormals(vector<QueryPoint<VertexT> > &query_points)
+{
+	string comment = timestamp.getElapsedTime() + "Calculating query point normals ";
+	ProgressBar progress(query_points.size(), comment);
+
+	m_queryPointNormals.clear();
+	m_queryPointNormals.resize(query_points.size());
+
+	// Every query point is shared by up to eight boxes and every edge by
+	// four, so one search per query point replaces up to twelve searches
+	// per box. Invalid query points are never used for normals.
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(int i = 0; i < (int)query_points.size(); i++)
+	{
+		if(!query_points[i].m_invalid)
+		{
+			m_queryPointNormals[i] = (NormalT) m_surface->getInterpolatedNormal(query_points[i].m_position);
+		}
+		++progress;
+	}
+	cout << endl;
+}
+
+template<typename VertexT, typename NormalT>
+void SharpBox<VertexT, NormalT>::clearQueryPointNormals()
+{
+	vector<NormalT>().swap(m_queryPointNormals);
+}
+
+template<typename VertexT, typename NormalT>
+void SharpBox<VertexT, NormalT>::detectSharpFeatures(VertexT corners[], VertexT vertex_positions[], NormalT vertex_normals[], uint index)
 {
 	//  skip unhandled configurations
 	if (ExtendedMCTable[index][0] == -1)
@@ -72,7 +151,7 @@ void SharpBox<VertexT, NormalT>::detectSharpFeatures(VertexT vertex_positions[],
 		return;
 	}
 
-	getNormals(vertex_positions, vertex_normals);
+	getNormals(corners, vertex_positions, vertex_normals);
 
 	NormalT n_asterisk;
 	float phi = FLT_MAX;
@@ -168,7 +247,7 @@ void SharpBox<VertexT, NormalT>::getSurface(
 	}
 
 	// Check for presence of sharp features in the box
-	this->detectSharpFeatures(vertex_positions, vertex_normals, index);
+	this->detectSharpFeatures(corners, vertex_positions, vertex_normals, index);
 
 	uint edge_index = 0;
 	int triangle_indices[3];
@@ -0,0 +1,90 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * SpatialSort.hpp
+ */
+
+#ifndef SPATIALSORT_HPP_
+#define SPATIALSORT_HPP_
+
+#include <lvr/io/PointBuffer.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/// Space filling curves for the spatial sorting of points
+enum SpatialCurve
+{
+    MORTON_CURVE,
+    HILBERT_CURVE
+};
+
+/**
+ * @brief   Parses a curve name ("morton" or "hilbert")
+ *
+ * @return  false if the name is unknown
+ */
+bool parseSpatialCurve(const string& name, SpatialCurve& curve);
+
+/**
+ * @brief   Computes the 63 bit Morton or Hilbert codes of points. The points
+ *          are quantized to 21 bits per axis within their bounding cube.
+ *
+ * @param points    Interleaved xyz coordinates
+ * @param n         Number of points
+ * @param curve     The space filling curve
+ * @param codes     The n codes
+ */
+void spatialCodes(const float* points, size_t n, SpatialCurve curve, vector<uint64_t>& codes);
+
+/**
+ * @brief   Sorts points along a space filling curve with a parallel radix
+ *          sort. The sort is stable, so the result is deterministic.
+ *
+ * @param points    Interleaved xyz coordinates
+ * @param n         Number of points
+ * @param curve     The space filling curve
+ * @param perm      The permutation: sorted position i holds point perm[i]
+ */
+void spatialOrder(const float* points, size_t n, SpatialCurve curve, vector<size_t>& perm);
+
+/**
+ * @brief   Creates a point buffer with all point channels (points, normals,
+ *          colors, intensities and confidences) permuted. Sub clouds are
+ *          not kept, because they refer to the original order.
+ *
+ * @param buffer    The input buffer. It is not changed.
+ * @param perm      A permutation created by spatialOrder
+ * @param inverse   If false, point i of the result is point perm[i] of the
+ *                  input. If true, the permutation is undone, i.e. point
+ *                  perm[i] of the result is point i of the input.
+ */
+PointBufferPtr permutePointBuffer(PointBufferPtr buffer, const vector<size_t>& perm, bool inverse = false);
+
+} // namespace lvr
+
+#endif /* SPATIALSORT_HPP_ */
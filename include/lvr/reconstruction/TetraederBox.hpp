@@ -59,6 +59,11 @@ public:
             vector<QueryPoint<VertexT> > &query_points,
             uint &globalIndex);
 
+    /**
+     * @brief Forgets the mesh vertices created by \ref getSurface
+     */
+    virtual void clearIntersections();
+
 
 private:
 
@@ -34,6 +34,13 @@ TetraederBox<VertexT, NormalT>::TetraederBox(VertexT v) : FastBox<VertexT, Norma
     for(int i = 0; i < 19; i++) this->m_intersections[i] = this->INVALID_INDEX;
 }
 
+template<typename VertexT, typename NormalT>
+void TetraederBox<VertexT, NormalT>::clearIntersections()
+{
+    FastBox<VertexT, NormalT>::clearIntersections();
+    for(int i = 0; i < 19; i++) this->m_intersections[i] = this->INVALID_INDEX;
+}
+
 template<typename VertexT, typename NormalT>
 void TetraederBox<VertexT, NormalT>::interpolateIntersections(
         int tetraNumber,
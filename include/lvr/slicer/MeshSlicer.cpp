@@ -116,6 +116,203 @@ vector<float> MeshSlicer::compute2dProjection()
 	return output;
 }
 
+vector<vector<MeshSlicer::Polyline> > MeshSlicer::compute2dSlices(const vector<double>& values)
+{
+	vector<vector<Polyline> > result(values.size());
+
+	int axis;
+	if(dimension.compare("x") == 0)
+	{
+		axis = 0;
+	}
+	else if(dimension.compare("y") == 0)
+	{
+		axis = 1;
+	}
+	else if(dimension.compare("z") == 0)
+	{
+		axis = 2;
+	}
+	else
+	{
+		cout << "ERROR: Could not set dimension." << endl;
+		return result;
+	}
+
+	// Sort the levels and remember their original position
+	vector<size_t> order(values.size());
+	for(size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&values](size_t a, size_t b) { return values[a] < values[b]; });
+
+	vector<double> sorted(values.size());
+	for(size_t i = 0; i < order.size(); i++)
+	{
+		sorted[i] = values[order[i]];
+	}
+
+	// Sweep: every triangle is added to all levels within its extent
+	vector<vector<size_t> > levelFaces(values.size());
+	size_t numFaces = faces.size() / 3;
+	for(size_t f = 0; f < numFaces; f++)
+	{
+		double lo = DBL_MAX;
+		double hi = -DBL_MAX;
+		for(int c = 0; c < 3; c++)
+		{
+			double v = vertices[3 * faces[3 * f + c] + axis];
+			lo = std::min(lo, v);
+			hi = std::max(hi, v);
+		}
+
+		vector<double>::iterator first = std::lower_bound(sorted.begin(), sorted.end(), lo);
+		vector<double>::iterator last = std::upper_bound(sorted.begin(), sorted.end(), hi);
+		for(vector<double>::iterator it = first; it != last; it++)
+		{
+			levelFaces[it - sorted.begin()].push_back(f);
+		}
+	}
+
+	if(verbose)
+	{
+		cout << timestamp << "Computing " << values.size() << " slices" << endl;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 1)
+	for(int l = 0; l < (int)sorted.size(); l++)
+	{
+		double level = sorted[l];
+
+		// Intersect the triangles. A vertex on the plane counts as above,
+		// so every triangle is cut at exactly zero or two of its edges and
+		// neighboring triangles agree on the edges they share.
+		vector<pair<uint64_t, uint64_t> > segmentEdges;
+		std::unordered_map<uint64_t, size_t> points;
+		vector<float> coordinates;
+
+		const vector<size_t>& levelF = levelFaces[l];
+		for(size_t i = 0; i < levelF.size(); i++)
+		{
+			size_t f = levelF[i];
+			uint64_t keys[2];
+			int numCuts = 0;
+
+			for(int e = 0; e < 3; e++)
+			{
+				unsigned int a = faces[3 * f + e];
+				unsigned int b = faces[3 * f + (e + 1) % 3];
+				if(a > b)
+				{
+					std::swap(a, b);
+				}
+
+				double da = vertices[3 * a + axis] - level;
+				double db = vertices[3 * b + axis] - level;
+				if((da < 0) == (db < 0))
+				{
+					continue;
+				}
+
+				uint64_t key = ((uint64_t)a << 32) | b;
+				if(points.find(key) == points.end())
+				{
+					double t = da / (da - db);
+					points[key] = coordinates.size() / 3;
+					for(int c = 0; c < 3; c++)
+					{
+						double va = vertices[3 * a + c];
+						double vb = vertices[3 * b + c];
+						coordinates.push_back((float)(va + t * (vb - va)));
+					}
+				}
+
+				if(numCuts < 2)
+				{
+					keys[numCuts] = key;
+				}
+				numCuts++;
+			}
+
+			if(numCuts == 2)
+			{
+				segmentEdges.push_back(std::make_pair(keys[0], keys[1]));
+			}
+		}
+
+		// Chain the segments via their shared edges
+		std::unordered_map<uint64_t, vector<size_t> > incident;
+		for(size_t s = 0; s < segmentEdges.size(); s++)
+		{
+			incident[segmentEdges[s].first].push_back(s);
+			incident[segmentEdges[s].second].push_back(s);
+		}
+
+		vector<bool> used(segmentEdges.size(), false);
+		vector<Polyline>& polylines = result[order[l]];
+
+		// Open chains start at edges with one segment, closed ones anywhere
+		for(int pass = 0; pass < 2; pass++)
+		{
+			for(size_t s = 0; s < segmentEdges.size(); s++)
+			{
+				if(used[s])
+				{
+					continue;
+				}
+
+				uint64_t start = segmentEdges[s].first;
+				if(pass == 0)
+				{
+					if(incident[start].size() != 1)
+					{
+						start = segmentEdges[s].second;
+						if(incident[start].size() != 1)
+						{
+							continue;
+						}
+					}
+				}
+
+				Polyline polyline;
+				uint64_t current = start;
+				size_t segment = s;
+				while(true)
+				{
+					size_t p = points[current];
+					polyline.push_back(coordinates[3 * p]);
+					polyline.push_back(coordinates[3 * p + 1]);
+					polyline.push_back(coordinates[3 * p + 2]);
+
+					if(segment == segmentEdges.size())
+					{
+						break;
+					}
+					used[segment] = true;
+					current = segmentEdges[segment].first == current ?
+							segmentEdges[segment].second : segmentEdges[segment].first;
+
+					// Continue with an unused segment at the new point
+					const vector<size_t>& next = incident[current];
+					segment = segmentEdges.size();
+					for(size_t n = 0; n < next.size(); n++)
+					{
+						if(!used[next[n]])
+						{
+							segment = next[n];
+							break;
+						}
+					}
+				}
+				polylines.push_back(polyline);
+			}
+		}
+	}
+
+	return result;
+}
+
 /// AABB Tree Operations
 
 void MeshSlicer::buildTree()
@@ -42,6 +42,7 @@
 #include <math.h>
 #include <algorithm>
 #include <queue>
+#include <stdint.h>
 
 //#if _MSC_VER
 //#include <GL/GLU.h>
@@ -96,6 +97,9 @@ public:
 	typedef CGAL::AABB_traits<K, Primitive> AABB_triangle_traits;
 	typedef CGAL::AABB_tree<AABB_triangle_traits> Tree;
 
+	/// A chain of slice segments as interleaved x, y, z coordinates
+	typedef vector<float> Polyline;
+
 	/**
 	 * @brief   Creates an empty FusionMesh 
 	 */
@@ -156,6 +160,20 @@ public:
 	*/
 	virtual vector<float> compute2dProjection();
 
+	/**
+	 * @brief   Computes the slices of the mesh at all given positions along
+	 *          the current dimension. The triangles are sorted into the
+	 *          levels they span once and all levels are cut in parallel.
+	 *          The segments of each level are chained into polylines via
+	 *          the mesh edges they intersect. Closed contours repeat their
+	 *          first point at the end.
+	 *
+	 * @param   values      The positions of the cutting planes
+	 *
+	 * @return  The polylines of every level in the order of values
+	 */
+	virtual vector<vector<Polyline> > compute2dSlices(const vector<double>& values);
+
 	/// Convenience Function
 	
 	/**
@@ -187,6 +187,22 @@ public:
 	 */
 	float calcMaxCorrelationCoefficient();
 
+	/**
+	 * \brief	Calculates all 14 texture features at once. The marginal
+	 *		distributions of each cooccurrence matrix are computed
+	 *		only once and the features that iterate over the whole
+	 *		matrix are evaluated in one fused pass. The results are
+	 *		the same as the ones of the single calc* methods.
+	 *
+	 * \param	features	An array of 14 floats in the order ASM,
+	 *				contrast, correlation, sum of squares, inverse
+	 *				difference, sum average, sum entropy, sum variance,
+	 *				entropy, difference variance, difference entropy,
+	 *				information measures 1 and 2 and maximal
+	 *				correlation coefficient
+	 */
+	void calcFeatures(float* features);
+
 	///The 14 coefficients for texture comparison
 	static float m_coeffs[14];
 
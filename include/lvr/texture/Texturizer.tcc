@@ -310,27 +310,54 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::createInitialTextu
 
     //cout << "PIXELS IN TEXTURE: " << sizeX * sizeY << endl;
     string msg = timestamp.getElapsedTime() + "Calculating Texture Pixels... ";
-    ProgressBar progress(sizeX * sizeY, msg);
+    ProgressBar progress(sizeY, msg);
+
+    //generate the positions of all texels row by row
+    size_t numTexels = (size_t)sizeX * sizeY;
+    vector<float> positions(3 * numTexels);
 
     #pragma omp parallel for
 	for(int y = 0; y < sizeY; y++)
 	{
 		for(int x = 0; x < sizeX; x++)
 		{
-			vector<VertexT> cv;
-
 			VertexT current_position = p + best_v1
 				* (x * Texture::m_texelSize + best_a_min - Texture::m_texelSize / 2.0)
 				+ best_v2
 				* (y * Texture::m_texelSize + best_b_min - Texture::m_texelSize / 2.0);
 
-			int one = 1;
-			m_pm->searchTree()->kSearch(current_position, one, cv);
+			float* pos = &positions[3 * ((size_t)y * sizeX + x)];
+			pos[0] = current_position[0];
+			pos[1] = current_position[1];
+			pos[2] = current_position[2];
+		}
+	}
 
-			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 0] = cv[0].r;
-			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 1] = cv[0].g;
-			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 2] = cv[0].b;
+	//find the nearest point of all texels at once
+	vector<size_t> nearest;
+	m_pm->searchTree()->kSearchBatch(positions.empty() ? 0 : &positions[0], numTexels, 1, nearest);
 
+	//copy the colors of the nearest points into the texture
+	PointBufferPtr points = m_pm->pointBuffer();
+	ucharView colors = points->getPointColorView();
+
+    #pragma omp parallel for
+	for(int y = 0; y < sizeY; y++)
+	{
+		for(int x = 0; x < sizeX; x++)
+		{
+			size_t index = nearest[(size_t)y * sizeX + x];
+			unsigned char* texel = &texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x];
+			if(index < colors.size())
+			{
+				texel[0] = colors[index][0];
+				texel[1] = colors[index][1];
+				texel[2] = colors[index][2];
+			}
+			else
+			{
+				texel[0] = texel[1] = texel[2] = 0;
+			}
 		}
         ++progress;
 	}
@@ -68,6 +68,15 @@ int OpenMPConfig::getNumThreads()
 #endif
 }
 
+int OpenMPConfig::getThreadNum()
+{
+#ifdef LVR_USE_OPEN_MP
+	return omp_get_thread_num();
+#else
+	return 0;
+#endif
+}
+
 } // namespace lvr
 
 
@@ -0,0 +1,542 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+ /*
+ * PointOctreeLOD.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include <lvr/display/PointOctreeLOD.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace lvr
+{
+
+namespace
+{
+
+/// Identifies hierarchy files written by PointOctreeLOD::save()
+const char      LOD_MAGIC[8] = {'L', 'V', 'R', 'L', 'O', 'D', '0', '2'};
+
+/// Nodes on this level are never split to avoid endless recursion on
+/// duplicate points
+const int32_t   LOD_MAX_DEPTH = 24;
+
+/// A node that still has to be processed and the indices of its points
+struct LODBuildItem
+{
+    int32_t                 node;
+    std::vector<size_t>     indices;
+};
+
+/// Writes the fields of a node without the padding of the struct
+void writeNode(std::ofstream& out, const LODNode& node)
+{
+    out.write((char*)node.min, sizeof(node.min));
+    out.write((char*)&node.size, sizeof(node.size));
+    out.write((char*)&node.spacing, sizeof(node.spacing));
+    out.write((char*)&node.level, sizeof(node.level));
+    out.write((char*)&node.parent, sizeof(node.parent));
+    out.write((char*)node.children, sizeof(node.children));
+    out.write((char*)&node.offset, sizeof(node.offset));
+    out.write((char*)&node.numPoints, sizeof(node.numPoints));
+}
+
+/// Reads a node written by writeNode()
+void readNode(std::ifstream& in, LODNode& node)
+{
+    in.read((char*)node.min, sizeof(node.min));
+    in.read((char*)&node.size, sizeof(node.size));
+    in.read((char*)&node.spacing, sizeof(node.spacing));
+    in.read((char*)&node.level, sizeof(node.level));
+    in.read((char*)&node.parent, sizeof(node.parent));
+    in.read((char*)node.children, sizeof(node.children));
+    in.read((char*)&node.offset, sizeof(node.offset));
+    in.read((char*)&node.numPoints, sizeof(node.numPoints));
+}
+
+/**
+ * Keeps one point per cell of a regular grid over the node and sorts the
+ * remaining points into the octants of the node.
+ */
+void splitNode(
+        const LODNode& node,
+        const float* points,
+        std::vector<size_t>& indices,
+        size_t maxLeafPoints,
+        int res,
+        std::vector<size_t>& kept,
+        std::vector<std::vector<size_t> >& children)
+{
+    if(indices.size() <= maxLeafPoints || node.level >= LOD_MAX_DEPTH)
+    {
+        kept.swap(indices);
+        return;
+    }
+
+    std::vector<bool> occupied((size_t)res * res * res, false);
+    float cell = node.size / res;
+    float half = node.size / 2;
+
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        const float* p = points + 3 * indices[i];
+        float rx = p[0] - node.min[0];
+        float ry = p[1] - node.min[1];
+        float rz = p[2] - node.min[2];
+
+        int ix = std::min(std::max((int)(rx / cell), 0), res - 1);
+        int iy = std::min(std::max((int)(ry / cell), 0), res - 1);
+        int iz = std::min(std::max((int)(rz / cell), 0), res - 1);
+        size_t key = ((size_t)ix * res + iy) * res + iz;
+
+        if(!occupied[key])
+        {
+            occupied[key] = true;
+            kept.push_back(indices[i]);
+        }
+        else
+        {
+            int octant = (rx >= half ? 1 : 0) | (ry >= half ? 2 : 0) | (rz >= half ? 4 : 0);
+            children[octant].push_back(indices[i]);
+        }
+    }
+
+    // Free the memory of the processed index list early
+    std::vector<size_t>().swap(indices);
+}
+
+} // anonymous namespace
+
+LODView::LODView()
+    : numPlanes(0), fov(0.785398f), screenHeight(1000.0f), minPixelSize(1.0f)
+{
+    position[0] = position[1] = position[2] = 0.0f;
+    memset(planes, 0, sizeof(planes));
+}
+
+PointOctreeLOD::PointOctreeLOD()
+    : m_numPoints(0), m_hasColors(false)
+{
+
+}
+
+PointOctreeLOD::PointOctreeLOD(PointBufferPtr buffer, size_t maxLeafPoints, int gridResolution)
+    : m_numPoints(0), m_hasColors(false)
+{
+    size_t n(0), n_c(0);
+    floatArr points;
+    ucharArr colors;
+
+    if(buffer)
+    {
+        points = buffer->getPointArray(n);
+        colors = buffer->getPointColorArray(n_c);
+    }
+
+    if(n == 0)
+    {
+        return;
+    }
+
+    m_hasColors = (n_c == n);
+    gridResolution = std::max(gridResolution, 1);
+
+    // Compute a bounding cube for the root node
+    float bmin[3] = {points[0], points[1], points[2]};
+    float bmax[3] = {points[0], points[1], points[2]};
+    for(size_t i = 1; i < n; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            bmin[j] = std::min(bmin[j], points[3 * i + j]);
+            bmax[j] = std::max(bmax[j], points[3 * i + j]);
+        }
+    }
+
+    float size = std::max(bmax[0] - bmin[0], std::max(bmax[1] - bmin[1], bmax[2] - bmin[2]));
+    size = std::max(size * 1.0001f, std::numeric_limits<float>::epsilon());
+
+    LODNode root;
+    memcpy(root.min, bmin, sizeof(bmin));
+    root.size       = size;
+    root.spacing    = size / gridResolution;
+    root.level      = 0;
+    root.parent     = -1;
+    root.offset     = 0;
+    root.numPoints  = 0;
+    std::fill(root.children, root.children + 8, -1);
+    m_nodes.push_back(root);
+
+    std::vector<LODBuildItem> current(1);
+    current[0].node = 0;
+    current[0].indices.resize(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        current[0].indices[i] = i;
+    }
+
+    // Point indices in final storage order
+    std::vector<size_t> order;
+    order.reserve(n);
+
+    // Build the tree level by level. All nodes of a level are independent
+    // and split in parallel. Node creation is done serially afterwards to
+    // get a deterministic breadth first layout.
+    while(!current.empty())
+    {
+        long numItems = (long)current.size();
+        std::vector<std::vector<size_t> > kept(numItems);
+        std::vector<std::vector<std::vector<size_t> > > children(
+                numItems, std::vector<std::vector<size_t> >(8));
+
+        #pragma omp parallel for schedule(dynamic)
+        for(long i = 0; i < numItems; i++)
+        {
+            splitNode(m_nodes[current[i].node], points.get(), current[i].indices,
+                      maxLeafPoints, gridResolution, kept[i], children[i]);
+        }
+
+        std::vector<LODBuildItem> next;
+        for(long i = 0; i < numItems; i++)
+        {
+            int32_t id = current[i].node;
+            m_nodes[id].offset = order.size();
+            m_nodes[id].numPoints = kept[i].size();
+            order.insert(order.end(), kept[i].begin(), kept[i].end());
+            std::vector<size_t>().swap(kept[i]);
+
+            for(int c = 0; c < 8; c++)
+            {
+                if(children[i][c].empty())
+                {
+                    continue;
+                }
+
+                LODNode child;
+                const LODNode& parent = m_nodes[id];
+                child.size      = parent.size / 2;
+                child.min[0]    = parent.min[0] + ((c & 1) ? child.size : 0.0f);
+                child.min[1]    = parent.min[1] + ((c & 2) ? child.size : 0.0f);
+                child.min[2]    = parent.min[2] + ((c & 4) ? child.size : 0.0f);
+                child.spacing   = child.size / gridResolution;
+                child.level     = parent.level + 1;
+                child.parent    = id;
+                child.offset    = 0;
+                child.numPoints = 0;
+                std::fill(child.children, child.children + 8, -1);
+
+                m_nodes[id].children[c] = (int32_t)m_nodes.size();
+                m_nodes.push_back(child);
+
+                next.push_back(LODBuildItem());
+                next.back().node = m_nodes[id].children[c];
+                next.back().indices.swap(children[i][c]);
+            }
+        }
+        current.swap(next);
+    }
+
+    // Copy the points into node order
+    m_numPoints = order.size();
+    m_points = floatArr(new float[3 * m_numPoints]);
+    if(m_hasColors)
+    {
+        m_colors = ucharArr(new unsigned char[3 * m_numPoints]);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for(long i = 0; i < (long)m_numPoints; i++)
+    {
+        size_t src = 3 * order[i];
+        m_points[3 * i    ] = points[src    ];
+        m_points[3 * i + 1] = points[src + 1];
+        m_points[3 * i + 2] = points[src + 2];
+        if(m_hasColors)
+        {
+            m_colors[3 * i    ] = colors[src    ];
+            m_colors[3 * i + 1] = colors[src + 1];
+            m_colors[3 * i + 2] = colors[src + 2];
+        }
+    }
+
+    std::cout << timestamp << "Created LOD hierarchy with " << m_nodes.size()
+         << " nodes and " << m_numPoints << " points." << std::endl;
+}
+
+void PointOctreeLOD::save(std::string directory)
+{
+    boost::filesystem::path dir(directory);
+    boost::filesystem::create_directories(dir);
+
+    // The files are written under temporary names first. An opened
+    // hierarchy may be saved into its own directory, and its points are
+    // read from the old files while the new ones are written.
+    boost::filesystem::path hierarchyPath = dir / "hierarchy.lod";
+    boost::filesystem::path pointPath = dir / "points.bin";
+    boost::filesystem::path colorPath = dir / "colors.bin";
+
+    std::ofstream hierarchy((hierarchyPath.string() + ".tmp").c_str(), std::ios::binary);
+    std::ofstream pointFile((pointPath.string() + ".tmp").c_str(), std::ios::binary);
+    std::ofstream colorFile;
+    if(m_hasColors)
+    {
+        colorFile.open((colorPath.string() + ".tmp").c_str(), std::ios::binary);
+    }
+
+    if(!hierarchy.good() || !pointFile.good() || (m_hasColors && !colorFile.good()))
+    {
+        std::cout << timestamp << "PointOctreeLOD: Unable to write to " << directory << std::endl;
+        return;
+    }
+
+    uint64_t numNodes = m_nodes.size();
+    uint64_t numPoints = m_numPoints;
+    uint8_t  colors = m_hasColors ? 1 : 0;
+    hierarchy.write(LOD_MAGIC, sizeof(LOD_MAGIC));
+    hierarchy.write((char*)&numNodes, sizeof(numNodes));
+    hierarchy.write((char*)&numPoints, sizeof(numPoints));
+    hierarchy.write((char*)&colors, sizeof(colors));
+    for(size_t i = 0; i < m_nodes.size(); i++)
+    {
+        writeNode(hierarchy, m_nodes[i]);
+    }
+
+    // Opened hierarchies only hold the node table. Stream the node
+    // data through memory in that case.
+    if(m_points)
+    {
+        pointFile.write((char*)m_points.get(), 3 * m_numPoints * sizeof(float));
+        if(m_hasColors)
+        {
+            colorFile.write((char*)m_colors.get(), 3 * m_numPoints);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < m_nodes.size(); i++)
+        {
+            PointBufferPtr node = getNodePoints(i);
+            size_t np, nc;
+            floatArr p = node->getPointArray(np);
+            ucharArr c = node->getPointColorArray(nc);
+            pointFile.write((char*)p.get(), 3 * np * sizeof(float));
+            if(m_hasColors)
+            {
+                colorFile.write((char*)c.get(), 3 * nc);
+            }
+        }
+    }
+
+    hierarchy.close();
+    pointFile.close();
+    colorFile.close();
+    if(hierarchy.fail() || pointFile.fail() || (m_hasColors && colorFile.fail()))
+    {
+        std::cout << timestamp << "PointOctreeLOD: Unable to write to " << directory << std::endl;
+        return;
+    }
+
+    boost::filesystem::rename(pointPath.string() + ".tmp", pointPath);
+    if(m_hasColors)
+    {
+        boost::filesystem::rename(colorPath.string() + ".tmp", colorPath);
+    }
+    boost::filesystem::rename(hierarchyPath.string() + ".tmp", hierarchyPath);
+}
+
+PointOctreeLODPtr PointOctreeLOD::open(std::string directory)
+{
+    boost::filesystem::path dir(directory);
+    std::ifstream hierarchy((dir / "hierarchy.lod").string().c_str(), std::ios::binary);
+
+    char magic[8];
+    if(!hierarchy.good() || !hierarchy.read(magic, sizeof(magic))
+            || memcmp(magic, LOD_MAGIC, sizeof(magic)) != 0)
+    {
+        std::cout << timestamp << "PointOctreeLOD: " << directory
+             << " does not contain a valid hierarchy." << std::endl;
+        return PointOctreeLODPtr();
+    }
+
+    uint64_t numNodes, numPoints;
+    uint8_t colors;
+    hierarchy.read((char*)&numNodes, sizeof(numNodes));
+    hierarchy.read((char*)&numPoints, sizeof(numPoints));
+    hierarchy.read((char*)&colors, sizeof(colors));
+
+    PointOctreeLODPtr lod(new PointOctreeLOD);
+    lod->m_directory = directory;
+    lod->m_numPoints = numPoints;
+    lod->m_hasColors = (colors != 0);
+    lod->m_nodes.resize(numNodes);
+    for(size_t i = 0; i < numNodes && hierarchy.good(); i++)
+    {
+        readNode(hierarchy, lod->m_nodes[i]);
+    }
+
+    if(!hierarchy.good())
+    {
+        std::cout << timestamp << "PointOctreeLOD: Hierarchy in " << directory
+             << " is truncated." << std::endl;
+        return PointOctreeLODPtr();
+    }
+
+    return lod;
+}
+
+PointBufferPtr PointOctreeLOD::getNodePoints(size_t id) const
+{
+    PointBufferPtr buffer(new PointBuffer);
+    const LODNode& node = m_nodes[id];
+    size_t n = node.numPoints;
+
+    if(n == 0)
+    {
+        return buffer;
+    }
+
+    floatArr points(new float[3 * n]);
+    ucharArr colors;
+    if(m_hasColors)
+    {
+        colors = ucharArr(new unsigned char[3 * n]);
+    }
+
+    if(m_points)
+    {
+        memcpy(points.get(), m_points.get() + 3 * node.offset, 3 * n * sizeof(float));
+        if(m_hasColors)
+        {
+            memcpy(colors.get(), m_colors.get() + 3 * node.offset, 3 * n);
+        }
+    }
+    else
+    {
+        boost::filesystem::path dir(m_directory);
+        std::ifstream pointFile((dir / "points.bin").string().c_str(), std::ios::binary);
+        pointFile.seekg(3 * node.offset * sizeof(float));
+        pointFile.read((char*)points.get(), 3 * n * sizeof(float));
+
+        if(m_hasColors)
+        {
+            std::ifstream colorFile((dir / "colors.bin").string().c_str(), std::ios::binary);
+            colorFile.seekg(3 * node.offset);
+            colorFile.read((char*)colors.get(), 3 * n);
+        }
+    }
+
+    buffer->setPointArray(points, n);
+    if(m_hasColors)
+    {
+        buffer->setPointColorArray(colors, n);
+    }
+    return buffer;
+}
+
+size_t PointOctreeLOD::selectNodes(const LODView& view, size_t pointBudget, std::vector<size_t>& nodes) const
+{
+    nodes.clear();
+    if(m_nodes.empty())
+    {
+        return 0;
+    }
+
+    // Pixels per unit length at distance 1
+    float projection = view.screenHeight / (2.0f * tanf(view.fov / 2.0f));
+
+    // Nodes are visited by their projected size, largest first
+    std::priority_queue<std::pair<float, size_t> > queue;
+    queue.push(std::make_pair(std::numeric_limits<float>::max(), 0));
+
+    size_t numPoints = 0;
+    while(!queue.empty())
+    {
+        size_t id = queue.top().second;
+        queue.pop();
+
+        const LODNode& node = m_nodes[id];
+        float half = node.size / 2;
+        float center[3] = {node.min[0] + half, node.min[1] + half, node.min[2] + half};
+        float radius = half * sqrtf(3.0f);
+
+        // Frustum culling of the bounding sphere
+        bool visible = true;
+        for(int i = 0; i < view.numPlanes && visible; i++)
+        {
+            const float* pl = view.planes[i];
+            visible = (pl[0] * center[0] + pl[1] * center[1] + pl[2] * center[2] + pl[3] >= -radius);
+        }
+
+        if(!visible)
+        {
+            continue;
+        }
+
+        float dx = center[0] - view.position[0];
+        float dy = center[1] - view.position[1];
+        float dz = center[2] - view.position[2];
+        float distance = std::max(sqrtf(dx * dx + dy * dy + dz * dz) - radius, 1e-6f);
+
+        // Skip nodes that would not add visible detail
+        if(node.level > 0 && node.spacing * projection / distance < view.minPixelSize)
+        {
+            continue;
+        }
+
+        if(numPoints + node.numPoints > pointBudget)
+        {
+            break;
+        }
+
+        numPoints += node.numPoints;
+        nodes.push_back(id);
+
+        for(int c = 0; c < 8; c++)
+        {
+            if(node.children[c] != -1)
+            {
+                const LODNode& child = m_nodes[node.children[c]];
+                float ch = child.size / 2;
+                float cx = child.min[0] + ch - view.position[0];
+                float cy = child.min[1] + ch - view.position[1];
+                float cz = child.min[2] + ch - view.position[2];
+                float cr = ch * sqrtf(3.0f);
+                float cd = std::max(sqrtf(cx * cx + cy * cy + cz * cz) - cr, 1e-6f);
+                queue.push(std::make_pair(cr * projection / cd, (size_t)node.children[c]));
+            }
+        }
+    }
+
+    return numPoints;
+}
+
+} // namespace lvr
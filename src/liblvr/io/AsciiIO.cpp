@@ -311,12 +311,14 @@ int AsciiIO::getEntriesInLine(string filename)
 
     in.close();
 
-    // Get number of blanks
+    // Count the entries. strtok() is not used, since scans are read
+    // concurrently by several threads.
     int c = 0;
-    char* pch = strtok(line, " ");
+    char* save = 0;
+    char* pch = strtok_r(line, " ", &save);
     while(pch){
         c++;
-        pch = strtok(NULL, " ");
+        pch = strtok_r(NULL, " ", &save);
     }
 
     return c;
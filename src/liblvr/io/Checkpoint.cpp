@@ -0,0 +1,253 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * Checkpoint.cpp
+ */
+
+#include <lvr/io/Checkpoint.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <stdint.h>
+
+#include <boost/filesystem.hpp>
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::ofstream;
+
+namespace lvr
+{
+
+namespace
+{
+
+/// File identification, the last character is the format version
+const char MAGIC[8] = {'L', 'V', 'R', 'C', 'K', 'P', 'T', '1'};
+
+/// 64 bit FNV-1a hash
+uint64_t hash(const unsigned char* data, size_t size, uint64_t h = 14695981039346656037ULL)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/// Appends raw bytes to a buffer
+void append(vector<unsigned char>& buffer, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void appendValue(vector<unsigned char>& buffer, uint64_t value)
+{
+    append(buffer, &value, sizeof(value));
+}
+
+/// Reads raw bytes from a buffer and advances the position
+bool extract(const vector<unsigned char>& buffer, size_t& pos, void* data, size_t size)
+{
+    if(size > buffer.size() - pos)
+    {
+        return false;
+    }
+    memcpy(data, &buffer[pos], size);
+    pos += size;
+    return true;
+}
+
+bool extractValue(const vector<unsigned char>& buffer, size_t& pos, uint64_t& value)
+{
+    return extract(buffer, pos, &value, sizeof(value));
+}
+
+} // namespace
+
+Checkpoint::Checkpoint(string directory, string stage, string key)
+    : m_directory(directory), m_stage(stage), m_key(key)
+{
+
+}
+
+void Checkpoint::addBlock(const void* data, size_t elementSize, size_t count)
+{
+    ucharArr block(new unsigned char[elementSize * count]);
+    if(count)
+    {
+        memcpy(block.get(), data, elementSize * count);
+    }
+    m_blocks.push_back(block);
+    m_elementSizes.push_back(elementSize);
+    m_counts.push_back(count);
+}
+
+string Checkpoint::filename() const
+{
+    std::stringstream name;
+    name << m_stage << "-" << std::hex << std::setw(16) << std::setfill('0')
+         << hash(reinterpret_cast<const unsigned char*>(m_key.c_str()), m_key.size()) << ".ckpt";
+    return (boost::filesystem::path(m_directory) / name.str()).string();
+}
+
+bool Checkpoint::write() const
+{
+    // Header, key and arrays are hashed together
+    vector<unsigned char> buffer;
+    appendValue(buffer, m_key.size());
+    append(buffer, m_key.c_str(), m_key.size());
+    appendValue(buffer, m_blocks.size());
+    for(size_t i = 0; i < m_blocks.size(); i++)
+    {
+        appendValue(buffer, m_elementSizes[i]);
+        appendValue(buffer, m_counts[i]);
+        append(buffer, m_blocks[i].get(), m_elementSizes[i] * m_counts[i]);
+    }
+    uint64_t checksum = hash(&buffer[0], buffer.size());
+
+    string file = filename();
+    string tmp = file + ".tmp";
+    try
+    {
+        boost::filesystem::create_directories(m_directory);
+
+        ofstream out(tmp.c_str(), std::ios::binary);
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+        out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        out.close();
+        if(!out.good())
+        {
+            cout << timestamp << "Checkpoint: Unable to write " << tmp << "." << endl;
+            boost::filesystem::remove(tmp);
+            return false;
+        }
+
+        // Replace an older checkpoint only by a complete file
+        boost::filesystem::rename(tmp, file);
+    }
+    catch(boost::filesystem::filesystem_error& e)
+    {
+        cout << timestamp << "Checkpoint: " << e.what() << endl;
+        return false;
+    }
+
+    cout << timestamp << "Wrote " << m_stage << " checkpoint " << file << endl;
+    return true;
+}
+
+bool Checkpoint::read()
+{
+    m_blocks.clear();
+    m_elementSizes.clear();
+    m_counts.clear();
+
+    string file = filename();
+    ifstream in(file.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        return false;
+    }
+
+    vector<unsigned char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if(buffer.size() < sizeof(MAGIC) + sizeof(uint64_t)
+       || memcmp(&buffer[0], MAGIC, sizeof(MAGIC)) != 0)
+    {
+        cout << timestamp << "Checkpoint: " << file << " is not a checkpoint file." << endl;
+        return false;
+    }
+
+    size_t end = buffer.size() - sizeof(uint64_t);
+    uint64_t checksum;
+    memcpy(&checksum, &buffer[end], sizeof(checksum));
+    if(checksum != hash(&buffer[sizeof(MAGIC)], end - sizeof(MAGIC)))
+    {
+        cout << timestamp << "Checkpoint: " << file << " is damaged." << endl;
+        return false;
+    }
+    buffer.resize(end);
+
+    // Compare the full key to exclude hash collisions
+    size_t pos = sizeof(MAGIC);
+    uint64_t keySize, numBlocks;
+    if(!extractValue(buffer, pos, keySize) || keySize > buffer.size() - pos)
+    {
+        return false;
+    }
+    string key(buffer.begin() + pos, buffer.begin() + pos + keySize);
+    pos += keySize;
+    if(key != m_key)
+    {
+        cout << timestamp << "Checkpoint: " << file << " belongs to different parameters." << endl;
+        return false;
+    }
+
+    if(!extractValue(buffer, pos, numBlocks))
+    {
+        return false;
+    }
+    for(uint64_t i = 0; i < numBlocks; i++)
+    {
+        uint64_t elementSize, count;
+        if(!extractValue(buffer, pos, elementSize) || !extractValue(buffer, pos, count)
+           || elementSize == 0 || count > (buffer.size() - pos) / elementSize)
+        {
+            m_blocks.clear();
+            m_elementSizes.clear();
+            m_counts.clear();
+            return false;
+        }
+
+        ucharArr block(new unsigned char[elementSize * count]);
+        extract(buffer, pos, block.get(), elementSize * count);
+        m_blocks.push_back(block);
+        m_elementSizes.push_back(elementSize);
+        m_counts.push_back(count);
+    }
+
+    cout << timestamp << "Read " << m_stage << " checkpoint " << file << endl;
+    return true;
+}
+
+string Checkpoint::fileSignature(string filename)
+{
+    std::stringstream signature;
+    try
+    {
+        boost::filesystem::path path = boost::filesystem::absolute(filename);
+        signature << path.string() << " " << boost::filesystem::file_size(path)
+                  << " " << boost::filesystem::last_write_time(path);
+    }
+    catch(boost::filesystem::filesystem_error& e)
+    {
+        signature.str("");
+        signature << filename;
+    }
+    return signature.str();
+}
+
+} // namespace lvr
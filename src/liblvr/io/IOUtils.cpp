@@ -1,8 +1,115 @@
 #include <lvr/io/IOUtils.hpp>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 namespace lvr
 {
 
+namespace
+{
+
+/// Number of points that are transformed by one SIMD iteration
+const size_t c_transformBlock = 4;
+
+/**
+ * @brief   Transforms the points [first, last) one by one
+ */
+inline void transformScalar(float* data, size_t first, size_t last, const float* m, bool translate)
+{
+    float tx = translate ? m[12] : 0.0f;
+    float ty = translate ? m[13] : 0.0f;
+    float tz = translate ? m[14] : 0.0f;
+
+    for(size_t i = first; i < last; i++)
+    {
+        float* p = data + 3 * i;
+        float x = p[0];
+        float y = p[1];
+        float z = p[2];
+        p[0] = m[0] * x + m[4] * y + m[ 8] * z + tx;
+        p[1] = m[1] * x + m[5] * y + m[ 9] * z + ty;
+        p[2] = m[2] * x + m[6] * y + m[10] * z + tz;
+    }
+}
+
+/**
+ * @brief   Transforms all points of an interleaved xyz array. Blocks of
+ *          four points (three SSE registers) are deinterleaved into x, y
+ *          and z registers, transformed and interleaved again.
+ */
+void transformInterleaved(float* data, size_t n, const float* m, bool translate)
+{
+    size_t numBlocks = n / c_transformBlock;
+
+#if defined(__SSE__)
+    #pragma omp parallel for schedule(static)
+    for(long b = 0; b < (long)numBlocks; b++)
+    {
+        float* p = data + 3 * c_transformBlock * b;
+
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        __m128 r0 = _mm_loadu_ps(p);
+        __m128 r1 = _mm_loadu_ps(p + 4);
+        __m128 r2 = _mm_loadu_ps(p + 8);
+
+        __m128 t0 = _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 1, 2, 2));
+        __m128 x  = _mm_shuffle_ps(r0, t0, _MM_SHUFFLE(2, 0, 3, 0));
+
+        __m128 t1 = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 1, 1));
+        __m128 t2 = _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(2, 2, 3, 3));
+        __m128 y  = _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+
+        __m128 t3 = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 1, 2, 2));
+        __m128 t4 = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 3, 0, 0));
+        __m128 z  = _mm_shuffle_ps(t3, t4, _MM_SHUFFLE(2, 0, 2, 0));
+
+        __m128 tx = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(m[0]), x),
+                _mm_mul_ps(_mm_set1_ps(m[4]), y)),
+                _mm_mul_ps(_mm_set1_ps(m[8]), z));
+        __m128 ty = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(m[1]), x),
+                _mm_mul_ps(_mm_set1_ps(m[5]), y)),
+                _mm_mul_ps(_mm_set1_ps(m[9]), z));
+        __m128 tz = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(m[2]), x),
+                _mm_mul_ps(_mm_set1_ps(m[6]), y)),
+                _mm_mul_ps(_mm_set1_ps(m[10]), z));
+
+        if(translate)
+        {
+            tx = _mm_add_ps(tx, _mm_set1_ps(m[12]));
+            ty = _mm_add_ps(ty, _mm_set1_ps(m[13]));
+            tz = _mm_add_ps(tz, _mm_set1_ps(m[14]));
+        }
+
+        __m128 u0 = _mm_shuffle_ps(tx, ty, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 u1 = _mm_shuffle_ps(tz, tx, _MM_SHUFFLE(1, 1, 0, 0));
+        __m128 u2 = _mm_shuffle_ps(ty, tz, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 u3 = _mm_shuffle_ps(tx, ty, _MM_SHUFFLE(2, 2, 2, 2));
+        __m128 u4 = _mm_shuffle_ps(tz, tx, _MM_SHUFFLE(3, 3, 2, 2));
+        __m128 u5 = _mm_shuffle_ps(ty, tz, _MM_SHUFFLE(3, 3, 3, 3));
+
+        _mm_storeu_ps(p,     _mm_shuffle_ps(u0, u1, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(u2, u3, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(u4, u5, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#else
+    #pragma omp parallel for schedule(static)
+    for(long b = 0; b < (long)numBlocks; b++)
+    {
+        transformScalar(data, b * c_transformBlock, (b + 1) * c_transformBlock, m, translate);
+    }
+#endif
+
+    // Remaining points
+    transformScalar(data, numBlocks * c_transformBlock, n, m, translate);
+}
+
+} // namespace
+
 Eigen::Matrix4d buildTransformation(double* alignxf)
 {
     Eigen::Matrix3d rotation;
@@ -295,26 +402,56 @@ void transformAndReducePointCloud(ModelPtr model, int modulo, int sx, int sy, in
 }
 
 
-void transformPointCloud(ModelPtr model, Eigen::Matrix4d transformation)
+void transformationToFloat(const Eigen::Matrix4d& transformation, float* matrix)
 {
-    std::cout << timestamp << "Transforming model." << std::endl;
-    size_t numPoints;
+    for(int c = 0; c < 4; c++)
+    {
+        for(int r = 0; r < 4; r++)
+        {
+            matrix[4 * c + r] = transformation(r, c);
+        }
+    }
+}
+
+void transformPoints(float* points, size_t n, const float* matrix)
+{
+    transformInterleaved(points, n, matrix, true);
+}
 
-    floatArr arr = model->m_pointCloud->getPointArray(numPoints);
+void transformNormals(float* normals, size_t n, const float* matrix)
+{
+    transformInterleaved(normals, n, matrix, false);
+}
 
-    for(int i = 0; i < numPoints; i++)
+void transformPointBuffer(PointBufferPtr buffer, const Eigen::Matrix4d& transformation)
+{
+    if(!buffer)
     {
-        float x = arr[3 * i];
-        float y = arr[3 * i + 1];
-        float z = arr[3 * i + 2];
+        return;
+    }
 
-        Eigen::Vector4d v(x,y,z,1);
-        Eigen::Vector4d tv = transformation * v;
+    float matrix[16];
+    transformationToFloat(transformation, matrix);
 
-        arr[3 * i]     = tv[0];
-        arr[3 * i + 1] = tv[1];
-        arr[3 * i + 2] = tv[2];
+    size_t numPoints;
+    floatArr points = buffer->getPointArray(numPoints);
+    if(numPoints)
+    {
+        transformPoints(points.get(), numPoints, matrix);
     }
+
+    size_t numNormals;
+    floatArr normals = buffer->getPointNormalArray(numNormals);
+    if(numNormals)
+    {
+        transformNormals(normals.get(), numNormals, matrix);
+    }
+}
+
+void transformPointCloud(ModelPtr model, Eigen::Matrix4d transformation)
+{
+    std::cout << timestamp << "Transforming model." << std::endl;
+    transformPointBuffer(model->m_pointCloud, transformation);
 }
 
 void transformPointCloudAndAppend(PointBufferPtr& buffer, boost::filesystem::path& transfromFile, std::vector<float>& pts, std::vector<float>& nrm)
@@ -360,42 +497,16 @@ void transformPointCloudAndAppend(PointBufferPtr& buffer, boost::filesystem::pat
          return;
      }
 
-     for(size_t i = 0; i < n_points; i++)
-     {
-
-        float x = points[3 * i];
-        float y = points[3 * i + 1];
-        float z = points[3 * i + 2];
-
-        Eigen::Vector4d v(x,y,z,1);
-        Eigen::Vector4d tv = transform * v;
-
-//        points[3 * i]     = tv[0];
-//        points[3 * i + 1] = tv[1];
-//        points[3 * i + 2] = tv[2];
-
-        pts.push_back(tv[0]);
-        pts.push_back(tv[1]);
-        pts.push_back(tv[2]);
-
-        Eigen::Matrix3d rotation = transform.block(0, 0, 3, 3);
-
-        float nx = normals[3 * i];
-        float ny = normals[3 * i + 1];
-        float nz = normals[3 * i + 2];
-
-        Eigen::Vector3d normal(nx, ny, nz);
-        Eigen::Vector3d tn = rotation * normal;
-
-//        normals[3 * i]     = tn[0];
-//        normals[3 * i + 1] = tn[1];
-//        normals[3 * i + 2] = tn[2];
-
-        nrm.push_back(tn[0]);
-        nrm.push_back(tn[1]);
-        nrm.push_back(tn[2]);
-     }
+     // Append the original data and transform it in place
+     size_t pointOffset = pts.size();
+     size_t normalOffset = nrm.size();
+     pts.insert(pts.end(), points.get(), points.get() + 3 * n_points);
+     nrm.insert(nrm.end(), normals.get(), normals.get() + 3 * n_normals);
 
+     float matrix[16];
+     transformationToFloat(transform, matrix);
+     transformPoints(pts.data() + pointOffset, n_points, matrix);
+     transformNormals(nrm.data() + normalOffset, n_normals, matrix);
 }
 
 void writePointsAndNormals(std::vector<float>& p, std::vector<float>& n, std::string outfile)
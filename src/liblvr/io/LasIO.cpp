@@ -29,75 +29,540 @@ using std::endl;
 
 #include <lvr/io/LasIO.hpp>
 #include <lvr/io/Timestamp.hpp>
+#include <lvr/config/lvropenmp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <climits>
 
 #include "lasreader.hpp"
 #include "laswriter.hpp"
+#include "lasindex.hpp"
+#include "lasquadtree.hpp"
 
 namespace lvr
 {
 
-ModelPtr LasIO::read(string filename )
+namespace
 {
 
-    // Create Lasreader object
+/// Files with fewer points are decoded by one thread
+const size_t c_minParallelPoints = 1 << 20;
+
+/// Coordinates up to this magnitude keep millimeters as floats and are not shifted
+const double c_maxUnshifted = 10000.0;
+
+/// Opens a reader for the given file or returns 0
+LASreader* openReader(const string& filename)
+{
     LASreadOpener lasreadopener;
     lasreadopener.set_file_name(filename.c_str());
 
-    if(lasreadopener.active())
+    if(!lasreadopener.active())
+    {
+        return 0;
+    }
+    return lasreadopener.open();
+}
+
+void closeReader(LASreader* lasreader)
+{
+    if(lasreader)
     {
-        LASreader* lasreader = lasreadopener.open();
+        lasreader->close();
+        delete lasreader;
+    }
+}
 
+/**
+ * @brief   Computes the shift that is subtracted from the coordinates of a
+ *          file before they are converted to floats. It is the lower
+ *          corner of the bounding box in whole meters, or 0 for axes that
+ *          are precise enough without it.
+ */
+void computeShift(const LASheader& header, double shift[3])
+{
+    const double min[3] = {header.min_x, header.min_y, header.min_z};
+    const double max[3] = {header.max_x, header.max_y, header.max_z};
+    for(int i = 0; i < 3; i++)
+    {
+        bool large = std::max(fabs(min[i]), fabs(max[i])) > c_maxUnshifted;
+        shift[i] = large ? floor(min[i]) : 0.0;
+    }
+}
+
+/**
+ * @brief   Checks whether a reader can seek to a point without decoding
+ *          all points before it. True for uncompressed and chunked
+ *          compressed files.
+ */
+bool isSeekable(LASreader* lasreader)
+{
+    LASzip* laszip = lasreader->header.laszip;
+    return laszip == 0 || laszip->compressor == LASZIP_COMPRESSOR_NONE
+        || laszip->compressor == LASZIP_COMPRESSOR_CHUNKED;
+}
+
+/**
+ * @brief   Decodes the next n points of a reader into the given arrays.
+ *          The shift is subtracted in double precision. RGB values are
+ *          stored with their 16 bits, intensities and rgb may be null.
+ *          Returns the number of decoded points.
+ */
+size_t decodePoints(LASreader* lasreader, size_t n, const double* shift, float* points, float* intensities, U16* rgb)
+{
+    size_t i = 0;
+    for(; i < n && lasreader->read_point(); i++)
+    {
+        const LASpoint& point = lasreader->point;
+        points[3 * i]     = point.get_x() - shift[0];
+        points[3 * i + 1] = point.get_y() - shift[1];
+        points[3 * i + 2] = point.get_z() - shift[2];
+
+        if(intensities)
+        {
+            intensities[i] = point.intensity;
+        }
+
+        if(rgb)
+        {
+            rgb[3 * i]     = point.rgb[0];
+            rgb[3 * i + 1] = point.rgb[1];
+            rgb[3 * i + 2] = point.rgb[2];
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief   Decodes the points [first, first + n) of a file into the given
+ *          arrays. The points are split into one contiguous part per
+ *          thread if the file is large and seekable, every thread decodes
+ *          its part with its own reader. The given reader is used for the
+ *          first part. Returns false if not all points could be decoded.
+ */
+bool decodeParallel(const string& filename, LASreader* lasreader, vector<LASreader*>& readers,
+        size_t first, size_t n, const double* shift, float* points, float* intensities, U16* rgb)
+{
+    int numPieces = 1;
+    if(n >= c_minParallelPoints && isSeekable(lasreader))
+    {
+        numPieces = std::max(OpenMPConfig::getNumThreads(), 1);
+    }
+
+    if(readers.empty())
+    {
+        readers.push_back(lasreader);
+    }
+    readers.resize(std::max((size_t)numPieces, readers.size()), 0);
+
+    bool ok = true;
+
+    #pragma omp parallel for schedule(static) reduction(&&:ok)
+    for(int p = 0; p < numPieces; p++)
+    {
+        size_t begin = first + n * p / numPieces;
+        size_t end   = first + n * (p + 1) / numPieces;
+
+        if(!readers[p])
+        {
+            readers[p] = openReader(filename);
+        }
+
+        LASreader* r = readers[p];
+        if(!r || (r->p_count != (I64)begin && !r->seek(begin)))
+        {
+            ok = false;
+            continue;
+        }
+
+        size_t offset = begin - first;
+        size_t decoded = decodePoints(r, end - begin, shift, points + 3 * offset,
+                intensities ? intensities + offset : 0, rgb ? rgb + 3 * offset : 0);
+        ok = ok && decoded == end - begin;
+    }
+
+    return ok;
+}
+
+/**
+ * @brief   Converts the 16 bit RGB values of n points to 8 bit colors.
+ *          Many files store 8 bit values, so the values are only scaled
+ *          down if one of them is larger than 255.
+ */
+ucharArr convertColors(const U16* rgb, size_t n)
+{
+    U16 maxValue = 0;
+    for(size_t i = 0; i < 3 * n; i++)
+    {
+        maxValue = std::max(maxValue, rgb[i]);
+    }
+    int shift = maxValue > 255 ? 8 : 0;
+
+    ucharArr colors(new unsigned char[3 * n]);
+    for(size_t i = 0; i < 3 * n; i++)
+    {
+        colors[i] = rgb[i] >> shift;
+    }
+    return colors;
+}
+
+} // namespace
+
+ModelPtr LasIO::read(string filename )
+{
+    return readRegion(filename, 0);
+}
+
+ModelPtr LasIO::read(string filename, double minX, double minY, double maxX, double maxY)
+{
+    double region[4] = {minX, minY, maxX, maxY};
+    return readRegion(filename, region);
+}
+
+ModelPtr LasIO::readRegion(string filename, const double* region)
+{
+    // Create Lasreader object
+    LASreader* lasreader = openReader(filename);
+
+    if(!lasreader)
+    {
+        cout << timestamp << "LasIO::read(): Unable to open file " << filename << endl;
+        return ModelPtr();
+    }
+
+    bool hasRGB = lasreader->point.have_rgb;
+
+    double shift[3];
+    computeShift(lasreader->header, shift);
+    if(shift[0] != 0.0 || shift[1] != 0.0 || shift[2] != 0.0)
+    {
+        cout << timestamp << "LasIO::read(): Coordinates of " << filename << " are shifted by ("
+             << shift[0] << ", " << shift[1] << ", " << shift[2] << ")" << endl;
+    }
+
+    size_t num_points = 0;
+    floatArr points;
+    floatArr intensities;
+    vector<U16> rgb;
+
+    if(region)
+    {
+        // The filter uses the spatial index of the file if there is one,
+        // so the number of points is only known after reading them
+        lasreader->inside_rectangle(region[0], region[1], region[2], region[3]);
+
+        vector<float> p;
+        vector<float> in;
+        const size_t blockSize = 65536;
+        size_t decoded = blockSize;
+        while(decoded == blockSize)
+        {
+            p.resize(3 * (num_points + blockSize));
+            in.resize(num_points + blockSize);
+            if(hasRGB)
+            {
+                rgb.resize(3 * (num_points + blockSize));
+            }
+
+            decoded = decodePoints(lasreader, blockSize, shift, &p[3 * num_points], &in[num_points],
+                    hasRGB ? &rgb[3 * num_points] : 0);
+            num_points += decoded;
+        }
+
+        points = floatArr(new float[3 * num_points]);
+        intensities = floatArr(new float[num_points]);
+        std::copy(p.begin(), p.begin() + 3 * num_points, points.get());
+        std::copy(in.begin(), in.begin() + num_points, intensities.get());
+        closeReader(lasreader);
+    }
+    else
+    {
         // Get number of points in file
-        size_t num_points = lasreader->npoints;
+        num_points = lasreader->npoints;
 
         // Alloc coordinate array
-        floatArr points ( new float[3 * num_points]);
-        floatArr intensities ( new float[num_points]);
-        ucharArr colors (new unsigned char[3 * num_points]);
+        points = floatArr( new float[3 * num_points]);
+        intensities = floatArr( new float[num_points]);
+        if(hasRGB)
+        {
+            rgb.resize(3 * num_points);
+        }
 
         // Read point data
+        vector<LASreader*> readers;
+        bool ok = decodeParallel(filename, lasreader, readers, 0, num_points, shift,
+                points.get(), intensities.get(), hasRGB ? &rgb[0] : 0);
+
+        for(size_t i = 0; i < readers.size(); i++)
+        {
+            closeReader(readers[i]);
+        }
+
+        if(!ok)
+        {
+            cout << timestamp << "LasIO::read(): Unable to decode the points of " << filename << endl;
+            return ModelPtr();
+        }
+    }
+
+    ucharArr colors;
+    if(hasRGB)
+    {
+        colors = convertColors(num_points ? &rgb[0] : 0, num_points);
+    }
+    else
+    {
+        // Create fake colors from intensities
+        colors = ucharArr(new unsigned char[3 * num_points]);
         for(size_t i = 0; i < num_points; i++)
         {
-            size_t buf_pos = 3 * i;
-            lasreader->read_point();
-            points[buf_pos]     = lasreader->point.x;
-            points[buf_pos + 1] = lasreader->point.y;
-            points[buf_pos + 2] = lasreader->point.z;
+            colors[3 * i] = colors[3 * i + 1] = colors[3 * i + 2] = (U16)intensities[i];
+        }
+    }
 
-            // Create fake colors from intensities
-            /// TODO: Check for color attributes if possible...
-            colors[buf_pos] = lasreader->point.intensity;
-            colors[buf_pos + 1] = lasreader->point.intensity;
-            colors[buf_pos + 2] = lasreader->point.intensity;
+    // Create point buffer and model
+    PointBufferPtr p_buffer( new PointBuffer);
+    p_buffer->setPointArray(points, num_points);
+    p_buffer->setPointIntensityArray(intensities, num_points);
+    p_buffer->setPointColorArray(colors, num_points);
 
-            intensities[i] = lasreader->point.intensity;
+    ModelPtr m_ptr( new Model(p_buffer));
+    std::copy(shift, shift + 3, m_ptr->m_shift);
+    m_model = m_ptr;
 
-        }
+    return m_ptr;
+}
 
-        // Create point buffer and model
-        PointBufferPtr p_buffer( new PointBuffer);
-        p_buffer->setPointArray(points, num_points);
-        p_buffer->setPointIntensityArray(intensities, num_points);
-        p_buffer->setPointColorArray(colors, num_points);
+bool LasIO::readChunks(string filename, size_t chunkSize, std::function<void(vector<float>&)> f, double* shift)
+{
+    LASreader* lasreader = openReader(filename);
 
-        ModelPtr m_ptr( new Model(p_buffer));
-        m_model = m_ptr;
+    if(!lasreader)
+    {
+        cout << timestamp << "LasIO::readChunks(): Unable to open file " << filename << endl;
+        return false;
+    }
 
-        delete lasreader;
+    size_t num_points = lasreader->npoints;
+    chunkSize = std::max(chunkSize, (size_t)1);
 
-        return m_ptr;
+    double s[3] = {0.0, 0.0, 0.0};
+    if(shift)
+    {
+        computeShift(lasreader->header, s);
+        std::copy(s, s + 3, shift);
     }
-    else
+
+    // The readers are kept over all chunks, every one seeks to its part
+    vector<LASreader*> readers;
+    vector<float> points;
+    bool ok = true;
+
+    for(size_t first = 0; ok && first < num_points; first += chunkSize)
     {
-        cout << timestamp << "LasIO::read(): Unable to open file " << filename << endl;
+        size_t n = std::min(chunkSize, num_points - first);
+        points.resize(3 * n);
+        ok = decodeParallel(filename, lasreader, readers, first, n, s, &points[0], 0, 0);
+        if(ok)
+        {
+            f(points);
+        }
+    }
+
+    for(size_t i = 0; i < readers.size(); i++)
+    {
+        closeReader(readers[i]);
+    }
+    if(readers.empty())
+    {
+        closeReader(lasreader);
     }
+
+    if(!ok)
+    {
+        cout << timestamp << "LasIO::readChunks(): Unable to decode the points of " << filename << endl;
+    }
+    return ok;
 }
 
+bool LasIO::createIndex(string filename, float cellSize)
+{
+    LASreader* lasreader = openReader(filename);
+
+    if(!lasreader)
+    {
+        cout << timestamp << "LasIO::createIndex(): Unable to open file " << filename << endl;
+        return false;
+    }
+
+    cout << timestamp << "Creating spatial index for " << filename << endl;
+
+    // Same parameters as the lasindex tool of LAStools
+    LASquadtree* quadtree = new LASquadtree;
+    quadtree->setup(lasreader->header.min_x, lasreader->header.max_x,
+                    lasreader->header.min_y, lasreader->header.max_y, cellSize);
+
+    LASindex index;
+    index.prepare(quadtree, 1000);
+    while(lasreader->read_point())
+    {
+        index.add(&lasreader->point, (U32)(lasreader->p_count - 1));
+    }
+    index.complete(100000, -20);
+
+    bool ok = index.write(filename.c_str());
+    closeReader(lasreader);
+
+    return ok;
+}
 
 void LasIO::save( string filename )
 {
-    /// TODO: Implement LAS output
-    std::cerr << "LASIO: Saving not yet implemented." << endl;
+    if(!m_model || !m_model->m_pointCloud)
+    {
+        cout << timestamp << "LasIO::save(): No point cloud to save." << endl;
+        return;
+    }
+
+    PointBufferPtr buffer = m_model->m_pointCloud;
+    size_t n_colors;
+    buffer->getPointColorArray(n_colors);
+
+    LasWriter writer(filename, n_colors == buffer->getNumPoints() && n_colors > 0, 0.001, m_model->m_shift);
+    if(writer.write(buffer))
+    {
+        size_t n = writer.close();
+        cout << timestamp << "Wrote " << n << " points to " << filename << endl;
+    }
+}
+
+LasWriter::LasWriter(string filename, bool colors, double scale, const double* shift)
+    : m_filename(filename), m_colors(colors), m_scale(scale),
+      m_writer(0), m_header(new LASheader), m_numPoints(0), m_clipped(0)
+{
+    setShift(shift);
+}
+
+LasWriter::~LasWriter()
+{
+    close();
+    delete m_header;
+}
+
+bool LasWriter::write(const float* points, size_t n, const unsigned char* colors, const float* intensities)
+{
+    if(n == 0)
+    {
+        return true;
+    }
+
+    LASheader& header = *m_header;
+
+    if(!m_writer)
+    {
+        header.point_data_format = m_colors ? 2 : 0;
+        header.point_data_record_length = m_colors ? 26 : 20;
+        header.x_scale_factor = header.y_scale_factor = header.z_scale_factor = m_scale;
+
+        // Offsets on a coarse grid next to the first point keep the
+        // stored integers small
+        header.x_offset = floor((points[0] + m_shift[0]) / 100.0) * 100.0;
+        header.y_offset = floor((points[1] + m_shift[1]) / 100.0) * 100.0;
+        header.z_offset = floor((points[2] + m_shift[2]) / 100.0) * 100.0;
+
+        LASwriteOpener laswriteopener;
+        laswriteopener.set_file_name(m_filename.c_str());
+        m_writer = laswriteopener.open(m_header);
+
+        if(!m_writer)
+        {
+            cout << timestamp << "LasWriter: Unable to open file " << m_filename << endl;
+            return false;
+        }
+    }
+
+    LASpoint point;
+    point.init(m_header, header.point_data_format, header.point_data_record_length, m_header);
+
+    const double* offset[3] = {&header.x_offset, &header.y_offset, &header.z_offset};
+    I32* coordinates[3] = {&point.x, &point.y, &point.z};
+
+    for(size_t i = 0; i < n; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            double q = floor((points[3 * i + j] + m_shift[j] - *offset[j]) / m_scale + 0.5);
+            if(q < INT_MIN || q > INT_MAX)
+            {
+                q = std::min(std::max(q, (double)INT_MIN), (double)INT_MAX);
+                m_clipped++;
+            }
+            *coordinates[j] = (I32)q;
+        }
+
+        if(intensities)
+        {
+            point.intensity = (U16)std::min(std::max(intensities[i], 0.0f), 65535.0f);
+        }
+
+        // Scale the colors to the 16 bits of the format, 255 becomes 65535
+        if(m_colors && colors)
+        {
+            point.rgb[0] = colors[3 * i] * 257;
+            point.rgb[1] = colors[3 * i + 1] * 257;
+            point.rgb[2] = colors[3 * i + 2] * 257;
+        }
+
+        if(!m_writer->write_point(&point))
+        {
+            cout << timestamp << "LasWriter: Unable to write to " << m_filename << endl;
+            return false;
+        }
+        m_writer->update_inventory(&point);
+    }
+
+    m_numPoints += n;
+    return true;
+}
+
+bool LasWriter::write(PointBufferPtr buffer)
+{
+    size_t n, n_colors, n_intensities;
+    floatArr points = buffer->getPointArray(n);
+    ucharArr colors = buffer->getPointColorArray(n_colors);
+    floatArr intensities = buffer->getPointIntensityArray(n_intensities);
+
+    return write(points.get(), n,
+            n_colors == n ? colors.get() : 0,
+            n_intensities == n ? intensities.get() : 0);
+}
+
+void LasWriter::setShift(const double* shift)
+{
+    for(int i = 0; i < 3; i++)
+    {
+        m_shift[i] = shift ? shift[i] : 0.0;
+    }
+}
+
+size_t LasWriter::close()
+{
+    if(m_writer)
+    {
+        // Number of points and bounding box are taken from the inventory
+        m_writer->update_header(m_header, TRUE);
+        m_writer->close();
+        delete m_writer;
+        m_writer = 0;
+
+        if(m_clipped)
+        {
+            cout << timestamp << "LasWriter: " << m_clipped << " coordinates were outside of the range of "
+                 << m_filename << ". Use a larger scale." << endl;
+        }
+    }
+    return m_numPoints;
 }
 
 } /* namespace lvr */
@@ -158,6 +158,36 @@ idx3uArr MeshBuffer::getIndexedFaceArray(size_t& n)
 	return p;
 }
 
+floatView MeshBuffer::getVertexView()
+{
+	return floatView(m_vertices.get(), m_numVertices, 3);
+}
+
+floatView MeshBuffer::getVertexNormalView()
+{
+	return floatView(m_vertexNormals.get(), m_numVertexNormals, 3);
+}
+
+ucharView MeshBuffer::getVertexColorView()
+{
+	return ucharView(m_vertexColors.get(), m_numVertexColors, 3);
+}
+
+floatView MeshBuffer::getVertexIntensityView()
+{
+	return floatView(m_vertexIntensity.get(), m_numVertexIntensities, 1);
+}
+
+floatView MeshBuffer::getVertexConfidenceView()
+{
+	return floatView(m_vertexConfidence.get(), m_numVertexConfidences, 1);
+}
+
+uintView MeshBuffer::getFaceView()
+{
+	return uintView(m_faceIndices.get(), m_numFaces, 3);
+}
+
 void MeshBuffer::setVertexArray(floatArr array, size_t n)
 {
 	m_vertices = array;
@@ -71,7 +71,7 @@ ModelPtr ModelFactory::readModel( std::string filename )
     {
         io = new ObjIO;
     }
-    else if (extension == ".las")
+    else if (extension == ".las" || extension == ".laz")
     {
         io = new LasIO;
     }
@@ -222,6 +222,10 @@ void ModelFactory::saveModel( ModelPtr m, std::string filename)
     {
     	io = new STLIO;
     }
+    else if (extension == ".las" || extension == ".laz")
+    {
+        io = new LasIO;
+    }
 #ifdef LVR_USE_PCL
     else if (extension == ".pcd")
     {
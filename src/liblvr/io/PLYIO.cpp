@@ -34,16 +34,431 @@
 #include <lvr/io/PLYIO.hpp>
 #include <lvr/io/Timestamp.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <ctime>
 #include <sstream>
 #include <fstream>
+#include <vector>
+
+using std::vector;
 
 
 
 namespace lvr
 {
 
+namespace
+{
+
+/// Number of bytes that are read or written at once by the block wise I/O
+const size_t PLY_BLOCK_SIZE = 64 * 1024 * 1024;
+
+/// A property of a PLY element as given in the header
+struct PlyProperty
+{
+    string  name;
+
+    /// Type of the value, e_ply_type
+    int     type;
+
+    /// Type of the list length, -1 for scalar properties
+    int     lengthType;
+
+    /// Offset in the record (scalar elements only)
+    size_t  offset;
+};
+
+/// An element of a PLY file as given in the header
+struct PlyElement
+{
+    string              name;
+    size_t              count;
+    vector<PlyProperty> properties;
+
+    /// Size of a record, only valid if the element has no list properties
+    size_t              recordSize;
+    bool                fixed;
+
+    const PlyProperty* find( const char* n ) const
+    {
+        for ( size_t i = 0; i < properties.size(); i++ )
+        {
+            if ( properties[i].name == n )
+            {
+                return &properties[i];
+            }
+        }
+        return 0;
+    }
+};
+
+/// Channels of a vertex or point element
+struct PlyChannels
+{
+    PlyChannels() : n( 0 ), numColors( 0 ), numConfidences( 0 ),
+        numIntensities( 0 ), numNormals( 0 ) {}
+
+    floatArr    coords;
+    ucharArr    colors;
+    floatArr    confidences;
+    floatArr    intensities;
+    floatArr    normals;
+    size_t      n;
+    size_t      numColors;
+    size_t      numConfidences;
+    size_t      numIntensities;
+    size_t      numNormals;
+};
+
+int plyTypeFromName( const string& name )
+{
+    /* Same order as e_ply_type. */
+    static const char* const names[] = {
+        "int8", "uint8", "int16", "uint16", "int32", "uint32", "float32", "float64",
+        "char", "uchar", "short", "ushort", "int", "uint", "float", "double" };
+    for ( int i = 0; i < 16; i++ )
+    {
+        if ( name == names[i] )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t plyTypeSize( int type )
+{
+    static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+    return sizes[type % 8];
+}
+
+inline double plyValue( const char* p, int type )
+{
+    switch ( type % 8 )
+    {
+        case 0: { int8_t   v; memcpy( &v, p, 1 ); return v; }
+        case 1: { uint8_t  v; memcpy( &v, p, 1 ); return v; }
+        case 2: { int16_t  v; memcpy( &v, p, 2 ); return v; }
+        case 3: { uint16_t v; memcpy( &v, p, 2 ); return v; }
+        case 4: { int32_t  v; memcpy( &v, p, 4 ); return v; }
+        case 5: { uint32_t v; memcpy( &v, p, 4 ); return v; }
+        case 6: { float    v; memcpy( &v, p, 4 ); return v; }
+        default:{ double   v; memcpy( &v, p, 8 ); return v; }
+    }
+}
+
+bool hostIsLittleEndian()
+{
+    uint16_t v = 1;
+    return *( (unsigned char*) &v ) == 1;
+}
+
+bool readPlyHeader( std::ifstream& in, string& format, vector<PlyElement>& elements )
+{
+    string line;
+    if ( !std::getline( in, line ) || line.compare( 0, 3, "ply" ) )
+    {
+        return false;
+    }
+
+    while ( std::getline( in, line ) )
+    {
+        if ( !line.empty() && line[ line.size() - 1 ] == '\r' )
+        {
+            line.erase( line.size() - 1 );
+        }
+
+        std::stringstream ss( line );
+        string key;
+        ss >> key;
+        if ( key == "format" )
+        {
+            ss >> format;
+        }
+        else if ( key == "element" )
+        {
+            PlyElement e;
+            ss >> e.name >> e.count;
+            e.recordSize = 0;
+            e.fixed = true;
+            elements.push_back( e );
+        }
+        else if ( key == "property" )
+        {
+            if ( elements.empty() )
+            {
+                return false;
+            }
+            PlyElement& e = elements.back();
+            PlyProperty p;
+            string type;
+            ss >> type;
+            if ( type == "list" )
+            {
+                string lengthType, valueType;
+                ss >> lengthType >> valueType >> p.name;
+                p.lengthType = plyTypeFromName( lengthType );
+                p.type       = plyTypeFromName( valueType );
+                if ( p.lengthType < 0 )
+                {
+                    return false;
+                }
+                e.fixed = false;
+            }
+            else
+            {
+                ss >> p.name;
+                p.type       = plyTypeFromName( type );
+                p.lengthType = -1;
+            }
+            if ( p.type < 0 )
+            {
+                return false;
+            }
+            p.offset = e.recordSize;
+            if ( p.lengthType < 0 )
+            {
+                e.recordSize += plyTypeSize( p.type );
+            }
+            e.properties.push_back( p );
+        }
+        else if ( key == "end_header" )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Reads a vertex or point element. Only elements without list properties
+ * are supported. */
+bool readPlyChannels( std::ifstream& in, const PlyElement& e, PlyChannels& c,
+        bool readColor, bool readConfidence, bool readIntensity, bool readNormals )
+{
+    const PlyProperty* xyz[3]    = { e.find( "x" ),   e.find( "y" ),     e.find( "z" ) };
+    const PlyProperty* rgb[3]    = { e.find( "red" ), e.find( "green" ), e.find( "blue" ) };
+    const PlyProperty* nxyz[3]   = { e.find( "nx" ),  e.find( "ny" ),    e.find( "nz" ) };
+    const PlyProperty* confidence = readConfidence ? e.find( "confidence" ) : 0;
+    const PlyProperty* intensity  = readIntensity  ? e.find( "intensity" )  : 0;
+    bool color   = readColor   && rgb[0] && rgb[1] && rgb[2];
+    bool normals = readNormals && nxyz[0] && nxyz[1] && nxyz[2];
+
+    if ( !e.fixed || !xyz[0] || !xyz[1] || !xyz[2] )
+    {
+        return false;
+    }
+
+    c.n      = e.count;
+    c.coords = floatArr( new float[ 3 * e.count ] );
+    if ( color )
+    {
+        c.colors    = ucharArr( new unsigned char[ 3 * e.count ] );
+        c.numColors = e.count;
+    }
+    if ( confidence )
+    {
+        c.confidences    = floatArr( new float[ e.count ] );
+        c.numConfidences = e.count;
+    }
+    if ( intensity )
+    {
+        c.intensities    = floatArr( new float[ e.count ] );
+        c.numIntensities = e.count;
+    }
+    if ( normals )
+    {
+        c.normals    = floatArr( new float[ 3 * e.count ] );
+        c.numNormals = e.count;
+    }
+
+    size_t blockRecords = std::max( PLY_BLOCK_SIZE / e.recordSize, (size_t) 1 );
+    vector<char> block;
+    for ( size_t start = 0; start < e.count; start += blockRecords )
+    {
+        size_t n = std::min( blockRecords, e.count - start );
+        block.resize( n * e.recordSize );
+        if ( !in.read( &block[0], block.size() ) )
+        {
+            return false;
+        }
+
+        #pragma omp parallel for schedule(static)
+        for ( long i = 0; i < (long) n; i++ )
+        {
+            const char* r = &block[ i * e.recordSize ];
+            size_t j = start + i;
+            for ( int k = 0; k < 3; k++ )
+            {
+                c.coords[ 3 * j + k ] = plyValue( r + xyz[k]->offset, xyz[k]->type );
+            }
+            if ( color )
+            {
+                for ( int k = 0; k < 3; k++ )
+                {
+                    c.colors[ 3 * j + k ] = plyValue( r + rgb[k]->offset, rgb[k]->type );
+                }
+            }
+            if ( confidence )
+            {
+                c.confidences[ j ] = plyValue( r + confidence->offset, confidence->type );
+            }
+            if ( intensity )
+            {
+                c.intensities[ j ] = plyValue( r + intensity->offset, intensity->type );
+            }
+            if ( normals )
+            {
+                for ( int k = 0; k < 3; k++ )
+                {
+                    c.normals[ 3 * j + k ] = plyValue( r + nxyz[k]->offset, nxyz[k]->type );
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* Reads a face element that consists of triangles only. */
+bool readPlyFaces( std::ifstream& in, const PlyElement& e, uintArr& faces )
+{
+    if ( e.properties.size() != 1 || e.properties[0].lengthType < 0 )
+    {
+        return false;
+    }
+    const PlyProperty& p = e.properties[0];
+    if ( p.name != "vertex_indices" && p.name != "vertex_index" )
+    {
+        return false;
+    }
+
+    size_t lengthSize = plyTypeSize( p.lengthType );
+    size_t valueSize  = plyTypeSize( p.type );
+    size_t recordSize = lengthSize + 3 * valueSize;
+
+    /* An empty face element leaves the array unset, so the vertices are
+     * taken as points like in files without faces. */
+    if ( !e.count )
+    {
+        return true;
+    }
+    faces = uintArr( new unsigned int[ 3 * e.count ] );
+
+    size_t blockRecords = std::max( PLY_BLOCK_SIZE / recordSize, (size_t) 1 );
+    vector<char> block;
+    for ( size_t start = 0; start < e.count; start += blockRecords )
+    {
+        size_t n = std::min( blockRecords, e.count - start );
+        block.resize( n * recordSize );
+        if ( !in.read( &block[0], block.size() ) )
+        {
+            return false;
+        }
+
+        int nonTriangles = 0;
+
+        #pragma omp parallel for schedule(static) reduction(+:nonTriangles)
+        for ( long i = 0; i < (long) n; i++ )
+        {
+            const char* r = &block[ i * recordSize ];
+            if ( plyValue( r, p.lengthType ) != 3 )
+            {
+                nonTriangles++;
+                continue;
+            }
+            for ( int k = 0; k < 3; k++ )
+            {
+                faces[ 3 * ( start + i ) + k ] = plyValue( r + lengthSize + k * valueSize, p.type );
+            }
+        }
+
+        /* The records have a variable size, so the block layout is only
+         * valid for pure triangle meshes. */
+        if ( nonTriangles )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Writes a vertex or point element. The property order matches the header
+ * written by PLYIO::saveBinary. */
+void writePlyChannels( std::ofstream& out, floatArr coords, ucharArr colors,
+        floatArr intensities, floatArr confidences, floatArr normals, size_t count )
+{
+    size_t recordSize = 3 * sizeof(float)
+        + ( colors      ? 3 : 0 )
+        + ( intensities ? sizeof(float) : 0 )
+        + ( confidences ? sizeof(float) : 0 )
+        + ( normals     ? 3 * sizeof(float) : 0 );
+
+    size_t blockRecords = std::max( PLY_BLOCK_SIZE / recordSize, (size_t) 1 );
+    vector<char> block;
+    for ( size_t start = 0; start < count; start += blockRecords )
+    {
+        size_t n = std::min( blockRecords, count - start );
+        block.resize( n * recordSize );
+
+        #pragma omp parallel for schedule(static)
+        for ( long i = 0; i < (long) n; i++ )
+        {
+            char* r = &block[ i * recordSize ];
+            size_t j = start + i;
+            memcpy( r, &coords[ 3 * j ], 3 * sizeof(float) );
+            r += 3 * sizeof(float);
+            if ( colors )
+            {
+                memcpy( r, &colors[ 3 * j ], 3 );
+                r += 3;
+            }
+            if ( intensities )
+            {
+                memcpy( r, &intensities[ j ], sizeof(float) );
+                r += sizeof(float);
+            }
+            if ( confidences )
+            {
+                memcpy( r, &confidences[ j ], sizeof(float) );
+                r += sizeof(float);
+            }
+            if ( normals )
+            {
+                memcpy( r, &normals[ 3 * j ], 3 * sizeof(float) );
+            }
+        }
+        out.write( &block[0], block.size() );
+    }
+}
+
+void writePlyFaces( std::ofstream& out, uintArr faces, size_t count )
+{
+    const size_t recordSize = 1 + 3 * sizeof(int32_t);
+
+    size_t blockRecords = PLY_BLOCK_SIZE / recordSize;
+    vector<char> block;
+    for ( size_t start = 0; start < count; start += blockRecords )
+    {
+        size_t n = std::min( blockRecords, count - start );
+        block.resize( n * recordSize );
+
+        #pragma omp parallel for schedule(static)
+        for ( long i = 0; i < (long) n; i++ )
+        {
+            char* r = &block[ i * recordSize ];
+            r[0] = 3;
+            for ( int k = 0; k < 3; k++ )
+            {
+                int32_t index = faces[ 3 * ( start + i ) + k ];
+                memcpy( r + 1 + k * sizeof(int32_t), &index, sizeof(int32_t) );
+            }
+        }
+        out.write( &block[0], block.size() );
+    }
+}
+
+} // anonymous namespace
+
 
 void PLYIO::save( string filename )
 {
@@ -53,6 +468,11 @@ void PLYIO::save( string filename )
         return;
     }
 
+    if ( saveBinary( filename ) )
+    {
+        return;
+    }
+
     /* Handle options. */
     e_ply_storage_mode mode( PLY_LITTLE_ENDIAN );
 
@@ -391,6 +811,12 @@ ModelPtr PLYIO::read( string filename )
 ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
         bool readIntensity, bool readNormals, bool readFaces )
 {
+    ModelPtr binaryModel = readBinary( filename, readColor, readConfidence,
+            readIntensity, readNormals, readFaces );
+    if ( binaryModel )
+    {
+        return binaryModel;
+    }
 
     /* Start reading new PLY */
     p_ply ply = ply_open( filename.c_str(), NULL, 0, NULL );
@@ -708,6 +1134,348 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
 }
 
 
+bool PLYIO::readChunks( string filename, size_t chunkSize,
+        std::function<void(vector<float>&, vector<float>&)> f )
+{
+    if ( !hostIsLittleEndian() )
+    {
+        return false;
+    }
+
+    std::ifstream in( filename.c_str(), std::ios::binary );
+    string format;
+    vector<PlyElement> elements;
+    if ( !in.good() || !readPlyHeader( in, format, elements ) || format != "binary_little_endian" )
+    {
+        return false;
+    }
+
+    /* Same choice of the element as in read(). */
+    long pointElement  = -1;
+    long vertexElement = -1;
+    bool faces = false;
+    for ( size_t i = 0; i < elements.size(); i++ )
+    {
+        if ( elements[i].name == "point" && pointElement < 0 )
+        {
+            pointElement = i;
+        }
+        else if ( elements[i].name == "vertex" && vertexElement < 0 )
+        {
+            vertexElement = i;
+        }
+        else if ( elements[i].name == "face" && elements[i].count )
+        {
+            faces = true;
+        }
+    }
+    long target = pointElement >= 0 ? pointElement : ( faces ? -1 : vertexElement );
+    if ( target < 0 )
+    {
+        return false;
+    }
+
+    /* Elements with lists can't be skipped without parsing them. */
+    for ( long i = 0; i < target; i++ )
+    {
+        if ( !elements[i].fixed )
+        {
+            return false;
+        }
+        in.seekg( elements[i].count * elements[i].recordSize, std::ios::cur );
+    }
+
+    const PlyElement& e = elements[target];
+    const PlyProperty* xyz[3]  = { e.find( "x" ),  e.find( "y" ),  e.find( "z" ) };
+    const PlyProperty* nxyz[3] = { e.find( "nx" ), e.find( "ny" ), e.find( "nz" ) };
+    bool normals = nxyz[0] && nxyz[1] && nxyz[2];
+    if ( !e.fixed || !xyz[0] || !xyz[1] || !xyz[2] )
+    {
+        return false;
+    }
+
+    chunkSize = std::max( chunkSize, (size_t) 1 );
+    vector<char>  block;
+    vector<float> points;
+    vector<float> pointNormals;
+    for ( size_t start = 0; start < e.count; start += chunkSize )
+    {
+        size_t n = std::min( chunkSize, e.count - start );
+        block.resize( n * e.recordSize );
+        if ( !in.read( &block[0], block.size() ) )
+        {
+            std::cout << timestamp << "»" << filename << "« is truncated." << std::endl;
+            return false;
+        }
+
+        points.resize( 3 * n );
+        pointNormals.resize( normals ? 3 * n : 0 );
+
+        #pragma omp parallel for schedule(static)
+        for ( long i = 0; i < (long) n; i++ )
+        {
+            const char* r = &block[ i * e.recordSize ];
+            for ( int k = 0; k < 3; k++ )
+            {
+                points[ 3 * i + k ] = plyValue( r + xyz[k]->offset, xyz[k]->type );
+            }
+            if ( normals )
+            {
+                for ( int k = 0; k < 3; k++ )
+                {
+                    pointNormals[ 3 * i + k ] = plyValue( r + nxyz[k]->offset, nxyz[k]->type );
+                }
+            }
+        }
+
+        f( points, pointNormals );
+    }
+    return true;
+}
+
+
+ModelPtr PLYIO::readBinary( string filename, bool readColor, bool readConfidence,
+        bool readIntensity, bool readNormals, bool readFaces )
+{
+    if ( !hostIsLittleEndian() )
+    {
+        return ModelPtr();
+    }
+
+    std::ifstream in( filename.c_str(), std::ios::binary );
+    string format;
+    vector<PlyElement> elements;
+    if ( !in.good() || !readPlyHeader( in, format, elements ) || format != "binary_little_endian" )
+    {
+        return ModelPtr();
+    }
+
+    std::cout << timestamp << "Loading »" << filename << "«." << std::endl;
+
+    PlyChannels vertices;
+    PlyChannels points;
+    uintArr     faces;
+    size_t      numFaces = 0;
+
+    for ( size_t i = 0; i < elements.size(); i++ )
+    {
+        const PlyElement& e = elements[i];
+        bool ok = true;
+        if ( e.name == "vertex" )
+        {
+            ok = readPlyChannels( in, e, vertices, readColor, readConfidence, readIntensity, readNormals );
+        }
+        else if ( e.name == "point" )
+        {
+            ok = readPlyChannels( in, e, points, readColor, readConfidence, readIntensity, readNormals );
+        }
+        else if ( e.name == "face" && readFaces )
+        {
+            ok = readPlyFaces( in, e, faces );
+            numFaces = e.count;
+        }
+        else if ( e.fixed )
+        {
+            in.seekg( e.count * e.recordSize, std::ios::cur );
+        }
+        else
+        {
+            /* Elements with lists can't be skipped without parsing them,
+             * but they don't matter if nothing else is read afterwards. */
+            bool needed = false;
+            for ( size_t j = i + 1; j < elements.size(); j++ )
+            {
+                needed = needed || elements[j].name == "vertex" || elements[j].name == "point"
+                    || ( elements[j].name == "face" && readFaces );
+            }
+            if ( !needed )
+            {
+                break;
+            }
+            ok = false;
+        }
+
+        if ( !ok )
+        {
+            std::cout << timestamp << "Layout of »" << filename
+                << "« is not supported by the block wise reader. Using RPly." << std::endl;
+            return ModelPtr();
+        }
+    }
+
+    if ( !( vertices.n || points.n ) )
+    {
+        std::cout << timestamp << "Neither vertices nor points in ply."
+            << std::endl;
+        return ModelPtr();
+    }
+
+    /* Check if we got only vertices and neither points nor faces. If that is
+     * the case then use the vertices as points. */
+    if ( vertices.n && !points.n && !faces )
+    {
+        std::cout << timestamp << "PLY contains neither faces nor points. "
+            << "Assuming that vertices are meant to be points." << std::endl;
+        std::swap( points, vertices );
+    }
+
+    PointBufferPtr pc;
+    MeshBufferPtr mesh;
+    if ( points.n )
+    {
+        pc = PointBufferPtr( new PointBuffer );
+        pc->setPointArray(           points.coords,      points.n );
+        pc->setPointColorArray(      points.colors,      points.numColors );
+        pc->setPointIntensityArray(  points.intensities, points.numIntensities );
+        pc->setPointConfidenceArray( points.confidences, points.numConfidences );
+        pc->setPointNormalArray(     points.normals,     points.numNormals );
+    }
+
+    if ( vertices.n )
+    {
+        mesh = MeshBufferPtr( new MeshBuffer );
+        mesh->setVertexArray(           vertices.coords,      vertices.n );
+        mesh->setVertexColorArray(      vertices.colors,      vertices.numColors );
+        mesh->setVertexIntensityArray(  vertices.intensities, vertices.numIntensities );
+        mesh->setVertexNormalArray(     vertices.normals,     vertices.numNormals );
+        mesh->setVertexConfidenceArray( vertices.confidences, vertices.numConfidences );
+        mesh->setFaceArray(             faces,                numFaces );
+    }
+
+    ModelPtr m( new Model( mesh, pc ) );
+    m_model = m;
+    return m;
+}
+
+
+bool PLYIO::saveBinary( string filename )
+{
+    if ( !hostIsLittleEndian() )
+    {
+        return false;
+    }
+
+    PlyChannels vertices;
+    PlyChannels points;
+    uintArr     faces;
+    size_t      numFaces = 0;
+
+    if ( m_model->m_pointCloud )
+    {
+        PointBufferPtr pc( m_model->m_pointCloud );
+        points.coords      = pc->getPointArray( points.n );
+        points.colors      = pc->getPointColorArray( points.numColors );
+        points.intensities = pc->getPointIntensityArray( points.numIntensities );
+        points.confidences = pc->getPointConfidenceArray( points.numConfidences );
+        points.normals     = pc->getPointNormalArray( points.numNormals );
+    }
+
+    if ( m_model->m_mesh )
+    {
+        MeshBufferPtr mesh( m_model->m_mesh );
+        vertices.coords      = mesh->getVertexArray( vertices.n );
+        vertices.colors      = mesh->getVertexColorArray( vertices.numColors );
+        vertices.intensities = mesh->getVertexIntensityArray( vertices.numIntensities );
+        vertices.confidences = mesh->getVertexConfidenceArray( vertices.numConfidences );
+        vertices.normals     = mesh->getVertexNormalArray( vertices.numNormals );
+        faces                = mesh->getFaceArray( numFaces );
+    }
+
+    if ( !( vertices.coords || points.coords ) )
+    {
+        std::cout << timestamp << "Neither vertices nor points to write." << std::endl;
+        return true;
+    }
+
+    /* Channels that don't match the number of vertices or points are not
+     * written, as in the RPly based writer. */
+    PlyChannels* channels[2] = { &vertices, &points };
+    const char*  names[2]    = { "vertices", "points" };
+    for ( int i = 0; i < 2; i++ )
+    {
+        PlyChannels& c = *channels[i];
+        if ( ( c.colors && c.numColors != c.n )
+          || ( c.intensities && c.numIntensities != c.n )
+          || ( c.confidences && c.numConfidences != c.n )
+          || ( c.normals && c.numNormals != c.n ) )
+        {
+            std::cout << timestamp << "Amount of " << names[i] << " and attribute"
+                << " information is not equal. Mismatching attributes won't be"
+                << " written." << std::endl;
+        }
+        if ( c.numColors      != c.n ) c.colors.reset();
+        if ( c.numIntensities != c.n ) c.intensities.reset();
+        if ( c.numConfidences != c.n ) c.confidences.reset();
+        if ( c.numNormals     != c.n ) c.normals.reset();
+    }
+
+    std::ofstream out( filename.c_str(), std::ios::binary );
+    if ( !out.good() )
+    {
+        std::cerr << timestamp << "Could not create »" << filename << "«" << std::endl;
+        return true;
+    }
+
+    /* Header, same layout as written by RPly. */
+    std::stringstream header;
+    header << "ply\nformat binary_little_endian 1.0\n";
+    for ( int i = 0; i < 2; i++ )
+    {
+        PlyChannels& c = *channels[i];
+        if ( !c.coords )
+        {
+            continue;
+        }
+
+        header << "element " << ( i == 0 ? "vertex " : "point " ) << c.n << "\n";
+        header << "property float x\nproperty float y\nproperty float z\n";
+        if ( c.colors )
+        {
+            header << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+        }
+        if ( c.intensities )
+        {
+            header << "property float intensity\n";
+        }
+        if ( c.confidences )
+        {
+            header << "property float confidence\n";
+        }
+        if ( c.normals )
+        {
+            header << "property float nx\nproperty float ny\nproperty float nz\n";
+        }
+        if ( i == 0 && numFaces )
+        {
+            header << "element face " << numFaces << "\n";
+            header << "property list uchar int vertex_indices\n";
+        }
+    }
+    header << "end_header\n";
+    out << header.str();
+
+    if ( vertices.coords )
+    {
+        writePlyChannels( out, vertices.coords, vertices.colors, vertices.intensities,
+                vertices.confidences, vertices.normals, vertices.n );
+        writePlyFaces( out, faces, numFaces );
+    }
+
+    if ( points.coords )
+    {
+        writePlyChannels( out, points.coords, points.colors, points.intensities,
+                points.confidences, points.normals, points.n );
+    }
+
+    if ( !out.good() )
+    {
+        std::cerr << timestamp << "Could not write »" << filename << "«." << std::endl;
+    }
+
+    return true;
+}
+
+
 int PLYIO::readVertexCb( p_ply_argument argument )
 {
     float ** ptr;
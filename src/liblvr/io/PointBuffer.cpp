@@ -119,6 +119,36 @@ color3bArr PointBuffer::getIndexedPointColorArray( size_t &n )
 }
 
 
+floatView PointBuffer::getPointView()
+{
+    return floatView( m_points.get(), m_numPoints, 3 );
+}
+
+
+floatView PointBuffer::getPointNormalView()
+{
+    return floatView( m_pointNormals.get(), m_numPointNormals, 3 );
+}
+
+
+ucharView PointBuffer::getPointColorView()
+{
+    return ucharView( m_pointColors.get(), m_numPointColors, 3 );
+}
+
+
+floatView PointBuffer::getPointIntensityView()
+{
+    return floatView( m_pointIntensities.get(), m_numPointIntensities, 1 );
+}
+
+
+floatView PointBuffer::getPointConfidenceView()
+{
+    return floatView( m_pointConfidences.get(), m_numPointConfidence, 1 );
+}
+
+
 coord3fArr PointBuffer::getIndexedPointNormalArray( size_t &n )
 {
 
@@ -0,0 +1,183 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * Profiler.cpp
+ */
+
+#include <lvr/io/Profiler.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <fstream>
+#include <iomanip>
+
+#if defined(_MSC_VER)
+#include <time.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using std::endl;
+using std::ofstream;
+using std::setw;
+
+namespace lvr
+{
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::addRecord(const ProfilerRecord& record)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_records.push_back(record);
+}
+
+vector<ProfilerRecord> Profiler::getRecords()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_records;
+}
+
+void Profiler::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_records.clear();
+}
+
+void Profiler::print(ostream& os)
+{
+    vector<ProfilerRecord> records = getRecords();
+
+    os << setw(16) << "stage" << setw(12) << "wall [s]" << setw(12) << "cpu [s]"
+       << setw(14) << "peak rss [kB]" << setw(12) << "items" << setw(14) << "items/s" << endl;
+
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        const ProfilerRecord& r = records[i];
+        os << setw(16) << r.name << setw(12) << r.wallTime << setw(12) << r.cpuTime
+           << setw(14) << r.peakRss << setw(12) << r.items
+           << setw(14) << (r.wallTime > 0 ? r.items / r.wallTime : 0) << endl;
+    }
+}
+
+bool Profiler::writeJSON(string filename)
+{
+    ofstream out(filename.c_str());
+    if(!out.good())
+    {
+        std::cout << timestamp << "Profiler: Unable to open " << filename << endl;
+        return false;
+    }
+
+    vector<ProfilerRecord> records = getRecords();
+
+    out << "{" << endl;
+    out << "  \"stages\": [" << endl;
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        const ProfilerRecord& r = records[i];
+
+        // Stage names are identifiers, only quotes and backslashes need escaping
+        string name;
+        for(size_t j = 0; j < r.name.size(); j++)
+        {
+            if(r.name[j] == '"' || r.name[j] == '\\')
+            {
+                name += '\\';
+            }
+            name += r.name[j];
+        }
+
+        out << "    {"
+            << "\"name\": \"" << name << "\", "
+            << "\"wall_time\": " << r.wallTime << ", "
+            << "\"cpu_time\": " << r.cpuTime << ", "
+            << "\"peak_rss_kb\": " << r.peakRss << ", "
+            << "\"items\": " << r.items << ", "
+            << "\"items_per_second\": " << (r.wallTime > 0 ? r.items / r.wallTime : 0)
+            << "}" << (i + 1 < records.size() ? "," : "") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+
+    return out.good();
+}
+
+double Profiler::cpuTime()
+{
+#if defined(_MSC_VER)
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+
+size_t Profiler::peakRss()
+{
+#if defined(_MSC_VER)
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    // Given in bytes on OS X
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+ProfilerStage::ProfilerStage(string name, size_t items)
+    : m_name(name), m_items(items), m_running(true)
+{
+    m_startWall = timestamp.getCurrentTimeinS();
+    m_startCpu = Profiler::cpuTime();
+}
+
+ProfilerStage::~ProfilerStage()
+{
+    stop();
+}
+
+void ProfilerStage::stop()
+{
+    if(!m_running)
+    {
+        return;
+    }
+    m_running = false;
+
+    ProfilerRecord record;
+    record.name = m_name;
+    record.wallTime = timestamp.getCurrentTimeinS() - m_startWall;
+    record.cpuTime = Profiler::cpuTime() - m_startCpu;
+    record.peakRss = Profiler::peakRss();
+    record.items = m_items;
+
+    Profiler::instance().addRecord(record);
+}
+
+} // namespace lvr
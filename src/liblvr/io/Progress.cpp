@@ -26,9 +26,11 @@
 
 
 #include <lvr/io/Progress.hpp>
+#include <lvr/config/lvropenmp.hpp>
 
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 using std::stringstream;
 using std::cout;
@@ -42,12 +44,27 @@ ProgressCallbackPtr ProgressBar::m_progressCallback = 0;
 ProgressTitleCallbackPtr ProgressBar::m_titleCallback = 0;
 
 ProgressBar::ProgressBar(size_t max_val, string prefix)
+	: m_counters(OpenMPConfig::getNumThreads())
 {
 	m_prefix = prefix;
 	m_maxVal = max_val;
-    m_currentVal = 0;
+	m_currentVal = 0;
 	m_percent = 0;
 
+	for(size_t i = 0; i < m_counters.size(); i++)
+	{
+		m_counters[i].value = 0;
+	}
+
+	// Update about 400 times per thread, i.e. several times per percent.
+	// The batch size is a power of two, so it can be checked with a mask.
+	m_batchSize = 1;
+	while(m_batchSize * 2 * 400 * m_counters.size() <= m_maxVal)
+	{
+		m_batchSize *= 2;
+	}
+	m_tail = m_maxVal <= 2 * m_batchSize * m_counters.size();
+
 	if(m_titleCallback)
 	{
 		// Remove time brackets
@@ -74,27 +91,55 @@ void ProgressBar::setProgressTitleCallback(ProgressTitleCallbackPtr ptr)
 
 void ProgressBar::operator++()
 {
-    boost::mutex::scoped_lock lock(m_mutex);
-
-    m_currentVal++;
-    short difference = (short)((float)m_currentVal/m_maxVal * 100 - m_percent);
-    if (difference < 1)
-    {
-        return;
-    }
-
-    while (difference >= 1)
-    {
-        m_percent++;
-        difference--;
-        print_bar();
-
-        if(m_progressCallback)
-        {
-        	m_progressCallback(m_percent);
-        }
-    }
+	size_t thread = OpenMPConfig::getThreadNum();
+	if(thread >= m_counters.size())
+	{
+		thread %= m_counters.size();
+	}
+
+	size_t local = m_counters[thread].value.fetch_add(1, std::memory_order_relaxed) + 1;
+
+	if((local & (m_batchSize - 1)) == 0 || m_tail.load(std::memory_order_relaxed))
+	{
+		update();
+	}
+}
+
+void ProgressBar::update()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+
+	size_t sum = 0;
+	for(size_t i = 0; i < m_counters.size(); i++)
+	{
+		sum += m_counters[i].value.load(std::memory_order_relaxed);
+	}
+	m_currentVal = std::max(m_currentVal, sum);
+
+	// Each thread has done less than a batch since its last update, so
+	// check every iteration when the rest fits into these batches
+	if(m_currentVal + 2 * m_batchSize * m_counters.size() >= m_maxVal)
+	{
+		m_tail = true;
+	}
 
+	short difference = (short)((float)m_currentVal/m_maxVal * 100 - m_percent);
+	if (difference < 1)
+	{
+		return;
+	}
+
+	while (difference >= 1)
+	{
+		m_percent++;
+		difference--;
+		print_bar();
+
+		if(m_progressCallback)
+		{
+			m_progressCallback(m_percent);
+		}
+	}
 }
 
 void ProgressBar::print_bar()
@@ -111,9 +156,7 @@ ProgressCounter::ProgressCounter(int stepVal, string prefix)
 
 void ProgressCounter::operator++()
 {
-	boost::mutex::scoped_lock lock(m_mutex);
-	m_currentVal++;
-	if(m_currentVal % m_stepVal == 0)
+	if((++m_currentVal) % m_stepVal == 0)
 	{
 		print_progress();
 	}
@@ -121,6 +164,7 @@ void ProgressCounter::operator++()
 
 void ProgressCounter::print_progress()
 {
+	boost::mutex::scoped_lock lock(m_mutex);
 	cout << "\r" << m_prefix << " " << m_currentVal << flush;
 }
 
@@ -100,7 +100,7 @@ Timestamp::Timestamp(): m_nullStream(&m_nullBuffer)
 
 unsigned long Timestamp::getCurrentTimeInMs() const
 {
-    static struct timeval tv;
+    struct timeval tv;
     gettimeofday( &tv, NULL );
     return tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
@@ -0,0 +1,69 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * LatticeEdge.cpp
+ */
+
+#include <lvr/reconstruction/LatticeEdge.hpp>
+
+#include <cmath>
+
+namespace lvr
+{
+
+namespace
+{
+
+/// Tolerance (in voxels) for a coordinate to be considered on the lattice
+const float LATTICE_EPSILON = 1e-3f;
+
+} // anonymous namespace
+
+bool latticeEdge(const float* v, const Vertexf& origin, float voxelsize, LatticeEdge& edge)
+{
+    int32_t c[3];
+    int free = -1;
+    for(int i = 0; i < 3; i++)
+    {
+        float t = (v[i] - origin[i]) / voxelsize - 0.5f;
+        float r = floorf(t + 0.5f);
+        if(fabs(t - r) < LATTICE_EPSILON)
+        {
+            c[i] = (int32_t)r;
+        }
+        else
+        {
+            if(free != -1)
+            {
+                return false;
+            }
+            free = i;
+            c[i] = (int32_t)floorf(t);
+        }
+    }
+
+    // Vertices exactly on a query point are assigned to the x edge
+    edge.x = c[0];
+    edge.y = c[1];
+    edge.z = c[2];
+    edge.axis = free == -1 ? 0 : free;
+    return true;
+}
+
+} // namespace lvr
@@ -0,0 +1,477 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * PlaneFitting.cpp
+ */
+
+#include <lvr/reconstruction/PlaneFitting.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace lvr
+{
+
+namespace
+{
+
+/**
+ * Accumulates the sums of the coordinates (s) and of all products of two
+ * coordinates (sxx ... szz) of the neighborhood relative to the query point.
+ */
+inline void accumulate(const float* points, const size_t* ids, size_t k, const float* query,
+                       float* s, float* sxx, float* syy, float* szz)
+{
+#if defined(__SSE__)
+    __m128 q   = _mm_set_ps(0.0f, query[2], query[1], query[0]);
+    __m128 as  = _mm_setzero_ps();
+    __m128 ax  = _mm_setzero_ps();
+    __m128 ay  = _mm_setzero_ps();
+    __m128 az  = _mm_setzero_ps();
+
+    for(size_t j = 0; j < k; j++)
+    {
+        const float* p = points + 3 * ids[j];
+        __m128 d = _mm_sub_ps(_mm_set_ps(0.0f, p[2], p[1], p[0]), q);
+
+        // One row of the outer product d * d^T per coordinate
+        as = _mm_add_ps(as, d);
+        ax = _mm_add_ps(ax, _mm_mul_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 0, 0))));
+        ay = _mm_add_ps(ay, _mm_mul_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1))));
+        az = _mm_add_ps(az, _mm_mul_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2))));
+    }
+
+    _mm_storeu_ps(s, as);
+    _mm_storeu_ps(sxx, ax);
+    _mm_storeu_ps(syy, ay);
+    _mm_storeu_ps(szz, az);
+#else
+    for(int i = 0; i < 4; i++)
+    {
+        s[i] = sxx[i] = syy[i] = szz[i] = 0.0f;
+    }
+
+    for(size_t j = 0; j < k; j++)
+    {
+        const float* p = points + 3 * ids[j];
+        float d[3] = {p[0] - query[0], p[1] - query[1], p[2] - query[2]};
+        for(int i = 0; i < 3; i++)
+        {
+            s[i]   += d[i];
+            sxx[i] += d[i] * d[0];
+            syy[i] += d[i] * d[1];
+            szz[i] += d[i] * d[2];
+        }
+    }
+#endif
+}
+
+/// Maximum number of neighborhood points used by fitPlaneRANSAC
+const size_t RANSAC_MAX_POINTS = 256;
+
+/**
+ * Scores the plane n * p = d against the points x, y, z. Returns the number
+ * of points closer than t and the sum of the distances truncated at t.
+ */
+inline void scorePlane(const float* x, const float* y, const float* z, size_t m,
+                       const float* n, float d, float t, size_t& inliers, float& cost)
+{
+    inliers = 0;
+    cost = 0.0f;
+
+    size_t i = 0;
+#if defined(__SSE__)
+    static const int bits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+    __m128 nx   = _mm_set1_ps(n[0]);
+    __m128 ny   = _mm_set1_ps(n[1]);
+    __m128 nz   = _mm_set1_ps(n[2]);
+    __m128 dd   = _mm_set1_ps(d);
+    __m128 tt   = _mm_set1_ps(t);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 acc  = _mm_setzero_ps();
+
+    for(; i + 4 <= m; i += 4)
+    {
+        __m128 dist = _mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(x + i)),
+                      _mm_add_ps(_mm_mul_ps(ny, _mm_loadu_ps(y + i)),
+                                 _mm_mul_ps(nz, _mm_loadu_ps(z + i))));
+        dist = _mm_andnot_ps(sign, _mm_sub_ps(dist, dd));
+
+        inliers += bits[_mm_movemask_ps(_mm_cmplt_ps(dist, tt))];
+        acc = _mm_add_ps(acc, _mm_min_ps(dist, tt));
+    }
+
+    float c[4];
+    _mm_storeu_ps(c, acc);
+    cost = (c[0] + c[1]) + (c[2] + c[3]);
+#endif
+    for(; i < m; i++)
+    {
+        float dist = fabs(n[0] * x[i] + n[1] * y[i] + n[2] * z[i] - d);
+        if(dist < t)
+        {
+            inliers++;
+        }
+        cost += std::min(dist, t);
+    }
+}
+
+/**
+ * Sums the coordinates (s) and the products of two coordinates (xx, xy, xz,
+ * yy, yz, zz in sxx) of all points closer than t to the plane n * p = d.
+ * Returns the number of these points.
+ */
+inline size_t accumulateInliers(const float* x, const float* y, const float* z, size_t m,
+                                const float* n, float d, float t, double* s, double* sxx)
+{
+    float fs[3]   = {0, 0, 0};
+    float fsxx[6] = {0, 0, 0, 0, 0, 0};
+    size_t count  = 0;
+
+    size_t i = 0;
+#if defined(__SSE__)
+    static const int bits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+    __m128 nx   = _mm_set1_ps(n[0]);
+    __m128 ny   = _mm_set1_ps(n[1]);
+    __m128 nz   = _mm_set1_ps(n[2]);
+    __m128 dd   = _mm_set1_ps(d);
+    __m128 tt   = _mm_set1_ps(t);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 acc[9];
+    for(int j = 0; j < 9; j++)
+    {
+        acc[j] = _mm_setzero_ps();
+    }
+
+    for(; i + 4 <= m; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+        __m128 dist = _mm_add_ps(_mm_mul_ps(nx, px),
+                      _mm_add_ps(_mm_mul_ps(ny, py), _mm_mul_ps(nz, pz)));
+        __m128 mask = _mm_cmplt_ps(_mm_andnot_ps(sign, _mm_sub_ps(dist, dd)), tt);
+        count += bits[_mm_movemask_ps(mask)];
+
+        // Outliers are zeroed
+        px = _mm_and_ps(px, mask);
+        py = _mm_and_ps(py, mask);
+        pz = _mm_and_ps(pz, mask);
+        acc[0] = _mm_add_ps(acc[0], px);
+        acc[1] = _mm_add_ps(acc[1], py);
+        acc[2] = _mm_add_ps(acc[2], pz);
+        acc[3] = _mm_add_ps(acc[3], _mm_mul_ps(px, px));
+        acc[4] = _mm_add_ps(acc[4], _mm_mul_ps(px, py));
+        acc[5] = _mm_add_ps(acc[5], _mm_mul_ps(px, pz));
+        acc[6] = _mm_add_ps(acc[6], _mm_mul_ps(py, py));
+        acc[7] = _mm_add_ps(acc[7], _mm_mul_ps(py, pz));
+        acc[8] = _mm_add_ps(acc[8], _mm_mul_ps(pz, pz));
+    }
+
+    for(int j = 0; j < 9; j++)
+    {
+        float c[4];
+        _mm_storeu_ps(c, acc[j]);
+        float sum = (c[0] + c[1]) + (c[2] + c[3]);
+        if(j < 3)
+        {
+            fs[j] = sum;
+        }
+        else
+        {
+            fsxx[j - 3] = sum;
+        }
+    }
+#endif
+    for(; i < m; i++)
+    {
+        if(fabs(n[0] * x[i] + n[1] * y[i] + n[2] * z[i] - d) < t)
+        {
+            fs[0] += x[i];
+            fs[1] += y[i];
+            fs[2] += z[i];
+            fsxx[0] += x[i] * x[i];
+            fsxx[1] += x[i] * y[i];
+            fsxx[2] += x[i] * z[i];
+            fsxx[3] += y[i] * y[i];
+            fsxx[4] += y[i] * z[i];
+            fsxx[5] += z[i] * z[i];
+            count++;
+        }
+    }
+
+    for(int j = 0; j < 3; j++)
+    {
+        s[j] = fs[j];
+    }
+    for(int j = 0; j < 6; j++)
+    {
+        sxx[j] = fsxx[j];
+    }
+    return count;
+}
+
+} // namespace
+
+bool fitPlane(const float* points, const size_t* ids, size_t k,
+              const float* query, float* normal, float* centroid)
+{
+    if(k < 3)
+    {
+        return false;
+    }
+
+    // Four floats each, the last one is unused
+    float s[4], sxx[4], syy[4], szz[4];
+    accumulate(points, ids, k, query, s, sxx, syy, szz);
+
+    // Mean and covariance of the neighborhood
+    double m[3] = {(double)s[0] / k, (double)s[1] / k, (double)s[2] / k};
+
+    Eigen::Matrix3d cov;
+    cov(0, 0) = sxx[0] / k - m[0] * m[0];
+    cov(0, 1) = sxx[1] / k - m[0] * m[1];
+    cov(0, 2) = sxx[2] / k - m[0] * m[2];
+    cov(1, 1) = syy[1] / k - m[1] * m[1];
+    cov(1, 2) = syy[2] / k - m[1] * m[2];
+    cov(2, 2) = szz[2] / k - m[2] * m[2];
+    cov(1, 0) = cov(0, 1);
+    cov(2, 0) = cov(0, 2);
+    cov(2, 1) = cov(1, 2);
+
+    if(cov.trace() <= 0)
+    {
+        return false;
+    }
+
+    // The eigenvalues are sorted in increasing order
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+    solver.computeDirect(cov);
+    Eigen::Vector3d n = solver.eigenvectors().col(0);
+
+    normal[0] = n[0];
+    normal[1] = n[1];
+    normal[2] = n[2];
+
+    if(centroid)
+    {
+        centroid[0] = query[0] + m[0];
+        centroid[1] = query[1] + m[1];
+        centroid[2] = query[2] + m[2];
+    }
+
+    return true;
+}
+
+void fitPlanes(const float* points, const size_t* ids, const size_t* offsets, size_t n,
+               const float* queries, float* normals, float* centroids)
+{
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(long i = 0; i < (long)n; i++)
+    {
+        float* centroid = centroids ? centroids + 3 * i : 0;
+        if(!fitPlane(points, ids + offsets[i], offsets[i + 1] - offsets[i],
+                     queries + 3 * i, normals + 3 * i, centroid))
+        {
+            normals[3 * i] = normals[3 * i + 1] = normals[3 * i + 2] = 0.0f;
+        }
+    }
+}
+
+bool fitPlaneRANSAC(const float* points, const size_t* ids, size_t k, FastRandom& random,
+                    float* normal, float* point, size_t maxIterations,
+                    float inlierRatio, float threshold)
+{
+    if(k < 3)
+    {
+        return false;
+    }
+
+    // Gather (a subsample of) the neighborhood relative to its first point
+    size_t m = std::min(k, RANSAC_MAX_POINTS);
+    float x[RANSAC_MAX_POINTS];
+    float y[RANSAC_MAX_POINTS];
+    float z[RANSAC_MAX_POINTS];
+
+    const float* origin = points + 3 * ids[0];
+    double c[3] = {0, 0, 0};
+    double r2 = 0;
+    for(size_t i = 0; i < m; i++)
+    {
+        const float* p = points + 3 * ids[i * k / m];
+        x[i] = p[0] - origin[0];
+        y[i] = p[1] - origin[1];
+        z[i] = p[2] - origin[2];
+        c[0] += x[i];
+        c[1] += y[i];
+        c[2] += z[i];
+        r2 += x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+    }
+    c[0] /= m;
+    c[1] /= m;
+    c[2] /= m;
+
+    // The inlier threshold is relative to the RMS radius of the neighborhood
+    r2 = r2 / m - (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    if(r2 <= 0)
+    {
+        return false;
+    }
+    float t = threshold * sqrt(r2);
+
+    float  bestCost = std::numeric_limits<float>::max();
+    float  bestNormal[3] = {0, 0, 0};
+    float  bestD = 0;
+    size_t iterations = maxIterations;
+
+    for(size_t it = 0; it < iterations; it++)
+    {
+        // Three distinct random points
+        uint32_t a = random.uniform(m);
+        uint32_t b = random.uniform(m - 1);
+        uint32_t d = random.uniform(m - 2);
+        if(b >= a) b++;
+        if(d >= std::min(a, b)) d++;
+        if(d >= std::max(a, b)) d++;
+
+        float e1[3] = {x[b] - x[a], y[b] - y[a], z[b] - z[a]};
+        float e2[3] = {x[d] - x[a], y[d] - y[a], z[d] - z[a]};
+        float n[3]  = {e1[1] * e2[2] - e1[2] * e2[1],
+                       e1[2] * e2[0] - e1[0] * e2[2],
+                       e1[0] * e2[1] - e1[1] * e2[0]};
+
+        // Skip (almost) collinear samples
+        float len2 = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        if(len2 <= 1e-8 * r2 * r2)
+        {
+            continue;
+        }
+
+        float len = sqrt(len2);
+        n[0] /= len;
+        n[1] /= len;
+        n[2] /= len;
+        float dist = n[0] * x[a] + n[1] * y[a] + n[2] * z[a];
+
+        size_t inliers;
+        float cost;
+        scorePlane(x, y, z, m, n, dist, t, inliers, cost);
+
+        if(cost < bestCost)
+        {
+            bestCost = cost;
+            bestNormal[0] = n[0];
+            bestNormal[1] = n[1];
+            bestNormal[2] = n[2];
+            bestD = dist;
+
+            double w = (double)inliers / m;
+            if(w >= inlierRatio)
+            {
+                break;
+            }
+
+            // Number of samples needed to draw three inliers with 99% confidence
+            double w3 = w * w * w;
+            if(w3 > 0)
+            {
+                double needed = ceil(log(0.01) / log(1.0 - w3));
+                iterations = std::min(iterations, (size_t)std::max(needed, (double)it + 1));
+            }
+        }
+    }
+
+    if(bestCost == std::numeric_limits<float>::max())
+    {
+        return false;
+    }
+
+    normal[0] = bestNormal[0];
+    normal[1] = bestNormal[1];
+    normal[2] = bestNormal[2];
+    point[0] = origin[0] + x[0];
+    point[1] = origin[1] + y[0];
+    point[2] = origin[2] + z[0];
+
+    // Refine with a least squares fit of the current inliers until the
+    // number of inliers does not change, at most twice
+    size_t lastCount = 0;
+    for(int round = 0; round < 2; round++)
+    {
+        double s[3];
+        double sxx[6];
+        size_t count = accumulateInliers(x, y, z, m, bestNormal, bestD, t, s, sxx);
+
+        if(count == 0 || count == lastCount)
+        {
+            break;
+        }
+        lastCount = count;
+
+        double mean[3] = {s[0] / count, s[1] / count, s[2] / count};
+        point[0] = origin[0] + mean[0];
+        point[1] = origin[1] + mean[1];
+        point[2] = origin[2] + mean[2];
+
+        if(count < 3)
+        {
+            break;
+        }
+
+        Eigen::Matrix3d cov;
+        cov(0, 0) = sxx[0] / count - mean[0] * mean[0];
+        cov(0, 1) = sxx[1] / count - mean[0] * mean[1];
+        cov(0, 2) = sxx[2] / count - mean[0] * mean[2];
+        cov(1, 1) = sxx[3] / count - mean[1] * mean[1];
+        cov(1, 2) = sxx[4] / count - mean[1] * mean[2];
+        cov(2, 2) = sxx[5] / count - mean[2] * mean[2];
+        cov(1, 0) = cov(0, 1);
+        cov(2, 0) = cov(0, 2);
+        cov(2, 1) = cov(1, 2);
+
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+        solver.computeDirect(cov);
+
+        // Keep the candidate if the inliers span no plane
+        if(!(solver.eigenvalues()(1) > 0))
+        {
+            break;
+        }
+
+        Eigen::Vector3d n = solver.eigenvectors().col(0);
+        bestNormal[0] = normal[0] = n[0];
+        bestNormal[1] = normal[1] = n[1];
+        bestNormal[2] = normal[2] = n[2];
+        bestD = n[0] * mean[0] + n[1] * mean[1] + n[2] * mean[2];
+    }
+
+    return true;
+}
+
+} // namespace lvr
@@ -0,0 +1,316 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * SpatialSort.cpp
+ */
+
+#include <lvr/reconstruction/SpatialSort.hpp>
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/config/lvropenmp.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/algorithm/string.hpp>
+
+namespace lvr
+{
+
+namespace
+{
+
+/// Number of bits per axis
+const int CODE_BITS = 21;
+
+/// Moves the lower 21 bits of v to every third bit
+inline uint64_t spreadBits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+    v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2)  & 0x1249249249249249ULL;
+    return v;
+}
+
+inline uint64_t mortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    return spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+}
+
+/**
+ * Hilbert code of a point, computed with the transposition algorithm of
+ * J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004
+ */
+inline uint64_t hilbertCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t X[3] = {x, y, z};
+    uint32_t M = 1u << (CODE_BITS - 1);
+
+    // Inverse undo
+    for(uint32_t Q = M; Q > 1; Q >>= 1)
+    {
+        uint32_t P = Q - 1;
+        for(int i = 0; i < 3; i++)
+        {
+            if(X[i] & Q)
+            {
+                X[0] ^= P;
+            }
+            else
+            {
+                uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for(uint32_t Q = M; Q > 1; Q >>= 1)
+    {
+        if(X[2] & Q)
+        {
+            t ^= Q - 1;
+        }
+    }
+    X[0] ^= t;
+    X[1] ^= t;
+    X[2] ^= t;
+
+    // The transposed index is interleaved with X[0] as the most significant axis
+    return spreadBits(X[2]) | (spreadBits(X[1]) << 1) | (spreadBits(X[0]) << 2);
+}
+
+/**
+ * Stable LSD radix sort of values by keys with 8 bit digits. Each chunk
+ * of the input is counted and scattered by one thread. Digits that are
+ * equal for all keys are skipped.
+ */
+void radixSort(vector<uint64_t>& keys, vector<size_t>& values)
+{
+    size_t n = keys.size();
+    vector<uint64_t> tmpKeys(n);
+    vector<size_t>   tmpValues(n);
+
+    int chunks = std::max(1, OpenMPConfig::getNumThreads());
+    size_t chunkSize = (n + chunks - 1) / chunks;
+    vector<size_t> hist(256 * chunks);
+
+    for(int shift = 0; shift < 64; shift += 8)
+    {
+        std::fill(hist.begin(), hist.end(), 0);
+
+        #pragma omp parallel for schedule(static, 1)
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t* h = &hist[256 * c];
+            size_t end = std::min(n, (c + 1) * chunkSize);
+            for(size_t i = c * chunkSize; i < end; i++)
+            {
+                h[(keys[i] >> shift) & 0xff]++;
+            }
+        }
+
+        // Skip the pass if all keys have the same digit
+        bool trivial = false;
+        for(int d = 0; d < 256 && !trivial; d++)
+        {
+            size_t count = 0;
+            for(int c = 0; c < chunks; c++)
+            {
+                count += hist[256 * c + d];
+            }
+            trivial = (count == n);
+        }
+        if(trivial)
+        {
+            continue;
+        }
+
+        // Start positions of each digit in each chunk
+        size_t sum = 0;
+        for(int d = 0; d < 256; d++)
+        {
+            for(int c = 0; c < chunks; c++)
+            {
+                size_t count = hist[256 * c + d];
+                hist[256 * c + d] = sum;
+                sum += count;
+            }
+        }
+
+        #pragma omp parallel for schedule(static, 1)
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t* h = &hist[256 * c];
+            size_t end = std::min(n, (c + 1) * chunkSize);
+            for(size_t i = c * chunkSize; i < end; i++)
+            {
+                size_t pos = h[(keys[i] >> shift) & 0xff]++;
+                tmpKeys[pos] = keys[i];
+                tmpValues[pos] = values[i];
+            }
+        }
+
+        keys.swap(tmpKeys);
+        values.swap(tmpValues);
+    }
+}
+
+/// Copies the channel src with the given number of elements per point
+template<typename T>
+boost::shared_array<T> permuteChannel(boost::shared_array<T> src, size_t n, size_t width,
+                                      const vector<size_t>& perm, bool inverse)
+{
+    boost::shared_array<T> dst(new T[width * n]);
+
+    #pragma omp parallel for schedule(static)
+    for(long i = 0; i < (long)n; i++)
+    {
+        size_t from = inverse ? i : perm[i];
+        size_t to   = inverse ? perm[i] : i;
+        for(size_t j = 0; j < width; j++)
+        {
+            dst[width * to + j] = src[width * from + j];
+        }
+    }
+
+    return dst;
+}
+
+} // namespace
+
+bool parseSpatialCurve(const string& name, SpatialCurve& curve)
+{
+    string lower = boost::algorithm::to_lower_copy(name);
+    if(lower == "morton")
+    {
+        curve = MORTON_CURVE;
+        return true;
+    }
+    if(lower == "hilbert")
+    {
+        curve = HILBERT_CURVE;
+        return true;
+    }
+    return false;
+}
+
+void spatialCodes(const float* points, size_t n, SpatialCurve curve, vector<uint64_t>& codes)
+{
+    codes.resize(n);
+    if(n == 0)
+    {
+        return;
+    }
+
+    float min[3], max[3];
+    for(int j = 0; j < 3; j++)
+    {
+        min[j] = std::numeric_limits<float>::max();
+        max[j] = -std::numeric_limits<float>::max();
+    }
+    for(size_t i = 0; i < n; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            min[j] = std::min(min[j], points[3 * i + j]);
+            max[j] = std::max(max[j], points[3 * i + j]);
+        }
+    }
+
+    // Quantize within the bounding cube to keep the curve isotropic
+    double extent = std::max(max[0] - min[0], std::max(max[1] - min[1], max[2] - min[2]));
+    double scale = extent > 0 ? ((1 << CODE_BITS) - 1) / extent : 0;
+
+    #pragma omp parallel for schedule(static)
+    for(long i = 0; i < (long)n; i++)
+    {
+        uint32_t q[3];
+        for(int j = 0; j < 3; j++)
+        {
+            q[j] = std::min((uint32_t)((points[3 * i + j] - min[j]) * scale), (1u << CODE_BITS) - 1);
+        }
+        codes[i] = curve == HILBERT_CURVE ? hilbertCode(q[0], q[1], q[2]) : mortonCode(q[0], q[1], q[2]);
+    }
+}
+
+void spatialOrder(const float* points, size_t n, SpatialCurve curve, vector<size_t>& perm)
+{
+    vector<uint64_t> codes;
+    spatialCodes(points, n, curve, codes);
+
+    perm.resize(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        perm[i] = i;
+    }
+
+    radixSort(codes, perm);
+}
+
+PointBufferPtr permutePointBuffer(PointBufferPtr buffer, const vector<size_t>& perm, bool inverse)
+{
+    PointBufferPtr result(new PointBuffer);
+
+    size_t n;
+    floatArr points = buffer->getPointArray(n);
+    if(n != perm.size())
+    {
+        std::cout << timestamp << "permutePointBuffer: Permutation has " << perm.size()
+                  << " entries, buffer has " << n << " points." << std::endl;
+        return buffer;
+    }
+    result->setPointArray(permuteChannel(points, n, 3, perm, inverse), n);
+
+    // Only channels with one entry per point can be permuted
+    size_t count;
+    floatArr normals = buffer->getPointNormalArray(count);
+    if(count == n)
+    {
+        result->setPointNormalArray(permuteChannel(normals, n, 3, perm, inverse), n);
+    }
+
+    ucharArr colors = buffer->getPointColorArray(count);
+    if(count == n)
+    {
+        result->setPointColorArray(permuteChannel(colors, n, 3, perm, inverse), n);
+    }
+
+    floatArr intensities = buffer->getPointIntensityArray(count);
+    if(count == n)
+    {
+        result->setPointIntensityArray(permuteChannel(intensities, n, 1, perm, inverse), n);
+    }
+
+    floatArr confidences = buffer->getPointConfidenceArray(count);
+    if(count == n)
+    {
+        result->setPointConfidenceArray(permuteChannel(confidences, n, 1, perm, inverse), n);
+    }
+
+    return result;
+}
+
+} // namespace lvr
@@ -27,6 +27,8 @@
 #include <lvr/texture/Statistics.hpp>
 #include <opencv/cv.h>
 
+#include <vector>
+
 using namespace std;
 
 namespace lvr {
@@ -633,6 +635,173 @@ float Statistics::calcMaxCorrelationCoefficient()
 	return result / 4;
 }
 
+void Statistics::calcFeatures(float* features)
+{
+	int n = this->m_numColors;
+	float** coocs[4] = {this->m_cooc0, this->m_cooc1, this->m_cooc2, this->m_cooc3};
+
+	double result[14];
+	for (int f = 0; f < 14; f++)
+	{
+		result[f] = 0;
+	}
+
+	vector<float> px(n), py(n), pxplusy(2 * n - 1), pxminusy(n);
+	vector<float> logPy(n);
+
+	for (int direction = 0; direction < 4; direction++)
+	{
+		float** com = coocs[direction];
+
+		//calculate all marginal distributions once
+		std::fill(px.begin(), px.end(), 0.0f);
+		std::fill(py.begin(), py.end(), 0.0f);
+		std::fill(pxplusy.begin(), pxplusy.end(), 0.0f);
+		std::fill(pxminusy.begin(), pxminusy.end(), 0.0f);
+		for (int i = 0; i < n; i++)
+		{
+			const float* row = com[i];
+			float rowSum = 0;
+			for (int j = 0; j < n; j++)
+			{
+				rowSum += row[j];
+				py[j] += row[j];
+			}
+			px[i] = rowSum;
+
+			for (int j = 0; j < n; j++)
+			{
+				pxplusy[i + j] += row[j];
+				pxminusy[abs(i - j)] += row[j];
+			}
+		}
+
+		//fused pass over the cooccurrence matrix
+		float asmSum = 0, contrast = 0, ijSum = 0, entropy = 0, trace = 0;
+		float hxy1 = 0, hxy2 = 0;
+		for (int j = 0; j < n; j++)
+		{
+			logPy[j] = log(py[j] + Statistics::epsilon);
+		}
+		for (int i = 0; i < n; i++)
+		{
+			const float* row = com[i];
+			float pi = px[i];
+			for (int j = 0; j < n; j++)
+			{
+				float c = row[j];
+				float d = i - j;
+				float pij = pi * py[j];
+				float logPij = log(pij + Statistics::epsilon);
+				asmSum   += c * c;
+				contrast += d * d * c;
+				ijSum    += i * j * c;
+				entropy  += c * log(c + Statistics::epsilon);
+				hxy1     += c * logPij;
+				hxy2     += pij * logPij;
+			}
+			trace += row[i];
+		}
+		entropy *= -1;
+		hxy1 *= -1;
+		hxy2 *= -1;
+
+		//features of the marginal distributions
+		float ux = 0, uy = 0, sx = 0, sy = 0, hx = 0, hy = 0, u = 0;
+		for (int i = 0; i < n; i++)
+		{
+			ux += px[i] / n;
+			uy += py[i] / n;
+			u  += px[i] / (n * n);
+			hx += px[i] * log(px[i] + Statistics::epsilon);
+			hy += py[i] * logPy[i];
+		}
+		hx *= -1;
+		hy *= -1;
+
+		float sumOfSquares = 0;
+		for (int i = 0; i < n; i++)
+		{
+			sx += (px[i] - ux) * (px[i] - ux);
+			sy += (py[i] - uy) * (py[i] - uy);
+			sumOfSquares += (i - u) * (i - u) * px[i];
+		}
+		sx = sqrt(sx);
+		sy = sqrt(sy);
+
+		float sumAvg = 0, sumEntropy = 0;
+		for (int k = 0; k < 2 * n - 1; k++)
+		{
+			sumAvg += k * pxplusy[k];
+			sumEntropy += pxplusy[k] * log(pxplusy[k] + Statistics::epsilon);
+		}
+		sumEntropy *= -1;
+
+		float sumVariance = 0;
+		for (int k = 0; k < 2 * n - 1; k++)
+		{
+			sumVariance += (k - sumEntropy) * (k - sumEntropy) * pxplusy[k];
+		}
+
+		float du = 0, diffVariance = 0, diffEntropy = 0;
+		for (int k = 0; k < n; k++)
+		{
+			du += pxminusy[k] / n;
+			diffEntropy += pxminusy[k] * log(pxminusy[k] + Statistics::epsilon);
+		}
+		for (int k = 0; k < n; k++)
+		{
+			diffVariance += (pxminusy[k] - du) * (pxminusy[k] - du);
+		}
+
+		//Q is not symmetric, px[i] only divides row i
+		cv::Mat Q(n, n, CV_64FC1);
+		for (int i = 0; i < n; i++)
+		{
+			for (int j = 0; j < n; j++)
+			{
+				double q = 0;
+				for (int k = 0; k < n; k++)
+				{
+					q += (com[i][k] * com[j][k]) / (px[i] * py[k] + Statistics::epsilon);
+				}
+				Q.at<double>(i,j) = q;
+			}
+		}
+
+		// The correlation sums (i * j * c - ux * uy) / (sx * sy) over all
+		// entries. The inverse difference of the single methods uses an
+		// integer division that only keeps the diagonal, i.e. the trace.
+		result[0]  += asmSum;
+		result[1]  += contrast;
+		result[2]  += (ijSum - n * n * ux * uy) / (sx * sy);
+		result[3]  += sumOfSquares;
+		result[4]  += trace;
+		result[5]  += sumAvg;
+		result[6]  += sumEntropy;
+		result[7]  += sumVariance;
+		result[8]  += entropy;
+		result[9]  += diffVariance;
+		result[10] -= diffEntropy;
+		result[11] += (entropy - hxy1) / max(hx, hy);
+		result[12] += sqrt(1 - exp(-2.0 * (hxy2 - entropy)));
+
+		// cv::eigen treats its input as symmetric, but Q is passed in full
+		// as in calcMaxCorrelationCoefficient, so that feature 13 keeps the
+		// values of the single method
+		cv::Mat E, V;
+		if (cv::eigen(Q, E, V))
+		{
+			result[13] += sqrt(E.at<double>(1,0));
+		}
+	}
+
+	for (int f = 0; f < 14; f++)
+	{
+		features[f] = result[f] / 4;
+	}
+}
+
 void Statistics::calcCooc(const cv::Mat &t)
 {
 	cv::Mat img(t);
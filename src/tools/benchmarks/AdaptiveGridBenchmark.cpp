@@ -0,0 +1,233 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * AdaptiveGridBenchmark.cpp
+ *
+ * Compares marching cubes on the uniform PointsetGrid with dual marching
+ * cubes on the AdaptiveGrid. The scene is a scanned room of 10 x 8 x 3 m
+ * with a ball on the floor, sampled from a scanner in the room center.
+ * For both meshes the number of cells and triangles, the time for grid,
+ * distance values and extraction, the number of border and non-manifold
+ * edges and the distance of the vertices to the true surface are printed.
+ *
+ * Usage: lvr_adaptivegrid_benchmark [point spacing] [voxelsize] [levels]
+ */
+#include <lvr/reconstruction/AdaptiveKSearchSurface.hpp>
+#include <lvr/reconstruction/AdaptiveReconstruction.hpp>
+#include <lvr/reconstruction/FastReconstruction.hpp>
+#include <lvr/reconstruction/PointsetGrid.hpp>
+#include <lvr/reconstruction/FastBox.hpp>
+#include <lvr/geometry/BaseMesh.hpp>
+#include <lvr/geometry/ColorVertex.hpp>
+#include <lvr/geometry/Normal.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+namespace
+{
+
+typedef ColorVertex<float, unsigned char> cVertex;
+typedef Normal<float> cNormal;
+typedef PointsetSurface<cVertex> psSurface;
+typedef AdaptiveKSearchSurface<cVertex, cNormal> akSurface;
+
+/// Center and radius of the ball
+const float BALL[4] = {2.0f, 1.0f, -0.8f, 0.6f};
+
+/// Collects vertices and triangles without building a half edge mesh
+class TriangleSoup : public BaseMesh<cVertex, cNormal>
+{
+public:
+    virtual void addVertex(cVertex v)
+    {
+        vertices.push_back(v[0]);
+        vertices.push_back(v[1]);
+        vertices.push_back(v[2]);
+    }
+    virtual void addNormal(cNormal n) {}
+    virtual void addTriangle(uint a, uint b, uint c)
+    {
+        faces.push_back(a);
+        faces.push_back(b);
+        faces.push_back(c);
+    }
+    virtual void flipEdge(uint v1, uint v2) {}
+    virtual void finalize() {}
+    virtual size_t meshSize() { return vertices.size() / 3; }
+
+    std::vector<float> vertices;
+    std::vector<uint>  faces;
+};
+
+/// Unsigned distance of a point to the walls of the room and the ball
+float surfaceDistance(float x, float y, float z)
+{
+    float walls = std::min(std::min(fabs(x + 5), fabs(x - 5)),
+                  std::min(std::min(fabs(y + 4), fabs(y - 4)),
+                           std::min(fabs(z + 1.5f), fabs(z - 1.5f))));
+    float dx = x - BALL[0], dy = y - BALL[1], dz = z - BALL[2];
+    float ball = fabs(sqrt(dx * dx + dy * dy + dz * dz) - BALL[3]);
+    return std::min(walls, ball);
+}
+
+/// Samples the room and the part of the ball that is visible from the origin
+PointBufferPtr createRoom(float spacing)
+{
+    std::vector<float> p;
+    for(float a = -5; a <= 5; a += spacing)
+    {
+        for(float b = -4; b <= 4; b += spacing)
+        {
+            float c[6] = {a, b, -1.5f, a, b, 1.5f};
+            p.insert(p.end(), c, c + 6);
+        }
+        for(float b = -1.5f; b <= 1.5f; b += spacing)
+        {
+            float c[6] = {a, -4, b, a, 4, b};
+            p.insert(p.end(), c, c + 6);
+        }
+    }
+    for(float a = -4; a <= 4; a += spacing)
+    {
+        for(float b = -1.5f; b <= 1.5f; b += spacing)
+        {
+            float c[6] = {-5, a, b, 5, a, b};
+            p.insert(p.end(), c, c + 6);
+        }
+    }
+
+    int n = (int)(4 * M_PI * BALL[3] * BALL[3] / (spacing * spacing));
+    for(int i = 0; i < n; i++)
+    {
+        float u = 2.0f * rand() / RAND_MAX - 1.0f;
+        float t = 2.0f * M_PI * rand() / RAND_MAX;
+        float r = sqrt(1.0f - u * u);
+        float d[3] = {r * cos(t), r * sin(t), u};
+        if(d[0] * BALL[0] + d[1] * BALL[1] + d[2] * BALL[2] > 0)
+        {
+            continue;
+        }
+        for(int j = 0; j < 3; j++)
+        {
+            p.push_back(BALL[j] + BALL[3] * d[j]);
+        }
+    }
+
+    size_t numPoints = p.size() / 3;
+    floatArr array(new float[p.size()]);
+    std::copy(p.begin(), p.end(), array.get());
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(array, numPoints);
+    return buffer;
+}
+
+void report(const char* name, size_t cells, double gridTime, double distanceTime,
+        double meshTime, TriangleSoup& mesh)
+{
+    std::map<std::pair<uint, uint>, int> edges;
+    for(size_t i = 0; i < mesh.faces.size(); i += 3)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            uint a = mesh.faces[i + j];
+            uint b = mesh.faces[i + (j + 1) % 3];
+            edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+    }
+    size_t border = 0, nonManifold = 0;
+    std::map<std::pair<uint, uint>, int>::iterator it;
+    for(it = edges.begin(); it != edges.end(); it++)
+    {
+        border += it->second == 1;
+        nonManifold += it->second > 2;
+    }
+
+    std::vector<float> errors;
+    for(size_t i = 0; i < mesh.vertices.size(); i += 3)
+    {
+        errors.push_back(surfaceDistance(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]));
+    }
+    std::sort(errors.begin(), errors.end());
+    size_t n = errors.size();
+
+    cout << name << "\t" << cells << "\t" << mesh.faces.size() / 3 << "\t"
+         << gridTime << "\t" << distanceTime << "\t" << meshTime << "\t"
+         << border << "\t" << nonManifold << "\t"
+         << (n ? errors[n / 2] : 0) << "\t" << (n ? errors[n * 9 / 10] : 0) << "\t"
+         << (n ? errors[n * 99 / 100] : 0) << endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    float spacing   = argc > 1 ? atof(argv[1]) : 0.04f;
+    float voxelsize = argc > 2 ? atof(argv[2]) : 0.08f;
+    int   levels    = argc > 3 ? atoi(argv[3]) : 4;
+
+    PointBufferPtr buffer = createRoom(spacing);
+    psSurface::Ptr surface(new akSurface(buffer, "NANOFLANN", 10, 10, 5));
+    surface->calculateSurfaceNormals();
+    BoundingBox<cVertex> bb = surface->getBoundingBox();
+
+    cout << timestamp << buffer->getNumPoints() << " points, voxelsize " << voxelsize
+         << ", " << levels << " levels" << endl;
+
+    Timestamp ts;
+    PointsetGrid<cVertex, FastBox<cVertex, cNormal> > grid(voxelsize, surface, bb, true, true);
+    double gridTime = ts.getElapsedTimeInMs();
+    ts.resetTimer();
+    grid.calcDistanceValues();
+    double distanceTime = ts.getElapsedTimeInMs();
+    ts.resetTimer();
+    FastReconstruction<cVertex, cNormal, FastBox<cVertex, cNormal> > reconstruction(&grid);
+    TriangleSoup mesh;
+    reconstruction.getMesh(mesh);
+    double meshTime = ts.getElapsedTimeInMs();
+
+    ts.resetTimer();
+    AdaptiveGrid<cVertex> adaptiveGrid(voxelsize, surface, bb, levels);
+    double adaptiveGridTime = ts.getElapsedTimeInMs();
+    ts.resetTimer();
+    adaptiveGrid.calcDistanceValues();
+    double adaptiveDistanceTime = ts.getElapsedTimeInMs();
+    ts.resetTimer();
+    AdaptiveReconstruction<cVertex, cNormal> adaptiveReconstruction(&adaptiveGrid);
+    TriangleSoup adaptiveMesh;
+    adaptiveReconstruction.getMesh(adaptiveMesh);
+    double adaptiveMeshTime = ts.getElapsedTimeInMs();
+
+    cout << "method\tcells\ttriangles\tgrid [ms]\tdistances [ms]\tmesh [ms]\tborder edges\tnon-manifold edges"
+         << "\terror median\terror 90%\terror 99%" << endl;
+    report("MC", grid.getNumberOfCells(), gridTime, distanceTime, meshTime, mesh);
+    report("DMC", adaptiveGrid.getNumberOfCells(), adaptiveGridTime, adaptiveDistanceTime, adaptiveMeshTime, adaptiveMesh);
+
+    return 0;
+}
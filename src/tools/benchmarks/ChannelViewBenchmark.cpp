@@ -0,0 +1,106 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * ChannelViewBenchmark.cpp
+ *
+ * Compares the access of point normals through the shared array getters
+ * of PointBuffer with the access through a channel view. The access
+ * pattern mimics PointsetSurface::getInterpolatedNormal: every thread
+ * averages the normals of k neighbors for many query points.
+ */
+#include <lvr/io/PointBuffer.hpp>
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/config/lvropenmp.hpp>
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+int main(int argc, char** argv)
+{
+    size_t numPoints  = argc > 1 ? atol(argv[1]) : 1000000;
+    size_t numQueries = argc > 2 ? atol(argv[2]) : 1000000;
+    const size_t k = 20;
+
+    floatArr normals(new float[3 * numPoints]);
+    for(size_t i = 0; i < 3 * numPoints; i++)
+    {
+        normals[i] = (float)rand() / RAND_MAX;
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointNormalArray(normals, numPoints);
+
+    std::vector<size_t> neighbors(numQueries * k);
+    for(size_t i = 0; i < neighbors.size(); i++)
+    {
+        neighbors[i] = rand() % numPoints;
+    }
+
+    cout << timestamp << numPoints << " normals, " << numQueries << " queries, k = " << k << endl;
+    cout << "threads\tgetter [ms]\tview [ms]\tspeedup" << endl;
+
+    for(int threads = 1; threads <= OpenMPConfig::getNumThreads(); threads *= 2)
+    {
+        OpenMPConfig::setNumThreads(threads);
+        float sumGetter = 0.0f;
+        float sumView = 0.0f;
+
+        Timestamp ts;
+        #pragma omp parallel for reduction(+:sumGetter)
+        for(long q = 0; q < (long)numQueries; q++)
+        {
+            size_t n;
+            for(size_t j = 0; j < k; j++)
+            {
+                size_t idx = neighbors[q * k + j];
+                sumGetter += buffer->getIndexedPointNormalArray(n)[idx][0];
+                sumGetter += buffer->getIndexedPointNormalArray(n)[idx][1];
+                sumGetter += buffer->getIndexedPointNormalArray(n)[idx][2];
+            }
+        }
+        double getterTime = ts.getElapsedTimeInMs();
+
+        ts.resetTimer();
+        floatView view = buffer->getPointNormalView();
+        #pragma omp parallel for reduction(+:sumView)
+        for(long q = 0; q < (long)numQueries; q++)
+        {
+            for(size_t j = 0; j < k; j++)
+            {
+                const float* n = view[neighbors[q * k + j]];
+                sumView += n[0];
+                sumView += n[1];
+                sumView += n[2];
+            }
+        }
+        double viewTime = ts.getElapsedTimeInMs();
+
+        cout << threads << "\t" << getterTime << "\t\t" << viewTime << "\t\t"
+             << (viewTime > 0 ? getterTime / viewTime : 0.0)
+             << (fabs(sumGetter - sumView) <= 1e-3 * fabs(sumGetter) ? "" : "\t(checksum differs)") << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,322 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * IncrementalGridBenchmark.cpp
+ *
+ * Compares a full rebuild of normals, grid, distance values and mesh with
+ * the incremental update when a small scan is added to a site. The update
+ * builds a search tree only for the site points around the scan, updates
+ * the grid by PointsetGrid::addPoints and splices the surface of the
+ * updated cells into the mesh of the site. The site is a noisy unit
+ * sphere, the added scan covers the cap above a given height. The distance
+ * values of both grids are compared for every query point and the meshes
+ * are compared by their numbers of faces and border edges.
+ *
+ * Usage: lvr_incrementalgrid_benchmark [points] [voxelsize] [cap height]
+ */
+#include <lvr/reconstruction/AdaptiveKSearchSurface.hpp>
+#include <lvr/reconstruction/PointsetGrid.hpp>
+#include <lvr/reconstruction/FastReconstruction.hpp>
+#include <lvr/reconstruction/FastBox.hpp>
+#include <lvr/geometry/HalfEdgeMesh.hpp>
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/geometry/ColorVertex.hpp>
+#include <lvr/geometry/Normal.hpp>
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+namespace
+{
+
+typedef ColorVertex<float, unsigned char> cVertex;
+typedef Normal<float> cNormal;
+typedef PointsetSurface<cVertex> psSurface;
+typedef AdaptiveKSearchSurface<cVertex, cNormal> akSurface;
+typedef FastBox<cVertex, cNormal> fBox;
+typedef PointsetGrid<cVertex, fBox> psGrid;
+typedef FastReconstruction<cVertex, cNormal, fBox> fReconstruction;
+typedef HalfEdgeMesh<cVertex, cNormal> hMesh;
+
+/// Lexicographic order of query point positions
+struct PositionLess
+{
+    bool operator()(const cVertex& a, const cVertex& b) const
+    {
+        if(a[0] != b[0]) return a[0] < b[0];
+        if(a[1] != b[1]) return a[1] < b[1];
+        return a[2] < b[2];
+    }
+};
+
+/// Creates a point buffer from n interleaved points
+PointBufferPtr createBuffer(const std::vector<float>& points, size_t n)
+{
+    floatArr array(new float[3 * n]);
+    for(size_t i = 0; i < 3 * n; i++)
+    {
+        array[i] = points[i];
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(array, n);
+    return buffer;
+}
+
+psSurface::Ptr createSurface(PointBufferPtr buffer)
+{
+    return psSurface::Ptr(new akSurface(buffer, "NANOFLANN", 10, 10, 5));
+}
+
+/**
+ * Creates a buffer of the site points within the margin around the voxels
+ * of the scan, followed by the points of the scan. The normals of the site
+ * points are copied, the normals of the scan are zero.
+ */
+PointBufferPtr createLocalBuffer(psSurface::Ptr site, const std::vector<float>& scan,
+                                 float voxelsize, float margin, size_t& numLocal)
+{
+    std::set<std::vector<int> > voxels;
+    std::vector<int> voxel(3);
+    for(size_t i = 0; i < scan.size(); i += 3)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            voxel[k] = (int)floorf(scan[i + k] / voxelsize);
+        }
+        voxels.insert(voxel);
+    }
+
+    std::unordered_set<size_t> found;
+    std::vector<size_t> indices;
+    float r = margin + 0.5f * sqrtf(3.0f) * voxelsize;
+    for(std::set<std::vector<int> >::iterator it = voxels.begin(); it != voxels.end(); it++)
+    {
+        float center[3];
+        for(int k = 0; k < 3; k++)
+        {
+            center[k] = ((*it)[k] + 0.5f) * voxelsize;
+        }
+        site->searchTree()->radiusSearch(center, r, indices);
+        found.insert(indices.begin(), indices.end());
+    }
+
+    size_t n, nn;
+    floatArr sitePoints = site->pointBuffer()->getPointArray(n);
+    floatArr siteNormals = site->pointBuffer()->getPointNormalArray(nn);
+
+    numLocal = found.size();
+    size_t total = numLocal + scan.size() / 3;
+    floatArr points(new float[3 * total]);
+    floatArr normals(new float[3 * total]);
+    size_t j = 0;
+    for(std::unordered_set<size_t>::iterator it = found.begin(); it != found.end(); it++, j++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            points[3 * j + k] = sitePoints[3 * *it + k];
+            normals[3 * j + k] = siteNormals[3 * *it + k];
+        }
+    }
+    for(size_t i = 0; i < scan.size(); i++)
+    {
+        points[3 * numLocal + i] = scan[i];
+        normals[3 * numLocal + i] = 0.0f;
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(points, total);
+    buffer->setPointNormalArray(normals, total);
+    return buffer;
+}
+
+/// Extracts the whole surface of a grid
+MeshBufferPtr extractMesh(psGrid& grid, psSurface::Ptr surface)
+{
+    hMesh mesh(surface);
+    fReconstruction reconstruction(&grid);
+    reconstruction.getMesh(mesh);
+    mesh.finalize();
+    return mesh.meshBuffer();
+}
+
+/// Counts the edges that belong to only one triangle
+size_t countBorderEdges(MeshBufferPtr mesh)
+{
+    size_t numFaces;
+    uintArr faces = mesh->getFaceArray(numFaces);
+
+    std::map<std::pair<unsigned int, unsigned int>, int> edges;
+    for(size_t i = 0; i < numFaces; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            unsigned int a = faces[3 * i + j];
+            unsigned int b = faces[3 * i + (j + 1) % 3];
+            edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+    }
+
+    size_t count = 0;
+    std::map<std::pair<unsigned int, unsigned int>, int>::iterator it;
+    for(it = edges.begin(); it != edges.end(); it++)
+    {
+        count += it->second == 1;
+    }
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t numPoints = argc > 1 ? atoi(argv[1]) : 200000;
+    float  voxelsize = argc > 2 ? atof(argv[2]) : 0.05f;
+    float  cap       = argc > 3 ? atof(argv[3]) : 0.9f;
+
+    // Points of the site first, points of the added scan at the end
+    std::vector<float> site, scan;
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        float x, y, z, l;
+        do
+        {
+            x = 2.0f * rand() / RAND_MAX - 1.0f;
+            y = 2.0f * rand() / RAND_MAX - 1.0f;
+            z = 2.0f * rand() / RAND_MAX - 1.0f;
+            l = sqrt(x * x + y * y + z * z);
+        }
+        while(l > 1.0f || l < 1e-3f);
+
+        float r = 1.0f + 0.001f * rand() / RAND_MAX;
+        std::vector<float>& target = z / l < cap ? site : scan;
+        target.push_back(r * x / l);
+        target.push_back(r * y / l);
+        target.push_back(r * z / l);
+    }
+    size_t numSite = site.size() / 3;
+    size_t numScan = scan.size() / 3;
+    std::vector<float> all(site);
+    all.insert(all.end(), scan.begin(), scan.end());
+
+    cout << timestamp << numSite << " site points, " << numScan << " added points, voxelsize "
+         << voxelsize << endl;
+
+    // Full rebuild with all points
+    Timestamp ts;
+    psSurface::Ptr full = createSurface(createBuffer(all, numSite + numScan));
+    full->calculateSurfaceNormals();
+    BoundingBox<cVertex> bb = full->getBoundingBox();
+    psGrid fullGrid(voxelsize, full, bb, true, true);
+    fullGrid.calcDistanceValues();
+    MeshBufferPtr fullMesh = extractMesh(fullGrid, full);
+    double fullTime = ts.getElapsedTimeInMs();
+
+    // Site without the added scan. The grid covers the whole bounding box.
+    psSurface::Ptr initial = createSurface(createBuffer(site, numSite));
+    initial->calculateSurfaceNormals();
+    psGrid grid(voxelsize, initial, bb, true, true);
+    grid.calcDistanceValues();
+    MeshBufferPtr siteMesh = extractMesh(grid, initial);
+
+    // Incremental update: keep the normals of the site and estimate only
+    // the normals of the new points. The search tree contains only the
+    // site points within the update radius of two voxels and the reach
+    // of the kd nearest neighbors around the scan.
+    ts.resetTimer();
+    size_t numLocal;
+    PointBufferPtr local = createLocalBuffer(initial, scan, voxelsize, 4 * voxelsize, numLocal);
+    akSurface* aks = new akSurface(local, "NANOFLANN", 10, 10, 5);
+    psSurface::Ptr updated(aks);
+    aks->calculateSurfaceNormals(numLocal);
+    size_t numUpdated = grid.addPoints(updated, numLocal);
+
+    hMesh fragment(updated);
+    fReconstruction reconstruction(&grid);
+    reconstruction.getMesh(fragment, grid.getUpdatedCells());
+    fragment.finalize();
+    MeshBufferPtr splicedMesh = reconstruction.spliceMesh(siteMesh, fragment.meshBuffer(), grid.getUpdatedCells());
+    double updateTime = ts.getElapsedTimeInMs();
+
+    // Compare the distance values at equal positions
+    std::map<cVertex, size_t, PositionLess> fullIndex;
+    std::vector<QueryPoint<cVertex> >& fullPoints = fullGrid.getQueryPoints();
+    for(size_t i = 0; i < fullPoints.size(); i++)
+    {
+        fullIndex[fullPoints[i].m_position] = i;
+    }
+
+    std::vector<QueryPoint<cVertex> >& points = grid.getQueryPoints();
+    size_t missing = 0, invalidMismatch = 0;
+    double maxDeviation = 0, meanDeviation = 0;
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        std::map<cVertex, size_t, PositionLess>::iterator it = fullIndex.find(points[i].m_position);
+        if(it == fullIndex.end())
+        {
+            missing++;
+            continue;
+        }
+
+        const QueryPoint<cVertex>& q = fullPoints[it->second];
+        if(q.m_invalid != points[i].m_invalid)
+        {
+            invalidMismatch++;
+        }
+        if(!q.m_invalid && !points[i].m_invalid)
+        {
+            double d = fabs(q.m_distance - points[i].m_distance);
+            maxDeviation = std::max(maxDeviation, d);
+            meanDeviation += d;
+        }
+    }
+    meanDeviation /= std::max((size_t)1, points.size());
+
+    size_t n;
+    fullMesh->getFaceArray(n);
+    size_t fullFaces = n;
+    splicedMesh->getFaceArray(n);
+    size_t splicedFaces = n;
+
+    cout << "method\t\tquery points\tupdated\t\tfaces\t\ttime [ms]" << endl;
+    cout << "full rebuild\t" << fullPoints.size() << "\t\t" << fullPoints.size() << "\t\t"
+         << fullFaces << "\t\t" << fullTime << endl;
+    cout << "incremental\t" << points.size() << "\t\t" << numUpdated << "\t\t"
+         << splicedFaces << "\t\t" << updateTime << endl;
+    cout << "site points in the search tree of the update: " << numLocal << " of " << numSite
+         << ", re-extracted cells: " << grid.getUpdatedCells().size() << " of " << grid.getNumberOfCells() << endl;
+    cout << "query points missing in the update: " << missing
+         << ", differing invalid flags: " << invalidMismatch << endl;
+    cout << "distance deviation mean: " << meanDeviation << ", max.: " << maxDeviation
+         << " (" << maxDeviation / voxelsize << " voxels)" << endl;
+    cout << "border edges full rebuild: " << countBorderEdges(fullMesh)
+         << ", incremental: " << countBorderEdges(splicedMesh) << endl;
+    cout << "speedup: " << (updateTime > 0 ? fullTime / updateTime : 0.0) << endl;
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * PlaneFitBenchmark.cpp
+ *
+ * Compares the normals of the least squares height field fit that was used
+ * by AdaptiveKSearchSurface::calcPlane before with the covariance based
+ * fitPlane and fitPlanes kernels and with fitPlaneRANSAC. The neighborhoods
+ * are noisy samples of randomly oriented planes, so the deviation from the
+ * true normal is reported for all methods.
+ */
+#include <lvr/reconstruction/PlaneFitting.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <Eigen/Dense>
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+namespace
+{
+
+float uniform()
+{
+    return (float)rand() / RAND_MAX;
+}
+
+/// The normal of the former height field fit y = C0 + C1 * x + C2 * z
+void fitHeightField(const float* points, const size_t* ids, size_t k, const float* query, float* normal)
+{
+    float epsilon = 100.0;
+
+    Eigen::Vector3f C;
+    Eigen::VectorXf F(k);
+    Eigen::MatrixXf B(k, 3);
+
+    for(size_t j = 0; j < k; j++)
+    {
+        const float* p = points + 3 * ids[j];
+        F(j)    = p[1];
+        B(j, 0) = 1.0f;
+        B(j, 1) = p[0];
+        B(j, 2) = p[2];
+    }
+
+    C = B.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(F);
+
+    float z1 = C(0) + C(1) * (query[0] + epsilon) + C(2) * query[2];
+    float z2 = C(0) + C(1) * query[0] + C(2) * (query[2] + epsilon);
+
+    Eigen::Vector3f diff1(epsilon, z1 - query[1], 0);
+    Eigen::Vector3f diff2(0, z2 - query[1], epsilon);
+    Eigen::Vector3f n = diff1.cross(diff2).normalized();
+
+    normal[0] = n[0];
+    normal[1] = n[1];
+    normal[2] = n[2];
+}
+
+/// Angle between two unoriented unit normals in degrees
+double angle(const float* a, const float* b)
+{
+    double d = fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+    return acos(std::min(1.0, d)) * 180.0 / M_PI;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int    numPlanes = argc > 1 ? atoi(argv[1]) : 100000;
+    int    k         = argc > 2 ? atoi(argv[2]) : 20;
+    double noise     = argc > 3 ? atof(argv[3]) : 0.01;
+    float  offset    = argc > 4 ? atof(argv[4]) : 100.0f;
+
+    // Neighborhoods of k points in a unit square of a random plane, placed
+    // up to offset units away from the origin. Some planes are almost
+    // parallel to the y axis, where the height field fit is ill-conditioned.
+    std::vector<float>  points(3 * numPlanes * k);
+    std::vector<float>  queries(3 * numPlanes);
+    std::vector<float>  truth(3 * numPlanes);
+    std::vector<size_t> ids(numPlanes * k);
+    std::vector<size_t> offsets(numPlanes + 1);
+
+    for(int i = 0; i < numPlanes; i++)
+    {
+        Eigen::Vector3f n = Eigen::Vector3f::Random().normalized();
+        Eigen::Vector3f u = n.unitOrthogonal();
+        Eigen::Vector3f v = n.cross(u);
+        Eigen::Vector3f c = Eigen::Vector3f::Random() * offset;
+
+        for(int j = 0; j < k; j++)
+        {
+            Eigen::Vector3f p = c + u * (uniform() - 0.5f) + v * (uniform() - 0.5f)
+                              + n * (float)(noise * (uniform() - 0.5f));
+            size_t id = i * k + j;
+            points[3 * id]     = p[0];
+            points[3 * id + 1] = p[1];
+            points[3 * id + 2] = p[2];
+            ids[id] = id;
+        }
+
+        // The first neighbor is the query point
+        queries[3 * i]     = points[3 * i * k];
+        queries[3 * i + 1] = points[3 * i * k + 1];
+        queries[3 * i + 2] = points[3 * i * k + 2];
+        truth[3 * i]     = n[0];
+        truth[3 * i + 1] = n[1];
+        truth[3 * i + 2] = n[2];
+        offsets[i] = i * k;
+    }
+    offsets[numPlanes] = numPlanes * k;
+
+    cout << timestamp << numPlanes << " neighborhoods of " << k << " points, noise "
+         << noise << ", offset " << offset << endl;
+
+    std::vector<float> svd(3 * numPlanes);
+    std::vector<float> cov(3 * numPlanes);
+    std::vector<float> batch(3 * numPlanes);
+    std::vector<float> ransac(3 * numPlanes);
+
+    Timestamp ts;
+    for(int i = 0; i < numPlanes; i++)
+    {
+        fitHeightField(&points[0], &ids[offsets[i]], k, &queries[3 * i], &svd[3 * i]);
+    }
+    double svdTime = ts.getElapsedTimeInMs();
+
+    ts.resetTimer();
+    for(int i = 0; i < numPlanes; i++)
+    {
+        fitPlane(&points[0], &ids[offsets[i]], k, &queries[3 * i], &cov[3 * i]);
+    }
+    double covTime = ts.getElapsedTimeInMs();
+
+    ts.resetTimer();
+    fitPlanes(&points[0], &ids[0], &offsets[0], numPlanes, &queries[0], &batch[0]);
+    double batchTime = ts.getElapsedTimeInMs();
+
+    ts.resetTimer();
+    for(int i = 0; i < numPlanes; i++)
+    {
+        FastRandom random(i);
+        float point[3];
+        fitPlaneRANSAC(&points[0], &ids[offsets[i]], k, random, &ransac[3 * i], point);
+    }
+    double ransacTime = ts.getElapsedTimeInMs();
+
+    // Mean and maximum angular errors in degrees
+    double svdMean = 0, svdMax = 0;
+    double covMean = 0, covMax = 0;
+    double ransacMean = 0, ransacMax = 0;
+    double batchDev = 0;
+    for(int i = 0; i < numPlanes; i++)
+    {
+        double a = angle(&svd[3 * i], &truth[3 * i]);
+        double b = angle(&cov[3 * i], &truth[3 * i]);
+        double c = angle(&ransac[3 * i], &truth[3 * i]);
+        svdMean += a;
+        covMean += b;
+        ransacMean += c;
+        svdMax = std::max(svdMax, a);
+        covMax = std::max(covMax, b);
+        ransacMax = std::max(ransacMax, c);
+        for(int j = 0; j < 3; j++)
+        {
+            batchDev = std::max(batchDev, (double)fabs(cov[3 * i + j] - batch[3 * i + j]));
+        }
+    }
+    svdMean /= numPlanes;
+    covMean /= numPlanes;
+    ransacMean /= numPlanes;
+
+    cout << "method\t\tmean error [deg]\tmax. error [deg]\ttime [ms]" << endl;
+    cout << "height field\t" << svdMean << "\t\t" << svdMax << "\t\t\t" << svdTime << endl;
+    cout << "fitPlane\t" << covMean << "\t\t" << covMax << "\t\t\t" << covTime << endl;
+    cout << "fitPlanes\t" << "\t\t\t\t\t\t" << batchTime << endl;
+    cout << "fitPlaneRANSAC\t" << ransacMean << "\t\t" << ransacMax << "\t\t\t" << ransacTime << endl;
+    cout << "max. deviation fitPlane / fitPlanes: " << batchDev << endl;
+    cout << "speedup fitPlane: " << (covTime > 0 ? svdTime / covTime : 0.0)
+         << ", fitPlanes: " << (batchTime > 0 ? svdTime / batchTime : 0.0) << endl;
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * SpatialSortBenchmark.cpp
+ *
+ * Measures the wall time and the cache misses of a normal estimation
+ * (k nearest neighbors and a plane fit for every point) on a point cloud
+ * in scanner like random order and after sorting it along a Morton and a
+ * Hilbert curve. Cache misses are read from the Linux performance
+ * counters and reported as n/a where they are not available.
+ *
+ * Usage: lvr_spatialsort_benchmark [input file] [k]. Without an input
+ * file, one million points on a noisy sphere are used.
+ */
+#include <lvr/reconstruction/SpatialSort.hpp>
+#include <lvr/reconstruction/PlaneFitting.hpp>
+#include <lvr/reconstruction/SearchTreeNanoflann.hpp>
+#include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/geometry/ColorVertex.hpp>
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+namespace
+{
+
+typedef ColorVertex<float, unsigned char> cVertex;
+
+/// Counts the hardware cache misses of the process and its threads
+class CacheMissCounter
+{
+public:
+    CacheMissCounter() : m_fd(-1)
+    {
+#if defined(__linux__)
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled       = 1;
+        attr.inherit        = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        m_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CacheMissCounter()
+    {
+#if defined(__linux__)
+        if(m_fd >= 0) close(m_fd);
+#endif
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        if(m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /// Returns the number of misses since start() or -1 if not available
+    long long stop()
+    {
+        long long count = -1;
+#if defined(__linux__)
+        if(m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if(read(m_fd, &count, sizeof(count)) != sizeof(count))
+            {
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int m_fd;
+};
+
+/// Random points on a noisy unit sphere
+PointBufferPtr createSphere(size_t n)
+{
+    floatArr points(new float[3 * n]);
+    for(size_t i = 0; i < n; i++)
+    {
+        float x, y, z, l;
+        do
+        {
+            x = 2.0f * rand() / RAND_MAX - 1.0f;
+            y = 2.0f * rand() / RAND_MAX - 1.0f;
+            z = 2.0f * rand() / RAND_MAX - 1.0f;
+            l = sqrt(x * x + y * y + z * z);
+        }
+        while(l > 1.0f || l < 1e-3f);
+
+        float r = 1.0f + 0.001f * rand() / RAND_MAX;
+        points[3 * i]     = r * x / l;
+        points[3 * i + 1] = r * y / l;
+        points[3 * i + 2] = r * z / l;
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(points, n);
+    return buffer;
+}
+
+/// Estimates a normal for every point and reports time and cache misses
+void run(const char* name, PointBufferPtr buffer, size_t k, double sortTime)
+{
+    size_t n;
+    floatArr points = buffer->getPointArray(n);
+
+    Timestamp ts;
+    SearchTreeNanoflann<cVertex> tree(buffer, n, k, k, k);
+    double buildTime = ts.getElapsedTimeInMs();
+
+    CacheMissCounter counter;
+    counter.start();
+    ts.resetTimer();
+
+    double checksum = 0;
+    #pragma omp parallel reduction(+:checksum)
+    {
+        vector<size_t> ids;
+        vector<float> distances;
+
+        #pragma omp for schedule(static)
+        for(long i = 0; i < (long)n; i++)
+        {
+            coord<float> qp;
+            qp[0] = points[3 * i];
+            qp[1] = points[3 * i + 1];
+            qp[2] = points[3 * i + 2];
+            tree.kSearch(qp, k, ids, distances);
+
+            float normal[3] = {0, 0, 0};
+            fitPlane(points.get(), &ids[0], ids.size(), &points[3 * i], normal);
+            checksum += fabs(normal[0]) + fabs(normal[1]) + fabs(normal[2]);
+        }
+    }
+
+    double searchTime = ts.getElapsedTimeInMs();
+    long long misses = counter.stop();
+
+    cout << name << "\t\t" << sortTime << "\t\t" << buildTime << "\t\t" << searchTime << "\t\t";
+    if(misses >= 0)
+    {
+        cout << misses;
+    }
+    else
+    {
+        cout << "n/a";
+    }
+    cout << "\t\t" << checksum / n << endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    PointBufferPtr buffer;
+    if(argc > 1)
+    {
+        ModelPtr model = ModelFactory::readModel(argv[1]);
+        if(!model || !model->m_pointCloud)
+        {
+            cout << timestamp << "Unable to read points from " << argv[1] << endl;
+            return -1;
+        }
+        buffer = model->m_pointCloud;
+    }
+    else
+    {
+        buffer = createSphere(1000000);
+    }
+    size_t k = argc > 2 ? atoi(argv[2]) : 20;
+
+    // Simulate an unsorted input
+    size_t n;
+    floatArr points = buffer->getPointArray(n);
+    vector<size_t> shuffle(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        shuffle[i] = i;
+    }
+    std::random_shuffle(shuffle.begin(), shuffle.end());
+    buffer = permutePointBuffer(buffer, shuffle);
+    points = buffer->getPointArray(n);
+
+    cout << timestamp << n << " points, k = " << k << endl;
+    cout << "order\t\tsort [ms]\tbuild [ms]\tnormals [ms]\tcache misses\tchecksum" << endl;
+
+    run("random", buffer, k, 0);
+
+    vector<size_t> perm;
+    Timestamp ts;
+    spatialOrder(points.get(), n, MORTON_CURVE, perm);
+    PointBufferPtr morton = permutePointBuffer(buffer, perm);
+    run("morton", morton, k, ts.getElapsedTimeInMs());
+
+    ts.resetTimer();
+    spatialOrder(points.get(), n, HILBERT_CURVE, perm);
+    PointBufferPtr hilbert = permutePointBuffer(buffer, perm);
+    run("hilbert", hilbert, k, ts.getElapsedTimeInMs());
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * StatisticsBenchmark.cpp
+ *
+ * Compares the computation of the 14 texture features through the single
+ * calc* methods of Statistics, as done by ImageProcessor::calcStats
+ * before, with the fused Statistics::calcFeatures.
+ */
+#include <lvr/texture/Statistics.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <opencv/cv.h>
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+int main(int argc, char** argv)
+{
+    int numTextures = argc > 1 ? atoi(argv[1]) : 100;
+    int size        = argc > 2 ? atoi(argv[2]) : 64;
+    int numColors   = argc > 3 ? atoi(argv[3]) : 16;
+
+    std::vector<cv::Mat> textures(numTextures);
+    for(int i = 0; i < numTextures; i++)
+    {
+        textures[i] = cv::Mat(size, size, CV_8UC3);
+        cv::randu(textures[i], cv::Scalar::all(0), cv::Scalar::all(255));
+    }
+
+    cout << timestamp << numTextures << " textures of " << size << "x" << size
+         << " pixels, " << numColors << " gray levels" << endl;
+
+    std::vector<float> single(14 * numTextures);
+    std::vector<float> fused(14 * numTextures);
+
+    double singleTime = 0;
+    double fusedTime = 0;
+    for(int i = 0; i < numTextures; i++)
+    {
+        Statistics stat(textures[i], numColors);
+        float* s = &single[14 * i];
+
+        Timestamp ts;
+        s[0]  = stat.calcASM();
+        s[1]  = stat.calcContrast();
+        s[2]  = stat.calcCorrelation();
+        s[3]  = stat.calcSumOfSquares();
+        s[4]  = stat.calcInverseDifference();
+        s[5]  = stat.calcSumAvg();
+        s[6]  = stat.calcSumEntropy();
+        s[7]  = stat.calcSumVariance();
+        s[8]  = stat.calcEntropy();
+        s[9]  = stat.calcDifferenceVariance();
+        s[10] = stat.calcDifferenceEntropy();
+        s[11] = stat.calcInformationMeasures1();
+        s[12] = stat.calcInformationMeasures2();
+        s[13] = stat.calcMaxCorrelationCoefficient();
+        singleTime += ts.getElapsedTimeInMs();
+
+        ts.resetTimer();
+        stat.calcFeatures(&fused[14 * i]);
+        fusedTime += ts.getElapsedTimeInMs();
+    }
+
+    // Largest relative deviation per feature
+    cout << "feature\tmax. relative deviation" << endl;
+    for(int f = 0; f < 14; f++)
+    {
+        double dev = 0;
+        for(int i = 0; i < numTextures; i++)
+        {
+            double a = single[14 * i + f];
+            double b = fused[14 * i + f];
+            dev = std::max(dev, fabs(a - b) / std::max(1e-6, fabs(a)));
+        }
+        cout << f << "\t" << dev << endl;
+    }
+
+    cout << "single [ms]\tfused [ms]\tspeedup" << endl;
+    cout << singleTime << "\t\t" << fusedTime << "\t\t"
+         << (fusedTime > 0 ? singleTime / fusedTime : 0.0) << endl;
+
+    return 0;
+}
@@ -50,8 +50,7 @@ typedef Normal<float>                            fNormal;
  */
 int main(int argc, char** argv)
 {
-	MeshBufferPtr mesh_buffer1;
-	MeshBufferPtr mesh_buffer2;
+	vector<MeshBufferPtr> mesh_buffers;
 	// Create an empty mesh
 	Fusion<fVertex, fNormal> mesh;
 	// Parse command line arguments
@@ -69,39 +68,27 @@ int main(int argc, char** argv)
 
 		// Create a mesh loader object
 		ModelFactory io_factory;
-		ModelPtr model1 = io_factory.readModel( options.getMesh1FileName() );
-		ModelPtr model2 = io_factory.readModel( options.getMesh2FileName() );
+		vector<string> files = options.getMeshFileNames();
 
-
-		// Parse loaded data
-		if ( !model1 )
-		{
-			cout << timestamp << "IO Error: Unable to parse " << options.getMesh1FileName() << endl;
-			exit(-1);
-		}
-
-		mesh_buffer1 = model1->m_mesh;
-
-		if(!mesh_buffer1)
-		{
-			cout << timestamp << "Given file contains no supported mesh information" << endl;
-			exit(-1);
-		}	
-
-		if ( !model2 )
-		{
-			cout << timestamp << "IO Error: Unable to parse " << options.getMesh2FileName() << endl;
-			exit(-1);
-		}
-
-		mesh_buffer2= model2->m_mesh;
-
-		if(!mesh_buffer2)
+		for(size_t i = 0; i < files.size(); i++)
 		{
-			cout << timestamp << "Given file contains no supported mesh information" << endl;
-			exit(-1);
+			ModelPtr model = io_factory.readModel( files[i] );
+
+			// Parse loaded data
+			if ( !model )
+			{
+				cout << timestamp << "IO Error: Unable to parse " << files[i] << endl;
+				exit(-1);
+			}
+
+			if(!model->m_mesh)
+			{
+				cout << timestamp << "Given file contains no supported mesh information" << endl;
+				exit(-1);
+			}
+			mesh_buffers.push_back(model->m_mesh);
 		}
-		cout << timestamp << "Successfully loaded both meshes." << endl;
+		cout << timestamp << "Successfully loaded " << mesh_buffers.size() << " meshes." << endl;
 		
 		mesh.setVerbosity(options.getVerbosity());
 		mesh.setDistanceThreshold(options.getDistanceTreshold());
@@ -109,16 +96,25 @@ int main(int argc, char** argv)
 	}catch(...)
 		{
 			std::cout << "Unable to parse options. Call 'fusion --help' for more information." << std::endl;
+			return 0;
 		}
-	// Load and integrate meshes
-	mesh.addMeshAndRemoteIntegrateOnly(mesh_buffer1);
-	mesh.addMeshAndRemoteIntegrateOnly(mesh_buffer2);
-	
-	/*mesh.addMesh(mesh_buffer1);
-	mesh.lazyIntegrate();
 
-	mesh.addMesh(mesh_buffer2);
-	mesh.integrate();*/
+	// Load and integrate meshes. The first one is taken as it is.
+	for(size_t i = 0; i < mesh_buffers.size(); i++)
+	{
+		if(i == 0)
+		{
+			mesh.addMeshAndLazyIntegrate(mesh_buffers[i]);
+		}
+		else if(options.remoteOnly())
+		{
+			mesh.addMeshAndRemoteIntegrateOnly(mesh_buffers[i]);
+		}
+		else
+		{
+			mesh.addMeshAndIntegrate(mesh_buffers[i]);
+		}
+	}
 
 	mesh.finalize();
 
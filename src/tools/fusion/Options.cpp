@@ -36,14 +36,15 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
 	m_descr.add_options()
 		        ("help", "Produce help message")
 		        ("mesh1", value< vector<string> >(), "Input file name for mesh1. Supported formats are .ply")
-		        ("mesh2", value< vector<string> >(), "Input file name for mesh2. Supported formats are .ply")
+		        ("mesh2", value< vector<string> >(), "Input file names of the meshes fused into mesh1. Supported formats are .ply")
 		        ("fusion", value< vector<string> >(), "Input file name for mesh2. Supported formats are .ply")
 		        ("t", value< vector<double> >(), "Distance treshold for AABB Search.")
 				("v", "Verbosity On.")
+				("remote", "Integrate only the faces that are not close to the fused mesh.")
         ;
 		;
 
-	m_pdescr.add("mesh1", -1);
+	m_pdescr.add("mesh1", 1);
 	m_pdescr.add("mesh2", -1);
 
 	// Parse command line and generate variables map
@@ -76,6 +77,19 @@ string Options::getMesh2FileName() const
 	return (m_variables["mesh2"].as< vector<string> >())[0];
 }
 
+vector<string> Options::getMeshFileNames() const
+{
+	vector<string> names = m_variables["mesh1"].as< vector<string> >();
+	vector<string> others = m_variables["mesh2"].as< vector<string> >();
+	names.insert(names.end(), others.begin(), others.end());
+	return names;
+}
+
+bool Options::remoteOnly() const
+{
+	return (m_variables.count("remote"));
+}
+
 string Options::getFusionMeshFileName() const
 {
 	return (m_variables["fusion"].as< vector<string> >())[0];
@@ -83,6 +97,10 @@ string Options::getFusionMeshFileName() const
 
 double Options::getDistanceTreshold() const
 {
+	if(!m_variables.count("t"))
+	{
+		return 0.01;
+	}
 	return (m_variables["t"].as< vector<double> >())[0];
 }
 
@@ -107,7 +125,7 @@ bool Options::printUsage() const
 
 bool Options::outputFileNameSet() const
 {
-	return (m_variables["fusion"].as< vector<string> >()).size() > 0;
+	return m_variables.count("fusion") && (m_variables["fusion"].as< vector<string> >()).size() > 0;
 }
 
 } // namespace fusion
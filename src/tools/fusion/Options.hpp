@@ -80,6 +80,16 @@ public:
 	 */
 	string 	getMesh2FileName() const;
 	
+	/**
+	 * @brief	Returns the names of all input meshes in the order of fusion
+	 */
+	vector<string> getMeshFileNames() const;
+
+	/**
+	 * @brief	Returns true if only remote faces should be integrated
+	 */
+	bool	remoteOnly() const;
+
 	/**
 	 * @brief	Returns the output file name
 	 */
@@ -111,6 +121,11 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	cout << endl;
 	cout << "##### Mesh1: " << o.getMesh1FileName() << endl;
 	cout << "##### Mesh2: " << o.getMesh2FileName() << endl;
+	cout << "##### Threshold: " << o.getDistanceTreshold() << endl;
+	if(o.remoteOnly())
+	{
+	    cout << "##### Remote integration only" << endl;
+	}
 		
 	if(o.outputFileNameSet())
 	{
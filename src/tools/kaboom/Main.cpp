@@ -29,9 +29,13 @@
 #include <fstream>
 #include <utility>
 #include <iterator>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
 using namespace std;
 
 #include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/qi_lit.hpp>
@@ -41,17 +45,24 @@ using namespace std;
 #include <Eigen/Dense>
 
 #include "Options.hpp"
+#include "ScanPipeline.hpp"
 #include <lvr/io/BaseIO.hpp>
 #include <lvr/io/DatIO.hpp>
 #include <lvr/io/Timestamp.hpp>
 #include <lvr/io/ModelFactory.hpp>
 #include <lvr/io/AsciiIO.hpp>
 #include <lvr/io/IOUtils.hpp>
+#include <lvr/io/LasIO.hpp>
 #ifdef LVR_USE_PCL
 #include <lvr/reconstruction/PCLFiltering.hpp>
 #endif
 
-#define BUF_SIZE 1024
+/// Bytes of a point without and with colors in binary PLY files
+const size_t PLY_POINT_RECORD = 3 * sizeof(float);
+const size_t PLY_COLOR_RECORD = 3 * sizeof(float) + 3 * sizeof(unsigned char);
+
+/// Width of the point count in PLY headers
+const int PLY_COUNT_WIDTH = 20;
 
 using namespace lvr;
 
@@ -59,8 +70,60 @@ namespace qi = boost::spirit::qi;
 
 const kaboom::Options* options;
 
-// This is dirty 
-bool lastScan = false;
+/// The output file if all scans are merged
+struct MergedOutput
+{
+    std::ofstream   out;
+
+    /// Position of the point count in the PLY header
+    std::streampos  countPos;
+
+    size_t          points_written;
+
+    /// Whether the PLY file contains colors
+    bool            colors;
+
+    bool            ply;
+
+    /// Writer of merged LAS output, the stream above is unused then
+    boost::shared_ptr<LasWriter> las;
+} merged;
+
+/// Returns true if the scans are written as .las or .laz files
+bool lasOutput()
+{
+    return options->getOutputFormat() == "LAS" || options->getOutputFormat() == "LAZ";
+}
+
+/// Returns true if the given file can be read by LasIO
+bool isLasFile(const boost::filesystem::path& file)
+{
+    return file.extension() == ".las" || file.extension() == ".laz";
+}
+
+/**
+ * @brief   Adds the shift of a georeferenced scan to its points. The
+ *          coordinates lose precision as floats, but frames, poses and
+ *          axis scaling are defined for the original coordinates.
+ */
+void unshiftModel(ModelPtr model)
+{
+    if(model->m_shift[0] == 0.0 && model->m_shift[1] == 0.0 && model->m_shift[2] == 0.0)
+    {
+        return;
+    }
+
+    size_t n;
+    floatArr points = model->m_pointCloud->getPointArray(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            points[3 * i + k] += model->m_shift[k];
+        }
+    }
+    model->m_shift[0] = model->m_shift[1] = model->m_shift[2] = 0.0;
+}
 
 ModelPtr filterModel(ModelPtr p, int k, float sigma)
 {
@@ -89,58 +152,151 @@ ModelPtr filterModel(ModelPtr p, int k, float sigma)
 
 
 
-size_t writePly(ModelPtr model, std::fstream& out) 
+/**
+ * @brief   Appends the points of a model in the binary PLY layout to the
+ *          given buffer. Missing colors are written as black.
+ */
+size_t encodePly(ModelPtr model, bool colors, std::string& data)
 {
     size_t n_ip, n_colors;
 
+    // PLY stores floats, so the coordinates can't be kept more precise
+    unshiftModel(model);
+
     floatArr arr = model->m_pointCloud->getPointArray(n_ip);
 
-    ucharArr colors = model->m_pointCloud->getPointColorArray(n_colors);
+    ucharArr colorArr = model->m_pointCloud->getPointColorArray(n_colors);
 
-    if(n_colors && !(options->noColor()))
+    if(n_colors != n_ip)
     {
-        if(n_colors != n_ip)
-        {
-            std::cout << timestamp << "Numbers of points and colors needs to be identical" << std::endl;
-            return 0;
-        }
+        colorArr.reset();
+    }
 
-        for(int a = 0; a < n_ip; a++)
+    if(colors)
+    {
+        size_t offset = data.size();
+        data.resize(offset + n_ip * PLY_COLOR_RECORD);
+
+        char* out = &data[offset];
+        for(size_t a = 0; a < n_ip; a++)
         {
             // x y z
-            out.write((char*) (arr.get() + (3 * a)), sizeof(float) * 3);
+            memcpy(out, arr.get() + (3 * a), sizeof(float) * 3);
 
             // r g b
-            out.write((char*) (colors.get() + (3 * a)), sizeof(unsigned char) * 3);
+            if(colorArr)
+            {
+                memcpy(out + PLY_POINT_RECORD, colorArr.get() + (3 * a), sizeof(unsigned char) * 3);
+            }
+            else
+            {
+                memset(out + PLY_POINT_RECORD, 0, sizeof(unsigned char) * 3);
+            }
+            out += PLY_COLOR_RECORD;
         }
     }
     else
     {
-        // simply write whole points array
-        out.write((char*) arr.get(), sizeof(float) * n_ip * 3);
+        // simply copy whole points array
+        data.append((char*) arr.get(), sizeof(float) * n_ip * 3);
     }
 
     return n_ip;
+}
+
+/**
+ * @brief   Adds black colors to or removes the colors from the encoded
+ *          binary PLY points of a scan
+ */
+void setPlyColors(kaboom::ScanJob& job, bool colors)
+{
+    if(job.colors == colors)
+    {
+        return;
+    }
 
+    size_t from = job.colors ? PLY_COLOR_RECORD : PLY_POINT_RECORD;
+    size_t to   = colors ? PLY_COLOR_RECORD : PLY_POINT_RECORD;
+
+    std::string data(job.numPoints * to, '\0');
+    for(size_t a = 0; a < job.numPoints; a++)
+    {
+        memcpy(&data[a * to], &job.data[a * from], PLY_POINT_RECORD);
+    }
+
+    job.data.swap(data);
+    job.colors = colors;
 }
 
-size_t writePlyHeader(std::ofstream& out, size_t n_points, bool colors)
+/**
+ * @brief   Appends the points of a model as lines of text to the given
+ *          buffer in the format of writePointsToASCII
+ */
+size_t encodeASCII(ModelPtr model, std::string& data)
 {
-    out << "ply" << std::endl;
-    out << "format binary_little_endian 1.0" << std::endl;
+    size_t n_ip, n_colors;
+
+    floatArr arr = model->m_pointCloud->getPointArray(n_ip);
 
-    out << "element point " << n_points << std::endl;
-    out << "property float32 x" << std::endl;
-    out << "property float32 y" << std::endl;
-    out << "property float32 z" << std::endl;
+    ucharArr colors = model->m_pointCloud->getPointColorArray(n_colors);
+
+    // The shift of georeferenced scans is added in double precision
+    const double* shift = model->m_shift;
+    bool shifted = shift[0] != 0.0 || shift[1] != 0.0 || shift[2] != 0.0;
+
+    std::ostringstream out;
+    if(shifted)
+    {
+        out << std::fixed << std::setprecision(3);
+    }
+    for(size_t a = 0; a < n_ip; a++)
+    {
+        if(shifted)
+        {
+            out << arr[a * 3] + shift[0] << " " << arr[a * 3 + 1] + shift[1] << " " << arr[a * 3 + 2] + shift[2];
+        }
+        else
+        {
+            out << arr[a * 3] << " " << arr[a * 3 + 1] << " " << arr[a * 3 + 2];
+        }
+
+        if(n_colors && !(options->noColor()))
+        {
+            out << " " << (int)colors[a * 3] << " " << (int)colors[a * 3 + 1] << " " << (int)colors[a * 3 + 2];
+        }
+        out << "\n";
+    }
+
+    data += out.str();
+    return n_ip;
+}
+
+/**
+ * @brief   Writes a binary PLY header and returns the position of the
+ *          point count, which is padded so it can be overwritten with
+ *          any other count later
+ */
+std::streampos writePlyHeader(std::ostream& out, size_t n_points, bool colors)
+{
+    out << "ply" << "\n";
+    out << "format binary_little_endian 1.0" << "\n";
+
+    out << "element point ";
+    std::streampos countPos = out.tellp();
+    out << std::left << std::setw(PLY_COUNT_WIDTH) << n_points << "\n";
+    out << "property float32 x" << "\n";
+    out << "property float32 y" << "\n";
+    out << "property float32 z" << "\n";
 
     if(colors)
     {
-        out << "property uchar red" << std::endl;
-        out << "property uchar green" << std::endl;
-        out << "property uchar blue" << std::endl;
+        out << "property uchar red" << "\n";
+        out << "property uchar green" << "\n";
+        out << "property uchar blue" << "\n";
     }
-    out << "end_header" << std::endl;
+    out << "end_header" << "\n";
+
+    return countPos;
 }
 
 
@@ -197,39 +353,112 @@ Eigen::Matrix4d transformFrames(Eigen::Matrix4d frames)
 
 
 
-void processSingleFile(boost::filesystem::path& inFile)
+/**
+ * @brief   Returns the name of a converted scan in the output directory
+ */
+std::string outputName(const boost::filesystem::path& inFile)
 {
-    cout << timestamp << "Processing " << inFile << endl;
+    char name[1024];
 
+    if(options->getOutputFormat() == "ASCII")
+    {
+        sprintf(name, "%s/%s.3d", options->getOutputDir().c_str(), inFile.stem().c_str());
+    }
+    else if(options->getOutputFormat() == "PLY")
+    {
+        sprintf(name, "%s/%s.ply", options->getOutputDir().c_str(), inFile.stem().c_str());
+    }
+    else if(options->getOutputFormat() == "LAS")
+    {
+        sprintf(name, "%s/%s.las", options->getOutputDir().c_str(), inFile.stem().c_str());
+    }
+    else if(options->getOutputFormat() == "LAZ")
+    {
+        sprintf(name, "%s/%s.laz", options->getOutputDir().c_str(), inFile.stem().c_str());
+    }
+    else
+    {
+        // Keep the name, the points are written as ASCII
+        sprintf(name, "%s/%s", options->getOutputDir().c_str(), inFile.filename().c_str());
+    }
 
+    return std::string(name);
+}
 
-    cout << timestamp << "Reading point cloud data from file " << inFile.filename().string() << "." << endl;
+/**
+ * @brief   Read stage of the pipeline, loads the model of a scan
+ */
+bool readScan(kaboom::ScanJob& job)
+{
+    cout << timestamp << "Reading point cloud data from file " << job.file.filename().string() << "." << endl;
 
-    ModelPtr model = ModelFactory::readModel(inFile.string());
+    vector<double> region = options->getRegion();
+    if(region.size())
+    {
+        // Uses the spatial index of the file if there is one
+        if(!isLasFile(job.file))
+        {
+            cout << timestamp << "ERROR: Only LAS and LAZ files can be cropped to a region: " << job.file << endl;
+            return false;
+        }
+        LasIO io;
+        job.model = io.read(job.file.string(), region[0], region[1], region[2], region[3]);
+    }
+    else
+    {
+        job.model = ModelFactory::readModel(job.file.string());
+    }
 
-    if(0 == model)
+    if(!job.model || !job.model->m_pointCloud)
     {
-        throw "ERROR: Could not create Model for: ";
+        cout << timestamp << "ERROR: Could not create Model for: " << job.file << endl;
+        return false;
     }
 
-    if(options->getOutputFile() != "")
-    { 
-        char frames[1024];
-        char pose[1024];
-        sprintf(frames, "%s/%s.frames", inFile.parent_path().c_str(), inFile.stem().c_str());
-        sprintf(pose, "%s/%s.pose", inFile.parent_path().c_str(), inFile.stem().c_str());
+    return true;
+}
+
+/**
+ * @brief   Process stage of the pipeline. Transforms and reduces a scan
+ *          and encodes its points for the output format, so the writer
+ *          only has to copy them to the disk.
+ */
+bool processScan(kaboom::ScanJob& job)
+{
+    boost::filesystem::path& inFile = job.file;
+    ModelPtr model = job.model;
 
-        boost::filesystem::path framesPath(frames);
-        boost::filesystem::path posePath(pose);
+    cout << timestamp << "Processing " << inFile << endl;
+
+    char frames[1024];
+    char pose[1024];
+    sprintf(frames, "%s/%s.frames", inFile.parent_path().c_str(), inFile.stem().c_str());
+    sprintf(pose, "%s/%s.pose", inFile.parent_path().c_str(), inFile.stem().c_str());
+
+    boost::filesystem::path framesPath(frames);
+    boost::filesystem::path posePath(pose);
+
+    // Georeferenced scans keep their precise coordinates if they are
+    // only converted and reduced
+    bool identity = options->sx() == 1 && options->sy() == 1 && options->sz() == 1
+                 && options->x() == 0 && options->y() == 1 && options->z() == 2;
+    bool transform = options->getOutputFile() != ""
+                 && (boost::filesystem::exists(framesPath) || boost::filesystem::exists(posePath));
+    if(!identity || transform)
+    {
+        unshiftModel(model);
+    }
 
+    if(options->getOutputFile() != "")
+    {
         size_t reductionFactor = getReductionFactor(model, options->getTargetSize());
 
         if(options->transformBefore())
         {
- 	    transformAndReducePointCloud(
-		model, reductionFactor,
-		options->sx(), options->sy(), options->sz(),
-		options->x(), options->y(), options->z());	    
+            transformAndReducePointCloud(
+                model, reductionFactor,
+                options->sx(), options->sy(), options->sz(),
+                options->x(), options->y(), options->z());
         }
 
         if(boost::filesystem::exists(framesPath))
@@ -248,282 +477,210 @@ void processSingleFile(boost::filesystem::path& inFile)
 
         if(!options->transformBefore())
         {
-             transformAndReducePointCloud(
-		model, reductionFactor,
-		options->sx(), options->sy(), options->sz(),
-		options->x(), options->y(), options->z());
+            transformAndReducePointCloud(
+                model, reductionFactor,
+                options->sx(), options->sy(), options->sz(),
+                options->x(), options->y(), options->z());
         }
+    }
+    else
+    {
+        char framesOut[1024];
+        sprintf(framesOut, "%s/%s.frames", options->getOutputDir().c_str(), inFile.stem().c_str());
 
-        static size_t points_written = 0;
-
-
-        if(options->getOutputFormat() == "ASCII" || options->getOutputFormat() == "")
+        // Transform the frames
+        if(boost::filesystem::exists(framesPath))
         {
-            // Merge (only ASCII)
-            std::ofstream out;
+            std::cout << timestamp << "Transforming frame: " << framesPath << std::endl;
+            Eigen::Matrix4d transformed = transformFrames(getTransformationFromFrames(framesPath));
+            writeFrames(transformed, framesOut);
+        }
 
-            /* If points were written we want to append the next scans, otherwise we want an empty file */
-            if(points_written != 0)
-            {
-                out.open(options->getOutputFile().c_str(), std::ofstream::out | std::ofstream::app);
-            }
-            else
-            {
-                out.open(options->getOutputFile().c_str(), std::ofstream::out | std::ofstream::trunc);
-            }
+        transformAndReducePointCloud(
+            model, getReductionFactor(model, options->getTargetSize()),
+            options->sx(), options->sy(), options->sz(),
+            options->x(), options->y(), options->z());
+    }
 
-            points_written += writePointsToASCII(model, out, options->noColor());
+    if(options->getOutputFormat() == "PLY" || lasOutput())
+    {
+        size_t n_ip, n_colors;
+        model->m_pointCloud->getPointArray(n_ip);
+        model->m_pointCloud->getPointColorArray(n_colors);
 
-            out.close();
+        job.colors = n_colors && !(options->noColor());
+        if(job.colors && n_colors != n_ip)
+        {
+            std::cout << timestamp << "Numbers of points and colors needs to be identical" << std::endl;
+            return false;
         }
-        else if(options->getOutputFormat() == "PLY")
+
+        // The LAS writer encodes the points itself
+        if(lasOutput())
         {
-            char tmp_file[1024];
+            job.numPoints = n_ip;
+            return true;
+        }
 
-            sprintf(tmp_file, "%s/tmp.ply", inFile.parent_path().c_str());
+        job.numPoints = encodePly(model, job.colors, job.data);
+    }
+    else
+    {
+        job.numPoints = encodeASCII(model, job.data);
+    }
 
-            std::fstream tmp;
+    // The encoded points are all the writer needs
+    job.model.reset();
 
-            if(points_written != 0)
-            {
-                tmp.open(tmp_file, std::fstream::in | std::fstream::out | std::fstream::app | std::fstream::binary);
-            }
-            else
-            {
-                tmp.open(tmp_file, std::fstream::in | std::fstream::out | std::fstream::trunc | std::fstream::binary);
-            }
-            
-            if(tmp.is_open())
-            {
-                points_written += writePly(model, tmp);
-            }
-            else
-            {
-                std::cout << "could not open " << tmp_file << std::endl;
-            }
-            
-            if(true == lastScan)
-            {
-                std::ofstream out;
-
-                // write the header -> open in text_mode 
-                out.open(options->getOutputFile().c_str(), std::ofstream::out | std::ofstream::trunc);
-                // check if we have color information
-                size_t n_colors;
-                ucharArr colors = model->m_pointCloud->getPointColorArray(n_colors);
-                if(n_colors && !(options->noColor()))
-                {
-                    writePlyHeader(out, points_written, true);
-                }
-                else
-                {
-                    writePlyHeader(out, points_written, false);
-                }
-
-                out.close();
-
-                // determine size of the complete binary blob
-                tmp.seekg(0, std::fstream::end);
-                size_t blob_size = tmp.tellg();
-                tmp.seekg(0, std::fstream::beg);
-
-                // open the actual output file for binary blob write
-                out.open(options->getOutputFile(), std::ofstream::out | std::ofstream::app | std::ofstream::binary);
-                
-                char buffer[BUF_SIZE];
-                
-                while(blob_size)
-                {
-                    if(blob_size < BUF_SIZE)
-                    { 
-                        // read the rest from tmp file (binary blob)
-                        tmp.read(buffer, blob_size);
-                        // write the rest to actual ply file
-                        out.write(buffer, blob_size);
-
-                        blob_size -= blob_size;
-                    }
-                    else
-                    {
-                        // reading from tmp file (binary blob)
-                        tmp.read(buffer, BUF_SIZE);
-                        // write to actual ply file
-                        out.write(buffer, BUF_SIZE);
-
-                        blob_size -= BUF_SIZE;
-                    }
-                }
-
-                out.close();
-                tmp.close();
-
-                std::remove(tmp_file);
-
-                std::cout << timestamp << "Wrote " << points_written << " points." << std::endl;
-            }
-            else
-            {
-                tmp.close();
-            }
+    return true;
+}
 
-        }
-    }
-    else
+/**
+ * @brief   Appends the points of a scan to a LAS writer. The shift of the
+ *          scan is added back, so georeferenced coordinates stay precise.
+ */
+bool writeLas(LasWriter& writer, kaboom::ScanJob& job)
+{
+    PointBufferPtr buffer = job.model->m_pointCloud;
+
+    size_t n, n_colors, n_intensities;
+    floatArr points = buffer->getPointArray(n);
+    ucharArr colors = buffer->getPointColorArray(n_colors);
+    floatArr intensities = buffer->getPointIntensityArray(n_intensities);
+
+    writer.setShift(job.model->m_shift);
+    return writer.write(points.get(), n,
+            job.colors ? colors.get() : 0,
+            n_intensities == n ? intensities.get() : 0);
+}
+
+/**
+ * @brief   Write stage of the pipeline. Appends a scan to the merged
+ *          output file or writes it to its own file.
+ */
+bool writeScan(kaboom::ScanJob& job)
+{
+    if(options->getOutputFile() != "" && lasOutput())
     {
-        if(options->getOutputFormat() == "")
+        // The first scan decides whether the merged points have colors
+        if(!merged.las)
         {
-            // Infer format from file extension, convert and write out
-            char name[1024];
-            char frames[1024];
-            char pose[1024];
-            char framesOut[1024];
-            char poseOut[1024];
-
-            sprintf(frames, "%s/%s.frames", inFile.parent_path().c_str(), inFile.stem().c_str());
-            sprintf(pose, "%s/%s.pose", inFile.parent_path().c_str(), inFile.stem().c_str());
-            sprintf(framesOut, "%s/%s.frames", options->getOutputDir().c_str(), inFile.stem().c_str());
-            sprintf(poseOut, "%s/%s.pose", options->getOutputDir().c_str(), inFile.stem().c_str());
-            sprintf(name, "%s/%s", options->getOutputDir().c_str(), inFile.filename().c_str());
-
-            boost::filesystem::path framesPath(frames);
-            boost::filesystem::path posePath(pose);
-
-            // Transform the frames
-            if(boost::filesystem::exists(framesPath))
-            {
-                std::cout << timestamp << "Transforming frame: " << framesPath << std::endl;
-                Eigen::Matrix4d transformed = transformFrames(getTransformationFromFrames(framesPath));
-                writeFrames(transformed, framesOut);
-            }
+            merged.las.reset(new LasWriter(options->getOutputFile(), job.colors));
+            merged.colors = job.colors;
+        }
 
-            ofstream out(name);
-           
-	    transformAndReducePointCloud(
-		model, getReductionFactor(model, options->getTargetSize()),
-		options->sx(), options->sy(), options->sz(),
-		options->x(), options->y(), options->z());
-	    
-            size_t points_written = writePointsToASCII(model, out, options->noColor());
-
-            out.close();
-            cout << timestamp << "Wrote " << points_written << " points to file " << name << endl;
+        if(!merged.colors)
+        {
+            job.colors = false;
         }
-        else if(options->getOutputFormat() == "ASCII")
+        return writeLas(*merged.las, job);
+    }
+
+    if(options->getOutputFile() != "")
+    {
+        if(!merged.out.is_open())
         {
-            // Infer format from file extension, convert and write out
-            char name[1024];
-            char frames[1024];
-            char pose[1024];
-            char framesOut[1024];
-            char poseOut[1024];
-
-            std::cout << timestamp << "ASCII" << std::endl;
-
-            sprintf(frames, "%s/%s.frames", inFile.parent_path().c_str(), inFile.stem().c_str());
-            sprintf(pose, "%s/%s.pose", inFile.parent_path().c_str(), inFile.stem().c_str());
-            sprintf(framesOut, "%s/%s.frames", options->getOutputDir().c_str(), inFile.stem().c_str());
-            sprintf(poseOut, "%s/%s.pose", options->getOutputDir().c_str(), inFile.stem().c_str());
-            sprintf(name, "%s/%s.3d", options->getOutputDir().c_str(), inFile.stem().c_str());
-
-            boost::filesystem::path framesPath(frames);
-            boost::filesystem::path posePath(pose);
-
-            // Transform the frames
-            if(boost::filesystem::exists(framesPath))
+            merged.out.open(options->getOutputFile().c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+            if(!merged.out.good())
             {
-                std::cout << timestamp << "Transforming frame: " << framesPath << std::endl;
-                Eigen::Matrix4d transformed = transformFrames(getTransformationFromFrames(framesPath));
-                writeFrames(transformed, framesOut);
+                cout << timestamp << "Error: Unable to open " << options->getOutputFile() << endl;
+                return false;
             }
 
-            // Transform the pose file
-            if(boost::filesystem::exists(posePath))
+            merged.points_written = 0;
+            merged.ply = (options->getOutputFormat() == "PLY");
+
+            // The first scan decides whether the merged points have colors.
+            // The point count is patched when all scans are written.
+            merged.colors = job.colors;
+            if(merged.ply)
             {
+                merged.countPos = writePlyHeader(merged.out, 0, merged.colors);
             }
+        }
 
-            ofstream out(name);
-	    
-      	    transformAndReducePointCloud(
-		model, getReductionFactor(model, options->getTargetSize()),
-		options->sx(), options->sy(), options->sz(),
-		options->x(), options->y(), options->z());
-
-            size_t points_written = writePointsToASCII(model, out, options->noColor());
-
-            out.close();
-            cout << timestamp << "Wrote " << points_written << " points to file " << name << endl;
-
+        if(merged.ply)
+        {
+            setPlyColors(job, merged.colors);
         }
-        else if(options->getOutputFormat() == "PLY")
+
+        merged.out.write(job.data.data(), job.data.size());
+        if(!merged.out.good())
         {
-            char name[1024];
-            char frames[1024];
-            char pose[1024];
-            char framesOut[1024];
-            char poseOut[1024];
-
-            std::cout << timestamp << "Writing PLY" << std::endl;
-
-            sprintf(frames, "%s/%s.frames", inFile.parent_path().c_str(), inFile.stem().c_str());
-            sprintf(pose, "%s/%s.pose", inFile.parent_path().c_str(), inFile.stem().c_str());
-            sprintf(framesOut, "%s/%s.frames", options->getOutputDir().c_str(), inFile.stem().c_str());
-            sprintf(poseOut, "%s/%s.pose", options->getOutputDir().c_str(), inFile.stem().c_str());
-            sprintf(name, "%s/%s.ply", options->getOutputDir().c_str(), inFile.stem().c_str());
-
-            boost::filesystem::path framesPath(frames);
-            boost::filesystem::path posePath(pose);
-            boost::filesystem::path saveName(name);
-
-            // Transform the frames
-            if(boost::filesystem::exists(framesPath))
-            {
-                std::cout << timestamp << "Transforming frame: " << framesPath << std::endl;
-                Eigen::Matrix4d transformed = transformFrames(getTransformationFromFrames(framesPath));
-                writeFrames(transformed, framesOut);
-            }
+            cout << timestamp << "Error: Unable to write to " << options->getOutputFile() << endl;
+            return false;
+        }
 
-	    transformAndReducePointCloud(
-		model, getReductionFactor(model, options->getTargetSize()),
-		options->sx(), options->sy(), options->sz(),
-		options->x(), options->y(), options->z());
+        merged.points_written += job.numPoints;
+        return true;
+    }
 
-	    
-            std::ofstream out;
+    std::string name = outputName(job.file);
 
-            // write the header -> open in text_mode 
-            out.open(saveName.c_str(), std::ofstream::out | std::ofstream::trunc);
+    if(lasOutput())
+    {
+        LasWriter writer(name, job.colors);
+        if(!writeLas(writer, job))
+        {
+            return false;
+        }
+        writer.close();
+        cout << timestamp << "Wrote " << job.numPoints << " points to file " << name << endl;
 
-            // check if we have color information
-            size_t n_colors;
-            size_t n_ip;
-            ucharArr colors = model->m_pointCloud->getPointColorArray(n_colors);
-            floatArr point  = model->m_pointCloud->getPointArray(n_ip);
-            if(n_colors && !(options->noColor()))
-            {
-                writePlyHeader(out, n_ip, true);
-            }
-            else
-            {
-                writePlyHeader(out, n_ip, false);
-            }
+        return !options->createIndex() || LasIO::createIndex(name);
+    }
 
-            out.close();
+    std::ofstream out(name.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    if(options->getOutputFormat() == "PLY")
+    {
+        writePlyHeader(out, job.numPoints, job.colors);
+    }
+    out.write(job.data.data(), job.data.size());
 
-            std::fstream binOut;
-            //size_t points_written = writeModel(model, saveName);
+    if(!out.good())
+    {
+        cout << timestamp << "Error: Unable to write " << name << endl;
+        return false;
+    }
 
-            //binOut.open(options->getOutputFile(), std::ofstream::out | std::ofstream::app | std::ofstream::binary);
-            
-            binOut.open(saveName.c_str(), std::fstream::in | std::fstream::out | std::fstream::app | std::fstream::binary);
+    out.close();
+    cout << timestamp << "Wrote " << job.numPoints << " points to file " << name << endl;
 
-            size_t points_written = writePly(model, binOut);
-            
-            binOut.close();
+    return true;
+}
 
-            cout << timestamp << "Wrote " << points_written << " points to file " << name << endl;
+/**
+ * @brief   Patches the point count of the merged PLY file and closes it
+ */
+void closeMergedOutput()
+{
+    if(merged.las)
+    {
+        size_t n = merged.las->close();
+        merged.las.reset();
+        std::cout << timestamp << "Wrote " << n << " points." << std::endl;
 
+        if(options->createIndex())
+        {
+            LasIO::createIndex(options->getOutputFile());
         }
+        return;
+    }
+
+    if(!merged.out.is_open())
+    {
+        return;
+    }
+
+    if(merged.ply)
+    {
+        merged.out.seekp(merged.countPos);
+        merged.out << std::left << std::setw(PLY_COUNT_WIDTH) << merged.points_written;
     }
+
+    merged.out.close();
+
+    std::cout << timestamp << "Wrote " << merged.points_written << " points." << std::endl;
 }
 
     template <typename Iterator>
@@ -585,6 +742,26 @@ int main(int argc, char** argv) {
     boost::filesystem::path inputDir(options->getInputDir());
     boost::filesystem::path outputDir(options->getOutputDir());
 
+    string format = options->getOutputFormat();
+    if(format != "" && format != "ASCII" && format != "PLY" && format != "LAS" && format != "LAZ")
+    {
+        cout << timestamp << "Error: Output format " << format << " is not supported" << endl;
+        exit(-1);
+    }
+
+    vector<double> region = options->getRegion();
+    if(region.size() && (region.size() != 4 || region[0] > region[2] || region[1] > region[3]))
+    {
+        cout << timestamp << "Error: The region has to be given as minX minY maxX maxY" << endl;
+        exit(-1);
+    }
+
+    if(options->getMaxScans() < 1)
+    {
+        cout << timestamp << "Error: maxScans has to be at least 1" << endl;
+        exit(-1);
+    }
+
     // Check input directory
     if(!boost::filesystem::exists(inputDir))
     {
@@ -618,7 +795,7 @@ int main(int argc, char** argv) {
     for(boost::filesystem::directory_iterator it(inputDir); it != end; ++it)
     {
         std::string ext =	it->path().extension().string();
-        if(ext == ".3d" || ext == ".ply" || ext == ".dat" || ext == ".txt" || ext == ".las")
+        if(ext == ".3d" || ext == ".ply" || ext == ".dat" || ext == ".txt" || ext == ".las" || ext == ".laz")
         {
             v.push_back(it->path());
         }
@@ -627,8 +804,8 @@ int main(int argc, char** argv) {
     // Sort entries
     sort(v.begin(), v.end(), sortScans);
 
-    vector<float>	 		merge_points;
-    vector<unsigned char>	merge_colors;
+    // Select the scans to process
+    vector<boost::filesystem::path> scans;
 
     int j = -1;
     for(vector<boost::filesystem::path>::iterator it = v.begin(); it != v.end(); ++it)
@@ -657,23 +834,7 @@ int main(int argc, char** argv) {
             // when end is default(=0) process the complete vector
             if(0 == options->getEnd() || i <= options->getEnd())
             {
-                try
-                {
-                    // This is dirty and bad designed.
-                    // We need to know when we advanced to the last scan
-                    // for ply merging. Which originally was not planned.
-                    // Two cases end option set or not.
-                    if((i  == options->getEnd()) || std::next(it, 1) == v.end())
-                    {
-                        lastScan = true;
-                    }
-                    processSingleFile(*it);
-                }
-                catch(const char* msg)
-                {
-                    std::cerr << timestamp << msg << *it << std::endl;
-                    break;
-                }
+                scans.push_back(*it);
                 j = i;
             }
             else
@@ -684,7 +845,16 @@ int main(int argc, char** argv) {
 
     }
 
+    // Read, transform and write the scans concurrently
+    kaboom::ScanPipeline pipeline(readScan, processScan, writeScan,
+            options->getNumReaders(), options->getNumWorkers(), options->getMaxScans());
+
+    size_t numWritten = pipeline.run(scans);
+    closeMergedOutput();
+
+    cout << timestamp << "Processed " << numWritten << " of " << scans.size() << " scans." << endl;
+
     cout << timestamp << "Program end." << endl;
     delete options;
-    return 0;
+    return numWritten == scans.size() ? 0 : -1;
 }
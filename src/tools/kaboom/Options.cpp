@@ -26,6 +26,8 @@
 
 #include "Options.hpp"
 
+#include <boost/thread.hpp>
+
 namespace kaboom
 {
 
@@ -40,7 +42,7 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
 		("inputFile", value<string>()->default_value(""), "A single file to convert.")
 		("outputFile", value<string>()->default_value(""), "The name of a single output file if scans are merged. If the format can be deduced frim the file extension, the specification of --outputFormat is optional.")
 		("outputDir", value<string>()->default_value("./"), "The target directory for converted data.")
-		("outputFormat", value<string>()->default_value(""), "Specify the output format. Possible values are ASCII, PLY, DAT, LAS. If left empty, the format is deduced from the extension of the input files.")
+		("outputFormat", value<string>()->default_value(""), "Specify the output format. Possible values are ASCII, PLY, LAS and LAZ. If left empty, the format is deduced from the extension of the input files.")
 	    ("filter", value<bool>()->default_value(false), "Filter input data.")
 	    ("noColor", value<bool>()->default_value(false), "Export without Colors.")
 	    ("k", value<int>()->default_value(1), "k neighborhood for filtering.")
@@ -58,6 +60,11 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
 	    ("bPos,b", value<int>()->default_value(-1), "Position of the blue color component in the input data lines. (-1) means no color information")
         ("start,s", value<int>()->default_value(0), "start at scan NR")
         ("end,e", value<int>()->default_value(0), "end at scan NR")
+        ("readers", value<int>()->default_value(2), "Number of threads that read scans.")
+        ("workers", value<int>()->default_value(0), "Number of threads that transform and reduce scans. (0) means one per core.")
+        ("maxScans", value<int>()->default_value(4), "Maximum number of scans that are read but not yet written. Bounds the used memory.")
+        ("region", value< vector<double> >()->multitoken(), "Only convert the points inside the rectangle minX minY maxX maxY of LAS or LAZ scans. A spatial index (.lax file) of the scans is used if present.")
+        ("index", value<bool>()->default_value(false), "Write a spatial index (.lax file) for LAS and LAZ output files.")
 	;
 
 	m_pdescr.add("inputFile", -1);
@@ -129,6 +136,39 @@ int		Options::getTargetSize() const
 	return m_variables["targetSize"].as<int>();
 }
 
+int     Options::getNumReaders() const
+{
+    return m_variables["readers"].as<int>();
+}
+
+int     Options::getNumWorkers() const
+{
+    int workers = m_variables["workers"].as<int>();
+    if(workers <= 0)
+    {
+        workers = boost::thread::hardware_concurrency();
+    }
+    return workers;
+}
+
+int     Options::getMaxScans() const
+{
+    return m_variables["maxScans"].as<int>();
+}
+
+vector<double> Options::getRegion() const
+{
+    if(m_variables.count("region"))
+    {
+        return m_variables["region"].as< vector<double> >();
+    }
+    return vector<double>();
+}
+
+bool    Options::createIndex() const
+{
+    return m_variables["index"].as<bool>();
+}
 
 Options::~Options() {
 	// TODO Auto-generated destructor stub
@@ -70,6 +70,21 @@ public:
 	float	getSigma() const;
 	int		getTargetSize() const;
 
+	/// Returns the number of threads that read scans
+	int		getNumReaders() const;
+
+	/// Returns the number of threads that transform and reduce scans
+	int		getNumWorkers() const;
+
+	/// Returns the maximum number of scans in the pipeline
+	int		getMaxScans() const;
+
+	/// Returns the rectangle (min x, min y, max x, max y) the scans are cropped to, empty if not given
+	vector<double> getRegion() const;
+
+	/// Whether a spatial index is written for LAS output files
+	bool	createIndex() const;
+
 	/**
 	 * @brief   Returns the position of the x coordinate in the data.
 	 */
@@ -159,6 +174,9 @@ inline ostream& operator<<(ostream& os, const Options &o)
 		cout << "##### Filter  \t\t\t: NO" << endl;
 	}
 	cout << "##### Target Size \t: " << o.getTargetSize() << endl;
+	cout << "##### Readers \t\t: " << o.getNumReaders() << endl;
+	cout << "##### Workers \t\t: " << o.getNumWorkers() << endl;
+	cout << "##### Max Scans \t\t: " << o.getMaxScans() << endl;
 	return os;
 }
 
@@ -0,0 +1,198 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * ScanPipeline.cpp
+ */
+
+#include "ScanPipeline.hpp"
+
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/config/lvropenmp.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+namespace kaboom
+{
+
+namespace
+{
+
+/// Runs a stage and reports exceptions as failure
+bool runStage(ScanPipeline::Stage& stage, ScanJob& job)
+{
+    try
+    {
+        return stage(job);
+    }
+    catch(std::exception& e)
+    {
+        cout << lvr::timestamp << "Error while processing " << job.file << ": " << e.what() << endl;
+    }
+    return false;
+}
+
+} // namespace
+
+ScanPipeline::ScanPipeline(Stage read, Stage process, Stage write, int readers, int workers, size_t maxScans)
+    : m_read(read), m_process(process), m_write(write),
+      m_readers(std::max(readers, 1)),
+      m_maxScans(std::max(maxScans, (size_t)1)),
+      m_nextRead(0), m_numRead(0), m_numWritten(0), m_stop(false)
+{
+    // At most maxScans scans are in flight, more workers would only idle
+    m_workers = (int)std::min((size_t)std::max(workers, 1), m_maxScans);
+}
+
+size_t ScanPipeline::run(const std::vector<boost::filesystem::path>& files)
+{
+    m_jobs.clear();
+    m_jobs.resize(files.size());
+    for(size_t i = 0; i < files.size(); i++)
+    {
+        m_jobs[i].index     = i;
+        m_jobs[i].file      = files[i];
+        m_jobs[i].numPoints = 0;
+        m_jobs[i].colors    = false;
+        m_jobs[i].valid     = true;
+    }
+
+    m_readQueue.clear();
+    m_processed.assign(files.size(), false);
+    m_nextRead   = 0;
+    m_numRead    = 0;
+    m_numWritten = 0;
+    m_stop       = false;
+
+    boost::thread_group threads;
+    for(int i = 0; i < m_readers; i++)
+    {
+        threads.create_thread(boost::bind(&ScanPipeline::readScans, this));
+    }
+    for(int i = 0; i < m_workers; i++)
+    {
+        threads.create_thread(boost::bind(&ScanPipeline::processScans, this));
+    }
+
+    // Write the scans in their order
+    for(size_t i = 0; i < m_jobs.size(); i++)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+            while(!m_processed[i])
+            {
+                m_changed.wait(lock);
+            }
+        }
+
+        ScanJob& job = m_jobs[i];
+        if(!job.valid || !runStage(m_write, job))
+        {
+            break;
+        }
+
+        // Free the scan before the next one may be read
+        job.model.reset();
+        std::string().swap(job.data);
+
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_numWritten++;
+        m_changed.notify_all();
+    }
+
+    {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_stop = true;
+        m_changed.notify_all();
+    }
+    threads.join_all();
+
+    size_t numWritten = m_numWritten;
+    m_jobs.clear();
+    return numWritten;
+}
+
+void ScanPipeline::readScans()
+{
+    while(true)
+    {
+        size_t i;
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+            while(!m_stop && m_nextRead < m_jobs.size() && m_nextRead >= m_numWritten + m_maxScans)
+            {
+                m_changed.wait(lock);
+            }
+            if(m_stop || m_nextRead >= m_jobs.size())
+            {
+                return;
+            }
+            i = m_nextRead++;
+        }
+
+        ScanJob& job = m_jobs[i];
+        job.valid = runStage(m_read, job);
+
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_readQueue.push_back(i);
+        m_numRead++;
+        m_changed.notify_all();
+    }
+}
+
+void ScanPipeline::processScans()
+{
+    // Share the cores between the workers instead of letting every worker
+    // start an OpenMP team of its own
+    lvr::OpenMPConfig::setNumThreads(std::max(lvr::OpenMPConfig::getNumThreads() / m_workers, 1));
+
+    while(true)
+    {
+        size_t i;
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+            while(!m_stop && m_readQueue.empty() && m_numRead < m_jobs.size())
+            {
+                m_changed.wait(lock);
+            }
+            if(m_stop || m_readQueue.empty())
+            {
+                return;
+            }
+            i = m_readQueue.front();
+            m_readQueue.pop_front();
+        }
+
+        ScanJob& job = m_jobs[i];
+        if(job.valid)
+        {
+            job.valid = runStage(m_process, job);
+        }
+
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_processed[i] = true;
+        m_changed.notify_all();
+    }
+}
+
+} // namespace kaboom
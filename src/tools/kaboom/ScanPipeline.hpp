@@ -0,0 +1,154 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * ScanPipeline.hpp
+ */
+
+#ifndef SCANPIPELINE_HPP_
+#define SCANPIPELINE_HPP_
+
+#include <lvr/io/Model.hpp>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace kaboom
+{
+
+/**
+ * @brief   A scan on its way through the pipeline
+ */
+struct ScanJob
+{
+    /// Position of the scan in the output
+    size_t                      index;
+
+    /// The scan file
+    boost::filesystem::path     file;
+
+    /// The point cloud, set by the read stage
+    lvr::ModelPtr               model;
+
+    /// The encoded points, set by the process stage for the writer
+    std::string                 data;
+
+    /// Number of points in data
+    size_t                      numPoints;
+
+    /// Whether data contains colors
+    bool                        colors;
+
+    /// False if a stage failed for this scan
+    bool                        valid;
+};
+
+/**
+ * @brief   Runs the read, process and write stages for a list of scans
+ *          concurrently.
+ *
+ *          Several reader threads load scans, several worker threads
+ *          transform, reduce and encode them and the calling thread writes
+ *          them in the order of the list. At most maxScans scans are between
+ *          being read and written at any time, which bounds the memory and
+ *          both queues. Since a scan is only read if all scans before it fit
+ *          into this window, the scan the writer waits for can always
+ *          proceed. Reading and decoding thus overlap with writing, so the
+ *          disk stays busy while the CPUs work on the next scans. The
+ *          OpenMP threads of the workers are limited so that all workers
+ *          together use one thread per core.
+ *
+ *          If a stage fails for a scan, the scans before it are written and
+ *          the pipeline stops.
+ */
+class ScanPipeline
+{
+public:
+
+    /// A stage of the pipeline. Returns false if the scan can't be processed.
+    typedef boost::function<bool (ScanJob&)> Stage;
+
+    /**
+     * @brief   Constructor.
+     *
+     * @param read      Loads the model of a scan
+     * @param process   Transforms the model and encodes it for the writer
+     * @param write     Writes a scan, called in the order of the scans
+     * @param readers   Number of reader threads
+     * @param workers   Number of worker threads, at most maxScans are used
+     * @param maxScans  Maximum number of scans in the pipeline
+     */
+    ScanPipeline(Stage read, Stage process, Stage write, int readers, int workers, size_t maxScans);
+
+    /**
+     * @brief   Processes the given scans and returns the number of scans
+     *          that were written.
+     */
+    size_t run(const std::vector<boost::filesystem::path>& files);
+
+private:
+
+    /// Takes the next scan in the window and reads it
+    void readScans();
+
+    /// Takes read scans and processes them
+    void processScans();
+
+    Stage                       m_read;
+    Stage                       m_process;
+    Stage                       m_write;
+
+    int                         m_readers;
+    int                         m_workers;
+    size_t                      m_maxScans;
+
+    /// All scans of the current run
+    std::vector<ScanJob>        m_jobs;
+
+    /// Indices of read scans that wait for a worker
+    std::deque<size_t>          m_readQueue;
+
+    /// Whether a scan is ready for the writer
+    std::vector<bool>           m_processed;
+
+    /// Index of the next scan that is handed to a reader
+    size_t                      m_nextRead;
+
+    /// Number of scans that were put into the read queue
+    size_t                      m_numRead;
+
+    /// Number of written scans
+    size_t                      m_numWritten;
+
+    /// Set when the writer stops, the threads exit as soon as possible
+    bool                        m_stop;
+
+    boost::mutex                m_mutex;
+
+    /// Notified whenever one of the counters or queues above changes
+    boost::condition_variable   m_changed;
+};
+
+} // namespace kaboom
+
+#endif /* SCANPIPELINE_HPP_ */
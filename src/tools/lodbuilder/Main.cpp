@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2013 Universität Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "Options.hpp"
+
+#include <lvr/display/PointOctreeLOD.hpp>
+#include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/config/lvropenmp.hpp>
+
+using namespace lvr;
+
+/**
+ * Builds a level of detail hierarchy offline so that viewers can
+ * open large point clouds without processing them again.
+ */
+int main(int argc, char** argv)
+{
+    lodbuilder::Options options(argc, argv);
+    cout << options << endl;
+
+    OpenMPConfig::setMaxNumThreads();
+
+    ModelPtr model = ModelFactory::readModel(options.inputFile());
+    if(!model || !model->m_pointCloud)
+    {
+        cout << timestamp << "IO Error: Unable to parse " << options.inputFile() << endl;
+        return -1;
+    }
+
+    PointOctreeLOD lod(model->m_pointCloud, options.maxLeafPoints(), options.gridResolution());
+
+    cout << timestamp << "Writing hierarchy to " << options.outputDirectory() << endl;
+    lod.save(options.outputDirectory());
+    cout << timestamp << "Finished." << endl;
+
+    return 0;
+}
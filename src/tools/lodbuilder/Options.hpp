@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2013 Universität Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef OPTIONS_H_
+#define OPTIONS_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using std::ostream;
+
+
+namespace lodbuilder
+{
+
+using namespace boost::program_options;
+
+/**
+ * @brief A class to parse the program options for the level of detail
+ *        hierarchy builder.
+ */
+class Options
+{
+public:
+
+    /**
+     * @brief Ctor. Parses the command parameters given to the main
+     *     function of the program
+     */
+    Options(int argc, char** argv);
+    virtual ~Options();
+
+    string  inputFile() const
+    {
+        return (m_variables["inputFile"].as< vector<string> >())[0];
+    }
+
+    string  outputDirectory() const
+    {
+        return (m_variables["outputDir"].as<string>());
+    }
+
+    size_t  maxLeafPoints() const
+    {
+        return (m_variables["leafSize"].as<size_t>());
+    }
+
+    int     gridResolution() const
+    {
+        return (m_variables["gridRes"].as<int>());
+    }
+
+private:
+
+    /// The internally used variable map
+    variables_map m_variables;
+
+    /// The internally used option description
+    options_description m_descr;
+
+    /// The internally used positional option desription
+    positional_options_description m_pdescr;
+
+    string  m_outputDir;
+    size_t  m_leafSize;
+    int     m_gridRes;
+};
+
+inline ostream& operator<<(ostream& os, const Options& o)
+{
+    os << "##### Settings: LOD Builder #####" << endl;
+    os << "Output Directory: " << o.outputDirectory() << endl;
+    os << "Max Leaf Size: " << o.maxLeafPoints() << endl;
+    os << "Grid Resolution: " << o.gridResolution() << endl;
+
+    return os;
+}
+
+} // namespace lodbuilder
+
+#endif
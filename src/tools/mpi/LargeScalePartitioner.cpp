@@ -0,0 +1,523 @@
+//
+// Parallel out-of-core octree partitioning of large point clouds
+//
+
+#include "LargeScalePartitioner.hpp"
+
+#include <lvr/config/lvropenmp.hpp>
+#include <lvr/io/Timestamp.hpp>
+#include <lvr/io/LasIO.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace lvr
+{
+
+const int LargeScalePartitioner::c_directions[c_numDirections][3] =
+    {{0, 0, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}, {0, -1, 0}, {-1, 0, 0},
+     {0, 1, 1}, {0, 1, -1}, {0, -1, 1}, {0, -1, -1},
+     {1, 0, 1}, {1, 0, -1}, {-1, 0, 1}, {-1, 0, -1},
+     {1, 1, 0}, {1, -1, 0}, {-1, 1, 0}, {-1, -1, 0},
+     {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1},
+     {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1}};
+
+namespace
+{
+
+/// Upper bound for the memory used to buffer leaf points before writing
+const size_t MAX_BUFFERED_FLOATS = 128 * 1024 * 1024;
+
+/**
+ * Interleaves the lowest levels bits of x, y and z. The octant order
+ * matches LargeScaleOctree (x: 4, y: 2, z: 1).
+ */
+uint64_t mortonEncode(uint32_t x, uint32_t y, uint32_t z, int levels)
+{
+    uint64_t code = 0;
+    for(int b = 0; b < levels; b++)
+    {
+        uint64_t octant = (((x >> b) & 1) << 2) | (((y >> b) & 1) << 1) | ((z >> b) & 1);
+        code |= octant << (3 * b);
+    }
+    return code;
+}
+
+void mortonDecode(uint64_t code, int levels, uint32_t& x, uint32_t& y, uint32_t& z)
+{
+    x = y = z = 0;
+    for(int b = 0; b < levels; b++)
+    {
+        uint64_t octant = (code >> (3 * b)) & 7;
+        x |= ((octant >> 2) & 1) << b;
+        y |= ((octant >> 1) & 1) << b;
+        z |= (octant & 1) << b;
+    }
+}
+
+/// Appends buffered points to a leaf file and clears the buffer
+void flushLeaf(const string& path, vector<float>& buffer)
+{
+    if(buffer.empty())
+    {
+        return;
+    }
+    ofstream out(path.c_str(), std::ios::binary | std::ios::app);
+    out.write((char*)&buffer[0], buffer.size() * sizeof(float));
+    vector<float>().swap(buffer);
+}
+
+} // anonymous namespace
+
+LargeScalePartitioner::LargeScalePartitioner(string outputDir, size_t maxPoints, int maxLevel, size_t chunkSize)
+    : m_outputDir(outputDir),
+      m_maxPoints(maxPoints),
+      m_maxLevel(std::min(std::max(maxLevel, 1), 10)),
+      m_chunkSize(std::max(chunkSize, (size_t)1024)),
+      m_size(0)
+{
+    m_min[0] = m_min[1] = m_min[2] = 0.0f;
+    m_shift[0] = m_shift[1] = m_shift[2] = 0.0;
+}
+
+bool LargeScalePartitioner::readChunks(string inputFile, std::function<void(vector<float>&)> f)
+{
+    // LAS files are decoded in parallel chunks of the same size in memory.
+    // The shift is derived from the header, so every pass uses the same.
+    string extension = boost::filesystem::path(inputFile).extension().string();
+    if(extension == ".las" || extension == ".laz")
+    {
+        if(!LasIO::readChunks(inputFile, m_chunkSize / (3 * sizeof(float)), f, m_shift))
+        {
+            cout << timestamp << "Partitioner: Unable to read " << inputFile << endl;
+            return false;
+        }
+        return true;
+    }
+
+    ifstream in(inputFile.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        cout << timestamp << "Partitioner: Unable to open " << inputFile << endl;
+        return false;
+    }
+
+    int numPieces = OpenMPConfig::getNumThreads();
+    vector<char> data;
+    vector<char> rest;
+
+    while(true)
+    {
+        data.swap(rest);
+        rest.clear();
+
+        size_t old = data.size();
+        data.resize(old + m_chunkSize);
+        in.read(&data[old], m_chunkSize);
+        size_t got = in.gcount();
+        data.resize(old + got);
+
+        bool eof = !in;
+        if(data.empty())
+        {
+            break;
+        }
+
+        // Only parse complete lines, keep the rest for the next chunk
+        if(!eof)
+        {
+            size_t end = data.size();
+            while(end > 0 && data[end - 1] != '\n')
+            {
+                end--;
+            }
+            if(end == 0)
+            {
+                // No complete line yet, read more
+                rest.swap(data);
+                continue;
+            }
+            rest.assign(data.begin() + end, data.end());
+            data.resize(end);
+        }
+        data.push_back('\0');
+
+        // Split the chunk at line boundaries and parse the pieces in parallel
+        size_t length = data.size() - 1;
+        vector<size_t> starts(numPieces + 1, length);
+        starts[0] = 0;
+        for(int p = 1; p < numPieces; p++)
+        {
+            size_t s = std::max(starts[p - 1], p * length / numPieces);
+            while(s < length && s > 0 && data[s - 1] != '\n')
+            {
+                s++;
+            }
+            starts[p] = s;
+        }
+
+        vector<vector<float> > parsed(numPieces);
+
+        #pragma omp parallel for schedule(static)
+        for(int p = 0; p < numPieces; p++)
+        {
+            size_t pos = starts[p];
+            while(pos < starts[p + 1])
+            {
+                char* line = &data[pos];
+                char* lineEnd = (char*)memchr(line, '\n', starts[p + 1] - pos);
+                if(lineEnd)
+                {
+                    *lineEnd = '\0';
+                    pos = lineEnd - &data[0] + 1;
+                }
+                else
+                {
+                    pos = starts[p + 1];
+                }
+
+                float v[3];
+                char* c = line;
+                int i = 0;
+                for(; i < 3; i++)
+                {
+                    char* next;
+                    v[i] = strtof(c, &next);
+                    if(next == c)
+                    {
+                        break;
+                    }
+                    c = next;
+                }
+
+                // Skip headers, comments and empty lines
+                if(i == 3)
+                {
+                    parsed[p].insert(parsed[p].end(), v, v + 3);
+                }
+            }
+        }
+
+        size_t total = 0;
+        for(int p = 0; p < numPieces; p++)
+        {
+            total += parsed[p].size();
+        }
+
+        vector<float> points;
+        points.reserve(total);
+        for(int p = 0; p < numPieces; p++)
+        {
+            points.insert(points.end(), parsed[p].begin(), parsed[p].end());
+            vector<float>().swap(parsed[p]);
+        }
+
+        f(points);
+
+        if(eof && rest.empty())
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+uint64_t LargeScalePartitioner::cellCode(const float* p) const
+{
+    uint32_t n = 1u << m_maxLevel;
+    uint32_t c[3];
+    for(int i = 0; i < 3; i++)
+    {
+        long idx = (long)((p[i] - m_min[i]) / m_size * n);
+        c[i] = (uint32_t)std::min(std::max(idx, 0L), (long)n - 1);
+    }
+    return mortonEncode(c[0], c[1], c[2], m_maxLevel);
+}
+
+bool LargeScalePartitioner::partition(string inputFile)
+{
+    boost::filesystem::create_directories(m_outputDir);
+    m_leafs.clear();
+
+    // Pass 1: Bounding box
+    float bmin[3] = { std::numeric_limits<float>::max(),  std::numeric_limits<float>::max(),  std::numeric_limits<float>::max()};
+    float bmax[3] = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+    size_t numPoints = 0;
+
+    bool ok = readChunks(inputFile, [&](vector<float>& points)
+    {
+        size_t n = points.size() / 3;
+        for(size_t i = 0; i < n; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                bmin[j] = std::min(bmin[j], points[3 * i + j]);
+                bmax[j] = std::max(bmax[j], points[3 * i + j]);
+            }
+        }
+        numPoints += n;
+    });
+
+    if(!ok)
+    {
+        return false;
+    }
+
+    if(numPoints == 0)
+    {
+        cout << timestamp << "Partitioner: No points found in " << inputFile << endl;
+        return false;
+    }
+
+    if(m_shift[0] != 0.0 || m_shift[1] != 0.0 || m_shift[2] != 0.0)
+    {
+        cout << timestamp << "Partitioner: Coordinates are shifted by ("
+             << m_shift[0] << ", " << m_shift[1] << ", " << m_shift[2] << ")" << endl;
+    }
+
+    memcpy(m_min, bmin, sizeof(bmin));
+    m_size = std::max(bmax[0] - bmin[0], std::max(bmax[1] - bmin[1], bmax[2] - bmin[2]));
+    m_size = std::max(m_size * 1.0001f, std::numeric_limits<float>::epsilon());
+    cout << timestamp << "Partitioner: Read " << numPoints << " points." << endl;
+
+    // Pass 2: Morton codes on the finest level and cell histogram
+    size_t numCells = (size_t)1 << (3 * m_maxLevel);
+    vector<uint64_t> histogram(numCells + 1, 0);
+
+    ok = readChunks(inputFile, [&](vector<float>& points)
+    {
+        long n = points.size() / 3;
+        vector<uint64_t> codes(n);
+
+        #pragma omp parallel for schedule(static)
+        for(long i = 0; i < n; i++)
+        {
+            codes[i] = cellCode(&points[3 * i]);
+        }
+
+        for(long i = 0; i < n; i++)
+        {
+            histogram[codes[i] + 1]++;
+        }
+    });
+
+    if(!ok)
+    {
+        return false;
+    }
+
+    // Prefix sums give the point count of every octree node in O(1)
+    for(size_t i = 1; i <= numCells; i++)
+    {
+        histogram[i] += histogram[i - 1];
+    }
+
+    m_cellLeafs.assign(numCells, -1);
+    buildTree(0, 0, histogram);
+    vector<uint64_t>().swap(histogram);
+
+    cout << timestamp << "Partitioner: Created " << m_leafs.size() << " leafs." << endl;
+
+    // Write the headers of the leaf files. The format matches
+    // LargeScaleScheduler::savePartition() without normals.
+    for(size_t i = 0; i < m_leafs.size(); i++)
+    {
+        ofstream out(m_leafs[i].path.c_str(), std::ios::binary | std::ios::trunc);
+        uint64_t header[2] = {m_leafs[i].numPoints, 0};
+        out.write((char*)header, sizeof(header));
+    }
+
+    // Pass 3: Distribute the points. Every point is written once, the
+    // leaf buffers are flushed when they get too large.
+    vector<vector<float> > buffers(m_leafs.size());
+    size_t flushSize = std::max((size_t)3 * 4096, MAX_BUFFERED_FLOATS / std::max(m_leafs.size(), (size_t)1));
+
+    ok = readChunks(inputFile, [&](vector<float>& points)
+    {
+        long n = points.size() / 3;
+        vector<int32_t> leafs(n);
+
+        #pragma omp parallel for schedule(static)
+        for(long i = 0; i < n; i++)
+        {
+            leafs[i] = m_cellLeafs[cellCode(&points[3 * i])];
+        }
+
+        for(long i = 0; i < n; i++)
+        {
+            vector<float>& b = buffers[leafs[i]];
+            b.insert(b.end(), &points[3 * i], &points[3 * i] + 3);
+        }
+
+        vector<size_t> full;
+        for(size_t i = 0; i < buffers.size(); i++)
+        {
+            if(buffers[i].size() >= flushSize)
+            {
+                full.push_back(i);
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for(long i = 0; i < (long)full.size(); i++)
+        {
+            flushLeaf(m_leafs[full[i]].path, buffers[full[i]]);
+        }
+    });
+
+    #pragma omp parallel for schedule(dynamic)
+    for(long i = 0; i < (long)buffers.size(); i++)
+    {
+        flushLeaf(m_leafs[i].path, buffers[i]);
+    }
+
+    if(!ok)
+    {
+        return false;
+    }
+
+    computeNeighbors();
+    cout << timestamp << "Partitioner: Finished." << endl;
+    return true;
+}
+
+void LargeScalePartitioner::buildTree(int level, uint64_t code, const vector<uint64_t>& prefix)
+{
+    int shift = 3 * (m_maxLevel - level);
+    uint64_t first = code << shift;
+    uint64_t last = (code + 1) << shift;
+    uint64_t count = prefix[last] - prefix[first];
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    if(count <= m_maxPoints || level == m_maxLevel)
+    {
+        if(count > m_maxPoints)
+        {
+            cout << timestamp << "Partitioner: Leaf on finest level has " << count
+                 << " points. Consider a larger maximum level." << endl;
+        }
+
+        PartitionLeaf leaf;
+        uint32_t x, y, z;
+        mortonDecode(code, level, x, y, z);
+        leaf.length = m_size / (1 << level);
+        leaf.center = Vertexf(m_min[0] + (x + 0.5f) * leaf.length,
+                              m_min[1] + (y + 0.5f) * leaf.length,
+                              m_min[2] + (z + 0.5f) * leaf.length);
+        leaf.level = level;
+        leaf.code = code;
+        leaf.numPoints = count;
+        leaf.path = (boost::filesystem::path(m_outputDir) / (to_string(m_leafs.size()) + ".bin")).string();
+
+        std::fill(m_cellLeafs.begin() + first, m_cellLeafs.begin() + last, (int32_t)m_leafs.size());
+        m_leafs.push_back(leaf);
+        return;
+    }
+
+    for(int o = 0; o < 8; o++)
+    {
+        buildTree(level + 1, code * 8 + o, prefix);
+    }
+}
+
+void LargeScalePartitioner::computeNeighbors()
+{
+    long n = 1 << m_maxLevel;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(long l = 0; l < (long)m_leafs.size(); l++)
+    {
+        PartitionLeaf& leaf = m_leafs[l];
+        long f = 1 << (m_maxLevel - leaf.level);
+
+        uint32_t x, y, z;
+        mortonDecode(leaf.code, leaf.level, x, y, z);
+        long start[3] = {x * f, y * f, z * f};
+
+        for(int d = 0; d < c_numDirections; d++)
+        {
+            // Range of finest cells next to the face, edge or corner: one
+            // layer outside of the leaf on the axes with a direction and
+            // the extent of the leaf on the others
+            long begin[3], end[3];
+            bool inside = true;
+            for(int k = 0; k < 3; k++)
+            {
+                if(c_directions[d][k] > 0)
+                {
+                    begin[k] = start[k] + f;
+                    end[k] = begin[k] + 1;
+                }
+                else if(c_directions[d][k] < 0)
+                {
+                    begin[k] = start[k] - 1;
+                    end[k] = start[k];
+                }
+                else
+                {
+                    begin[k] = start[k];
+                    end[k] = start[k] + f;
+                }
+                inside = inside && begin[k] >= 0 && end[k] <= n;
+            }
+            if(!inside)
+            {
+                continue;
+            }
+
+            vector<size_t>& neighbors = leaf.neighbors[d];
+            for(long i = begin[0]; i < end[0]; i++)
+            {
+                for(long j = begin[1]; j < end[1]; j++)
+                {
+                    for(long k = begin[2]; k < end[2]; k++)
+                    {
+                        int32_t id = m_cellLeafs[mortonEncode(i, j, k, m_maxLevel)];
+                        if(id >= 0 && (neighbors.empty() || neighbors.back() != (size_t)id))
+                        {
+                            neighbors.push_back(id);
+                        }
+                    }
+                }
+            }
+
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        }
+    }
+}
+
+void LargeScalePartitioner::writeNeighborMap(string file)
+{
+    ofstream out(file.c_str());
+    for(size_t l = 0; l < m_leafs.size(); l++)
+    {
+        for(int d = 0; d < c_numDirections; d++)
+        {
+            if(m_leafs[l].neighbors[d].empty())
+            {
+                continue;
+            }
+
+            out << m_leafs[l].path << " " << c_directions[d][0] << " "
+                << c_directions[d][1] << " " << c_directions[d][2];
+            for(size_t i = 0; i < m_leafs[l].neighbors[d].size(); i++)
+            {
+                out << " " << m_leafs[m_leafs[l].neighbors[d][i]].path;
+            }
+            out << endl;
+        }
+    }
+}
+
+} // namespace lvr
@@ -0,0 +1,160 @@
+//
+// Parallel out-of-core octree partitioning of large point clouds
+//
+
+#ifndef LAS_VEGAS_LARGESCALEPARTITIONER_H
+#define LAS_VEGAS_LARGESCALEPARTITIONER_H
+
+#include <lvr/geometry/Vertex.hpp>
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace lvr
+{
+
+/**
+ * @brief   A leaf of the partitioning octree
+ */
+struct PartitionLeaf
+{
+    /// Binary point file of the leaf (LargeScaleScheduler::loadPartition format)
+    string          path;
+
+    /// Number of points in the leaf
+    size_t          numPoints;
+
+    /// Center of the leaf cube
+    Vertexf         center;
+
+    /// Edge length of the leaf cube
+    float           length;
+
+    /// Octree level of the leaf
+    int             level;
+
+    /// Morton code of the leaf on its level
+    uint64_t        code;
+
+    /**
+     * Indices of the neighboring leaves in the directions of
+     * LargeScalePartitioner::c_directions: the six faces, the twelve
+     * edges and the eight corners of the leaf cube
+     */
+    vector<size_t>  neighbors[26];
+};
+
+/**
+ * @brief   Splits an ASCII or LAS point cloud into the leafs of an octree.
+ *
+ *          The input is streamed in chunks three times. The first pass
+ *          computes the bounding box, the second one computes Morton
+ *          codes of all points on the finest level in parallel and
+ *          counts them in a histogram. The octree is derived from the
+ *          histogram without touching the points. The last pass sorts
+ *          every point into its leaf and writes it exactly once into a
+ *          binary file per leaf. The neighborhood of the leafs is
+ *          computed from the same histogram grid.
+ */
+class LargeScalePartitioner
+{
+public:
+
+    /**
+     * @brief   Creates a partitioner
+     *
+     * @param outputDir     Directory for the leaf files
+     * @param maxPoints     Leafs with more points are split
+     * @param maxLevel      Depth of the finest level. The histogram has
+     *                      8^maxLevel entries
+     * @param chunkSize     Bytes of input that are processed at once
+     */
+    LargeScalePartitioner(string outputDir, size_t maxPoints, int maxLevel = 7,
+                          size_t chunkSize = 64 * 1024 * 1024);
+
+    /**
+     * @brief   Partitions the given ASCII or LAS file. Only the first
+     *          three columns of each line of ASCII files are used.
+     *          Georeferenced LAS coordinates are shifted like in
+     *          LasIO::read(), see getShift().
+     *
+     * @return  False if the input can't be read or contains no points
+     */
+    bool partition(string inputFile);
+
+    /// Returns the leafs that contain points
+    vector<PartitionLeaf>& getLeafs() { return m_leafs; }
+
+    /// Returns the minimum corner of the root cube
+    Vertexf getOrigin() const { return Vertexf(m_min[0], m_min[1], m_min[2]); }
+
+    /// Returns the edge length of the root cube
+    float getSize() const { return m_size; }
+
+    /// Returns the shift that was subtracted from all input coordinates
+    const double* getShift() const { return m_shift; }
+
+    /**
+     * @brief   Writes the neighborhood of all leafs into a text file. Each
+     *          line contains the path of a leaf, a direction and the paths
+     *          of all neighbors in that direction.
+     */
+    void writeNeighborMap(string file);
+
+    /// Number of directions used for the neighbor lists
+    static const int    c_numDirections = 26;
+
+    /// Directions used for the neighbor lists, faces first, then edges and corners
+    static const int    c_directions[c_numDirections][3];
+
+private:
+
+    /// Streams the input in chunks and calls f with the parsed coordinates.
+    /// Returns false if the input can't be read.
+    bool readChunks(string inputFile, std::function<void(vector<float>&)> f);
+
+    /// Returns the cell index of a point on the finest level
+    uint64_t cellCode(const float* p) const;
+
+    /// Creates the leafs below the given node from the histogram
+    void buildTree(int level, uint64_t code, const vector<uint64_t>& prefix);
+
+    /// Computes the neighbor lists of all leafs
+    void computeNeighbors();
+
+    /// Directory of the leaf files
+    string                  m_outputDir;
+
+    /// Maximum number of points in a leaf
+    size_t                  m_maxPoints;
+
+    /// Depth of the finest octree level
+    int                     m_maxLevel;
+
+    /// Number of bytes read at once
+    size_t                  m_chunkSize;
+
+    /// Minimum corner of the root cube
+    float                   m_min[3];
+
+    /// Edge length of the root cube
+    float                   m_size;
+
+    /// Shift of georeferenced LAS coordinates, see Model::m_shift
+    double                  m_shift[3];
+
+    /// Leaf index of every cell on the finest level, -1 for empty cells
+    vector<int32_t>         m_cellLeafs;
+
+    /// The leafs
+    vector<PartitionLeaf>   m_leafs;
+};
+
+} // namespace lvr
+
+#endif //LAS_VEGAS_LARGESCALEPARTITIONER_H
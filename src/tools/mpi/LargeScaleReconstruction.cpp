@@ -1,10 +1,15 @@
 //
 // Created by eiseck on 17.12.15.
 //
+#include <ctime>
 #include <fstream>
+#include <iomanip>
+#include <limits>
 #include "NodeData.hpp"
 #include <algorithm>
-#include "LargeScaleOctree.hpp"
+#include "LargeScalePartitioner.hpp"
+#include "LargeScaleScheduler.hpp"
+#include "LargeScaleStitcher.hpp"
 #include <string>
 #include <sstream>
 #include <boost/mpi/environment.hpp>
@@ -29,6 +34,7 @@
 #include <lvr/geometry/QuadricVertexCosts.hpp>
 #include "Options.hpp"
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 #ifdef LVR_USE_PCL
 #include <lvr/reconstruction/PCLKSurface.hpp>
 #endif
@@ -42,67 +48,38 @@ typedef AdaptiveKSearchSurface<ColorVertex<float, unsigned char>, Normal<float>
 #ifdef LVR_USE_PCL
 typedef PCLKSurface<ColorVertex<float, unsigned char> , Normal<float> > pclSurface;
 #endif
-enum MPIMSGSTATUS {DATA, FINISHED};
-
-bool nodePtrCompare(LargeScaleOctree* rhs, LargeScaleOctree* lhs)
+/**
+ * Returns the path of the binary cache file for the points and normals
+ * of the given partition. If localDir is empty the file is placed next
+ * to the partition. Otherwise the name contains the partition directory
+ * of this run, so caches of earlier runs are never mistaken for it.
+ */
+string partitionCachePath(string path, string localDir)
 {
-    return (*lhs) < (*rhs);
+    boost::filesystem::path p(path);
+    p.replace_extension(".bin");
+    if(localDir.empty())
+    {
+        return p.string();
+    }
+    string run = p.parent_path().filename().string();
+    return (boost::filesystem::path(localDir) / (run + "-" + p.filename().string())).string();
 }
 
-void getNeighborsOnSide(Vertexf dir, vector<std::pair<Vertexf, LargeScaleOctree*> >& neighbors, LargeScaleOctree* currentNode)
+/**
+ * Reads a cached partition and checks that it holds the expected number
+ * of points. Returns an empty pointer if there is no matching cache.
+ */
+PointBufferPtr loadCachedPartition(string path, size_t numPoints)
 {
-    if(currentNode->isLeaf())
-    {
-        neighbors.push_back(std::pair<Vertexf, LargeScaleOctree*>(dir*-1,currentNode));
-        return;
-    }
-    int ids[4];
-    if(dir.x == 1)
-    {
-        ids[0] = 4;
-        ids[1] = 5;
-        ids[2] = 6;
-        ids[3] = 7;
-    }
-    else if(dir.x == -1)
-    {
-        ids[0] = 0;
-        ids[1] = 1;
-        ids[2] = 2;
-        ids[3] = 3;
-    }
-    else if(dir.y == 1)
-    {
-        ids[0] = 2;
-        ids[1] = 3;
-        ids[2] = 6;
-        ids[3] = 7;
-    }
-    else if(dir.y == -1)
+    PointBufferPtr buffer = LargeScaleScheduler::loadPartition(path);
+    if(buffer && numPoints && buffer->getNumPoints() != numPoints)
     {
-        ids[0] = 0;
-        ids[1] = 1;
-        ids[2] = 4;
-        ids[3] = 5;
-    }
-    else if(dir.z == 1)
-    {
-        ids[0] = 1;
-        ids[1] = 3;
-        ids[2] = 5;
-        ids[3] = 7;
-    }
-    else if(dir.z == -1)
-    {
-        ids[0] = 0;
-        ids[1] = 2;
-        ids[2] = 4;
-        ids[3] = 6;
-    }
-    for(int i = 0 ; i<4 ;i++)
-    {
-        getNeighborsOnSide(dir, neighbors, (currentNode->getChildren()[ids[i]]));
+        cout << timestamp << "Ignoring " << path << ", it holds " << buffer->getNumPoints()
+             << " instead of " << numPoints << " points." << endl;
+        return PointBufferPtr();
     }
+    return buffer;
 }
 
 int main(int argc, char* argv[])
@@ -118,6 +95,14 @@ int main(int argc, char* argv[])
         return 0;
     }
     OpenMPConfig::setNumThreads(options.getNumThreads());
+
+    // Checked on every node, so all of them stop before any communication
+    string decomposition = options.getDecomposition();
+    if(decomposition != "MC" && decomposition != "PMC" && decomposition != "SF")
+    {
+        cout << timestamp << "Unsupported decomposition '" << decomposition << "'. Use MC, PMC or SF." << endl;
+        return 1;
+    }
     //std::cout << options << std::endl;
 
 /*    ifstream ifs(argv[1]);
@@ -144,471 +129,184 @@ int main(int argc, char* argv[])
     {
         std::cout << options << std::endl;
         cout << lvr::timestamp << "start" << endl;
-        clock_t begin = clock();
-        ifstream inputData(options.getInputFileName());
-        string s;
-        BoundingBox<Vertexf> box;
-        int j = 1;
-        while( getline( inputData, s ) )
+        // Split the input into octree leafs. Every point is written once
+        // into a binary file per leaf
+        string partitionDir = "node-" + to_string(std::time(0));
+        LargeScalePartitioner partitioner(partitionDir, options.getOctreeNodeSize());
+        LargeScaleScheduler scheduler(world, options.shipPoints());
+        if(!partitioner.partition(options.getInputFileName()))
         {
-            stringstream ss;
-            ss.str(s);
-            Vertexf v;
-            ss >> v.x >> v.y >> v.z;
-            box.expand(v);
-
+            cout << timestamp << "Unable to partition " << options.getInputFileName() << endl;
+            scheduler.finish();
+            return 1;
         }
+        cout << lvr::timestamp << "...Octree finished" << endl;
 
-        float size = box.getLongestSide();
-        Vertexf center = box.getMax()+box.getMin();
-        center/=2;
-        cout << lvr::timestamp << box << endl << "--------" << endl;
-
-        LargeScaleOctree octree(center, size, options.getOctreeNodeSize() );
-
-        inputData.close();
-        inputData.clear();
-        ifstream inputData2(options.getInputFileName());
-
-        while( getline( inputData2, s ) )
+        // Georeferenced coordinates are shifted before they are converted
+        // to float. The shift is kept with the partitions and the mesh.
+        const double* shift = partitioner.getShift();
         {
-            stringstream ss;
-            ss.str(s);
-            Vertexf v;
-            ss >> v.x >> v.y >> v.z;
-            octree.insert(v);
-
+            ofstream ofs(partitionDir + "/shift.txt");
+            ofs << std::setprecision(std::numeric_limits<double>::max_digits10);
+            ofs << shift[0] << " " << shift[1] << " " << shift[2] << endl;
         }
 
-        cout << lvr::timestamp << "...Octree finished" << endl;
-        clock_t end = clock();
-        vector<LargeScaleOctree*> nodes = octree.getNodes() ;
-        vector<LargeScaleOctree*> leafs;
-        vector<LargeScaleOctree*> originleafs;
-
-        //auto it = std::copy_if (nodes.begin(), nodes.end(), leafs.begin(), [](LargeScaleOctree* oc){return oc->isLeaf();} );
+        vector<PartitionLeaf>& allLeafs = partitioner.getLeafs();
+        vector<PartitionLeaf*> leafs;
         size_t minSize = std::max(std::max(options.getKn(), options.getKd()), options.getKi());
         cout << "min size: " << options.getKn() << endl;
-	    for(int i = 0 ; i< nodes.size() ; i++)
+        for(size_t i = 0 ; i < allLeafs.size() ; i++)
         {
-            if(nodes[i]->isLeaf() && nodes[i]->getSize()>minSize )
+            if(allLeafs[i].numPoints > minSize)
             {
-                leafs.push_back(nodes[i]);
-
+                leafs.push_back(&allLeafs[i]);
             }
         }
-        std::string firstpath = leafs[0]->getFilePath();
-        std::sort(leafs.begin(), leafs.end(), nodePtrCompare);
-        for(int i = 0 ; i< leafs.size(); i++)
-        {
-            cout << lvr::timestamp << leafs[i]->getFilePath() << " size: " << leafs[i]->getSize() << endl;
-        }
-        vector<string> nodePaths(leafs.size());
-        for(int i = 0 ; i< leafs.size() ; i++)
+        for(size_t i = 0 ; i < leafs.size(); i++)
         {
-            nodePaths.push_back(leafs[i]->getFilePath());
+            cout << lvr::timestamp << leafs[i]->path << " size: " << leafs[i]->numPoints << endl;
         }
-
-        //leafs.resize(std::distance(nodes.begin(),it));  // shrink container to new size
         cout << lvr::timestamp << "...got leafs, amount = " <<  leafs.size()<< endl;
-        originleafs = leafs;
-        for(int i = 0 ; i<originleafs.size() ; i++)
+
+        // All partitions share one query point lattice, so their meshes can
+        // be stitched. With a given number of intersections the voxel size
+        // is derived from the whole point cloud.
+        Vertexf origin = partitioner.getOrigin();
+        float voxelsize = options.getIntersections() > 0
+                ? partitioner.getSize() / options.getIntersections()
+                : options.getVoxelsize();
+
+        for(size_t i = 0 ; i < leafs.size() ; i++)
         {
-            string path = originleafs[i]->getFilePath();
-            boost::algorithm::replace_last(path, "xyz", "bb");
-            //HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > mainGrid(path);
-            float r = originleafs[i]->getLength()/2;
+            string path = boost::filesystem::path(leafs[i]->path).replace_extension(".bb").string();
+            float r = leafs[i]->length / 2;
             Vertexf rr(r,r,r);
-            Vertexf min = originleafs[i]->getCenter()-rr;
-            Vertexf max = originleafs[i]->getCenter()+rr;
+            Vertexf min = leafs[i]->center - rr;
+            Vertexf max = leafs[i]->center + rr;
+            // Written with full precision, so the workers read the exact
+            // boxes and lattice and the partitions' cells line up
             ofstream ofs(path);
+            ofs << std::setprecision(std::numeric_limits<float>::max_digits10);
             ofs << min.x << " " << min.y << " " << min.z  << " " << max.x << " " << max.y << " " << max.z << endl;
+            ofs << origin.x << " " << origin.y << " " << origin.z << " " << voxelsize << endl;
             ofs.close();
-
-        }
-        //Creating neighbor map
-        std::map<string,vector<std::pair<Vertexf, LargeScaleOctree*> > > nmap;
-        for(LargeScaleOctree* OTNode : leafs)
-        {
-            Vertexf center = OTNode->getCenter();
-            float radius = OTNode->getLength()/2;
-            const Vertexf directions[] = {{0,0,1}, {0,1,0}, {1,0,0}, {0,0,-1}, {0,-1,0}, {-1,0,0}};
-            vector<std::pair<Vertexf, LargeScaleOctree*> > currentNeigbors;
-            LargeScaleOctree* currentNode = &octree;
-            Vertexf max = octree.getCenter() + Vertexf(1,1,1)*(octree.getLength()/2);
-            Vertexf min = octree.getCenter() + Vertexf(-1,-1,-1)*(octree.getLength()/2);
-            //get neighbor for each direction (left, right, up, down, front, back)
-            for(int i = 0 ; i<6 ; i++)
-            {
-                LargeScaleOctree* currentNode = &octree;
-                Vertexf dirPoint = center + (directions[i]*(radius+(radius/2)));
-                int depth = 0;
-
-                while (!currentNode->isLeaf())
-                {
-                    if( dirPoint.x > max.x || dirPoint.y > max.y || dirPoint.z > max.z ||
-                        dirPoint.x < min.x || dirPoint.y < min.y || dirPoint.z < min.z )
-                    {
-                        break;
-                    }
-                    //Check if neighbor Node is the same size
-                    if(fabs(currentNode->getLength() - OTNode->getLength())<=1 || currentNode->isLeaf()) break;
-                    int nextChildNode = currentNode->getOctant(dirPoint);
-                    currentNode = currentNode->getChildren()[nextChildNode];
-                    //currentNode = &(currentNode->getChildren()[currentNode->getOctant(dirPoint)]);
-                    depth++;
-                    if(currentNode == 0) {
-                        cout <<"no!" << endl;
-                        break;
-                    }
-
-                }
-                if(depth>0 && currentNode->isLeaf() && currentNode!=0)
-                {
-                    currentNeigbors.push_back(std::pair<Vertexf, LargeScaleOctree*>(directions[i],currentNode));
-                }
-                else if(!(dirPoint.x > max.x || dirPoint.y > max.y || dirPoint.z > max.z ||
-                        dirPoint.x < min.x || dirPoint.y < min.y || dirPoint.z < min.z ))
-                {
-                    getNeighborsOnSide(directions[i]*-1, currentNeigbors,  currentNode);
-                }
-
-
-            }
-            if(! currentNeigbors.empty())
-            {
-                nmap[OTNode->getFilePath()] = currentNeigbors;
-            }
-
         }
 
-        /*cout << "MAP size: " << nmap.size() << endl;
-        for(auto it = nmap.begin() ; it != nmap.end() ; it++)
-        {
-            cout << it->first << " : " ;
-            for(auto n : it->second)
-            {
-                cout << n->getFilePath() << " ";
-            }
-            cout << endl;
-        }*/
-
-
-        stack<char> waitingfor;
-        for(int i = 1 ; i< world.size() && !leafs.empty() ; i++)
-        {
-            cout << "...sending to " << i << " do:  " << leafs.back()->getFilePath() << endl;
-            world.send(i, DATA, leafs.back()->getFilePath());
-            waitingfor.push(1);
-            cout << "...poping to " << i << endl;
-            leafs.pop_back();
-        }
-        cout << "...got leafs" << endl;
-        //WHILE DATA to send
+        // Neighbor map: leaf, direction and all leafs adjacent on that side
+        partitioner.writeNeighborMap(partitionDir + "/neighbors.txt");
 
-        while(! leafs.empty() || waitingfor.size()>0)
+        // Compute normals and distance grids of all leafs. The point counts
+        // are used as cost estimate for the scheduling
+        vector<PartitionTask> tasks(leafs.size());
+        for(size_t i = 0 ; i < leafs.size() ; i++)
         {
-            cout << "leafs left: " << leafs.size() << endl;
-            string msg;
-            mpi::status requests = world.recv(boost::mpi::any_source, FINISHED, msg);
-            waitingfor.pop();
-            cout << "######## rank 0 got message" << endl;
-
-            //cout << "######## testing " << requests.test()<< endl;
-            int rid = requests.source();
-            cout << "from" << requests.source() << endl;
-            cout << "QQQQQQQQQQQQQQQQQQQQQQQQ " << waitingfor.size() << "|" << leafs.size() << endl;
-            if(! leafs.empty())
+            tasks[i].path = leafs[i]->path;
+            tasks[i].numPoints = leafs[i]->numPoints;
+
+            // Neighbors across faces, edges and corners provide the points
+            // of the ghost layers. A large neighbor may touch several of
+            // them, but its points must only be added once.
+            vector<size_t> neighbors;
+            for(int d = 0 ; d < LargeScalePartitioner::c_numDirections ; d++)
             {
-                world.send(rid, DATA, leafs.back()->getFilePath());
-                leafs.pop_back();
-                waitingfor.push(1);
+                neighbors.insert(neighbors.end(), leafs[i]->neighbors[d].begin(), leafs[i]->neighbors[d].end());
             }
-            else if(waitingfor.size()==0)
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+            for(size_t n = 0 ; n < neighbors.size() ; n++)
             {
-                for(int i = 1 ; i< world.size() && !leafs.empty() ; i++)
-                {
-                    cout << "...sending to " << i << " finished"  << endl;
-                    world.send(i, DATA, "ready");
-
-                }
-                break;
+                tasks[i].neighbors.push_back(allLeafs[neighbors[n]].path);
             }
-
         }
+        scheduler.run(tasks);
+        cout << lvr::timestamp << "...got leafs" << endl;
 
-        //test
-        /*firstpath.pop_back();
-        firstpath.pop_back();
-        firstpath.pop_back();
-        firstpath.append("grid");
-        cout << "fpath: " << firstpath << endl;
-        HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > hg(firstpath);
-        cout << hg.getQueryPoints().size() << " " << hg.getNumberOfCells() << endl;
-        hg.serialize("test.grid");
-         */
-
-
-        int latticeDirID[6][4] =
+        // Reconstruct the meshes. Each grid is preferrably handled by the
+        // rank that created it, as it holds the cached partition data.
+        vector<PartitionTask> gridTasks(leafs.size());
+        for(size_t i = 0 ; i < leafs.size() ; i++)
         {
-            {2,6,1,5},
-            {3,7,2,6},
-            {7,4,5,6},
-            {0,4,3,7},
-            {4,0,1,5},
-            {0,1,2,3}
-        };
-/*
-        for(auto it = nmap.begin() ; it != nmap.end() ; it++)
+            gridTasks[i].preferredRank = scheduler.getRank(leafs[i]->path);
+            gridTasks[i].numPoints = leafs[i]->numPoints;
+            gridTasks[i].path = boost::filesystem::path(leafs[i]->path).replace_extension(".grid").string();
+        }
+        // The workers need the cached points with normals, so the raw
+        // points are not shipped in this stage
+        scheduler.run(gridTasks, false);
+        scheduler.finish();
+
+        // Weld the partition meshes along the shared lattice edges
+        vector<string> meshFiles;
+        for(size_t i = 0 ; i < leafs.size() ; i++)
         {
-
-            string mainPath = it->first;
-            boost::replace_all(mainPath, "xyz", "grid");
-            HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > mainGrid(mainPath);
-            BoundingBox<ColorVertex<float, unsigned char> > & mbb = mainGrid.getBoundingBox();
-            Vertexf maxMainIndices(mainGrid.getMaxIndexX(), mainGrid.getMaxIndexY(), mainGrid.getMaxIndexZ());
-            for(auto neighbor : it->second)
+            string meshFile = boost::filesystem::path(leafs[i]->path).replace_extension(".ply").string();
+            if(boost::filesystem::exists(meshFile))
             {
-
-                string neighborPath = neighbor.second->getFilePath();
-                if(std::find(nodePaths.begin(), nodePaths.end(), neighborPath) == nodePaths.end()) break;
-                cout << "interpolating points of " << it->first << " with: " << neighborPath<< endl;
-                boost::replace_all(neighborPath, "xyz", "grid");
-
-
-                if(boost::filesystem::exists(neighborPath))
-                {
-                    HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > neighborGrid(neighborPath);
-
-                    BoundingBox<ColorVertex<float, unsigned char> > & nbb = neighborGrid.getBoundingBox();
-                    ColorVertex<float, unsigned char> posDiff = nbb.getMin() - mbb.getMin();
-                    Vertexf & dir = neighbor.first;
-                    Vertex<int> diri(dir.x, dir.y, dir.z);
-                    diri = diri * -1;
-                    size_t x,y,z;
-                    size_t  maxx, maxy, maxz;
-
-                    size_t mainAxisId=0;
-                    if     ((diri*-1).x == 1)  mainAxisId = mainGrid.getMaxIndexX();
-                    else if((diri*-1).y == 1)  mainAxisId = mainGrid.getMaxIndexY();
-                    else if((diri*-1).z == 1)  mainAxisId = mainGrid.getMaxIndexZ();
-
-
-                    x = y = z = 0;
-                    maxx = neighborGrid.getMaxIndexX();
-                    maxy = neighborGrid.getMaxIndexY();
-                    maxz = neighborGrid.getMaxIndexZ();
-
-                    int lpSideId=0;
-                    int lpSideId2 = 0;
-
-                    if		(diri.x == 1)
-                    {
-                        x = maxx;
-                        lpSideId = 0;
-                        lpSideId2 = 5;
-                    }
-                    else if (diri.y == 1)
-                    {
-                        y = maxy;
-                        lpSideId = 1;
-                        lpSideId2 = 4;
-                    }
-                    else if (diri.z == 1)
-                    {
-                        z = maxz;
-                        lpSideId = 2;
-                        lpSideId2 = 3;
-                    }
-                    else if (diri.x == -1)
-                    {
-                        x = 0;
-                        maxx = 0;
-                        lpSideId = 3;
-                        lpSideId2 = 2;
-                    }
-                    else if (diri.y == -1)
-                    {
-                        y = 0;
-                        maxy = 0;
-                        lpSideId = 4;
-                        lpSideId2 = 1;
-                    }
-                    else if (diri.z == -1)
-                    {
-                        z = 0;
-                        maxz = 0;
-                        lpSideId = 5;
-                        lpSideId2 = 0;
-                    }
-                    for(int i = x ; i<=maxx ; i++)
-                    {
-                        for(int j = y ; j<=maxy; j++)
-                        {
-
-                            for(int k = z ; k<=maxz; k++)
-                            {
-                               // cout << "x=" << i << " y=" << j << " z=" << z << " max= " << maxx << " " << maxy << " " << maxz << endl;
-                                bool abbruch = false;
-                                float distMW=0;
-                                for(int l = 0 ; l<4 && !abbruch; l++)
-                                {
-                                   // cout << "trying to find grid: " << latticeDirID[lpSideId][l] << " " << i<< ", " << j << ", " << k << endl;
-                                    size_t qp_ID = neighborGrid.findQueryPoint(latticeDirID[lpSideId][l],i,j,k);
-
-
-
-                                    if (qp_ID == FastBox<ColorVertex<float, unsigned char>, Normal<float> >::INVALID_INDEX)
-                                    {
-                                     //   cout << "did not find grid id" << endl;
-                                        abbruch = true;
-                                        break;
-                                    }
-                                    //cout << "found grid id" << endl;
-                                    float  distN = neighborGrid.getQueryPoints()[qp_ID].m_distance;
-                                    distMW +=distN;
-                                    Vertex<int> nv(diri);
-                                    if(nv.x == 0) nv.x = 1;
-                                    else if(nv.x == 1 || nv.x == -1) nv.x = 0;
-                                    if(nv.y == 0) nv.y = 1;
-                                    else if(nv.y == 1 || nv.y == -1) nv.y = 0;
-                                    if(nv.z == 0) nv.z = 1;
-                                    else if(nv.z == 1 || nv.z == -1) nv.z = 0;
-
-                                    Vertex<int> mainCellCoord(x,y,z);
-                                    mainCellCoord.x *= nv.x;
-                                    mainCellCoord.y *= nv.y;
-                                    mainCellCoord.z *= nv.z;
-
-                                    if(mainCellCoord.x == 0) mainCellCoord.x = mainAxisId;
-                                    else if(mainCellCoord.y == 0) mainCellCoord.y = mainAxisId;
-                                    else if(mainCellCoord.z == 0) mainCellCoord.z = mainAxisId;
-                                    //cout << "trying to find grid2: " << latticeDirID[lpSideId2][l] << " " << mainCellCoord.x<< ", " << mainCellCoord.y << ", " << mainCellCoord.z << endl;
-                                    size_t qpMG_ID = mainGrid.findQueryPoint(latticeDirID[lpSideId2][l],mainCellCoord.x,mainCellCoord.y,mainCellCoord.z);
-
-
-                                    if (qpMG_ID == FastBox<ColorVertex<float, unsigned char>, Normal<float> >::INVALID_INDEX)
-                                    {
-                                        break;
-                                        abbruch = true;
-                                    }
-                                    float  distMGN = mainGrid.getQueryPoints()[qpMG_ID].m_distance;
-                                    distMW +=distMGN;
-                                    if(!abbruch && l ==3)
-                                    {
-                                        distMW = distMW/8;
-                                        for(int m = 0; m<4 ;m++)
-                                        {
-                                            size_t qp_ID = neighborGrid.findQueryPoint(latticeDirID[lpSideId][m],i,j,k);
-                                            neighborGrid.getQueryPoints().at(qp_ID).m_distance = distMW;
-                                            //neighborGrid.getQueryPoints()[qp_ID].m_distance = distMW;
-                                            size_t qpMG_ID = mainGrid.findQueryPoint(latticeDirID[lpSideId2][m],mainCellCoord.x,mainCellCoord.y,mainCellCoord.z);
-                                            mainGrid.getQueryPoints().at(qpMG_ID).m_distance = distMW;
-
-
-
-                                        }
-                                    }
-
-
-
-                                }
-
-                            }
-
-                        }
-                    }
-                    cout << timestamp <<" saving grid " << neighborPath << endl;
-                    neighborGrid.serialize(neighborPath);
-                }
-
+                meshFiles.push_back(meshFile);
             }
-            cout << timestamp <<" saving grid " << mainPath << endl;
-            mainGrid.serialize(mainPath);
-        }*/
-
-        std::vector<string> grids(nmap.size());
-
-        for(int i = 0 ; i<originleafs.size() ;i++)
-        {
-            string mainPath = originleafs[i]->getFilePath();
-            boost::replace_all(mainPath, "xyz", "grid");
-            grids.push_back(mainPath);
-
         }
-
-
-        while(! waitingfor.empty()) waitingfor.pop();
-        for(int i = 1 ; i< world.size() && !grids.empty() ; i++)
+        LargeScaleStitcher stitcher(origin, voxelsize);
+        ModelPtr m( new Model( stitcher.merge(meshFiles) ) );
+        std::copy(shift, shift + 3, m->m_shift);
+        if(shift[0] != 0.0 || shift[1] != 0.0 || shift[2] != 0.0)
         {
-            cout << "...sending to " << i << " do:  " << grids.back() << endl;
-            world.send(i, DATA, grids.back());
-            waitingfor.push(1);
-            cout << "...poping to " << i << endl;
-            grids.pop_back();
+            cout << timestamp << "The mesh is shifted by (" << shift[0] << ", " << shift[1] << ", " << shift[2]
+                 << "), see " << partitionDir << "/shift.txt" << endl;
         }
-        cout << "...got grids" << endl;
-        //WHILE DATA to send
-
-        while(! grids.empty() || waitingfor.size()>0)
-        {
-            cout << "grids left: " << grids.size() << endl;
-            string msg;
-            mpi::status requests = world.recv(boost::mpi::any_source, FINISHED, msg);
-            waitingfor.pop();
-            cout << "######## rank 0 got message" << endl;
-
-            //cout << "######## testing " << requests.test()<< endl;
-            int rid = requests.source();
-            cout << "from" << requests.source() << endl;
-            cout << "QQQQQQQQQQQQQQQQQQQQQQQQ " << waitingfor.size() << "|" << grids.size() << endl;
-            if(! grids.empty())
-            {
-                world.send(rid, DATA, grids.back());
-                grids.pop_back();
-                waitingfor.push(1);
-            }
-            else if(waitingfor.size()==0)
-            {
-                for(int i = 1 ; i< world.size() && !grids.empty() ; i++)
-                {
-                    cout << "...sending to " << i << " finished"  << endl;
-                    world.send(i, DATA, "ready");
+        ModelFactory::saveModel( m, "triangle_mesh.ply");
 
-                }
-                break;
-            }
-
-        }
         cout << "FINESHED in " << lvr::timestamp << endl;
-        world.abort(0);
     }
         //---------------------------------------------
         // SLAVE NODE
         //--------------------------------------------
     else
     {
-        bool ready = false;
-        while(! ready)
+        LargeScaleScheduler::work(world, [&](PartitionTask& task)
         {
-            std::string filePath;
-            world.recv(0, DATA, filePath);
-            if(filePath=="ready") break;
+            std::string filePath = task.path;
             std::cout << "NODE: " << world.rank() << " will use file: " << filePath << endl;
 
 
-            //If filePath does not contain "grid" it will generate a grid
+            //If filePath is not a grid it will generate a grid
             // else ist will generate a mesh from a given grid file
-            if(filePath.find("xyz") != std::string::npos)
+            bool isGrid = boost::filesystem::path(filePath).extension() == ".grid";
+            if(!isGrid)
             {
-                ModelPtr model = ModelFactory::readModel( filePath );
+                // Shipped points come first. Otherwise the cached partition
+                // or the partition itself is read.
+                string cachePath = partitionCachePath(filePath, options.getLocalDir());
                 PointBufferPtr p_loader;
-                if ( !model )
+                if ( task.points.empty() )
+                {
+                    p_loader = loadCachedPartition(cachePath, task.numPoints);
+                }
+                if ( !p_loader )
+                {
+                    p_loader = LargeScaleScheduler::getPoints(task);
+                }
+                if ( !p_loader )
                 {
                     cout << timestamp << "IO Error: Unable to parse " << filePath << endl;
                     exit(-1);
                 }
-                p_loader = model->m_pointCloud;
+
+                // Leaf cube and global lattice
+                string bbpath = boost::filesystem::path(filePath).replace_extension(".bb").string();
+                ifstream bbifs(bbpath);
+                Vertexf leafMin, leafMax, origin;
+                float voxelsize;
+                bbifs >> leafMin.x >> leafMin.y >> leafMin.z >> leafMax.x >> leafMax.y >> leafMax.z;
+                bbifs >> origin.x >> origin.y >> origin.z >> voxelsize;
+
+                // Add the points of the neighbors in the ghost layers, so
+                // distances on the partition boundary match on both sides
+                LargeScaleStitcher stitcher(origin, voxelsize);
+                size_t numOwnPoints = stitcher.addGhostPoints(p_loader, task.neighbors, leafMin, leafMax);
+
+                Vertexf gridMin, gridMax;
+                stitcher.gridBox(leafMin, leafMax, gridMin, gridMax);
+                BoundingBox<ColorVertex<float, unsigned char> > tmpbb(gridMin.x, gridMin.y, gridMin.z, gridMax.x, gridMax.y, gridMax.z);
 
                 string pcm_name = options.getPCM();
                 psSurface::Ptr surface;
@@ -654,30 +352,25 @@ int main(int argc, char* argv[])
                     cout << ", Nabo";
 #endif
                     cout << endl;
-                    return 0;
+                    exit(-1);
                 }
 
-                string bbpath = filePath;
-                boost::algorithm::replace_last(bbpath, "xyz", "bb");
-                ifstream bbifs(bbpath);
-                float minx, miny, minz, maxx, maxy, maxz;
-                bbifs >> minx >> miny >> minz >> maxx >> maxy >> maxz;
-                BoundingBox<ColorVertex<float, unsigned char> > tmpbb(minx, miny, minz, maxx, maxy, maxz);
-
                 surface->getBoundingBox().expand(tmpbb.getMin());
                 surface->getBoundingBox().expand(tmpbb.getMax());
 
                 surface->setKd(options.getKd());
                 surface->setKi(options.getKi());
                 surface->setKn(options.getKn());
-                surface->calculateSurfaceNormals();
-
-                HalfEdgeMesh<ColorVertex<float, unsigned char> , Normal<float> > mesh( surface );
-                // Set recursion depth for region growing
-                if(options.getDepth())
+                if(!p_loader->hasPointNormals())
                 {
-                    mesh.setDepth(options.getDepth());
+                    surface->calculateSurfaceNormals();
+
+                    // Keep points and normals in binary form for the meshing
+                    // stage, so they don't have to be parsed and estimated again.
+                    // Ghost points belong to the neighbors and are not stored.
+                    LargeScaleScheduler::savePartition(cachePath, p_loader, numOwnPoints);
                 }
+
                 if(options.getSharpFeatureThreshold())
                 {
                     SharpBox<Vertex<float> , Normal<float> >::m_theta_sharp = options.getSharpFeatureThreshold();
@@ -687,86 +380,57 @@ int main(int argc, char* argv[])
                     SharpBox<Vertex<float> , Normal<float> >::m_phi_corner = options.getSharpCornerThreshold();
                 }
 
-                float resolution;
-                bool useVoxelsize;
-                if(options.getIntersections() > 0)
-                {
-                    resolution = options.getIntersections();
-                    useVoxelsize = false;
-                }
-                else
-                {
-                    resolution = options.getVoxelsize();
-                    useVoxelsize = true;
-                }
+                // The voxel size of the global lattice is computed by the master.
+                // The grid box is aligned to the global lattice and already
+                // contains all points including the ghost layers.
+                float resolution = voxelsize;
+                bool useVoxelsize = true;
                 string decomposition = options.getDecomposition();
-                GridBase* grid;
-                FastReconstructionBase<ColorVertex<float, unsigned char>, Normal<float> >* reconstruction;
+                string out = boost::filesystem::path(filePath).replace_extension(".grid").string();
                 if(decomposition == "MC")
                 {
-
-                    cout << tmpbb << endl << "#########" << endl << surface->getBoundingBox() << "--------------" << endl;
-
-                    if(surface->getBoundingBox().getMin().x < tmpbb.getMin().x) tmpbb.expand(surface->getBoundingBox().getMin());
-                    if(surface->getBoundingBox().getMin().y < tmpbb.getMin().y) tmpbb.expand(surface->getBoundingBox().getMin());
-                    if(surface->getBoundingBox().getMin().z < tmpbb.getMin().z) tmpbb.expand(surface->getBoundingBox().getMin());
-
-                    if(surface->getBoundingBox().getMax().x > tmpbb.getMax().x) tmpbb.expand(surface->getBoundingBox().getMax());
-                    if(surface->getBoundingBox().getMax().y > tmpbb.getMax().y) tmpbb.expand(surface->getBoundingBox().getMax());
-                    if(surface->getBoundingBox().getMax().z > tmpbb.getMax().z) tmpbb.expand(surface->getBoundingBox().getMax());
-
-
-                    grid = new PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, tmpbb, useVoxelsize);
-                    grid->setExtrusion(options.extrude());
-                    PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-                    ps_grid->getBoundingBox() = tmpbb;
-                    ps_grid->calcDistanceValues();
-
-                    reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, FastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
-                    string out = filePath;
-                    out.pop_back();
-                    out.pop_back();
-                    out.pop_back();
-                    out.append("grid");
-                    ps_grid->serialize(out);
-
+                    PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > ps_grid(resolution, surface, tmpbb, useVoxelsize);
+                    ps_grid.setExtrusion(options.extrude());
+                    ps_grid.getBoundingBox() = tmpbb;
+                    ps_grid.calcDistanceValues();
+                    ps_grid.serialize(out);
                 }
                 else if(decomposition == "PMC")
                 {
-                    grid = new PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize);
-                    grid->setExtrusion(options.extrude());
                     BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
-                    PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-                    ps_grid->calcDistanceValues();
-
-                    reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
-
+                    PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > > ps_grid(resolution, surface, tmpbb, useVoxelsize);
+                    ps_grid.setExtrusion(options.extrude());
+                    ps_grid.getBoundingBox() = tmpbb;
+                    ps_grid.calcDistanceValues();
+                    ps_grid.serialize(out);
                 }
                 else if(decomposition == "SF")
                 {
                     SharpBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
-                    grid = new PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize);
-                    grid->setExtrusion(options.extrude());
-                    PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-                    ps_grid->calcDistanceValues();
-                    reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+                    PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > > ps_grid(resolution, surface, tmpbb, useVoxelsize);
+                    ps_grid.setExtrusion(options.extrude());
+                    ps_grid.getBoundingBox() = tmpbb;
+                    ps_grid.calcDistanceValues();
+                    ps_grid.serialize(out);
                 }
             }
             // Create Mesh from Grid
-            else if(filePath.find("grid") != std::string::npos)
+            else
             {
                 cout << "going to rreconstruct " << filePath << endl;
-                string cloudPath = filePath;
-                boost::algorithm::replace_last(cloudPath, "grid", "xyz");
-                ModelPtr model = ModelFactory::readModel(cloudPath );
-                PointBufferPtr p_loader;
-                if ( !model )
+                string cloudPath = boost::filesystem::path(filePath).replace_extension(".bin").string();
+                PointBufferPtr p_loader = loadCachedPartition(
+                        partitionCachePath(cloudPath, options.getLocalDir()), task.numPoints);
+                if ( !p_loader )
+                {
+                    p_loader = LargeScaleScheduler::loadPartition(cloudPath);
+                }
+                if ( !p_loader )
                 {
                     cout << timestamp << "IO Error: Unable to parse " << filePath << endl;
                     exit(-1);
                 }
-                p_loader = model->m_pointCloud;
-                cout << "loaded " << cloudPath << " with : "<< model->m_pointCloud->getNumPoints() << endl;
+                cout << "loaded " << cloudPath << " with : "<< p_loader->getNumPoints() << endl;
 
                 string pcm_name = options.getPCM();
                 psSurface::Ptr surface;
@@ -812,12 +476,20 @@ int main(int argc, char* argv[])
                     cout << ", Nabo";
 #endif
                     cout << endl;
-                    return 0;
+                    exit(-1);
                 }
 
                 surface->setKd(options.getKd());
                 surface->setKi(options.getKi());
                 surface->setKn(options.getKn());
+
+                // Another rank created the cache, so the normals that SF
+                // and PMC look up have to be estimated again
+                if(!p_loader->hasPointNormals())
+                {
+                    surface->calculateSurfaceNormals();
+                }
+
                 HalfEdgeMesh<ColorVertex<float, unsigned char> , Normal<float> > mesh( surface );
                 // Set recursion depth for region growing
                 if(options.getDepth())
@@ -825,13 +497,39 @@ int main(int argc, char* argv[])
                     mesh.setDepth(options.getDepth());
                 }
 
-                HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > mainGrid(filePath);
+                // The grid was computed with the boxes of the chosen decomposition
+                string decomposition = options.getDecomposition();
                 string out2 = filePath;
                 boost::algorithm::replace_first(out2, ".grid", "-2.grid");
-                mainGrid.saveGrid(out2);
-                cout << "finished reading the grid " << filePath << endl;
+                GridBase* mainGrid;
                 FastReconstructionBase<ColorVertex<float, unsigned char>, Normal<float> >* reconstruction;
-                reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, FastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(&mainGrid);
+                if(decomposition == "PMC")
+                {
+                    BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
+                    HashGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >* hg =
+                            new HashGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >(filePath);
+                    hg->saveGrid(out2);
+                    mainGrid = hg;
+                    reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(hg);
+                }
+                else if(decomposition == "SF")
+                {
+                    SharpBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
+                    HashGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >* hg =
+                            new HashGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >(filePath);
+                    hg->saveGrid(out2);
+                    mainGrid = hg;
+                    reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> >  >(hg);
+                }
+                else
+                {
+                    HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >* hg =
+                            new HashGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >(filePath);
+                    hg->saveGrid(out2);
+                    mainGrid = hg;
+                    reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, FastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(hg);
+                }
+                cout << "finished reading the grid " << filePath << endl;
                 reconstruction->getMesh(mesh);
                 //mesh.cleanContours(2);
                 if(options.getDanglingArtifacts())
@@ -876,16 +574,29 @@ int main(int argc, char* argv[])
                 {
                     mesh.finalize();
                 }
-                ModelPtr m( new Model( mesh.meshBuffer() ) );
+                // Only keep the cells owned by this leaf and emit the IDs of
+                // the boundary vertices for the final merge
+                string bbpath = boost::filesystem::path(filePath).replace_extension(".bb").string();
+                ifstream bbifs(bbpath);
+                Vertexf leafMin, leafMax, origin;
+                float voxelsize;
+                bbifs >> leafMin.x >> leafMin.y >> leafMin.z >> leafMax.x >> leafMax.y >> leafMax.z;
+                bbifs >> origin.x >> origin.y >> origin.z >> voxelsize;
+
+                string output = boost::filesystem::path(filePath).replace_extension(".ply").string();
+                LargeScaleStitcher stitcher(origin, voxelsize);
+                MeshBufferPtr clipped = stitcher.clip(mesh.meshBuffer(), leafMin, leafMax,
+                                                      LargeScaleStitcher::boundaryPath(output));
 
-                string output = filePath;
-                boost::algorithm::replace_first(output, "grid", "ply");
+                ModelPtr m( new Model( clipped ) );
                 ModelFactory::saveModel( m, output);
+
+                delete reconstruction;
+                delete mainGrid;
             }
 
-            world.send(0, FINISHED, std::string("world"));
             cout << timestamp << "Node: " << world.rank() << "finished "  << endl;
-        }
+        });
 
     }
 
@@ -0,0 +1,311 @@
+//
+// Work distribution for the large scale reconstruction
+//
+
+#include "LargeScaleScheduler.hpp"
+
+#include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/mpi/nonblocking.hpp>
+#include <boost/mpi/status.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace lvr
+{
+
+namespace
+{
+
+/// Message tag of tasks sent from rank 0 to the workers
+const int TASK_TAG = 0;
+
+/// Message tag of the timing reports sent back to rank 0
+const int RESULT_TAG = 1;
+
+bool taskCostCompare(const PartitionTask& lhs, const PartitionTask& rhs)
+{
+    return lhs.numPoints > rhs.numPoints;
+}
+
+} // anonymous namespace
+
+LargeScaleScheduler::LargeScaleScheduler(boost::mpi::communicator& world, bool shipPoints)
+    : m_world(world), m_shipPoints(shipPoints), m_timings(world.size())
+{
+
+}
+
+void LargeScaleScheduler::run(vector<PartitionTask>& tasks, bool usePoints)
+{
+    if(m_world.size() < 2)
+    {
+        cout << timestamp << "Scheduler: No worker ranks available." << endl;
+        return;
+    }
+
+    Timestamp stageTime;
+
+    // Largest partitions first
+    std::stable_sort(tasks.begin(), tasks.end(), taskCostCompare);
+    vector<bool> done(tasks.size(), false);
+    bool shipPoints = m_shipPoints && usePoints;
+
+    // Give every worker one task to work on and one to prefetch
+    size_t outstanding = 0;
+    for(int depth = 0; depth < 2; depth++)
+    {
+        for(int rank = 1; rank < m_world.size(); rank++)
+        {
+            if(sendNext(rank, tasks, done, shipPoints))
+            {
+                outstanding++;
+            }
+        }
+    }
+
+    while(outstanding > 0)
+    {
+        TaskTiming timing;
+        boost::mpi::status status = m_world.recv(boost::mpi::any_source, RESULT_TAG, timing);
+        outstanding--;
+
+        int rank = status.source();
+        m_timings[rank].compute += timing.compute;
+        m_timings[rank].wait    += timing.wait;
+        m_timings[rank].tasks   += timing.tasks;
+
+        if(sendNext(rank, tasks, done, shipPoints))
+        {
+            outstanding++;
+        }
+    }
+
+    cout << timestamp << "Scheduler: Processed " << tasks.size() << " partitions in "
+         << stageTime.getElapsedTimeInS() << " s." << endl;
+}
+
+bool LargeScaleScheduler::sendNext(int rank, vector<PartitionTask>& tasks, vector<bool>& done, bool shipPoints)
+{
+    // Prefer a task this rank already has local data for, otherwise
+    // take the largest remaining one
+    long next = -1;
+    for(size_t i = 0; i < tasks.size(); i++)
+    {
+        if(done[i])
+        {
+            continue;
+        }
+
+        if(next == -1)
+        {
+            next = i;
+        }
+
+        if(tasks[i].preferredRank == rank)
+        {
+            next = i;
+            break;
+        }
+    }
+
+    if(next == -1)
+    {
+        return false;
+    }
+
+    PartitionTask& task = tasks[next];
+    done[next] = true;
+
+    // A rank with node local data of this partition reads it itself
+    if(shipPoints && task.points.empty() && task.preferredRank != rank)
+    {
+        PointBufferPtr buffer = getPoints(task);
+        if(buffer)
+        {
+            size_t n;
+            floatArr points = buffer->getPointArray(n);
+            task.points.assign(points.get(), points.get() + 3 * n);
+            task.numPoints = n;
+        }
+    }
+
+    m_world.send(rank, TASK_TAG, task);
+    m_assignments[task.path] = rank;
+
+    // Free the shipped data, it is not needed on rank 0 anymore
+    vector<float>().swap(task.points);
+
+    return true;
+}
+
+int LargeScaleScheduler::getRank(string path)
+{
+    map<string, int>::iterator it = m_assignments.find(path);
+    if(it != m_assignments.end())
+    {
+        return it->second;
+    }
+    return -1;
+}
+
+void LargeScaleScheduler::finish()
+{
+    PartitionTask stop;
+    stop.path = "ready";
+    for(int rank = 1; rank < m_world.size(); rank++)
+    {
+        m_world.send(rank, TASK_TAG, stop);
+    }
+
+    double compute = 0.0;
+    double wait = 0.0;
+
+    cout << timestamp << "Scheduler: Timings per rank" << endl;
+    cout << "rank\ttasks\tcompute [s]\tidle [s]\tidle [%]" << endl;
+    for(int rank = 1; rank < m_world.size(); rank++)
+    {
+        TaskTiming& t = m_timings[rank];
+        double total = t.compute + t.wait;
+        cout << rank << "\t" << t.tasks << "\t"
+             << std::fixed << std::setprecision(2) << t.compute << "\t\t" << t.wait << "\t\t"
+             << (total > 0 ? 100.0 * t.wait / total : 0.0) << endl;
+        compute += t.compute;
+        wait += t.wait;
+    }
+
+    if(compute + wait > 0)
+    {
+        cout << timestamp << "Scheduler: Overall idle time "
+             << 100.0 * wait / (compute + wait) << " %" << endl;
+    }
+}
+
+void LargeScaleScheduler::work(boost::mpi::communicator& world, std::function<void(PartitionTask&)> process)
+{
+    TaskTiming timing;
+    Timestamp ts;
+
+    PartitionTask current;
+    world.recv(0, TASK_TAG, current);
+    timing.wait = ts.getElapsedTimeInS();
+
+    while(current.path != "ready")
+    {
+        // Receive the next task while working on the current one
+        PartitionTask next;
+        boost::mpi::request request = world.irecv(0, TASK_TAG, next);
+
+        ts.resetTimer();
+        process(current);
+        timing.compute = ts.getElapsedTimeInS();
+        timing.tasks = 1;
+
+        world.send(0, RESULT_TAG, timing);
+
+        ts.resetTimer();
+        request.wait();
+        timing.wait = ts.getElapsedTimeInS();
+
+        std::swap(current, next);
+    }
+}
+
+void LargeScaleScheduler::savePartition(string path, PointBufferPtr buffer, size_t count)
+{
+    size_t n, nn;
+    floatArr points = buffer->getPointArray(n);
+    floatArr normals = buffer->getPointNormalArray(nn);
+
+    if(count > 0)
+    {
+        n = std::min(n, count);
+        nn = std::min(nn, count);
+    }
+
+    // Other workers may read this partition for their ghost layers
+    string tmpPath = path + ".tmp";
+    {
+        ofstream out(tmpPath.c_str(), std::ios::binary);
+        uint64_t numPoints = n;
+        uint64_t numNormals = nn;
+        out.write((char*)&numPoints, sizeof(numPoints));
+        out.write((char*)&numNormals, sizeof(numNormals));
+        out.write((char*)points.get(), 3 * n * sizeof(float));
+        if(nn)
+        {
+            out.write((char*)normals.get(), 3 * nn * sizeof(float));
+        }
+    }
+    boost::filesystem::rename(tmpPath, path);
+}
+
+PointBufferPtr LargeScaleScheduler::loadPartition(string path)
+{
+    ifstream in(path.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        return PointBufferPtr();
+    }
+
+    uint64_t numPoints, numNormals;
+    in.read((char*)&numPoints, sizeof(numPoints));
+    in.read((char*)&numNormals, sizeof(numNormals));
+
+    floatArr points(new float[3 * numPoints]);
+    in.read((char*)points.get(), 3 * numPoints * sizeof(float));
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(points, numPoints);
+
+    if(numNormals)
+    {
+        floatArr normals(new float[3 * numNormals]);
+        in.read((char*)normals.get(), 3 * numNormals * sizeof(float));
+        buffer->setPointNormalArray(normals, numNormals);
+    }
+
+    if(!in.good())
+    {
+        cout << timestamp << "Scheduler: Partition file " << path << " is truncated." << endl;
+        return PointBufferPtr();
+    }
+
+    return buffer;
+}
+
+PointBufferPtr LargeScaleScheduler::getPoints(PartitionTask& task)
+{
+    if(!task.points.empty())
+    {
+        size_t n = task.points.size() / 3;
+        floatArr points(new float[3 * n]);
+        memcpy(points.get(), &task.points[0], 3 * n * sizeof(float));
+        vector<float>().swap(task.points);
+
+        PointBufferPtr buffer(new PointBuffer);
+        buffer->setPointArray(points, n);
+        return buffer;
+    }
+
+    // Leafs of the partitioner are already in binary form
+    if(boost::filesystem::path(task.path).extension() == ".bin")
+    {
+        return loadPartition(task.path);
+    }
+
+    ModelPtr model = ModelFactory::readModel(task.path);
+    if(!model)
+    {
+        return PointBufferPtr();
+    }
+    return model->m_pointCloud;
+}
+
+} // namespace lvr
@@ -0,0 +1,175 @@
+//
+// Work distribution for the large scale reconstruction
+//
+
+#ifndef LAS_VEGAS_LARGESCALESCHEDULER_H
+#define LAS_VEGAS_LARGESCALESCHEDULER_H
+
+#include <lvr/io/PointBuffer.hpp>
+
+#include <boost/mpi/communicator.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace lvr
+{
+
+/**
+ * @brief   A single partition that has to be processed by a worker.
+ */
+struct PartitionTask
+{
+    PartitionTask() : numPoints(0), preferredRank(-1) {}
+
+    /// Path of the partition (.bin or .xyz for normals and grid, .grid for meshing).
+    /// The path "ready" tells a worker to stop.
+    string          path;
+
+    /// Number of points in the partition, used as cost estimate
+    size_t          numPoints;
+
+    /// Rank that already holds node local data of this partition, -1 if none
+    int             preferredRank;
+
+    /// Interleaved point coordinates. Empty if the worker has to load
+    /// the partition itself.
+    vector<float>   points;
+
+    /// Partitions that share a face with this one
+    vector<string>  neighbors;
+
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int version)
+    {
+        ar & path;
+        ar & numPoints;
+        ar & preferredRank;
+        ar & points;
+        ar & neighbors;
+    }
+};
+
+/**
+ * @brief   Timing of a processed task that is reported back to rank 0.
+ */
+struct TaskTiming
+{
+    TaskTiming() : compute(0), wait(0), tasks(0) {}
+
+    /// Seconds spent processing tasks
+    double          compute;
+
+    /// Seconds spent waiting for the next task
+    double          wait;
+
+    /// Number of processed tasks
+    size_t          tasks;
+
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int version)
+    {
+        ar & compute;
+        ar & wait;
+        ar & tasks;
+    }
+};
+
+/**
+ * @brief   Distributes partitions from rank 0 to the workers.
+ *
+ *          Tasks are handed out largest first (by point count) so that
+ *          the expensive partitions do not end up at the tail of a stage.
+ *          Every worker always has one task in flight in addition to the
+ *          one it is working on, so the transfer of the next partition
+ *          overlaps with the computation of the current one. A worker
+ *          that asks for work preferrably gets a task it already holds
+ *          node local data for, otherwise the largest remaining task.
+ */
+class LargeScaleScheduler
+{
+public:
+
+    /**
+     * @brief   Creates a scheduler
+     *
+     * @param world         The MPI communicator
+     * @param shipPoints    If true, rank 0 sends the point data with each
+     *                      task. Otherwise the workers read it themselves.
+     */
+    LargeScaleScheduler(boost::mpi::communicator& world, bool shipPoints);
+
+    /**
+     * @brief   Master: processes all given tasks on the workers and
+     *          returns once all of them are finished.
+     *
+     * @param usePoints     False if the workers load the data of this stage
+     *                      themselves. No points are shipped then.
+     */
+    void run(vector<PartitionTask>& tasks, bool usePoints = true);
+
+    /**
+     * @brief   Master: Returns the rank that processed the given
+     *          partition in an earlier stage, -1 if unknown.
+     */
+    int getRank(string path);
+
+    /**
+     * @brief   Master: stops all workers and prints the timing summary.
+     */
+    void finish();
+
+    /**
+     * @brief   Worker: receives tasks and calls process for each of them
+     *          until rank 0 calls finish().
+     */
+    static void work(boost::mpi::communicator& world, std::function<void(PartitionTask&)> process);
+
+    /**
+     * @brief   Writes the points and normals of a buffer into a binary file.
+     *          The file is replaced atomically, so concurrent readers never
+     *          see a partially written partition.
+     *
+     * @param count     Number of points to store, 0 stores all points
+     */
+    static void savePartition(string path, PointBufferPtr buffer, size_t count = 0);
+
+    /**
+     * @brief   Reads a file that was written by savePartition(). Returns
+     *          an empty pointer if the file does not exist.
+     */
+    static PointBufferPtr loadPartition(string path);
+
+    /**
+     * @brief   Returns the points of a task as point buffer. Uses the
+     *          shipped points if present, otherwise reads the partition.
+     */
+    static PointBufferPtr getPoints(PartitionTask& task);
+
+private:
+
+    /// Sends the next task to the given rank. Returns false if no task was left
+    bool sendNext(int rank, vector<PartitionTask>& tasks, vector<bool>& done, bool shipPoints);
+
+    /// The MPI communicator
+    boost::mpi::communicator&   m_world;
+
+    /// True if points are sent over MPI
+    bool                        m_shipPoints;
+
+    /// Timings of all ranks
+    vector<TaskTiming>          m_timings;
+
+    /// Which rank processed which partition
+    map<string, int>            m_assignments;
+};
+
+} // namespace lvr
+
+#endif //LAS_VEGAS_LARGESCALESCHEDULER_H
@@ -0,0 +1,370 @@
+//
+// Seam-free stitching of the partition meshes of the large scale reconstruction
+//
+
+#include "LargeScaleStitcher.hpp"
+#include "LargeScaleScheduler.hpp"
+
+#include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace lvr
+{
+
+namespace
+{
+
+/// A boundary vertex as stored in the boundary files
+struct BoundaryVertex
+{
+    uint32_t    index;
+    LatticeEdge edge;
+};
+
+} // anonymous namespace
+
+LargeScaleStitcher::LargeScaleStitcher(Vertexf origin, float voxelsize, int ghostLayers)
+    : m_origin(origin), m_voxelsize(voxelsize), m_ghostLayers(ghostLayers)
+{
+
+}
+
+void LargeScaleStitcher::gridBox(const Vertexf& leafMin, const Vertexf& leafMax, Vertexf& min, Vertexf& max) const
+{
+    // One additional layer, so the owned and ghost cells at the border of
+    // the box are complete
+    int layers = m_ghostLayers + 1;
+    for(int i = 0; i < 3; i++)
+    {
+        min[i] = m_origin[i] + (floorf((leafMin[i] - m_origin[i]) / m_voxelsize) - layers) * m_voxelsize;
+        max[i] = m_origin[i] + (ceilf((leafMax[i] - m_origin[i]) / m_voxelsize) + layers) * m_voxelsize;
+    }
+}
+
+size_t LargeScaleStitcher::addGhostPoints(PointBufferPtr& buffer, const vector<string>& neighbors,
+                                          const Vertexf& leafMin, const Vertexf& leafMax) const
+{
+    size_t n, nn;
+    floatArr points = buffer->getPointArray(n);
+    floatArr normals = buffer->getPointNormalArray(nn);
+    bool useNormals = nn == n;
+
+    float margin = m_ghostLayers * m_voxelsize;
+    vector<float> ghostPoints;
+    vector<float> ghostNormals;
+
+    for(size_t i = 0; i < neighbors.size(); i++)
+    {
+        PointBufferPtr neighbor = LargeScaleScheduler::loadPartition(neighbors[i]);
+        if(!neighbor)
+        {
+            cout << timestamp << "Stitcher: Unable to read neighbor " << neighbors[i] << endl;
+            continue;
+        }
+
+        size_t m, mn;
+        floatArr np = neighbor->getPointArray(m);
+        floatArr nnormals = neighbor->getPointNormalArray(mn);
+        useNormals = useNormals && mn == m;
+
+        for(size_t j = 0; j < m; j++)
+        {
+            const float* p = &np[3 * j];
+            bool inGhost = true;
+            bool inLeaf = true;
+            for(int k = 0; k < 3; k++)
+            {
+                inGhost = inGhost && p[k] >= leafMin[k] - margin && p[k] < leafMax[k] + margin;
+                inLeaf = inLeaf && p[k] >= leafMin[k] && p[k] < leafMax[k];
+            }
+
+            if(inGhost && !inLeaf)
+            {
+                ghostPoints.insert(ghostPoints.end(), p, p + 3);
+                if(mn == m)
+                {
+                    ghostNormals.insert(ghostNormals.end(), &nnormals[3 * j], &nnormals[3 * j] + 3);
+                }
+            }
+        }
+    }
+
+    if(ghostPoints.empty())
+    {
+        return n;
+    }
+
+    size_t total = n + ghostPoints.size() / 3;
+    floatArr allPoints(new float[3 * total]);
+    std::copy(points.get(), points.get() + 3 * n, allPoints.get());
+    std::copy(ghostPoints.begin(), ghostPoints.end(), allPoints.get() + 3 * n);
+
+    // Normals are only kept if they are known for all points, otherwise
+    // they have to be estimated for the whole buffer
+    PointBufferPtr result(new PointBuffer);
+    result->setPointArray(allPoints, total);
+    if(useNormals)
+    {
+        floatArr allNormals(new float[3 * total]);
+        std::copy(normals.get(), normals.get() + 3 * n, allNormals.get());
+        std::copy(ghostNormals.begin(), ghostNormals.end(), allNormals.get() + 3 * n);
+        result->setPointNormalArray(allNormals, total);
+    }
+
+    cout << timestamp << "Stitcher: Added " << total - n << " ghost points." << endl;
+
+    buffer = result;
+    return n;
+}
+
+MeshBufferPtr LargeScaleStitcher::clip(MeshBufferPtr mesh, const Vertexf& leafMin, const Vertexf& leafMax,
+                                       string boundaryFile) const
+{
+    size_t numVertices, numFaces, numNormals, numColors;
+    floatArr vertices = mesh->getVertexArray(numVertices);
+    uintArr faces = mesh->getFaceArray(numFaces);
+    floatArr normals = mesh->getVertexNormalArray(numNormals);
+    ucharArr colors = mesh->getVertexColorArray(numColors);
+
+    // Keep the triangles of the cells whose center lies in the leaf
+    vector<char> keepFace(numFaces, 0);
+
+    #pragma omp parallel for schedule(static)
+    for(long i = 0; i < (long)numFaces; i++)
+    {
+        bool owned = true;
+        for(int k = 0; k < 3; k++)
+        {
+            float c = (vertices[3 * faces[3 * i]     + k]
+                     + vertices[3 * faces[3 * i + 1] + k]
+                     + vertices[3 * faces[3 * i + 2] + k]) / 3.0f;
+            float center = m_origin[k] + floorf((c - m_origin[k]) / m_voxelsize + 0.5f) * m_voxelsize;
+            owned = owned && center >= leafMin[k] && center < leafMax[k];
+        }
+        keepFace[i] = owned;
+    }
+
+    // Compact the vertices that are still referenced
+    vector<int64_t> newIndex(numVertices, -1);
+    vector<unsigned int> newFaces;
+    size_t count = 0;
+    for(size_t i = 0; i < numFaces; i++)
+    {
+        if(!keepFace[i])
+        {
+            continue;
+        }
+        for(int j = 0; j < 3; j++)
+        {
+            unsigned int v = faces[3 * i + j];
+            if(newIndex[v] == -1)
+            {
+                newIndex[v] = count++;
+            }
+            newFaces.push_back(newIndex[v]);
+        }
+    }
+
+    floatArr newVertices(new float[3 * count]);
+    floatArr newNormals(numNormals == numVertices ? new float[3 * count] : 0);
+    ucharArr newColors(numColors == numVertices ? new unsigned char[3 * count] : 0);
+
+    vector<BoundaryVertex> boundary;
+    float v = m_voxelsize;
+    for(size_t i = 0; i < numVertices; i++)
+    {
+        if(newIndex[i] == -1)
+        {
+            continue;
+        }
+
+        size_t j = newIndex[i];
+        std::copy(&vertices[3 * i], &vertices[3 * i] + 3, &newVertices[3 * j]);
+        if(newNormals)
+        {
+            std::copy(&normals[3 * i], &normals[3 * i] + 3, &newNormals[3 * j]);
+        }
+        if(newColors)
+        {
+            std::copy(&colors[3 * i], &colors[3 * i] + 3, &newColors[3 * j]);
+        }
+
+        // Vertices in the outermost owned cells may be shared with a
+        // neighbor partition
+        const float* p = &vertices[3 * i];
+        bool onBoundary = false;
+        for(int k = 0; k < 3; k++)
+        {
+            onBoundary = onBoundary || p[k] < leafMin[k] + v || p[k] > leafMax[k] - v;
+        }
+
+        BoundaryVertex b;
+        if(onBoundary && latticeEdge(p, m_origin, m_voxelsize, b.edge))
+        {
+            b.index = j;
+            boundary.push_back(b);
+        }
+    }
+
+    ofstream out(boundaryFile.c_str(), std::ios::binary);
+    uint64_t numBoundary = boundary.size();
+    out.write((char*)&numBoundary, sizeof(numBoundary));
+    if(numBoundary)
+    {
+        out.write((char*)&boundary[0], numBoundary * sizeof(BoundaryVertex));
+    }
+
+    MeshBufferPtr result(new MeshBuffer);
+    result->setVertexArray(newVertices, count);
+    result->setFaceArray(newFaces);
+    if(newNormals)
+    {
+        result->setVertexNormalArray(newNormals, count);
+    }
+    if(newColors)
+    {
+        result->setVertexColorArray(newColors, count);
+    }
+
+    cout << timestamp << "Stitcher: Kept " << newFaces.size() / 3 << " of " << numFaces
+         << " faces, " << numBoundary << " boundary vertices." << endl;
+
+    return result;
+}
+
+MeshBufferPtr LargeScaleStitcher::merge(const vector<string>& meshFiles) const
+{
+    vector<float> vertices;
+    vector<float> normals;
+    vector<unsigned char> colors;
+    vector<unsigned int> faces;
+    bool useNormals = true;
+    bool useColors = true;
+
+    // Only boundary vertices are kept in the map, so its size depends on
+    // the partition surfaces and not on the size of the whole mesh
+    unordered_map<LatticeEdge, unsigned int, LatticeEdgeHash> welded;
+    size_t numWelded = 0;
+
+    for(size_t m = 0; m < meshFiles.size(); m++)
+    {
+        ModelPtr model = ModelFactory::readModel(meshFiles[m]);
+        if(!model || !model->m_mesh)
+        {
+            cout << timestamp << "Stitcher: Unable to read " << meshFiles[m] << endl;
+            continue;
+        }
+
+        size_t numVertices, numFaces, numNormals, numColors;
+        floatArr v = model->m_mesh->getVertexArray(numVertices);
+        uintArr f = model->m_mesh->getFaceArray(numFaces);
+        floatArr n = model->m_mesh->getVertexNormalArray(numNormals);
+        ucharArr c = model->m_mesh->getVertexColorArray(numColors);
+
+        useNormals = useNormals && numNormals == numVertices;
+        useColors = useColors && numColors == numVertices;
+
+        // Map local to global vertex indices
+        vector<int64_t> globalIndex(numVertices, -1);
+
+        vector<BoundaryVertex> boundary;
+        ifstream in(boundaryPath(meshFiles[m]).c_str(), std::ios::binary);
+        uint64_t numBoundary = 0;
+        in.read((char*)&numBoundary, sizeof(numBoundary));
+        if(in.good() && numBoundary)
+        {
+            boundary.resize(numBoundary);
+            in.read((char*)&boundary[0], numBoundary * sizeof(BoundaryVertex));
+            if(!in.good())
+            {
+                cout << timestamp << "Stitcher: Boundary file of " << meshFiles[m] << " is truncated." << endl;
+                boundary.clear();
+            }
+        }
+
+        // Boundary vertices that were already created by another partition
+        for(size_t i = 0; i < boundary.size(); i++)
+        {
+            unordered_map<LatticeEdge, unsigned int, LatticeEdgeHash>::iterator it = welded.find(boundary[i].edge);
+            if(it != welded.end() && boundary[i].index < numVertices)
+            {
+                globalIndex[boundary[i].index] = it->second;
+                numWelded++;
+            }
+        }
+
+        for(size_t i = 0; i < numVertices; i++)
+        {
+            if(globalIndex[i] != -1)
+            {
+                continue;
+            }
+
+            globalIndex[i] = vertices.size() / 3;
+            vertices.insert(vertices.end(), &v[3 * i], &v[3 * i] + 3);
+            if(useNormals)
+            {
+                normals.insert(normals.end(), &n[3 * i], &n[3 * i] + 3);
+            }
+            if(useColors)
+            {
+                colors.insert(colors.end(), &c[3 * i], &c[3 * i] + 3);
+            }
+        }
+
+        // Register the new boundary vertices for the following partitions
+        for(size_t i = 0; i < boundary.size(); i++)
+        {
+            if(boundary[i].index < numVertices)
+            {
+                welded.insert(std::make_pair(boundary[i].edge, (unsigned int)globalIndex[boundary[i].index]));
+            }
+        }
+
+        for(size_t i = 0; i < numFaces; i++)
+        {
+            unsigned int a = globalIndex[f[3 * i]];
+            unsigned int b = globalIndex[f[3 * i + 1]];
+            unsigned int d = globalIndex[f[3 * i + 2]];
+
+            // Welding may collapse tiny triangles at the seams
+            if(a != b && b != d && a != d)
+            {
+                faces.push_back(a);
+                faces.push_back(b);
+                faces.push_back(d);
+            }
+        }
+    }
+
+    cout << timestamp << "Stitcher: Merged " << meshFiles.size() << " partitions, "
+         << vertices.size() / 3 << " vertices, " << faces.size() / 3 << " faces, "
+         << numWelded << " welded vertices." << endl;
+
+    MeshBufferPtr result(new MeshBuffer);
+    result->setVertexArray(vertices);
+    result->setFaceArray(faces);
+    if(useNormals && normals.size() == vertices.size())
+    {
+        result->setVertexNormalArray(normals);
+    }
+    if(useColors && colors.size() == vertices.size())
+    {
+        result->setVertexColorArray(colors);
+    }
+    return result;
+}
+
+string LargeScaleStitcher::boundaryPath(string meshFile)
+{
+    return boost::filesystem::path(meshFile).replace_extension(".bnd").string();
+}
+
+} // namespace lvr
@@ -0,0 +1,97 @@
+//
+// Seam-free stitching of the partition meshes of the large scale reconstruction
+//
+
+#ifndef LAS_VEGAS_LARGESCALESTITCHER_H
+#define LAS_VEGAS_LARGESCALESTITCHER_H
+
+#include <lvr/geometry/Vertex.hpp>
+#include <lvr/io/MeshBuffer.hpp>
+#include <lvr/io/PointBuffer.hpp>
+#include <lvr/reconstruction/LatticeEdge.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace lvr
+{
+
+/**
+ * @brief   Makes the independently reconstructed partitions fit together.
+ *
+ *          All partitions use the same query point lattice, defined by
+ *          a global origin and voxel size. Every partition computes its
+ *          grid on its leaf cube plus a ghost layer that is filled with
+ *          the points of the neighboring leafs, so query points on the
+ *          partition boundaries get their distance values from the same
+ *          data on both sides. Afterwards each partition only keeps the
+ *          triangles of the cells it owns and writes the lattice edges of
+ *          the vertices on its boundary. The final merge welds the
+ *          partition meshes into one mesh by these edge IDs.
+ */
+class LargeScaleStitcher
+{
+public:
+
+    /**
+     * @brief   Creates a stitcher for the given global lattice
+     *
+     * @param origin        Origin of the lattice (center of cell 0, 0, 0)
+     * @param voxelsize     Edge length of a cell
+     * @param ghostLayers   Number of cells added around each leaf
+     */
+    LargeScaleStitcher(Vertexf origin, float voxelsize, int ghostLayers = 2);
+
+    /**
+     * @brief   Computes the grid bounding box of a leaf. The box is
+     *          extended by the ghost layers and snapped to the lattice.
+     */
+    void gridBox(const Vertexf& leafMin, const Vertexf& leafMax, Vertexf& min, Vertexf& max) const;
+
+    /**
+     * @brief   Appends the points of the neighbor partitions that lie in
+     *          the ghost region of the given leaf. The points of the leaf
+     *          itself stay at the front of the buffer.
+     *
+     * @return  The number of points of the leaf itself
+     */
+    size_t addGhostPoints(PointBufferPtr& buffer, const vector<string>& neighbors,
+                          const Vertexf& leafMin, const Vertexf& leafMax) const;
+
+    /**
+     * @brief   Removes all triangles of cells that are not owned by the
+     *          given leaf and writes the lattice edges of the vertices on
+     *          the leaf boundary into boundaryFile.
+     */
+    MeshBufferPtr clip(MeshBufferPtr mesh, const Vertexf& leafMin, const Vertexf& leafMax,
+                       string boundaryFile) const;
+
+    /**
+     * @brief   Welds the given partition meshes into one mesh. Each mesh
+     *          needs a boundary file with the same name and the extension
+     *          ".bnd".
+     */
+    MeshBufferPtr merge(const vector<string>& meshFiles) const;
+
+    /// Returns the boundary file of a partition mesh
+    static string boundaryPath(string meshFile);
+
+private:
+
+    /// Origin of the global lattice
+    Vertexf     m_origin;
+
+    /// Voxel size of the global lattice
+    float       m_voxelsize;
+
+    /// Number of ghost cells around each leaf
+    int         m_ghostLayers;
+};
+
+} // namespace lvr
+
+#endif //LAS_VEGAS_LARGESCALESTITCHER_H
@@ -91,6 +91,8 @@ Options::Options(int argc, char** argv)
 						("buff", value<unsigned int>(&m_bufferSize)->default_value(30000000), "Minimum number of votes to consider a texture transformation as correct")
 						("os", value<unsigned int>(&m_octreeNodeSize)->default_value(1000000), "Minimum number of votes to consider a texture transformation as correct")
 						("outputFolder", value<string>(&m_outputFolderPath)->default_value(""), "Output Folder Path")
+						("shipPoints", "Send the point data of each partition over MPI instead of letting the workers read it from the shared file system.")
+						("localDir", value<string>(&m_localDir)->default_value(""), "Node local directory for cached partition data (points and normals). Defaults to the partition directory.")
         ;
 
 	setup();
@@ -106,6 +108,16 @@ unsigned int Options::getBufferSize() const
 	return m_variables["buff"].as<unsigned int>();
 }
 
+bool Options::shipPoints() const
+{
+	return m_variables.count("shipPoints");
+}
+
+string Options::getLocalDir() const
+{
+	return m_variables["localDir"].as<string>();
+}
+
 float Options::getVoxelsize() const
 {
 	return m_variables["voxelsize"].as<float>();
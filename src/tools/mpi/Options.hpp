@@ -313,6 +313,16 @@ public:
 	unsigned int getBufferSize() const;
 	string getOutputFolderPath() const;
 
+	/**
+	 * @brief	True if the master sends the partition points over MPI
+	 */
+	bool shipPoints() const;
+
+	/**
+	 * @brief	Node local directory for cached partition data
+	 */
+	string getLocalDir() const;
+
 
 private:
 
@@ -399,6 +409,9 @@ private:
 
 	string                          m_outputFolderPath;
 
+	/// Node local cache directory
+	string                          m_localDir;
+
 
 	
 	///Path to texture pack
@@ -569,6 +582,11 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	{
 		cout << "##### Buffer Size: \t\t: " << o.getBufferSize() << endl;
 	}
+
+	if(o.shipPoints())
+	{
+		cout << "##### Ship points via MPI\t: YES" << endl;
+	}
 	return os;
 }
 
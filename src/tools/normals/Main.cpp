@@ -96,36 +96,42 @@ void interpolateNormals(PointBufferPtr pc, size_t numPoints, int n)
     floatArr points = pc->getPointArray(count);
     floatArr normals = pc->getPointNormalArray(count);
 
+    // Gather the interpolated normals into a separate buffer, so that all
+    // threads read the unmodified input normals
+    floatArr interpolated(new float[3 * numPoints]);
+
     string comment = timestamp.getElapsedTime() + "Interpolating normals ";
     ProgressBar progress(numPoints, comment);
 
-    #pragma omp parallel for schedule(static)
-    for(size_t i = 0; i < numPoints; i++)
+    #pragma omp parallel
     {
-        // Create search tree
         vector< size_t > indices;
         vector< float > distances;
 
-        Vertex<float> vertex(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
-        tree->kSearch( vertex, n, indices, distances);
-
-        // Do interpolation
-        Normal<float> normal(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]);
-        for(int j = 0; j < indices.size(); j++)
+        #pragma omp for schedule(static)
+        for(long i = 0; i < (long)numPoints; i++)
         {
-            normal += Normal<float>(normals[3 * indices[j]], normals[3 * indices[j] + 1], normals[3 * indices[j] + 2]);
+            Vertex<float> vertex(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+            tree->kSearch( vertex, n, indices, distances);
+
+            // Do interpolation
+            Normal<float> normal(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]);
+            for(size_t j = 0; j < indices.size(); j++)
+            {
+                normal += Normal<float>(normals[3 * indices[j]], normals[3 * indices[j] + 1], normals[3 * indices[j] + 2]);
+            }
+            normal.normalize();
+
+            interpolated[3 * i]      = normal.x;
+            interpolated[3 * i + 1]  = normal.y;
+            interpolated[3 * i + 2]  = normal.z;
+
+            ++progress;
         }
-        normal.normalize();
-
-        // Save results in buffer (I know i should use a seperate buffer, but for testing it
-        // should be OK to save the interpolated values directly into the input buffer)
-        normals[3 * i]      = normal.x;
-        normals[3 * i + 1]  = normal.y;
-        normals[3 * i + 2]  = normal.z;
-
-        ++progress;
     }
     cout << endl;
+
+    pc->setPointNormalArray(interpolated, numPoints);
 }
 
 /**
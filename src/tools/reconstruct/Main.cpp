@@ -140,16 +140,21 @@
 #ifndef DEBUG
   #include "Options.hpp"
 #endif
+#include "SlabReconstruction.hpp"
 
 // Local includes
 #include <lvr/reconstruction/AdaptiveKSearchSurface.hpp>
 #include <lvr/reconstruction/FastReconstruction.hpp>
 #include <lvr/reconstruction/PointsetGrid.hpp>
+#include <lvr/reconstruction/AdaptiveReconstruction.hpp>
+#include <lvr/reconstruction/SpatialSort.hpp>
 #include <lvr/reconstruction/FastBox.hpp>
 #include <lvr/reconstruction/SharpBox.hpp>
 #include <lvr/reconstruction/TetraederBox.hpp>
 
 #include <lvr/io/PLYIO.hpp>
+#include <lvr/io/Profiler.hpp>
+#include <lvr/io/Checkpoint.hpp>
 #include <lvr/config/lvropenmp.hpp>
 #include <lvr/geometry/Matrix4.hpp>
 #include <lvr/geometry/HalfEdgeMesh.hpp>
@@ -167,6 +172,7 @@
 
 
 #include <iostream>
+#include <sstream>
 
 
 using namespace lvr;
@@ -176,10 +182,188 @@ typedef Normal<float> cNormal;
 typedef PointsetSurface<ColorVertex<float, unsigned char> > psSurface;
 typedef AdaptiveKSearchSurface<ColorVertex<float, unsigned char>, Normal<float> > akSurface;
 
+typedef HalfEdgeMesh<ColorVertex<float, unsigned char>, Normal<float> > hMesh;
+
 #ifdef LVR_USE_PCL
 typedef PCLKSurface<ColorVertex<float, unsigned char> , Normal<float> > pclSurface;
 #endif
 
+/**
+ * @brief   Calculates the distance values of a grid or restores them from
+ *          the checkpoint of an earlier run with the same key. Calculated
+ *          values are stored if a checkpoint directory is given.
+ */
+template<typename GridT>
+void calcDistances(GridT* grid, const string& checkpointDir, const string& key)
+{
+	vector<QueryPoint<cVertex> >& queryPoints = grid->getQueryPoints();
+	size_t n = queryPoints.size();
+	ProfilerStage distanceStage("distances", n);
+
+	if(checkpointDir != "")
+	{
+		Checkpoint checkpoint(checkpointDir, "distances", key);
+		if(checkpoint.read())
+		{
+			size_t numPositions, numDistances, numFlags;
+			floatArr positions = checkpoint.get<float>(0, numPositions);
+			floatArr distances = checkpoint.get<float>(1, numDistances);
+			ucharArr invalid   = checkpoint.get<unsigned char>(2, numFlags);
+
+			// The grid is built deterministically from the points, so the
+			// stored query points have to be the same
+			bool match = numPositions == 3 * n && numDistances == n && numFlags == n;
+			for(size_t i = 0; i < n && match; i++)
+			{
+				match = positions[3 * i]     == queryPoints[i].m_position[0]
+				     && positions[3 * i + 1] == queryPoints[i].m_position[1]
+				     && positions[3 * i + 2] == queryPoints[i].m_position[2];
+			}
+
+			if(match)
+			{
+				for(size_t i = 0; i < n; i++)
+				{
+					queryPoints[i].m_distance = distances[i];
+					queryPoints[i].m_invalid  = invalid[i] != 0;
+				}
+				cout << timestamp << "Using distance values from checkpoint." << endl;
+				return;
+			}
+			cout << timestamp << "Checkpoint does not match the grid. Recalculating distance values." << endl;
+		}
+	}
+
+	grid->calcDistanceValues();
+
+	if(checkpointDir != "")
+	{
+		floatArr positions(new float[3 * n]);
+		floatArr distances(new float[n]);
+		ucharArr invalid(new unsigned char[n]);
+		for(size_t i = 0; i < n; i++)
+		{
+			positions[3 * i]     = queryPoints[i].m_position[0];
+			positions[3 * i + 1] = queryPoints[i].m_position[1];
+			positions[3 * i + 2] = queryPoints[i].m_position[2];
+			distances[i] = queryPoints[i].m_distance;
+			invalid[i]   = queryPoints[i].m_invalid;
+		}
+
+		Checkpoint checkpoint(checkpointDir, "distances", key);
+		checkpoint.add(positions, 3 * n);
+		checkpoint.add(distances, n);
+		checkpoint.add(invalid, n);
+		checkpoint.write();
+	}
+}
+
+/**
+ * @brief   Stores the vertices, vertex normals and triangles of a mesh
+ *          before optimization in a checkpoint
+ */
+bool saveMeshCheckpoint(hMesh& mesh, const string& checkpointDir, const string& key)
+{
+	hMesh::VertexVector& vertices = mesh.getVertices();
+	hMesh::FaceVector& faces = mesh.getFaces();
+
+	floatArr positions(new float[3 * vertices.size()]);
+	floatArr normals(new float[3 * vertices.size()]);
+	for(size_t i = 0; i < vertices.size(); i++)
+	{
+		// Triangles refer to the vertex indices
+		if(vertices[i]->m_actIndex != i)
+		{
+			cout << timestamp << "Mesh vertices are not indexed consecutively. No mesh checkpoint written." << endl;
+			return false;
+		}
+
+		for(int j = 0; j < 3; j++)
+		{
+			positions[3 * i + j] = vertices[i]->m_position[j];
+			normals[3 * i + j]   = vertices[i]->m_normal[j];
+		}
+	}
+
+	// The first edge of a face runs from its vertex 2 to vertex 0, so this
+	// order reproduces the arguments of addTriangle()
+	uintArr indices(new unsigned int[3 * faces.size()]);
+	for(size_t i = 0; i < faces.size(); i++)
+	{
+		indices[3 * i]     = (*faces[i])(2)->m_actIndex;
+		indices[3 * i + 1] = (*faces[i])(0)->m_actIndex;
+		indices[3 * i + 2] = (*faces[i])(1)->m_actIndex;
+	}
+
+	Checkpoint checkpoint(checkpointDir, "mesh", key);
+	checkpoint.add(positions, 3 * vertices.size());
+	checkpoint.add(normals, 3 * vertices.size());
+	checkpoint.add(indices, 3 * faces.size());
+	return checkpoint.write();
+}
+
+/**
+ * @brief   Adds the vertices and triangles of a mesh checkpoint to an
+ *          empty mesh
+ *
+ * @return  false if there is no valid checkpoint for the key
+ */
+bool loadMeshCheckpoint(hMesh& mesh, const string& checkpointDir, const string& key)
+{
+	Checkpoint checkpoint(checkpointDir, "mesh", key);
+	if(!checkpoint.read())
+	{
+		return false;
+	}
+
+	size_t numPositions, numNormals, numIndices;
+	floatArr positions = checkpoint.get<float>(0, numPositions);
+	floatArr normals   = checkpoint.get<float>(1, numNormals);
+	uintArr  indices   = checkpoint.get<unsigned int>(2, numIndices);
+
+	size_t numVertices = numPositions / 3;
+	bool valid = numPositions % 3 == 0 && numNormals == numPositions && numIndices % 3 == 0;
+	for(size_t i = 0; i < numIndices && valid; i++)
+	{
+		valid = indices[i] < numVertices;
+	}
+	if(!valid)
+	{
+		cout << timestamp << "Invalid mesh checkpoint." << endl;
+		return false;
+	}
+
+	for(size_t i = 0; i < numVertices; i++)
+	{
+		mesh.addVertex(cVertex(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]));
+		mesh.addNormal(cNormal(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]));
+	}
+	for(size_t i = 0; i < numIndices; i += 3)
+	{
+		mesh.addTriangle(indices[i], indices[i + 1], indices[i + 2]);
+	}
+
+	cout << timestamp << "Using mesh with " << numVertices << " vertices and "
+	     << numIndices / 3 << " triangles from checkpoint." << endl;
+	return true;
+}
+
+/**
+ * @brief   Prints the stage profile and writes it to the file given in
+ *          the options
+ */
+void writeProfile(const reconstruct::Options& options)
+{
+	if(options.getProfileFile() != "")
+	{
+		Profiler::instance().print(cout);
+		if(Profiler::instance().writeJSON(options.getProfileFile()))
+		{
+			cout << timestamp << "Wrote stage profile to " << options.getProfileFile() << endl;
+		}
+	}
+}
+
 /**
  * @brief   Main entry point for the LSSR surface executable
  */
@@ -201,7 +385,18 @@ int main(int argc, char** argv)
 
 		std::cout << options << std::endl;
 
+		// Reconstruct large inputs slab by slab with bounded memory
+		if(options.getSlabPoints())
+		{
+			SlabReconstruction slabs(options);
+			bool ok = slabs.run("triangle_mesh.ply");
+			writeProfile(options);
+			cout << timestamp << "Program end." << endl;
+			return ok ? 0 : -1;
+		}
+
 		// Create a point loader object
+		ProfilerStage readStage("io_read");
 		ModelPtr model = ModelFactory::readModel( options.getInputFileName() );
 		PointBufferPtr p_loader;
 
@@ -212,6 +407,110 @@ int main(int argc, char** argv)
 			exit(-1);
 		}
 		p_loader = model->m_pointCloud;
+		readStage.setItems(p_loader ? p_loader->getNumPoints() : 0);
+		readStage.stop();
+
+		// Sort the points along a space filling curve. The permutation is
+		// kept to restore the input order of saved point normals.
+		vector<size_t> pointOrder;
+		if(options.getReorderCurve() != "" && p_loader)
+		{
+			SpatialCurve curve;
+			if(!parseSpatialCurve(options.getReorderCurve(), curve))
+			{
+				cout << timestamp << "Unknown space filling curve '" << options.getReorderCurve() << "'." << endl;
+				exit(-1);
+			}
+
+			ProfilerStage reorderStage("reorder", p_loader->getNumPoints());
+			size_t numPoints;
+			floatArr points = p_loader->getPointArray(numPoints);
+			spatialOrder(points.get(), numPoints, curve, pointOrder);
+			p_loader = permutePointBuffer(p_loader, pointOrder);
+			cout << timestamp << "Sorted " << numPoints << " points along a "
+			     << options.getReorderCurve() << " curve" << endl;
+		}
+
+		// Determine whether to use intersections or voxelsize
+		float resolution;
+		bool useVoxelsize;
+		if(options.getIntersections() > 0)
+		{
+			resolution = options.getIntersections();
+			useVoxelsize = false;
+		}
+		else
+		{
+			resolution = options.getVoxelsize();
+			useVoxelsize = true;
+		}
+
+		// Decomposition type for the grid
+		string decomposition = options.getDecomposition();
+
+		// Fail safe check
+        if(decomposition != "MT" && decomposition != "MC" && decomposition != "PMC" && decomposition != "SF" && decomposition != "DMC")
+		{
+			cout << "Unsupported decomposition type " << decomposition << ". Defaulting to PMC." << endl;
+			decomposition = "PMC";
+		}
+
+		// Keys of the stage checkpoints. Each key contains the input file and
+		// all parameters the stage and its predecessors depend on, so options
+		// of later stages like mesh optimization do not invalidate them.
+		string checkpointDir = options.getCheckpointDirectory();
+		std::stringstream key;
+		key.precision(9);
+		key << "input=" << Checkpoint::fileSignature(options.getInputFileName())
+		    << " reorder=" << options.getReorderCurve()
+		    << " pcm=" << options.getPCM()
+		    << " kn=" << options.getKn()
+		    << " ki=" << options.getKi()
+		    << " ransac=" << options.useRansac()
+		    << " recalcNormals=" << options.recalcNormals();
+		if(options.getScanPoseFile() != "")
+		{
+			key << " poses=" << Checkpoint::fileSignature(options.getScanPoseFile());
+		}
+		string normalKey = key.str();
+
+		key << " kd=" << options.getKd()
+		    << " resolution=" << resolution
+		    << " useVoxelsize=" << useVoxelsize
+		    << " extrude=" << options.extrude();
+		if(decomposition == "DMC")
+		{
+			key << " adaptiveLevels=" << options.getAdaptiveLevels()
+			    << " adaptiveTolerance=" << options.getAdaptiveTolerance();
+		}
+		string gridKey = key.str();
+
+		key << " decomposition=" << decomposition;
+		if(decomposition == "SF")
+		{
+			key << " sft=" << options.getSharpFeatureThreshold()
+			    << " sct=" << options.getSharpCornerThreshold();
+		}
+		string meshKey = key.str();
+
+		// Restore normals of an earlier run. The surface takes them from
+		// the point buffer.
+		bool normalsRestored = false;
+		if(checkpointDir != "" && p_loader && (!p_loader->hasPointNormals() || options.recalcNormals()))
+		{
+			Checkpoint checkpoint(checkpointDir, "normals", normalKey);
+			size_t numNormals;
+			floatArr normals;
+			if(checkpoint.read())
+			{
+				normals = checkpoint.get<float>(0, numNormals);
+			}
+			if(normals && numNormals == 3 * p_loader->getNumPoints())
+			{
+				p_loader->setPointNormalArray(normals, p_loader->getNumPoints());
+				normalsRestored = true;
+			}
+		}
 
 		// Create a point cloud manager
 		string pcm_name = options.getPCM();
@@ -267,11 +566,24 @@ int main(int argc, char** argv)
 		surface->setKn(options.getKn());
 
 		// Calculate normals if necessary
-		if(!surface->pointBuffer()->hasPointNormals()
+		if(normalsRestored)
+		{
+			cout << timestamp << "Using normals from checkpoint." << endl;
+		}
+		else if(!surface->pointBuffer()->hasPointNormals()
 				|| (surface->pointBuffer()->hasPointNormals() && options.recalcNormals()))
 		{
-		    Timestamp ts;
+			ProfilerStage normalStage("normals", surface->pointBuffer()->getNumPoints());
 			surface->calculateSurfaceNormals();
+			normalStage.stop();
+
+			if(checkpointDir != "")
+			{
+				size_t numNormals;
+				Checkpoint checkpoint(checkpointDir, "normals", normalKey);
+				checkpoint.add(surface->pointBuffer()->getPointNormalArray(numNormals), 3 * numNormals);
+				checkpoint.write();
+			}
 		}
 		else
 		{
@@ -283,11 +595,15 @@ int main(int argc, char** argv)
 		{
 			ModelPtr pn( new Model);
 			pn->m_pointCloud = surface->pointBuffer();
+			if(pointOrder.size())
+			{
+				pn->m_pointCloud = permutePointBuffer(pn->m_pointCloud, pointOrder, true);
+			}
 			ModelFactory::saveModel(pn, "pointnormals.ply");
 		}
 
 		// Create an empty mesh
-		HalfEdgeMesh<ColorVertex<float, unsigned char> , Normal<float> > mesh( surface );
+		hMesh mesh( surface );
 
 		// Set recursion depth for region growing
 		if(options.getDepth())
@@ -364,76 +680,93 @@ int main(int argc, char** argv)
 			SharpBox<Vertex<float> , Normal<float> >::m_phi_corner = options.getSharpCornerThreshold();
 		}
 
-		// Determine whether to use intersections or voxelsize
-		float resolution;
-		bool useVoxelsize;
-		if(options.getIntersections() > 0)
-		{
-			resolution = options.getIntersections();
-			useVoxelsize = false;
-		}
-		else
-		{
-			resolution = options.getVoxelsize();
-			useVoxelsize = true;
-		}
-
-		// Create a point set grid for reconstruction
-		string decomposition = options.getDecomposition();
+		// Continue with the raw mesh of an earlier run. The grid is only
+		// built if it has to be saved.
+		bool meshRestored = checkpointDir != "" && !options.saveGrid()
+		                 && loadMeshCheckpoint(mesh, checkpointDir, meshKey);
 
-		// Fail safe check
-        if(decomposition != "MT" && decomposition != "MC" && decomposition != "PMC" && decomposition != "SF" )
+		if(!meshRestored)
 		{
-			cout << "Unsupported decomposition type " << decomposition << ". Defaulting to PMC." << endl;
-			decomposition = "PMC";
-		}
+			ProfilerStage gridStage("grid");
+			GridBase* grid;
+			FastReconstructionBase<ColorVertex<float, unsigned char>, Normal<float> >* reconstruction;
+			if(decomposition == "MC")
+			{
+				grid = new PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
+				PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
+				gridStage.setItems(ps_grid->getNumberOfCells());
+				gridStage.stop();
 
-		GridBase* grid;
-		FastReconstructionBase<ColorVertex<float, unsigned char>, Normal<float> >* reconstruction;
-		if(decomposition == "MC")
-		{
-			grid = new PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
-			PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-			ps_grid->calcDistanceValues();
-			reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, FastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+				calcDistances(ps_grid, checkpointDir, gridKey);
+				reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, FastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
 
-		}
-		else if(decomposition == "PMC")
-		{
-			BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
-			grid = new PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
-			PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-			ps_grid->calcDistanceValues();
-			reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+			}
+			else if(decomposition == "PMC")
+			{
+				BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
+				grid = new PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
+				PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
+				gridStage.setItems(ps_grid->getNumberOfCells());
+				gridStage.stop();
 
-		}
-		else if(decomposition == "SF")
-		{
-			SharpBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
-			grid = new PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
-			PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-			ps_grid->calcDistanceValues();
-			reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
-		}
-        else if(decomposition == "MT")
-        {
-            grid = new PointsetGrid<ColorVertex<float, unsigned char>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
-            PointsetGrid<ColorVertex<float, unsigned char>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-            ps_grid->calcDistanceValues();
-            reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
-        }
+				calcDistances(ps_grid, checkpointDir, gridKey);
+				reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+
+			}
+			else if(decomposition == "SF")
+			{
+				SharpBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
+				grid = new PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
+				PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
+				gridStage.setItems(ps_grid->getNumberOfCells());
+				gridStage.stop();
+
+				calcDistances(ps_grid, checkpointDir, gridKey);
+				reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+			}
+	        else if(decomposition == "MT")
+	        {
+	            grid = new PointsetGrid<ColorVertex<float, unsigned char>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize, options.extrude());
+	            PointsetGrid<ColorVertex<float, unsigned char>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
+	            gridStage.setItems(ps_grid->getNumberOfCells());
+	            gridStage.stop();
+
+	            calcDistances(ps_grid, checkpointDir, gridKey);
+	            reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, TetraederBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+	        }
+			else if(decomposition == "DMC")
+			{
+				float voxelsize = useVoxelsize ? resolution : surface->getBoundingBox().getLongestSide() / resolution;
+				grid = new AdaptiveGrid<ColorVertex<float, unsigned char> >(voxelsize, surface, surface->getBoundingBox(), options.getAdaptiveLevels(), options.getAdaptiveTolerance());
+				AdaptiveGrid<ColorVertex<float, unsigned char> >* a_grid = static_cast<AdaptiveGrid<ColorVertex<float, unsigned char> >*>(grid);
+				gridStage.setItems(a_grid->getNumberOfCells());
+				gridStage.stop();
+
+				calcDistances(a_grid, checkpointDir, gridKey);
+				reconstruction = new AdaptiveReconstruction<ColorVertex<float, unsigned char>, Normal<float> >(a_grid);
+			}
 
 
 		
-		// Create mesh
-		reconstruction->getMesh(mesh);
-		
-		// Save grid to file
-		if(options.saveGrid())
-		{
-			grid->saveGrid("fastgrid.grid");
+			// Create mesh
+			ProfilerStage extractionStage("extraction");
+			reconstruction->getMesh(mesh);
+			extractionStage.setItems(mesh.meshSize());
+			extractionStage.stop();
+
+			if(checkpointDir != "")
+			{
+				saveMeshCheckpoint(mesh, checkpointDir, meshKey);
+			}
+
+			// Save grid to file
+			if(options.saveGrid())
+			{
+				grid->saveGrid("fastgrid.grid");
+			}
 		}
 
+		ProfilerStage optimizationStage("optimization", mesh.meshSize());
 		if(options.getDanglingArtifacts())
  		{
 			mesh.removeDanglingArtifacts(options.getDanglingArtifacts());
@@ -468,7 +801,10 @@ int main(int argc, char** argv)
 			mesh.fillHoles(options.getFillHoles());
 		}
 
+		optimizationStage.stop();
+
 		// Save triangle mesh
+		ProfilerStage finalizeStage("finalize", mesh.meshSize());
 		if ( options.retesselate() )
 		{
 			mesh.finalizeAndRetesselate(options.generateTextures(), options.getLineFusionThreshold());
@@ -478,6 +814,8 @@ int main(int argc, char** argv)
 			mesh.finalize();
 		}
 
+		finalizeStage.stop();
+
 		// Write classification to file
 		if ( options.writeClassificationResult() )
 		{
@@ -490,8 +828,15 @@ int main(int argc, char** argv)
 		if(options.saveOriginalData())
 		{
 			m->m_pointCloud = model->m_pointCloud;
+
+			// The computed normals are stored in the sorted buffer
+			if(pointOrder.size())
+			{
+				m->m_pointCloud = permutePointBuffer(surface->pointBuffer(), pointOrder, true);
+			}
 		}
 		cout << timestamp << "Saving mesh." << endl;
+		ProfilerStage writeStage("io_write", mesh.meshSize());
 		ModelFactory::saveModel( m, "triangle_mesh.ply");
 
 		// Save obj model if textures were generated
@@ -499,6 +844,10 @@ int main(int argc, char** argv)
 		{
 			ModelFactory::saveModel( m, "triangle_mesh.obj");
 		}		
+		writeStage.stop();
+
+		// Write stage profile
+		writeProfile(options);
 		cout << timestamp << "Program end." << endl;
 
 	}
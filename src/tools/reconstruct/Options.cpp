@@ -46,7 +46,7 @@ Options::Options(int argc, char** argv)
 		        ("intersections,i", value<int>(&m_intersections)->default_value(-1), "Number of intersections used for reconstruction. If other than -1, voxelsize will calculated automatically.")
 		        ("pcm,p", value<string>(&m_pcm)->default_value("FLANN"), "Point cloud manager used for point handling and normal estimation. Choose from {STANN, PCL, NABO}.")
                 ("ransac", "Set this flag for RANSAC based normal estimation.")
-		        ("decomposition,d", value<string>(&m_pcm)->default_value("PMC"), "Defines the type of decomposition that is used for the voxels (Standard Marching Cubes (MC), Planar Marching Cubes (PMC), Standard Marching Cubes with sharp feature detection (SF) or Tetraeder (MT) decomposition. Choose from {MC, PMC, MT, SF}")
+		        ("decomposition,d", value<string>(&m_pcm)->default_value("PMC"), "Defines the type of decomposition that is used for the voxels (Standard Marching Cubes (MC), Planar Marching Cubes (PMC), Standard Marching Cubes with sharp feature detection (SF), Tetraeder (MT) decomposition or Dual Marching Cubes on an adaptive octree (DMC). Choose from {MC, PMC, MT, SF, DMC}")
 		        ("optimizePlanes,o", "Shift all triangle vertices of a cluster onto their shared plane")
                 ("clusterPlanes,c", "Cluster planar regions based on normal threshold, do not shift vertices into regression plane.")
 		        ("cleanContours", value<int>(&m_cleanContourIterations)->default_value(0), "Remove noise artifacts from contours. Same values are between 2 and 4")
@@ -75,6 +75,8 @@ Options::Options(int argc, char** argv)
 		        ("threads", value<int>(&m_numThreads)->default_value( lvr::OpenMPConfig::getNumThreads() ), "Number of threads")
 		        ("sft", value<float>(&m_sft)->default_value(0.9), "Sharp feature threshold when using sharp feature decomposition")
 		        ("sct", value<float>(&m_sct)->default_value(0.7), "Sharp corner threshold when using sharp feature decomposition")
+		        ("adaptiveLevels", value<int>()->default_value(4), "Number of octree levels above the voxel size when using DMC decomposition. Flat regions are meshed with cells of up to 2^levels voxels.")
+		        ("adaptiveTolerance", value<float>()->default_value(0.05), "Maximum distance of the points in a cell from their plane relative to the cell size when using DMC decomposition. Cells with larger deviations are split.")
 		        ("ecm", value<string>(&m_ecm)->default_value("QUADRIC"), "Edge collapse method for mesh reduction. Choose from QUADRIC, QUADRIC_TRI, MELAX, SHORTEST")
 				("ecc", value<int>(&m_numEdgeCollapses)->default_value(0), "Edge collapse count. Number of edges to collapse for mesh reduction.")
 		        ("tp", value<string>(&m_texturePack)->default_value(""), "Path to texture pack")
@@ -88,6 +90,11 @@ Options::Options(int argc, char** argv)
 		        ("cro", "Use texture matching based on cross correlation.")
 		        ("patt", value<float>(&m_patternThreshold)->default_value(100), "Threshold for pattern extraction from textures")
 		        ("mtv", value<int>(&m_minimumTransformationVotes)->default_value(3), "Minimum number of votes to consider a texture transformation as correct")
+		        ("profile", value<string>()->default_value(""), "Write the run time, CPU time, peak memory and throughput of each pipeline stage to the given JSON file")
+		        ("reorder", value<string>()->default_value(""), "Sort the input points along a space filling curve before building the search tree to improve memory locality. Possible values: morton, hilbert. Saved point normals keep the input order.")
+		        ("checkpoint", value<string>()->default_value(""), "Directory for stage checkpoints. Point normals, distance values and the raw mesh are stored there and reused by later runs with the same input file and parameters, e.g. when only mesh optimization options change.")
+		        ("slabPoints", value<size_t>()->default_value(0), "Reconstruct the bounding box in slabs along its longest axis with at most this many points each. The slabs are meshed one after another and written to 'triangle_mesh.ply' with welded seams, so the memory usage depends on the slab size and not on the size of the input. 0 disables slabs.")
+		        ("slabMargin", value<int>()->default_value(10), "Number of voxels a slab is extended by the points of its neighbors, so normals and distance values at the seams are computed from complete neighborhoods.")
         ;
 
 	setup();
@@ -109,6 +116,16 @@ float Options::getSharpCornerThreshold() const
 	return m_variables["sct"].as<float>();
 }
 
+int Options::getAdaptiveLevels() const
+{
+	return m_variables["adaptiveLevels"].as<int>();
+}
+
+float Options::getAdaptiveTolerance() const
+{
+	return m_variables["adaptiveTolerance"].as<float>();
+}
+
 
 int Options::getNumThreads() const
 {
@@ -171,6 +188,31 @@ string Options::getScanPoseFile() const
 	return (m_variables["scanPoseFile"].as<string>());
 }
 
+string Options::getProfileFile() const
+{
+	return (m_variables["profile"].as<string>());
+}
+
+string Options::getReorderCurve() const
+{
+	return (m_variables["reorder"].as<string>());
+}
+
+string Options::getCheckpointDirectory() const
+{
+	return (m_variables["checkpoint"].as<string>());
+}
+
+size_t Options::getSlabPoints() const
+{
+	return (m_variables["slabPoints"].as<size_t>());
+}
+
+int Options::getSlabMargin() const
+{
+	return (m_variables["slabMargin"].as<int>());
+}
+
 int Options::getNumEdgeCollapses() const
 {
 	return (m_variables["ecc"].as<int>());
@@ -189,6 +189,37 @@ public:
 	 */
 	string 	getScanPoseFile() const;
 
+	/**
+	 * @brief	Returns the name of the JSON file for the stage profile or an
+	 * 			empty string if no profile should be written.
+	 */
+	string 	getProfileFile() const;
+
+	/**
+	 * @brief	Returns the space filling curve ("morton" or "hilbert") used
+	 * 			to sort the input points or an empty string if the points
+	 * 			keep their order.
+	 */
+	string 	getReorderCurve() const;
+
+	/**
+	 * @brief	Returns the directory for stage checkpoints or an empty
+	 * 			string if no checkpoints should be used.
+	 */
+	string 	getCheckpointDirectory() const;
+
+	/**
+	 * @brief	Returns the maximum number of points of a slab or 0 if the
+	 * 			whole point cloud is reconstructed at once.
+	 */
+	size_t 	getSlabPoints() const;
+
+	/**
+	 * @brief	Returns the number of voxels a slab is extended by the
+	 * 			points of its neighbors.
+	 */
+	int 	getSlabMargin() const;
+
 	/**
 	 * @brief   Returns the number of intersections. If the return value
 	 *          is positive it will be used for reconstruction instead of
@@ -265,6 +296,18 @@ public:
 		 */
 	float getSharpCornerThreshold() const;
 
+	/**
+	 * @brief   Returns the number of octree levels above the voxel size
+	 *          when using adaptive decomposition
+	 */
+	int getAdaptiveLevels() const;
+
+	/**
+	 * @brief   Returns the relative plane tolerance of the cells when
+	 *          using adaptive decomposition
+	 */
+	float getAdaptiveTolerance() const;
+
     /**
      * @brief   Returns the fusion threshold for tesselation
      */
@@ -473,6 +516,11 @@ inline ostream& operator<<(ostream& os, const Options &o)
 		cout << "##### Sharp feature threshold \t: " << o.getSharpFeatureThreshold() << endl;
 		cout << "##### Sharp corner threshold \t: " << o.getSharpCornerThreshold() << endl;
 	}
+	if(o.getDecomposition() == "DMC")
+	{
+		cout << "##### Adaptive levels \t\t: " << o.getAdaptiveLevels() << endl;
+		cout << "##### Adaptive tolerance \t: " << o.getAdaptiveTolerance() << endl;
+	}
 	if(o.retesselate())
 	{
 		cout << "##### Retesselate \t\t: YES"     << endl;
@@ -547,6 +595,25 @@ inline ostream& operator<<(ostream& os, const Options &o)
 		cout << "##### Edge collapse method: \t\t: " << o.getEdgeCollapseMethod() << endl;
 		cout << "##### Number of edge collapses\t: " << o.getNumEdgeCollapses() << endl;
 	}
+	if(o.getProfileFile() != "")
+	{
+		cout << "##### Profile \t\t\t: " << o.getProfileFile() << endl;
+	}
+	if(o.getReorderCurve() != "")
+	{
+		cout << "##### Point order \t\t: " << o.getReorderCurve() << endl;
+	}
+
+	if(o.getCheckpointDirectory() != "")
+	{
+		cout << "##### Checkpoints \t\t: " << o.getCheckpointDirectory() << endl;
+	}
+
+	if(o.getSlabPoints())
+	{
+		cout << "##### Slab size \t\t: " << o.getSlabPoints() << " points" << endl;
+		cout << "##### Slab margin \t\t: " << o.getSlabMargin() << " voxels" << endl;
+	}
 
 
 	return os;
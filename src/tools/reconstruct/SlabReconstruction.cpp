@@ -0,0 +1,784 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * SlabReconstruction.cpp
+ */
+
+#include "SlabReconstruction.hpp"
+
+#include <lvr/reconstruction/AdaptiveKSearchSurface.hpp>
+#include <lvr/reconstruction/FastReconstruction.hpp>
+#include <lvr/reconstruction/PointsetGrid.hpp>
+#include <lvr/reconstruction/SpatialSort.hpp>
+#include <lvr/reconstruction/FastBox.hpp>
+#include <lvr/reconstruction/SharpBox.hpp>
+#include <lvr/geometry/ColorVertex.hpp>
+#include <lvr/geometry/Normal.hpp>
+#include <lvr/geometry/HalfEdgeMesh.hpp>
+#include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/LasIO.hpp>
+#include <lvr/io/PLYIO.hpp>
+#include <lvr/io/Profiler.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#ifdef LVR_USE_PCL
+#include <lvr/reconstruction/PCLKSurface.hpp>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::ofstream;
+
+namespace lvr
+{
+
+namespace
+{
+
+typedef ColorVertex<float, unsigned char> cVertex;
+typedef Normal<float> cNormal;
+typedef PointsetSurface<cVertex> psSurface;
+typedef AdaptiveKSearchSurface<cVertex, cNormal> akSurface;
+typedef HalfEdgeMesh<cVertex, cNormal> hMesh;
+
+#ifdef LVR_USE_PCL
+typedef PCLKSurface<cVertex, cNormal> pclSurface;
+#endif
+
+/// Number of points parsed from a file at once
+const size_t CHUNK_POINTS = 1 << 20;
+
+/// Number of floats buffered for a slab file before they are written
+const size_t FLUSH_FLOATS = 1 << 16;
+
+/// Size of a vertex record: position, normal and color
+const size_t VERTEX_RECORD = 6 * sizeof(float) + 3;
+
+/// Size of a face record: vertex count and three indices
+const size_t FACE_RECORD = 1 + 3 * sizeof(int32_t);
+
+bool isAscii(string filename)
+{
+	string extension = boost::filesystem::path(filename).extension().string();
+	return extension == ".pts" || extension == ".3d" || extension == ".xyz" || extension == ".txt";
+}
+
+void flush(const string& path, vector<float>& buffer)
+{
+	if(buffer.empty())
+	{
+		return;
+	}
+	ofstream out(path.c_str(), std::ios::binary | std::ios::app);
+	out.write((char*)&buffer[0], buffer.size() * sizeof(float));
+	buffer.clear();
+}
+
+/// Builds the grid for the given box type and extracts the raw mesh
+template<typename BoxT>
+void extractMesh(float voxelsize, psSurface::Ptr surface, BoundingBox<cVertex> bb,
+                 bool extrude, hMesh& mesh)
+{
+	PointsetGrid<cVertex, BoxT> grid(voxelsize, surface, bb, true, extrude);
+	grid.calcDistanceValues();
+
+	FastReconstruction<cVertex, cNormal, BoxT> reconstruction(&grid);
+	reconstruction.getMesh(mesh);
+}
+
+} // anonymous namespace
+
+SlabReconstruction::SlabReconstruction(const reconstruct::Options& options)
+	: m_options(options),
+	  m_maxPoints(std::max(options.getSlabPoints(), (size_t)1)),
+	  m_margin(std::max(options.getSlabMargin(), 1)),
+	  m_useNormals(false),
+	  m_shifted(false),
+	  m_voxelsize(0),
+	  m_axis(0),
+	  m_numVertices(0),
+	  m_numFaces(0)
+{
+	boost::filesystem::path tmp = boost::filesystem::temp_directory_path()
+	                            / boost::filesystem::unique_path("lvr_slabs_%%%%-%%%%-%%%%");
+	m_tmpDir = tmp.string();
+}
+
+SlabReconstruction::~SlabReconstruction()
+{
+	m_vertexOut.close();
+	m_faceOut.close();
+	boost::system::error_code ec;
+	boost::filesystem::remove_all(m_tmpDir, ec);
+}
+
+bool SlabReconstruction::readPoints(PointFunction f)
+{
+	string filename = m_options.getInputFileName();
+
+	if(isAscii(filename))
+	{
+		ifstream in(filename.c_str());
+		if(!in.good())
+		{
+			cout << timestamp << "IO Error: Unable to open " << filename << endl;
+			return false;
+		}
+
+		vector<float> chunk;
+		chunk.reserve(3 * CHUNK_POINTS);
+		string line;
+		while(std::getline(in, line))
+		{
+			float v[3];
+			const char* c = line.c_str();
+			int i = 0;
+			for(; i < 3; i++)
+			{
+				char* next;
+				v[i] = strtof(c, &next);
+				if(next == c)
+				{
+					break;
+				}
+				c = next;
+			}
+
+			// Skip headers, comments and empty lines
+			if(i == 3)
+			{
+				chunk.insert(chunk.end(), v, v + 3);
+			}
+
+			if(chunk.size() == 3 * CHUNK_POINTS)
+			{
+				f(&chunk[0], 0, CHUNK_POINTS);
+				chunk.clear();
+			}
+		}
+
+		if(chunk.size())
+		{
+			f(&chunk[0], 0, chunk.size() / 3);
+		}
+		return true;
+	}
+
+	string extension = boost::filesystem::path(filename).extension().string();
+	if(extension == ".las" || extension == ".laz")
+	{
+		// Shifted like in a run without slabs
+		double shift[3];
+		bool ok = LasIO::readChunks(filename, CHUNK_POINTS, [&](vector<float>& points)
+		{
+			f(&points[0], 0, points.size() / 3);
+		}, shift);
+
+		if(ok && !m_shifted && (shift[0] != 0.0 || shift[1] != 0.0 || shift[2] != 0.0))
+		{
+			cout << timestamp << "Slabs: Coordinates are shifted by ("
+			     << shift[0] << ", " << shift[1] << ", " << shift[2] << ")" << endl;
+			m_shifted = true;
+		}
+		return ok;
+	}
+
+	if(extension == ".ply")
+	{
+		// Binary PLY files are streamed record by record, other
+		// layouts are read at once below
+		size_t numChunks = 0;
+		bool ok = PLYIO::readChunks(filename, CHUNK_POINTS, [&](vector<float>& points, vector<float>& normals)
+		{
+			f(&points[0], normals.empty() ? 0 : &normals[0], points.size() / 3);
+			numChunks++;
+		});
+
+		if(ok || numChunks)
+		{
+			return ok;
+		}
+	}
+
+	// Other formats have to be read at once
+	if(!m_input)
+	{
+		ModelPtr model = ModelFactory::readModel(filename);
+		if(!model || !model->m_pointCloud)
+		{
+			cout << timestamp << "IO Error: Unable to parse " << filename << endl;
+			return false;
+		}
+		m_input = model->m_pointCloud;
+	}
+
+	size_t n, nn;
+	floatArr points = m_input->getPointArray(n);
+	floatArr normals = m_input->getPointNormalArray(nn);
+	if(n)
+	{
+		f(points.get(), nn == n ? normals.get() : 0, n);
+	}
+	return true;
+}
+
+bool SlabReconstruction::calcBounds()
+{
+	float bmin[3] = { std::numeric_limits<float>::max(),  std::numeric_limits<float>::max(),  std::numeric_limits<float>::max()};
+	float bmax[3] = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+	size_t numPoints = 0;
+	bool hasNormals = true;
+
+	bool ok = readPoints([&](const float* points, const float* normals, size_t n)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			for(int k = 0; k < 3; k++)
+			{
+				bmin[k] = std::min(bmin[k], points[3 * i + k]);
+				bmax[k] = std::max(bmax[k], points[3 * i + k]);
+			}
+		}
+		numPoints += n;
+		hasNormals = hasNormals && normals;
+	});
+
+	if(!ok || numPoints == 0)
+	{
+		cout << timestamp << "Slabs: No points in " << m_options.getInputFileName() << endl;
+		return false;
+	}
+
+	m_min = Vertexf(bmin[0], bmin[1], bmin[2]);
+	m_max = Vertexf(bmax[0], bmax[1], bmax[2]);
+	m_useNormals = hasNormals && !m_options.recalcNormals();
+
+	m_axis = 0;
+	for(int k = 1; k < 3; k++)
+	{
+		if(bmax[k] - bmin[k] > bmax[m_axis] - bmin[m_axis])
+		{
+			m_axis = k;
+		}
+	}
+
+	// Same voxel size as the grid of a run without slabs
+	if(m_options.getIntersections() > 0)
+	{
+		m_voxelsize = (bmax[m_axis] - bmin[m_axis]) / m_options.getIntersections();
+	}
+	else
+	{
+		m_voxelsize = m_options.getVoxelsize();
+	}
+
+	cout << timestamp << "Slabs: " << numPoints << " points, voxelsize " << m_voxelsize
+	     << ", slab axis " << "xyz"[m_axis] << endl;
+	return true;
+}
+
+void SlabReconstruction::calcSlabs()
+{
+	int numCells = cellIndex(m_max[m_axis]) + 1;
+
+	// Number of points per cell layer along the axis
+	vector<size_t> histogram(numCells, 0);
+	readPoints([&](const float* points, const float* normals, size_t n)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			int c = std::min(std::max(cellIndex(points[3 * i + m_axis]), 0), numCells - 1);
+			histogram[c]++;
+		}
+	});
+
+	// Start a new slab whenever the next layer would exceed the limit.
+	// A single layer with more points can not be split.
+	m_slabBegin.clear();
+	m_slabBegin.push_back(0);
+	size_t count = 0;
+	for(int c = 0; c < numCells; c++)
+	{
+		if(count > 0 && count + histogram[c] > m_maxPoints)
+		{
+			m_slabBegin.push_back(c);
+			count = 0;
+		}
+		count += histogram[c];
+	}
+	m_slabBegin.push_back(numCells);
+
+	cout << timestamp << "Slabs: Cut " << numCells << " cell layers into "
+	     << m_slabBegin.size() - 1 << " slabs." << endl;
+}
+
+bool SlabReconstruction::splitPoints()
+{
+	try
+	{
+		boost::filesystem::create_directories(m_tmpDir);
+	}
+	catch(boost::filesystem::filesystem_error& e)
+	{
+		cout << timestamp << "Slabs: " << e.what() << endl;
+		return false;
+	}
+
+	size_t numSlabs = m_slabBegin.size() - 1;
+	int numCells = m_slabBegin.back();
+	int stride = m_useNormals ? 6 : 3;
+	vector<vector<float> > buffers(numSlabs);
+	m_slabPoints.assign(numSlabs, 0);
+
+	bool ok = readPoints([&](const float* points, const float* normals, size_t n)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			const float* p = &points[3 * i];
+			int c = std::min(std::max(cellIndex(p[m_axis]), 0), numCells - 1);
+			int slab = std::upper_bound(m_slabBegin.begin(), m_slabBegin.end(), c) - m_slabBegin.begin() - 1;
+
+			// The slab of the point and all neighbors whose margin contains it
+			int first = slab;
+			while(first > 0 && c < m_slabBegin[first] + m_margin)
+			{
+				first--;
+			}
+			int last = slab;
+			while(last < (int)numSlabs - 1 && c >= m_slabBegin[last + 1] - m_margin)
+			{
+				last++;
+			}
+
+			for(int s = first; s <= last; s++)
+			{
+				vector<float>& buffer = buffers[s];
+				buffer.insert(buffer.end(), p, p + 3);
+				if(stride == 6)
+				{
+					buffer.insert(buffer.end(), &normals[3 * i], &normals[3 * i] + 3);
+				}
+				m_slabPoints[s]++;
+
+				if(buffer.size() >= FLUSH_FLOATS)
+				{
+					flush(slabFile(s), buffer);
+				}
+			}
+		}
+	});
+
+	for(size_t s = 0; s < numSlabs; s++)
+	{
+		flush(slabFile(s), buffers[s]);
+	}
+	return ok;
+}
+
+PointBufferPtr SlabReconstruction::loadSlab(size_t slab)
+{
+	string path = slabFile(slab);
+	int stride = m_useNormals ? 6 : 3;
+
+	ifstream in(path.c_str(), std::ios::binary);
+	if(!in.good())
+	{
+		return PointBufferPtr();
+	}
+
+	vector<float> data(stride * m_slabPoints[slab]);
+	if(data.size())
+	{
+		in.read((char*)&data[0], data.size() * sizeof(float));
+	}
+	if(!in.good())
+	{
+		cout << timestamp << "Slabs: " << path << " is truncated." << endl;
+		return PointBufferPtr();
+	}
+	in.close();
+	boost::filesystem::remove(path);
+
+	size_t n = m_slabPoints[slab];
+	floatArr points(new float[3 * n]);
+	floatArr normals(m_useNormals ? new float[3 * n] : 0);
+	for(size_t i = 0; i < n; i++)
+	{
+		std::copy(&data[stride * i], &data[stride * i] + 3, &points[3 * i]);
+		if(normals)
+		{
+			std::copy(&data[stride * i + 3], &data[stride * i + 3] + 3, &normals[3 * i]);
+		}
+	}
+
+	PointBufferPtr buffer(new PointBuffer);
+	buffer->setPointArray(points, n);
+	if(normals)
+	{
+		buffer->setPointNormalArray(normals, n);
+	}
+	return buffer;
+}
+
+MeshBufferPtr SlabReconstruction::reconstructSlab(PointBufferPtr buffer)
+{
+	// Spatial order for the search tree of the slab
+	if(m_options.getReorderCurve() != "")
+	{
+		SpatialCurve curve;
+		if(parseSpatialCurve(m_options.getReorderCurve(), curve))
+		{
+			size_t n;
+			floatArr points = buffer->getPointArray(n);
+			vector<size_t> order;
+			spatialOrder(points.get(), n, curve, order);
+			buffer = permutePointBuffer(buffer, order);
+		}
+	}
+
+	string pcm_name = m_options.getPCM();
+	psSurface::Ptr surface;
+	if(pcm_name == "PCL")
+	{
+#ifdef LVR_USE_PCL
+		surface = psSurface::Ptr(new pclSurface(buffer));
+#else
+		cout << timestamp << "Can't create a PCL point set surface without PCL installed." << endl;
+		return MeshBufferPtr();
+#endif
+	}
+	else
+	{
+		// Scan poses refer to the point order of the input file, which
+		// is not preserved in the slabs
+		akSurface* aks = new akSurface(
+				buffer, pcm_name,
+				m_options.getKn(),
+				m_options.getKi(),
+				m_options.getKd(),
+				m_options.useRansac());
+
+		surface = psSurface::Ptr(aks);
+		if(m_options.useRansac())
+		{
+			aks->useRansac(true);
+		}
+	}
+
+	surface->setKd(m_options.getKd());
+	surface->setKi(m_options.getKi());
+	surface->setKn(m_options.getKn());
+
+	if(!buffer->hasPointNormals())
+	{
+		surface->calculateSurfaceNormals();
+	}
+
+	// All slabs use the lattice of the global bounding box. The box is
+	// expanded, because only expand() calculates its size.
+	BoundingBox<cVertex> bb;
+	bb.expand(m_min[0], m_min[1], m_min[2]);
+	bb.expand(m_max[0], m_max[1], m_max[2]);
+	hMesh mesh(surface);
+
+	string decomposition = m_options.getDecomposition();
+	if(decomposition == "SF")
+	{
+		SharpBox<cVertex, cNormal>::m_surface = surface;
+		extractMesh<SharpBox<cVertex, cNormal> >(m_voxelsize, surface, bb, m_options.extrude(), mesh);
+		SharpBox<cVertex, cNormal>::m_surface.reset();
+	}
+	else
+	{
+		extractMesh<FastBox<cVertex, cNormal> >(m_voxelsize, surface, bb, m_options.extrude(), mesh);
+	}
+
+	mesh.finalize();
+	return mesh.meshBuffer();
+}
+
+void SlabReconstruction::appendSlab(MeshBufferPtr mesh, size_t slab)
+{
+	size_t numVertices, numFaces, numNormals, numColors;
+	floatArr vertices = mesh->getVertexArray(numVertices);
+	uintArr faces = mesh->getFaceArray(numFaces);
+	floatArr normals = mesh->getVertexNormalArray(numNormals);
+	ucharArr colors = mesh->getVertexColorArray(numColors);
+
+	// The outermost slabs also own the extruded cells beyond the
+	// bounding box
+	size_t numSlabs = m_slabBegin.size() - 1;
+	int begin = slab == 0 ? INT_MIN : m_slabBegin[slab];
+	int end = slab == numSlabs - 1 ? INT_MAX : m_slabBegin[slab + 1];
+
+	// Positions of the seam planes along the axis. Vertices within one
+	// voxel of a seam may be shared with the neighbor.
+	float lower = m_min[m_axis] + (m_slabBegin[slab] - 0.5f) * m_voxelsize + m_voxelsize;
+	float upper = m_min[m_axis] + (m_slabBegin[slab + 1] - 0.5f) * m_voxelsize - m_voxelsize;
+
+	std::unordered_map<LatticeEdge, uint32_t, LatticeEdgeHash> seam;
+	vector<int64_t> outputIndex(numVertices, -1);
+	size_t numWelded = 0;
+	size_t numKept = 0;
+	char record[VERTEX_RECORD];
+
+	for(size_t i = 0; i < numFaces; i++)
+	{
+		// Keep the triangles of the cells whose center lies in the slab
+		float c = (vertices[3 * faces[3 * i]     + m_axis]
+		         + vertices[3 * faces[3 * i + 1] + m_axis]
+		         + vertices[3 * faces[3 * i + 2] + m_axis]) / 3.0f;
+		int cell = cellIndex(c);
+		if(cell < begin || cell >= end)
+		{
+			continue;
+		}
+
+		int32_t index[3];
+		for(int j = 0; j < 3; j++)
+		{
+			unsigned int v = faces[3 * i + j];
+			if(outputIndex[v] == -1)
+			{
+				const float* p = &vertices[3 * v];
+				LatticeEdge edge;
+				bool onLattice = latticeEdge(p, m_min, m_voxelsize, edge);
+
+				// Vertex already written by the previous slab
+				if(onLattice && p[m_axis] < lower)
+				{
+					std::unordered_map<LatticeEdge, uint32_t, LatticeEdgeHash>::iterator it = m_seam.find(edge);
+					if(it != m_seam.end())
+					{
+						outputIndex[v] = it->second;
+						numWelded++;
+					}
+				}
+
+				if(outputIndex[v] == -1)
+				{
+					float normal[3] = {0.0f, 0.0f, 0.0f};
+					unsigned char color[3] = {255, 255, 255};
+					if(numNormals == numVertices)
+					{
+						std::copy(&normals[3 * v], &normals[3 * v] + 3, normal);
+					}
+					if(numColors == numVertices)
+					{
+						std::copy(&colors[3 * v], &colors[3 * v] + 3, color);
+					}
+					memcpy(record, p, 3 * sizeof(float));
+					memcpy(record + 3 * sizeof(float), normal, 3 * sizeof(float));
+					memcpy(record + 6 * sizeof(float), color, 3);
+					m_vertexOut.write(record, VERTEX_RECORD);
+
+					outputIndex[v] = m_numVertices++;
+				}
+
+				if(onLattice && p[m_axis] > upper)
+				{
+					seam.insert(std::make_pair(edge, (uint32_t)outputIndex[v]));
+				}
+			}
+			index[j] = outputIndex[v];
+		}
+
+		// Welding may collapse tiny triangles at the seams
+		if(index[0] == index[1] || index[1] == index[2] || index[0] == index[2])
+		{
+			continue;
+		}
+
+		char face[FACE_RECORD];
+		face[0] = 3;
+		memcpy(face + 1, index, 3 * sizeof(int32_t));
+		m_faceOut.write(face, FACE_RECORD);
+		m_numFaces++;
+		numKept++;
+	}
+
+	m_seam.swap(seam);
+
+	cout << timestamp << "Slabs: Kept " << numKept << " of " << numFaces << " faces, "
+	     << numWelded << " welded vertices." << endl;
+}
+
+bool SlabReconstruction::writeMesh(string outputFile)
+{
+	m_vertexOut.close();
+	m_faceOut.close();
+	if(!m_vertexOut.good() || !m_faceOut.good())
+	{
+		cout << timestamp << "Slabs: Unable to write temporary mesh files." << endl;
+		return false;
+	}
+
+	// The records are written in the byte order of this machine
+	int endianTest = 1;
+	bool littleEndian = *(char*)&endianTest == 1;
+
+	ofstream out(outputFile.c_str(), std::ios::binary);
+	out << "ply" << "\n"
+	    << "format " << (littleEndian ? "binary_little_endian" : "binary_big_endian") << " 1.0" << "\n"
+	    << "element vertex " << m_numVertices << "\n"
+	    << "property float x" << "\n"
+	    << "property float y" << "\n"
+	    << "property float z" << "\n"
+	    << "property float nx" << "\n"
+	    << "property float ny" << "\n"
+	    << "property float nz" << "\n"
+	    << "property uchar red" << "\n"
+	    << "property uchar green" << "\n"
+	    << "property uchar blue" << "\n"
+	    << "element face " << m_numFaces << "\n"
+	    << "property list uchar int vertex_indices" << "\n"
+	    << "end_header" << "\n";
+
+	string vertexFile = (boost::filesystem::path(m_tmpDir) / "vertices.bin").string();
+	string faceFile = (boost::filesystem::path(m_tmpDir) / "faces.bin").string();
+	ifstream vertexIn(vertexFile.c_str(), std::ios::binary);
+	ifstream faceIn(faceFile.c_str(), std::ios::binary);
+	if(m_numVertices)
+	{
+		out << vertexIn.rdbuf();
+	}
+	if(m_numFaces)
+	{
+		out << faceIn.rdbuf();
+	}
+	out.close();
+
+	if(!out.good())
+	{
+		cout << timestamp << "Slabs: Unable to write " << outputFile << endl;
+		return false;
+	}
+
+	cout << timestamp << "Slabs: Wrote " << m_numVertices << " vertices and "
+	     << m_numFaces << " faces to " << outputFile << endl;
+	return true;
+}
+
+bool SlabReconstruction::run(string outputFile)
+{
+	if(m_options.optimizePlanes() || m_options.clusterPlanes() || m_options.getDanglingArtifacts()
+	   || m_options.getCleanContourIterations() || m_options.retesselate() || m_options.generateTextures())
+	{
+		cout << timestamp << "Slabs: Mesh optimizations need the whole mesh and are skipped." << endl;
+	}
+	if(m_options.getScanPoseFile() != "")
+	{
+		cout << timestamp << "Slabs: Scan poses are not supported and ignored." << endl;
+	}
+	if(m_options.getDecomposition() == "MT")
+	{
+		cout << timestamp << "Slabs: Tetraeder vertices can not be welded. Using MC decomposition." << endl;
+	}
+	if(m_options.getDecomposition() == "DMC")
+	{
+		cout << timestamp << "Slabs: Adaptive cells do not share the lattice of the seams. Using MC decomposition." << endl;
+	}
+	if(m_options.getDecomposition() == "PMC")
+	{
+		cout << timestamp << "Slabs: Plane contours are moved off the lattice of the seams. Using MC decomposition." << endl;
+	}
+	if(m_options.getSharpFeatureThreshold())
+	{
+		SharpBox<cVertex, cNormal>::m_theta_sharp = m_options.getSharpFeatureThreshold();
+	}
+	if(m_options.getSharpCornerThreshold())
+	{
+		SharpBox<cVertex, cNormal>::m_phi_corner = m_options.getSharpCornerThreshold();
+	}
+
+	ProfilerStage splitStage("split");
+	if(!calcBounds())
+	{
+		return false;
+	}
+	calcSlabs();
+	if(!splitPoints())
+	{
+		return false;
+	}
+
+	// Only the slab files are used from here on
+	m_input.reset();
+	splitStage.stop();
+
+	m_vertexOut.open((boost::filesystem::path(m_tmpDir) / "vertices.bin").string().c_str(), std::ios::binary);
+	m_faceOut.open((boost::filesystem::path(m_tmpDir) / "faces.bin").string().c_str(), std::ios::binary);
+
+	size_t numSlabs = m_slabBegin.size() - 1;
+	size_t minPoints = std::max(m_options.getKn(), std::max(m_options.getKi(), m_options.getKd()));
+	for(size_t s = 0; s < numSlabs; s++)
+	{
+		ProfilerStage slabStage("slab", m_slabPoints[s]);
+		cout << timestamp << "Slabs: Reconstructing slab " << s + 1 << " of " << numSlabs
+		     << " with " << m_slabPoints[s] << " points." << endl;
+
+		PointBufferPtr buffer = loadSlab(s);
+		MeshBufferPtr mesh;
+		if(buffer && m_slabPoints[s] > minPoints)
+		{
+			mesh = reconstructSlab(buffer);
+		}
+		buffer.reset();
+
+		if(mesh)
+		{
+			appendSlab(mesh, s);
+		}
+		else
+		{
+			// Nothing to weld to the next slab
+			m_seam.clear();
+		}
+	}
+	m_seam.clear();
+
+	ProfilerStage writeStage("io_write", m_numFaces);
+	return writeMesh(outputFile);
+}
+
+int SlabReconstruction::cellIndex(float c) const
+{
+	return (int)floorf((c - m_min[m_axis]) / m_voxelsize + 0.5f);
+}
+
+string SlabReconstruction::slabFile(size_t slab) const
+{
+	std::stringstream name;
+	name << "slab-" << slab << ".bin";
+	return (boost::filesystem::path(m_tmpDir) / name.str()).string();
+}
+
+} // namespace lvr
@@ -0,0 +1,173 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * SlabReconstruction.hpp
+ */
+
+#ifndef SLABRECONSTRUCTION_HPP_
+#define SLABRECONSTRUCTION_HPP_
+
+#include "Options.hpp"
+
+#include <lvr/io/PointBuffer.hpp>
+#include <lvr/io/MeshBuffer.hpp>
+#include <lvr/geometry/Vertex.hpp>
+#include <lvr/reconstruction/LatticeEdge.hpp>
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief   Out-of-core reconstruction on a single machine.
+ *
+ *          The bounding box of the input is cut into slabs along its
+ *          longest axis, each with at most a given number of points. The
+ *          points are distributed into temporary files, every slab gets
+ *          the points of a margin around it as well. The slabs are then
+ *          reconstructed one after another with their own search tree and
+ *          grid. All grids share the lattice of the global bounding box,
+ *          so query points on both sides of a seam are identical. Each
+ *          slab only keeps the triangles of its own cells, welds the
+ *          vertices on its lower seam to those of the previous slab and
+ *          appends its mesh to the output. Only one slab and the vertices
+ *          of one seam are held in memory.
+ */
+class SlabReconstruction
+{
+public:
+
+	/**
+	 * @brief   Creates a slab reconstruction with the parameters of the
+	 *          given options
+	 */
+	SlabReconstruction(const reconstruct::Options& options);
+
+	/// Removes the temporary files
+	~SlabReconstruction();
+
+	/**
+	 * @brief   Reconstructs the input file of the options and writes the
+	 *          mesh as binary PLY file
+	 *
+	 * @return  false if the input could not be read or the output could
+	 *          not be written
+	 */
+	bool run(string outputFile);
+
+private:
+
+	/// Callback for a chunk of points and their normals (may be 0)
+	typedef std::function<void(const float*, const float*, size_t)> PointFunction;
+
+	/**
+	 * @brief   Calls f for all input points. ASCII, LAS and binary PLY
+	 *          files are streamed in chunks, all other formats are read
+	 *          once and kept until the points are distributed to the slabs.
+	 */
+	bool readPoints(PointFunction f);
+
+	/// Computes the bounding box, the voxel size and the slab axis
+	bool calcBounds();
+
+	/// Cuts the longest axis into slabs of at most m_maxPoints points
+	void calcSlabs();
+
+	/// Writes the points of each slab and its margin to a temporary file
+	bool splitPoints();
+
+	/// Reads the points of a slab
+	PointBufferPtr loadSlab(size_t slab);
+
+	/// Reconstructs the raw mesh of the points of a slab
+	MeshBufferPtr reconstructSlab(PointBufferPtr buffer);
+
+	/**
+	 * @brief   Appends the triangles of the cells of a slab to the output
+	 *          and welds its lower seam to the previous slab
+	 */
+	void appendSlab(MeshBufferPtr mesh, size_t slab);
+
+	/// Writes the PLY header and the collected vertices and faces
+	bool writeMesh(string outputFile);
+
+	/// Returns the lattice index of a coordinate along the slab axis
+	int cellIndex(float c) const;
+
+	/// Returns the temporary point file of a slab
+	string slabFile(size_t slab) const;
+
+	const reconstruct::Options&  m_options;
+
+	/// Maximum number of points of a slab without its margin
+	size_t          m_maxPoints;
+
+	/// Width of the slab margins in voxels
+	int             m_margin;
+
+	/// Directory for the temporary files
+	string          m_tmpDir;
+
+	/// The points of an input file that can't be streamed until they are distributed
+	PointBufferPtr  m_input;
+
+	/// Whether the slab files contain point normals
+	bool            m_useNormals;
+
+	/// Whether the shift of georeferenced LAS input was reported
+	bool            m_shifted;
+
+	/// Bounding box of all points, its minimum is the lattice origin
+	Vertexf         m_min;
+	Vertexf         m_max;
+
+	float           m_voxelsize;
+
+	/// Index of the longest axis of the bounding box
+	int             m_axis;
+
+	/// First lattice index of each slab along the axis and the end index
+	vector<int>     m_slabBegin;
+
+	/// Number of points of each slab including its margin
+	vector<size_t>  m_slabPoints;
+
+	/// Vertices and faces of the output mesh
+	std::ofstream   m_vertexOut;
+	std::ofstream   m_faceOut;
+	size_t          m_numVertices;
+	size_t          m_numFaces;
+
+	/// Output indices of the vertices on the upper seam of the last slab
+	std::unordered_map<LatticeEdge, uint32_t, LatticeEdgeHash> m_seam;
+};
+
+} // namespace lvr
+
+#endif /* SLABRECONSTRUCTION_HPP_ */
@@ -89,19 +89,51 @@ int main(int argc, char** argv)
 		cout << "come here" << endl;
 		mesh.setDimension(options.getDimension());
 		cout << "here" << endl;
-		mesh.setValue(options.getValue());
+		if(!options.isStack())
+		{
+			mesh.setValue(options.getValue());
+		}
 				cout << "here2" << endl;
 		// Load and slice mesh
 		mesh.addMesh(input_mesh);
-		cout << "here3" << endl;
-		vector<float> segments = mesh.compute2dSlice();
-		 		cout << "here4" << endl;
-		cout << "Slice Segments:" << endl; 	
-		for(int i = 0; i < segments.size(); i+=6)
+
+		if(options.isStack())
 		{
-			cout << "(" << segments.at(i) << ", " << segments.at(i+1) << ", " << segments.at(i+2) << ") to (" << segments.at(i+3) << ", " << segments.at(i+4) << ", " << segments.at(i+5) << ")" << endl;
-		}	
-		 	
+			// Compute each value from its index so that rounding errors don't
+			// accumulate and drop the slice at max
+			double min = options.getMin();
+			double step = options.getStep();
+			vector<double> values;
+			for(long i = 0; min + i * step <= options.getMax() + 1e-9 * step; i++)
+			{
+				values.push_back(min + i * step);
+			}
+
+			vector<vector<MeshSlicer::Polyline> > slices = mesh.compute2dSlices(values);
+			for(size_t l = 0; l < slices.size(); l++)
+			{
+				cout << "Slice " << values[l] << ": " << slices[l].size() << " polyline(s)" << endl;
+				for(size_t p = 0; p < slices[l].size(); p++)
+				{
+					const MeshSlicer::Polyline& line = slices[l][p];
+					for(size_t i = 0; i < line.size(); i += 3)
+					{
+						cout << (i ? " " : "") << "(" << line[i] << ", " << line[i+1] << ", " << line[i+2] << ")";
+					}
+					cout << endl;
+				}
+			}
+		}
+		else
+		{
+			vector<float> segments = mesh.compute2dSlice();
+			cout << "Slice Segments:" << endl;
+			for(int i = 0; i < segments.size(); i+=6)
+			{
+				cout << "(" << segments.at(i) << ", " << segments.at(i+1) << ", " << segments.at(i+2) << ") to (" << segments.at(i+3) << ", " << segments.at(i+4) << ", " << segments.at(i+5) << ")" << endl;
+			}
+		}
+
      	cout << endl << timestamp << "Program end." << endl;
 	}
 	catch(...)
@@ -37,6 +37,9 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
 		        ("input", value< vector<string> >(), "Input file name. Supported formats are .ply")
 		        ("dimension", value< vector<string> >(), "Dimension parameter for the AABB Search.")
 		        ("value", value< vector<double> >(), "Dimension value for the AABB Search.")
+		        ("min", value<double>(), "Position of the first slice of a stack.")
+		        ("max", value<double>(), "Upper bound of the slice positions of a stack.")
+		        ("step", value<double>(), "Distance between the slices of a stack. If given, all slices between min and max are computed in parallel.")
         ;
 
 	m_pdescr.add("input", -1);
@@ -72,6 +75,26 @@ double Options::getValue() const
 	return (m_variables["value"].as< vector<double> >())[0];
 }
 
+bool Options::isStack() const
+{
+	return m_variables.count("step") > 0;
+}
+
+double Options::getMin() const
+{
+	return m_variables["min"].as<double>();
+}
+
+double Options::getMax() const
+{
+	return m_variables["max"].as<double>();
+}
+
+double Options::getStep() const
+{
+	return m_variables["step"].as<double>();
+}
+
 bool Options::printUsage() const
 {
   if(!m_variables.count("input"))
@@ -90,7 +113,17 @@ bool Options::printUsage() const
       return true;
     }
     
-     if(!m_variables.count("value") || m_variables.count("value") > 1)
+    if(isStack())
+    {
+      if(!m_variables.count("min") || !m_variables.count("max") || getStep() <= 0)
+      {
+        cout << "Error: A stack of slices needs min, max and a positive step." << endl;
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+      }
+    }
+    else if(!m_variables.count("value") || m_variables.count("value") > 1)
     {
       cout << "Error: You must specify exactly one value." << endl;
       cout << endl;
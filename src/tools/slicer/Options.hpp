@@ -74,6 +74,27 @@ public:
 	 */
 	double getValue() const;
 
+	/**
+	 * @brief	Returns true if a stack of slices between min and max
+	 *		should be computed
+	 */
+	bool isStack() const;
+
+	/**
+	 * @brief	Returns the position of the first slice of a stack
+	 */
+	double getMin() const;
+
+	/**
+	 * @brief	Returns the upper bound of the slice positions of a stack
+	 */
+	double getMax() const;
+
+	/**
+	 * @brief	Returns the distance between two slices of a stack
+	 */
+	double getStep() const;
+
 private:
 
 	/// The internally used variable map
@@ -94,7 +115,16 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	cout << endl;
 	cout << "##### Input: " << o.getInputFileName() << endl;
     cout << "##### Dimension \t\t: " << o.getDimension().c_str() << endl;
-    cout << "##### Value \t\t: " << o.getValue() << endl;
+    if(o.isStack())
+    {
+        cout << "##### Min \t\t: " << o.getMin() << endl;
+        cout << "##### Max \t\t: " << o.getMax() << endl;
+        cout << "##### Step \t\t: " << o.getStep() << endl;
+    }
+    else
+    {
+        cout << "##### Value \t\t: " << o.getValue() << endl;
+    }
 	
 	return os;
 }
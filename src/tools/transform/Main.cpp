@@ -29,6 +29,7 @@
 #include <lvr/geometry/Vertex.hpp>
 #include <lvr/io/Model.hpp>
 #include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/IOUtils.hpp>
 #include <lvr/io/Timestamp.hpp>
 #include <iostream>
 #include <cmath>
@@ -139,6 +140,20 @@ int main(int argc, char **argv)
       mat = Matrix4<float>(Vertex3f(x, y, z), Vertex3f(r1, r2, r3));
     }
 
+    // Apply the scaling after the transformation by scaling the
+    // rows of the matrix
+    float matrix[16];
+    for(int i = 0; i < 16; i++)
+      matrix[i] = mat[i];
+
+    float scale[3];
+    scale[0] = options.anyScaleX() ? options.getScaleX() : 1.0f;
+    scale[1] = options.anyScaleY() ? options.getScaleY() : 1.0f;
+    scale[2] = options.anyScaleZ() ? options.getScaleZ() : 1.0f;
+    for(int c = 0; c < 4; c++)
+      for(int r = 0; r < 3; r++)
+        matrix[4 * c + r] *= scale[r];
+
     // Get point buffer
     if(model->m_pointCloud)
     {
@@ -146,17 +161,9 @@ int main(int argc, char **argv)
 
       cout << timestamp << "Using points" << endl;
       did_anything = true;
-      coord3fArr points = p_buffer->getIndexedPointArray(num);
+      floatArr points = p_buffer->getPointArray(num);
       cout << mat;
-      for(size_t i = 0; i < num; i++)
-      {
-        Vertex<float> v(points[i][0], points[i][1], points[i][2]);
-        v = mat * v;
-        points[i][0] = options.anyScaleX() ? v[0] * options.getScaleX() : v[0];
-        points[i][1] = options.anyScaleY() ? v[1] * options.getScaleY() : v[1];
-        points[i][2] = options.anyScaleZ() ? v[2] * options.getScaleZ() : v[2];
-      }
-      p_buffer->setIndexedPointArray(points, num);
+      transformPoints(points.get(), num, matrix);
     }
 
     // Get mesh buffer
@@ -166,17 +173,8 @@ int main(int argc, char **argv)
 
       cout << timestamp << "Using meshes" << endl;
       did_anything = true;
-      coord3fArr points = m_buffer->getIndexedVertexArray(num);
-
-      for(size_t i = 0; i < num; i++)
-      {
-        Vertex<float> v(points[i][0], points[i][1], points[i][2]);
-        v = mat * v;
-        points[i][0] = options.anyScaleX() ? v[0] * options.getScaleX() : v[0];
-        points[i][1] = options.anyScaleY() ? v[1] * options.getScaleY() : v[1];
-        points[i][2] = options.anyScaleZ() ? v[2] * options.getScaleZ() : v[2];
-      }
-      m_buffer->setIndexedVertexArray(points, num);
+      floatArr points = m_buffer->getVertexArray(num);
+      transformPoints(points.get(), num, matrix);
     }
 
     if(!did_anything)
@@ -0,0 +1,77 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * LVRBridgeBenchmark.cpp
+ *
+ * Headless timing of the vtk bridge construction. Only the VTK data
+ * structures are created, no render window is opened, so this can be
+ * run on machines without a display.
+ */
+#include "../vtkBridge/LVRModelBridge.hpp"
+
+#include <lvr/io/ModelFactory.hpp>
+#include <lvr/io/Timestamp.hpp>
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace lvr;
+using std::cout;
+using std::endl;
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        cout << "Usage: " << argv[0] << " <model file> [iterations]" << endl;
+        return 0;
+    }
+
+    int iterations = 1;
+    if(argc > 2)
+    {
+        iterations = std::max(1, atoi(argv[2]));
+    }
+
+    Timestamp ts;
+    ModelPtr model = ModelFactory::readModel(argv[1]);
+    if(!model)
+    {
+        cout << timestamp << "IO Error: Unable to parse " << argv[1] << endl;
+        return -1;
+    }
+    cout << timestamp << "Loading model took " << ts.getElapsedTimeInMs() << " ms" << endl;
+
+    double total = 0.0;
+    for(int i = 0; i < iterations; i++)
+    {
+        ts.resetTimer();
+        LVRModelBridge bridge(model);
+        unsigned long elapsed = ts.getElapsedTimeInMs();
+        total += elapsed;
+        cout << timestamp << "Bridge construction " << i + 1 << " / " << iterations
+             << ": " << elapsed << " ms" << endl;
+    }
+
+    cout << timestamp << "Average bridge construction time: "
+         << total / iterations << " ms" << endl;
+
+    return 0;
+}
@@ -400,7 +400,7 @@ void LVRMainWindow::exportSelectedModel()
         {
             if(item->parent() && item->parent()->type() == LVRModelItemType)
             {
-                QString qFileName = QFileDialog::getSaveFileName(this, tr("Export Point Cloud As..."), "", tr("Point cloud Files(*.ply *.3d)"));
+                QString qFileName = QFileDialog::getSaveFileName(this, tr("Export Point Cloud As..."), "", tr("Point cloud Files(*.ply *.3d *.las *.laz)"));
 
                 LVRModelItem* model_item = static_cast<LVRModelItem*>(item->parent());
                 LVRPointCloudItem* pc_item = static_cast<LVRPointCloudItem*>(item);
@@ -526,7 +526,7 @@ void LVRMainWindow::renameModelItem()
 
 void LVRMainWindow::loadModel()
 {
-    QStringList filenames = QFileDialog::getOpenFileNames(this, tr("Open Model"), "", tr("Model Files (*.ply *.obj *.pts *.3d *.txt)"));
+    QStringList filenames = QFileDialog::getOpenFileNames(this, tr("Open Model"), "", tr("Model Files (*.ply *.obj *.pts *.3d *.txt *.las *.laz)"));
 
     if(filenames.size() > 0)
     {
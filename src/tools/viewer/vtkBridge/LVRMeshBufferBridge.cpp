@@ -37,6 +37,8 @@
 #include <vtkFloatArray.h>
 #include <vtkPointData.h>
 #include <vtkCellData.h>
+#include <vtkIdTypeArray.h>
+#include <vtkUnsignedCharArray.h>
 
 namespace lvr
 {
@@ -80,6 +82,11 @@ LVRMeshBufferBridge::LVRMeshBufferBridge(const LVRMeshBufferBridge& b)
     m_numVertices   = b.m_numVertices;
     m_numFaces      = b.m_numFaces;
     m_meshActor     = b.m_meshActor;
+    m_wireframeActor    = b.m_wireframeActor;
+    m_meshBuffer        = b.m_meshBuffer;
+    m_numColoredFaces   = b.m_numColoredFaces;
+    m_numTexturedFaces  = b.m_numTexturedFaces;
+    m_numTextures       = b.m_numTextures;
 }
 
 size_t	LVRMeshBufferBridge::getNumColoredFaces()
@@ -131,46 +138,41 @@ void LVRMeshBufferBridge::computeMeshActor(MeshBufferPtr meshbuffer)
         vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
         vtkSmartPointer<vtkCellArray> triangles = vtkSmartPointer<vtkCellArray>::New();
 
-        vtkSmartPointer<vtkUnsignedCharArray> scalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
-        scalars->SetNumberOfComponents(3);
-        scalars->SetName("Colors");
-
-        for(size_t i = 0; i < n_v; i++){
-            size_t index = 3 * i;
-            points->InsertNextPoint(
-                    vertices[index    ],
-                    vertices[index + 1],
-                    vertices[index + 2]);
-
-        	if(n_c)
-        	{
-        		unsigned char color[3];
-        		color[0] = colors[index];
-        		color[1] = colors[index + 1];
-        		color[2] = colors[index + 2];
-        		scalars->InsertNextTupleValue(color);
-        	}
-        }
-
-        for(size_t i = 0; i < n_i; i++)
+        // Wrap the vertex buffer without copying it (save = 1, the
+        // memory stays owned by m_meshBuffer)
+        vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+        coords->SetNumberOfComponents(3);
+        coords->SetArray(vertices.get(), 3 * n_v, 1);
+        points->SetData(coords);
+
+        // The index type of VTK differs from our unsigned int
+        // buffers, so the connectivity has to be converted. Do it in
+        // one bulk pass into the legacy (3, a, b, c) cell layout.
+        vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New();
+        cells->SetNumberOfValues(4 * n_i);
+        vtkIdType* ids = cells->GetPointer(0);
+
+        #pragma omp parallel for schedule(static)
+        for(long i = 0; i < (long)n_i; i++)
         {
-
-
             size_t index = 3 * i;
-            vtkSmartPointer<vtkTriangle> t = vtkSmartPointer<vtkTriangle>::New();
-            t->GetPointIds()->SetId(0, indices[index]);
-            t->GetPointIds()->SetId(1, indices[index + 1]);
-            t->GetPointIds()->SetId(2, indices[index + 2]);
-            triangles->InsertNextCell(t);
-
+            ids[4 * i    ] = 3;
+            ids[4 * i + 1] = indices[index    ];
+            ids[4 * i + 2] = indices[index + 1];
+            ids[4 * i + 3] = indices[index + 2];
         }
+        triangles->SetCells(n_i, cells);
 
         mesh->SetPoints(points);
         mesh->SetPolys(triangles);
 
-        if(n_c)
+        if(n_c == n_v && n_c)
         {
-        	mesh->GetPointData()->SetScalars(scalars);
+            vtkSmartPointer<vtkUnsignedCharArray> scalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
+            scalars->SetNumberOfComponents(3);
+            scalars->SetName("Colors");
+            scalars->SetArray(colors.get(), 3 * n_c, 1);
+            mesh->GetPointData()->SetScalars(scalars);
         }
 
         vtkSmartPointer<vtkPolyDataMapper> mesh_mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
@@ -69,6 +69,9 @@ protected:
     size_t                          m_numFaces;
     vtkSmartPointer<vtkActor>       m_meshActor;
     vtkSmartPointer<vtkActor>       m_wireframeActor;
+
+    /// Vertices and colors of the actors are not copied. VTK references
+    /// the arrays of this buffer directly.
     MeshBufferPtr                   m_meshBuffer;
 
     size_t							m_numColoredFaces;
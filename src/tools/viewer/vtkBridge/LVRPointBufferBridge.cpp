@@ -33,11 +33,15 @@
 #include <vtkActor.h>
 #include <vtkProperty.h>
 #include <vtkPointData.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkUnsignedCharArray.h>
 
 namespace lvr
 {
 
 LVRPointBufferBridge::LVRPointBufferBridge(PointBufferPtr pointCloud)
+    : m_numPoints(0), m_hasNormals(false), m_hasColors(false)
 {
     if(pointCloud)
     {
@@ -99,42 +103,42 @@ void LVRPointBufferBridge::computePointCloudActor(PointBufferPtr pc)
         vtkSmartPointer<vtkPoints>      vtk_points = vtkSmartPointer<vtkPoints>::New();
         vtkSmartPointer<vtkCellArray>   vtk_cells = vtkSmartPointer<vtkCellArray>::New();
 
-        vtkSmartPointer<vtkUnsignedCharArray> scalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
-        scalars->SetNumberOfComponents(3);
-        scalars->SetName("Colors");
-
-        double point[3];
         size_t n, n_c;
         floatArr points = pc->getPointArray(n);
         ucharArr colors = pc->getPointColorArray(n_c);
 
-        for(vtkIdType i = 0; i < n; i++)
+        // Wrap the point buffer without copying it. The last parameter
+        // (save = 1) tells VTK not to free the memory. The buffer is kept
+        // alive by m_pointBuffer as long as this bridge exists.
+        vtkSmartPointer<vtkFloatArray> vtk_coords = vtkSmartPointer<vtkFloatArray>::New();
+        vtk_coords->SetNumberOfComponents(3);
+        vtk_coords->SetArray(points.get(), 3 * n, 1);
+        vtk_points->SetData(vtk_coords);
+
+        // Generate all vertex cells at once. The legacy cell layout
+        // is (1, id) for every point.
+        vtkSmartPointer<vtkIdTypeArray> vtk_ids = vtkSmartPointer<vtkIdTypeArray>::New();
+        vtk_ids->SetNumberOfValues(2 * n);
+        vtkIdType* ids = vtk_ids->GetPointer(0);
+
+        #pragma omp parallel for schedule(static)
+        for(vtkIdType i = 0; i < (vtkIdType)n; i++)
         {
-        	int index = 3 * i;
-            point[0] = points[index    ];
-            point[1] = points[index + 1];
-            point[2] = points[index + 2];
-
-            if(n_c)
-            {
-            	unsigned char color[3];
-            	color[0] = colors[index];
-            	color[1] = colors[index + 1];
-            	color[2] = colors[index + 2];
-
-            	scalars->InsertNextTupleValue(color);
-            }
-
-            vtk_points->InsertNextPoint(point);
-            vtk_cells->InsertNextCell(1, &i);
+            ids[2 * i    ] = 1;
+            ids[2 * i + 1] = i;
         }
+        vtk_cells->SetCells(n, vtk_ids);
 
         vtk_polyData->SetPoints(vtk_points);
         vtk_polyData->SetVerts(vtk_cells);
 
-        if(n_c)
+        if(n_c == n && n_c)
         {
-               	vtk_polyData->GetPointData()->SetScalars(scalars);
+            vtkSmartPointer<vtkUnsignedCharArray> scalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
+            scalars->SetNumberOfComponents(3);
+            scalars->SetName("Colors");
+            scalars->SetArray(colors.get(), 3 * n_c, 1);
+            vtk_polyData->GetPointData()->SetScalars(scalars);
         }
 
         // Create poly data mapper and generate actor
@@ -155,6 +159,7 @@ LVRPointBufferBridge::LVRPointBufferBridge(const LVRPointBufferBridge& b)
     m_hasColors         = b.m_hasColors;
     m_hasNormals        = b.m_hasNormals;
     m_numPoints         = b.m_numPoints;
+    m_pointBuffer       = b.m_pointBuffer;
 }
 
 void LVRPointBufferBridge::setBaseColor(float r, float g, float b)
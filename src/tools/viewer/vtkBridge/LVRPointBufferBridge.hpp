@@ -64,6 +64,9 @@ protected:
     size_t                          m_numPoints;
     bool                            m_hasNormals;
     bool                            m_hasColors;
+
+    /// The VTK arrays of the actor reference the memory of this buffer
+    /// directly, so it has to be kept alive as long as the actor is used.
     PointBufferPtr                  m_pointBuffer;
 };
 